@@ -0,0 +1,344 @@
+/**
+ * @file bench_core.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief core_lib 的基准测试入口：覆盖全部公开接口，输出 JSON，并可与基线对比
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * 用法：
+ *   bench_core [--sizes 64,256,1024,4096] [--full] [--images sparse,dense,photo,screenshot]
+ *              [--channels 1|3|both] [--filter 子串] [--min-time 秒]
+ *              [--out result.json] [--compare baseline.json] [--threshold 0.10] [--tmp 目录]
+ *
+ * 表格输出到 stderr，JSON 输出到 --out 指定的文件（未指定时输出到 stdout）。
+ * --full 追加 8192 与 16384 两档尺寸（只对内存占用与像素数成正比的项生效，见 Benches() 中的 max_size）。
+ * --compare 时中位数耗时比基线慢 threshold 以上的项记为退化，存在退化时返回码为 1。
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgproc.hpp>
+#include "codec/compressor.h"
+#include "data_structure/triplet.h"
+#include "data_structure/triplet_buffer.h"
+#include "imgproc/image_processor.h"
+#include "imgproc/image_stats.h"
+#include "io/image_io.h"
+#include "io/ppm.h"
+#include "harness.h"
+#include "synthetic.h"
+
+namespace {
+
+/**
+ * @brief 一项基准测试
+ *
+ * @details prepare 在计时前执行准备工作（如生成输入文件），返回被计时的函数。
+ */
+struct Bench {
+    const char* name;
+    int max_size;           ///< 超过该边长时跳过（文本格式或 AoS 三元组在超大图上耗时与内存不可接受）
+    bool needs_color;       ///< 只对三通道图像有意义
+    std::function<std::function<void()>(const cv::Mat& img, const std::string& tmp_prefix)> prepare;
+};
+
+// 防止编译器把结果优化掉
+volatile size_t g_sink = 0;
+void Consume(const cv::Mat& m) { g_sink += m.total(); }
+
+const std::vector<Bench>& Benches() {
+    static const std::vector<Bench> benches = {
+        {"Processor::ToGray", 16384, true, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] { Consume(Processor::ToGray(img)); });
+        }},
+        {"Processor::Resize(1/2)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] { Consume(Processor::Resize(img, img.cols / 2, img.rows / 2)); });
+        }},
+        {"Processor::Resize(2x)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] { Consume(Processor::Resize(img, img.cols * 2, img.rows * 2)); });
+        }},
+        {"Processor::Resize(1/2,reuse)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            auto out = std::make_shared<cv::Mat>();   // 输出复用：稳态下每次调用不分配
+            return std::function<void()>([img, out] { Processor::Resize(img, img.cols / 2, img.rows / 2, *out); Consume(*out); });
+        }},
+        {"Processor::Resize(bicubic,2x)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] {
+                Consume(Processor::Resize(img, img.cols * 2, img.rows * 2, Processor::Interpolation::kBicubic));
+            });
+        }},
+        {"Processor::Resize(lanczos3,1/2)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] {
+                Consume(Processor::Resize(img, img.cols / 2, img.rows / 2, Processor::Interpolation::kLanczos3));
+            });
+        }},
+        {"Processor::BoxBlur(r=2)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            auto out = std::make_shared<cv::Mat>();
+            return std::function<void()>([img, out] { Processor::BoxBlur(img, *out, 2); Consume(*out); });
+        }},
+        {"Processor::BoxBlur(r=32)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            auto out = std::make_shared<cv::Mat>();
+            return std::function<void()>([img, out] { Processor::BoxBlur(img, *out, 32); Consume(*out); });
+        }},
+        {"Processor::GaussianBlur(sigma=4)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            auto out = std::make_shared<cv::Mat>();
+            return std::function<void()>([img, out] { Processor::GaussianBlur(img, *out, 4.0); Consume(*out); });
+        }},
+        // 参照项：OpenCV 自带实现，用于对比高质量插值的吞吐量
+        {"cv::resize(INTER_CUBIC,2x)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] {
+                cv::Mat out;
+                cv::resize(img, out, cv::Size(img.cols * 2, img.rows * 2), 0, 0, cv::INTER_CUBIC);
+                Consume(out);
+            });
+        }},
+        {"cv::resize(INTER_LANCZOS4,1/2)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] {
+                cv::Mat out;
+                cv::resize(img, out, cv::Size(img.cols / 2, img.rows / 2), 0, 0, cv::INTER_LANCZOS4);
+                Consume(out);
+            });
+        }},
+        {"TripletUtils::FindBackgroundColor", 16384, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] {
+                uint8_t bg[3];
+                TripletUtils::FindBackgroundColor(img, bg);
+                g_sink += bg[0];
+            });
+        }},
+        {"TripletUtils::MatToTriplets(vec)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            auto bg = std::make_shared<std::vector<uint8_t>>(3);
+            TripletUtils::FindBackgroundColor(img, bg->data());
+            return std::function<void()>([img, bg] {
+                std::vector<TripletNode> t;
+                TripletUtils::MatToTriplets(img, bg->data(), t);
+                g_sink += t.size();
+            });
+        }},
+        {"TripletUtils::TripletsToMat(vec)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            auto bg = std::make_shared<std::vector<uint8_t>>(3);
+            TripletUtils::FindBackgroundColor(img, bg->data());
+            auto t = std::make_shared<std::vector<TripletNode>>();
+            TripletUtils::MatToTriplets(img, bg->data(), *t);
+            return std::function<void()>([img, bg, t] {
+                cv::Mat out;
+                TripletUtils::TripletsToMat(*t, img.cols, img.rows, img.channels(), bg->data(), out);
+                Consume(out);
+            });
+        }},
+        {"TripletUtils::MatToTriplets(soa)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            auto bg = std::make_shared<std::vector<uint8_t>>(3);
+            TripletUtils::FindBackgroundColor(img, bg->data());
+            auto t = std::make_shared<TripletBuffer>();   // 复用容量，与批处理中的用法一致
+            return std::function<void()>([img, bg, t] {
+                TripletUtils::MatToTriplets(img, bg->data(), *t);
+                g_sink += t->size();
+            });
+        }},
+        {"TripletUtils::TripletsToMat(soa)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            uint8_t bg[3];
+            TripletUtils::FindBackgroundColor(img, bg);
+            auto t = std::make_shared<TripletBuffer>();
+            TripletUtils::MatToTriplets(img, bg, *t);
+            return std::function<void()>([t] {
+                cv::Mat out;
+                TripletUtils::TripletsToMat(*t, out);
+                Consume(out);
+            });
+        }},
+        {"TripletUtils::DiffToTriplets(1%)", 16384, false, [](const cv::Mat& img, const std::string&) {
+            // 左上角 1/10 x 1/10 的区域有变化，模拟屏幕录制中相邻两帧的差异
+            cv::Mat cur = img.clone();
+            for (int r = 0; r < img.rows / 10; ++r) {
+                for (int c = 0; c < img.cols / 10; ++c) cur.ptr<uint8_t>(r)[c * img.elemSize()] ^= 1;
+            }
+            auto arena = std::make_shared<TripletArena>();
+            return std::function<void()>([img, cur, arena] {
+                arena->Reset();
+                TripletBuffer t(arena.get());
+                TripletUtils::DiffToTriplets(cur, img, 0, t);
+                g_sink += t.size();
+            });
+        }},
+        {"ImageStats::Compute", 16384, false, [](const cv::Mat& img, const std::string&) {
+            return std::function<void()>([img] { g_sink += ImageStats::Compute(img).unique_colors; });
+        }},
+        {"Compressor::Save", 16384, false, [](const cv::Mat& img, const std::string& tmp) {
+            auto arena = std::make_shared<TripletArena>();
+            std::string path = tmp + ".trip";
+            return std::function<void()>([img, arena, path] { g_sink += Compressor::Save(path, img, arena.get()); });
+        }},
+        {"Compressor::Load", 16384, false, [](const cv::Mat& img, const std::string& tmp) {
+            auto arena = std::make_shared<TripletArena>();
+            std::string path = tmp + ".trip";
+            Compressor::Save(path, img);
+            return std::function<void()>([arena, path] { Consume(Compressor::Load(path, arena.get())); });
+        }},
+        {"Ppm::SaveNatAsPpm", 4096, false, [](const cv::Mat& img, const std::string& tmp) {
+            std::string path = tmp + ".ppm";
+            return std::function<void()>([img, path] { g_sink += Ppm::SaveNatAsPpm(path, img); });
+        }},
+        {"Ppm::LoadPpmAsMat", 4096, false, [](const cv::Mat& img, const std::string& tmp) {
+            std::string path = tmp + ".ppm";
+            Ppm::SaveNatAsPpm(path, img);
+            return std::function<void()>([path] { Consume(Ppm::LoadPpmAsMat(path)); });
+        }},
+        {"ImageIO::EncodeToBuffer(png)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            auto buf = std::make_shared<std::vector<uint8_t>>();   // 复用输出缓冲区
+            return std::function<void()>([img, buf] {
+                ImageIO::EncodeToBuffer(img, "png", ImageIO::EncodeOptions(), buf.get());
+                g_sink += buf->size();
+            });
+        }},
+        {"ImageIO::DecodeFromBuffer(png)", 4096, false, [](const cv::Mat& img, const std::string&) {
+            auto buf = std::make_shared<std::vector<uint8_t>>();
+            ImageIO::EncodeToBuffer(img, "png", ImageIO::EncodeOptions(), buf.get());
+            return std::function<void()>([buf] { Consume(ImageIO::DecodeFromBuffer(buf->data(), buf->size())); });
+        }},
+    };
+    return benches;
+}
+
+// 把 "a,b,c" 拆成字符串列表
+std::vector<std::string> Split(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+int Usage() {
+    std::cerr << "usage: bench_core [--sizes 64,256,1024,4096] [--full] [--images sparse,dense,photo,screenshot]\n"
+                 "                  [--channels 1|3|both] [--filter substr] [--min-time seconds]\n"
+                 "                  [--out result.json] [--compare baseline.json] [--threshold 0.10] [--tmp dir]\n";
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {64, 256, 1024, 4096};
+    std::vector<Synthetic::Kind> kinds = Synthetic::All();
+    std::vector<int> channel_list = {3};
+    std::string filter, out_path, compare_path;
+    std::string tmp_dir = std::filesystem::temp_directory_path().string();
+    double threshold = 0.10;
+    BenchConfig config;
+
+    // 解析参数
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string* v) {
+            if (i + 1 >= argc) return false;
+            *v = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (arg == "--full") {
+            sizes.push_back(8192);
+            sizes.push_back(16384);
+        } else if (arg == "--sizes" && next(&v)) {
+            sizes.clear();
+            for (const std::string& s : Split(v)) sizes.push_back(std::atoi(s.c_str()));
+        } else if (arg == "--images" && next(&v)) {
+            kinds.clear();
+            for (const std::string& s : Split(v)) {
+                Synthetic::Kind k;
+                if (!Synthetic::Parse(s, &k)) {
+                    std::cerr << "unknown image kind: " << s << std::endl;
+                    return Usage();
+                }
+                kinds.push_back(k);
+            }
+        } else if (arg == "--channels" && next(&v)) {
+            if (v == "both") channel_list = {1, 3};
+            else if (v == "1" || v == "3") channel_list = {std::atoi(v.c_str())};
+            else return Usage();
+        } else if (arg == "--filter" && next(&v)) {
+            filter = v;
+        } else if (arg == "--min-time" && next(&v)) {
+            config.min_time_s = std::atof(v.c_str());
+        } else if (arg == "--out" && next(&v)) {
+            out_path = v;
+        } else if (arg == "--compare" && next(&v)) {
+            compare_path = v;
+        } else if (arg == "--threshold" && next(&v)) {
+            threshold = std::atof(v.c_str());
+        } else if (arg == "--tmp" && next(&v)) {
+            tmp_dir = v;
+        } else {
+            return Usage();
+        }
+    }
+    for (int s : sizes) {
+        if (s <= 0) return Usage();
+    }
+
+    // 逐个图像运行全部测试项
+    std::vector<BenchResult> results;
+    const std::string tmp_prefix = (std::filesystem::path(tmp_dir) / "bench_core_input").string();
+    for (int channels : channel_list) {
+        for (Synthetic::Kind kind : kinds) {
+            for (int size : sizes) {
+                cv::Mat img;   // 只在有测试项需要时生成
+                for (const Bench& bench : Benches()) {
+                    if (size > bench.max_size || (bench.needs_color && channels != 3)) continue;
+                    if (!filter.empty() && std::string(bench.name).find(filter) == std::string::npos) continue;
+                    if (img.empty()) img = Synthetic::Make(kind, size, channels);
+
+                    size_t pixels = img.total();
+                    BenchResult r = Harness::Measure(config, bench.prepare(img, tmp_prefix), pixels, pixels * img.elemSize());
+                    r.name = bench.name;
+                    r.image = Synthetic::Name(kind);
+                    r.size = size;
+                    r.channels = channels;
+                    results.push_back(r);
+                    std::cerr << "." << std::flush;
+                }
+            }
+        }
+    }
+    std::cerr << "\n";
+    for (const char* ext : {".trip", ".ppm"}) {
+        std::error_code ec;
+        std::filesystem::remove(tmp_prefix + ext, ec);
+    }
+
+    Harness::WriteTable(std::cerr, results);
+    if (out_path.empty()) {
+        Harness::WriteJson(std::cout, results);
+    } else {
+        std::ofstream ofs(out_path);
+        if (!ofs) {
+            std::cerr << "cannot write " << out_path << std::endl;
+            return 2;
+        }
+        Harness::WriteJson(ofs, results);
+    }
+
+    // 与基线对比
+    if (!compare_path.empty()) {
+        std::vector<BenchResult> baseline;
+        if (!Harness::LoadJson(compare_path, &baseline)) {
+            std::cerr << "cannot read baseline " << compare_path << std::endl;
+            return 2;
+        }
+        int regressions = Harness::Compare(std::cerr, baseline, results, threshold);
+        std::fprintf(stderr, "%d regression(s) beyond %.1f%%\n", regressions, threshold * 100);
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file harness.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 基准测试计时与结果读写实现
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "harness.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+std::string BenchResult::Key() const {
+    return name + "|" + image + "|" + std::to_string(size) + "|" + std::to_string(channels);
+}
+
+BenchResult Harness::Measure(const BenchConfig& config, const std::function<void()>& fn,
+                             size_t pixels, size_t bytes) {
+    using Clock = std::chrono::steady_clock;
+    fn();   // 预热：填充缓存、触发首次分配
+
+    std::vector<double> samples;
+    double total_s = 0;
+    while (static_cast<int>(samples.size()) < config.max_samples &&
+           (static_cast<int>(samples.size()) < config.min_samples || total_s < config.min_time_s)) {
+        auto start = Clock::now();
+        fn();
+        double s = std::chrono::duration<double>(Clock::now() - start).count();
+        samples.push_back(s * 1e3);
+        total_s += s;
+    }
+
+    BenchResult r;
+    r.samples = static_cast<int>(samples.size());
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    r.median_ms = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    r.min_ms = sorted.front();
+    double sum = 0;
+    for (double v : samples) sum += v;
+    r.mean_ms = sum / n;
+    double var = 0;
+    for (double v : samples) var += (v - r.mean_ms) * (v - r.mean_ms);
+    r.stddev_ms = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+    r.cv = r.mean_ms > 0 ? r.stddev_ms / r.mean_ms : 0.0;
+    if (r.median_ms > 0) {
+        r.mpps = pixels / (r.median_ms * 1e-3) / 1e6;
+        r.mbps = bytes / (r.median_ms * 1e-3) / 1e6;
+    }
+    return r;
+}
+
+void Harness::WriteJson(std::ostream& os, const std::vector<BenchResult>& results) {
+    os << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"image\": \"%s\", \"size\": %d, \"channels\": %d, \"samples\": %d, "
+                      "\"median_ms\": %.6f, \"mean_ms\": %.6f, \"stddev_ms\": %.6f, \"min_ms\": %.6f, \"cv\": %.4f, "
+                      "\"mpps\": %.3f, \"mbps\": %.3f}",
+                      r.name.c_str(), r.image.c_str(), r.size, r.channels, r.samples,
+                      r.median_ms, r.mean_ms, r.stddev_ms, r.min_ms, r.cv, r.mpps, r.mbps);
+        os << line << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+// 从一行 JSON 中取出 "key": 后的值（字符串去掉引号），没有时返回 false
+static bool FieldOf(const std::string& line, const std::string& key, std::string* value) {
+    std::string pattern = "\"" + key + "\": ";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    pos += pattern.size();
+    if (pos < line.size() && line[pos] == '"') {
+        size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos) return false;
+        *value = line.substr(pos + 1, end - pos - 1);
+    } else {
+        size_t end = line.find_first_of(",}", pos);
+        *value = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+bool Harness::LoadJson(const std::string& path, std::vector<BenchResult>* results) {
+    std::ifstream ifs(path);
+    if (!ifs) return false;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::string name, image, size, channels, median;
+        if (!FieldOf(line, "name", &name) || !FieldOf(line, "image", &image) || !FieldOf(line, "size", &size) ||
+            !FieldOf(line, "channels", &channels) || !FieldOf(line, "median_ms", &median)) {
+            continue;
+        }
+        BenchResult r;
+        r.name = name;
+        r.image = image;
+        r.size = std::atoi(size.c_str());
+        r.channels = std::atoi(channels.c_str());
+        r.median_ms = std::atof(median.c_str());
+        std::string v;
+        if (FieldOf(line, "cv", &v)) r.cv = std::atof(v.c_str());
+        if (FieldOf(line, "mpps", &v)) r.mpps = std::atof(v.c_str());
+        if (FieldOf(line, "mbps", &v)) r.mbps = std::atof(v.c_str());
+        results->push_back(r);
+    }
+    return true;
+}
+
+void Harness::WriteTable(std::ostream& os, const std::vector<BenchResult>& results) {
+    os << std::left << std::setw(34) << "benchmark" << std::setw(12) << "image" << std::right
+       << std::setw(7) << "size" << std::setw(4) << "ch" << std::setw(12) << "median ms"
+       << std::setw(8) << "cv%" << std::setw(11) << "MP/s" << std::setw(11) << "MB/s" << '\n';
+    for (const BenchResult& r : results) {
+        os << std::left << std::setw(34) << r.name << std::setw(12) << r.image << std::right
+           << std::setw(7) << r.size << std::setw(4) << r.channels << std::fixed << std::setprecision(3)
+           << std::setw(12) << r.median_ms << std::setprecision(1) << std::setw(8) << r.cv * 100
+           << std::setw(11) << r.mpps << std::setw(11) << r.mbps << '\n';
+        os.unsetf(std::ios::fixed);
+    }
+}
+
+int Harness::Compare(std::ostream& os, const std::vector<BenchResult>& baseline,
+                     const std::vector<BenchResult>& current, double threshold) {
+    std::map<std::string, const BenchResult*> base;
+    for (const BenchResult& r : baseline) base[r.Key()] = &r;
+
+    int regressions = 0;
+    for (const BenchResult& r : current) {
+        auto it = base.find(r.Key());
+        if (it == base.end() || it->second->median_ms <= 0) continue;
+        double ratio = r.median_ms / it->second->median_ms;
+        const char* verdict = ratio > 1 + threshold ? "REGRESSION" : (ratio < 1 - threshold ? "improved" : "ok");
+        if (ratio > 1 + threshold) ++regressions;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-34s %-11s %6d %2d  %10.3f -> %10.3f ms  %+7.1f%%  %s\n",
+                      r.name.c_str(), r.image.c_str(), r.size, r.channels,
+                      it->second->median_ms, r.median_ms, (ratio - 1) * 100, verdict);
+        os << line;
+    }
+    return regressions;
+}
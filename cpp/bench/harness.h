@@ -0,0 +1,92 @@
+/**
+ * @file harness.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 基准测试的计时、统计与 JSON 结果读写
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 一项基准测试的结果
+ *
+ * @details 吞吐量按中位数耗时计算：mpps 为每秒处理的百万像素数，mbps 为每秒处理的 MB 数
+ * （字节数由各项测试给出，一般为原始像素字节数）。cv 为耗时的变异系数（标准差 / 均值），
+ * 用于判断结果是否稳定。
+ */
+struct BenchResult {
+    std::string name;       ///< 测试项，如 "Processor::ToGray"
+    std::string image;      ///< 图像类型，如 "photo"
+    int size = 0;           ///< 图像边长
+    int channels = 0;
+    int samples = 0;        ///< 计时次数
+    double median_ms = 0;
+    double mean_ms = 0;
+    double stddev_ms = 0;
+    double min_ms = 0;
+    double cv = 0;
+    double mpps = 0;
+    double mbps = 0;
+
+    /**
+     * @brief 结果的唯一键，用于与基线对比
+     */
+    std::string Key() const;
+};
+
+/**
+ * @brief 计时参数
+ */
+struct BenchConfig {
+    double min_time_s = 0.2;    ///< 每项至少累计计时的秒数
+    int min_samples = 3;
+    int max_samples = 50;
+};
+
+/**
+ * @brief 计时与结果读写
+ */
+class Harness {
+public:
+    /**
+     * @brief 预热一次后反复执行 fn 并统计耗时
+     *
+     * @param pixels 每次执行处理的像素数
+     * @param bytes 每次执行处理的字节数
+     */
+    static BenchResult Measure(const BenchConfig& config, const std::function<void()>& fn,
+                               size_t pixels, size_t bytes);
+
+    /**
+     * @brief 以 JSON 输出全部结果，每个结果占一行，便于 diff 与 Load 解析
+     */
+    static void WriteJson(std::ostream& os, const std::vector<BenchResult>& results);
+
+    /**
+     * @brief 读取 WriteJson 写出的文件，失败时返回 false
+     */
+    static bool LoadJson(const std::string& path, std::vector<BenchResult>* results);
+
+    /**
+     * @brief 输出便于阅读的表格
+     */
+    static void WriteTable(std::ostream& os, const std::vector<BenchResult>& results);
+
+    /**
+     * @brief 与基线对比，中位数耗时超过基线 (1 + threshold) 倍的项判为退化
+     *
+     * @return int 退化的项数
+     */
+    static int Compare(std::ostream& os, const std::vector<BenchResult>& baseline,
+                       const std::vector<BenchResult>& current, double threshold);
+};
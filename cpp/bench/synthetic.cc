@@ -0,0 +1,133 @@
+/**
+ * @file synthetic.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 合成图像生成实现
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "synthetic.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// 固定种子的 xorshift32，保证不同平台生成相同的图像
+struct Rng {
+    uint32_t state;
+    explicit Rng(uint32_t seed) : state(seed ? seed : 1u) {}
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    int Uniform(int n) { return static_cast<int>(Next() % static_cast<uint32_t>(n)); }
+};
+
+inline uint8_t Clamp8(int v) { return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); }
+
+// 在 img 上填充矩形区域
+void FillRect(cv::Mat& img, int x0, int y0, int w, int h, const uint8_t* color) {
+    const int cn = img.channels();
+    for (int r = y0; r < std::min(y0 + h, img.rows); ++r) {
+        uint8_t* p = img.ptr<uint8_t>(r);
+        for (int c = x0; c < std::min(x0 + w, img.cols); ++c) {
+            for (int k = 0; k < cn; ++k) p[c * cn + k] = color[k];
+        }
+    }
+}
+
+void MakeSparse(cv::Mat& img, Rng& rng) {
+    const uint8_t bg[3] = {240, 240, 240};
+    FillRect(img, 0, 0, img.cols, img.rows, bg);
+    // 若干个矩形，总面积约为图像的 2%
+    const int n = 8;
+    const int side = std::max(1, static_cast<int>(img.cols * std::sqrt(0.02 / n)));
+    for (int i = 0; i < n; ++i) {
+        uint8_t color[3] = {static_cast<uint8_t>(rng.Uniform(200)), static_cast<uint8_t>(rng.Uniform(200)), static_cast<uint8_t>(rng.Uniform(200))};
+        FillRect(img, rng.Uniform(img.cols), rng.Uniform(img.rows), side, side, color);
+    }
+}
+
+void MakeDense(cv::Mat& img, Rng& rng) {
+    const size_t n = img.total() * img.channels();
+    uint8_t* p = img.data;
+    for (size_t i = 0; i < n; ++i) p[i] = static_cast<uint8_t>(rng.Next() >> 24);
+}
+
+void MakePhoto(cv::Mat& img, Rng& rng) {
+    const int cn = img.channels();
+    const double fx = 6.0 / img.cols, fy = 4.0 / img.rows;
+    for (int r = 0; r < img.rows; ++r) {
+        uint8_t* p = img.ptr<uint8_t>(r);
+        for (int c = 0; c < img.cols; ++c) {
+            double base = 128 + 60 * std::sin(c * fx) * std::cos(r * fy) + 40.0 * c / img.cols;
+            for (int k = 0; k < cn; ++k) {
+                int noise = static_cast<int>(rng.Next() >> 29) - 4;   // [-4, 3]
+                p[c * cn + k] = Clamp8(static_cast<int>(base) + k * 20 + noise);
+            }
+        }
+    }
+}
+
+void MakeScreenshot(cv::Mat& img, Rng& rng) {
+    // 白色背景、灰色侧栏、蓝色标题栏
+    const uint8_t white[3] = {255, 255, 255}, side[3] = {230, 230, 230}, bar[3] = {200, 120, 40}, ink[3] = {30, 30, 30};
+    FillRect(img, 0, 0, img.cols, img.rows, white);
+    FillRect(img, 0, 0, img.cols / 5, img.rows, side);
+    FillRect(img, 0, 0, img.cols, std::max(1, img.rows / 20), bar);
+    // 文字状图案：按行排列的短横线块
+    const int line_h = 12, glyph_w = 6;
+    for (int y = img.rows / 10; y + line_h < img.rows; y += line_h * 2) {
+        int x = img.cols / 5 + 16;
+        int line_end = img.cols - 16 - rng.Uniform(std::max(1, img.cols / 3));
+        while (x + glyph_w < line_end) {
+            int w = glyph_w * (1 + rng.Uniform(6));
+            FillRect(img, x, y + rng.Uniform(3), w, line_h - 4, ink);
+            x += w + glyph_w;
+        }
+    }
+}
+
+}  // namespace
+
+cv::Mat Synthetic::Make(Kind kind, int size, int channels) {
+    cv::Mat img(size, size, CV_MAKETYPE(CV_8U, channels));
+    Rng rng(static_cast<uint32_t>(size) * 2654435761u + static_cast<uint32_t>(kind));
+    switch (kind) {
+        case Kind::kSparse: MakeSparse(img, rng); break;
+        case Kind::kDense: MakeDense(img, rng); break;
+        case Kind::kPhoto: MakePhoto(img, rng); break;
+        case Kind::kScreenshot: MakeScreenshot(img, rng); break;
+    }
+    return img;
+}
+
+const char* Synthetic::Name(Kind kind) {
+    switch (kind) {
+        case Kind::kSparse: return "sparse";
+        case Kind::kDense: return "dense";
+        case Kind::kPhoto: return "photo";
+        case Kind::kScreenshot: return "screenshot";
+    }
+    return "unknown";
+}
+
+bool Synthetic::Parse(const std::string& name, Kind* kind) {
+    for (Kind k : All()) {
+        if (name == Name(k)) {
+            *kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Synthetic::Kind> Synthetic::All() {
+    return {Kind::kSparse, Kind::kDense, Kind::kPhoto, Kind::kScreenshot};
+}
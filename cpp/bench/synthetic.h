@@ -0,0 +1,48 @@
+/**
+ * @file synthetic.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 基准测试用的合成图像生成
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 按内容特征生成确定性的合成图像（同样的参数总是得到同样的像素）
+ *
+ * @details 四类内容对应不同的压缩与处理特性：
+ * - kSparse：纯色背景上少量矩形，约 2% 非背景像素，三元组压缩的最佳情况；
+ * - kDense：均匀随机噪声，几乎没有背景，三元组压缩的最坏情况；
+ * - kPhoto：平滑渐变叠加轻微噪声，近似照片；
+ * - kScreenshot：大块纯色区域与细密的文字状图案，近似界面截图。
+ */
+class Synthetic {
+public:
+    enum class Kind { kSparse, kDense, kPhoto, kScreenshot };
+
+    /**
+     * @brief 生成 size × size 的 8 位图像
+     *
+     * @param kind 内容类型
+     * @param size 边长
+     * @param channels 1 或 3
+     */
+    static cv::Mat Make(Kind kind, int size, int channels);
+
+    static const char* Name(Kind kind);
+
+    /**
+     * @brief 按名字解析内容类型，无法识别时返回 false
+     */
+    static bool Parse(const std::string& name, Kind* kind);
+
+    static std::vector<Kind> All();
+};
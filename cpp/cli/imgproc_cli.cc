@@ -0,0 +1,512 @@
+/**
+ * @file imgproc_cli.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 命令行工具：格式转换、灰度化、缩放、三元组压缩与解压，支持多文件并行与标准输入输出
+ * @version 0.1
+ * @date 2025-12-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * 用法：
+ *   imgproc_cli <command> [options] <input>...
+ *
+ * 命令：
+ *   convert              只转换格式，输出格式由 -f 或 -o 的扩展名决定
+ *   gray                 灰度化
+ *   resize WxH           缩放到 W x H，--interp 选择插值方式
+ *   compress             压缩为 .trip
+ *   decompress           从 .trip 解压，默认输出 .png
+ *
+ * 选项：
+ *   -o <path>            输出路径。单个输入时可以是文件；多个输入或已存在的目录时按输入文件名
+ *                        写入该目录；含 %d（如 out/frame_%05d.png）时把输入视为帧序列，
+ *                        按顺序流水处理并报告帧率；"-" 表示标准输出。
+ *                        省略时输出到输入文件旁边，标准输入的结果写到标准输出。
+ *                        两个输入映射到同一个输出（如 a/x.png 与 b/x.png 写入同一目录），
+ *                        或输出会覆盖另一个输入时，不处理任何文件，按参数错误返回。
+ *   -f <png|ppm|pgm|trip> 输出格式
+ *   -j <N>               并行数，默认使用全部核心
+ *   --interp <bilinear|bicubic|lanczos3>  resize 的插值方式，默认 bilinear
+ *   --start <N>          帧序列模式下第一帧的编号，默认 1
+ *   --stats              结束时向 stderr 输出各阶段耗时
+ *   --trace <file>       同时记录事件，导出 Chrome trace JSON
+ *
+ * 输入为 "-" 时从标准输入读取一张图像（PNG/PPM/PGM/TRIP，按内容识别）。
+ * 含 '*' 或 '?' 的输入按通配符展开，方便在不展开通配符的 shell 中使用。
+ * 返回码：0 全部成功，1 有文件失败，2 参数错误。
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "common/stats.h"
+#include "io/image_io.h"
+#include "pipeline/batch_pipeline.h"
+#include "pipeline/image_file.h"
+#include "pipeline/operation.h"
+#include "pipeline/sequence_pipeline.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class Command { kConvert, kGray, kResize, kCompress, kDecompress };
+
+struct CliOptions {
+    Command command = Command::kConvert;
+    std::string command_name;
+    int width = 0;
+    int height = 0;
+    Processor::Interpolation interpolation = Processor::Interpolation::kBilinear;
+    std::vector<std::string> inputs;
+    std::string output;             ///< -o，空表示未指定
+    std::string format;             ///< -f，不带点，空表示未指定
+    int jobs = 0;
+    long long start_number = 1;
+    bool stats = false;
+    std::string trace_path;
+};
+
+int Usage() {
+    std::cerr << "usage: imgproc_cli <convert|gray|resize WxH|compress|decompress> [options] <input>...\n"
+                 "options: -o <file|dir|pattern_%05d.ext|->  -f <png|ppm|pgm|trip>  -j <N>\n"
+                 "         --interp <bilinear|bicubic|lanczos3>  --start <N>  --stats  --trace <file>\n"
+                 "input \"-\" reads one image from stdin; output \"-\" writes to stdout\n";
+    return 2;
+}
+
+bool IsKnownFormat(const std::string& fmt) {
+    return fmt == "png" || fmt == "ppm" || fmt == "pgm" || fmt == "trip";
+}
+
+// 小写、不带点的扩展名
+std::string ExtensionOf(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    if (!ext.empty()) ext.erase(0, 1);
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext;
+}
+
+bool ParseSize(const std::string& s, int* w, int* h) {
+    size_t x = s.find_first_of("xX");
+    if (x == std::string::npos) return false;
+    *w = std::atoi(s.substr(0, x).c_str());
+    *h = std::atoi(s.substr(x + 1).c_str());
+    return *w > 0 && *h > 0;
+}
+
+// 解析命令行，失败时返回 false 并输出原因
+bool ParseArgs(int argc, char** argv, CliOptions* opt) {
+    if (argc < 2) return false;
+    int i = 1;
+    opt->command_name = argv[i++];
+    if (opt->command_name == "convert") {
+        opt->command = Command::kConvert;
+    } else if (opt->command_name == "gray") {
+        opt->command = Command::kGray;
+    } else if (opt->command_name == "resize") {
+        opt->command = Command::kResize;
+        if (i >= argc || !ParseSize(argv[i++], &opt->width, &opt->height)) {
+            std::cerr << "resize requires a size such as 640x480" << std::endl;
+            return false;
+        }
+    } else if (opt->command_name == "compress") {
+        opt->command = Command::kCompress;
+    } else if (opt->command_name == "decompress") {
+        opt->command = Command::kDecompress;
+    } else {
+        std::cerr << "unknown command: " << opt->command_name << std::endl;
+        return false;
+    }
+
+    for (; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](std::string* v) {
+            if (i + 1 >= argc) return false;
+            *v = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (arg == "-o" && next(&v)) {
+            opt->output = v;
+        } else if (arg == "-f" && next(&v)) {
+            opt->format = v;
+            if (!IsKnownFormat(v)) {
+                std::cerr << "unknown format: " << v << std::endl;
+                return false;
+            }
+        } else if (arg == "-j" && next(&v)) {
+            opt->jobs = std::atoi(v.c_str());
+        } else if (arg == "--interp" && next(&v)) {
+            if (v == "bilinear") opt->interpolation = Processor::Interpolation::kBilinear;
+            else if (v == "bicubic") opt->interpolation = Processor::Interpolation::kBicubic;
+            else if (v == "lanczos3") opt->interpolation = Processor::Interpolation::kLanczos3;
+            else {
+                std::cerr << "unknown interpolation: " << v << std::endl;
+                return false;
+            }
+        } else if (arg == "--start" && next(&v)) {
+            opt->start_number = std::atoll(v.c_str());
+        } else if (arg == "--stats") {
+            opt->stats = true;
+        } else if (arg == "--trace" && next(&v)) {
+            opt->trace_path = v;
+        } else if (arg == "-" || arg.empty() || arg[0] != '-') {
+            opt->inputs.push_back(arg);
+        } else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opt->inputs.empty()) {
+        std::cerr << "no input" << std::endl;
+        return false;
+    }
+
+    // compress 只能输出 .trip，-f 与 -o 的扩展名不得冲突
+    if (opt->command == Command::kCompress) {
+        if (!opt->format.empty() && opt->format != "trip") {
+            std::cerr << "compress always writes .trip" << std::endl;
+            return false;
+        }
+        opt->format = "trip";
+    }
+    return true;
+}
+
+std::vector<Operation> OperationsOf(const CliOptions& opt) {
+    switch (opt.command) {
+        case Command::kGray: return {Operation::Gray()};
+        case Command::kResize: return {Operation::Resize(opt.width, opt.height, opt.interpolation)};
+        case Command::kConvert:
+        case Command::kCompress:
+        case Command::kDecompress: break;
+    }
+    return {};
+}
+
+// 通配符展开；"-" 与普通路径原样保留
+bool ExpandInputs(std::vector<std::string>* inputs) {
+    std::vector<std::string> out;
+    for (const std::string& in : *inputs) {
+        if (in.find_first_of("*?") == std::string::npos) {
+            out.push_back(in);
+            continue;
+        }
+        std::vector<std::string> matched = SequencePipeline::Glob(in);
+        if (matched.empty()) {
+            std::cerr << "no files match " << in << std::endl;
+            return false;
+        }
+        out.insert(out.end(), matched.begin(), matched.end());
+    }
+    *inputs = std::move(out);
+    return true;
+}
+
+/**
+ * @brief 确定输出格式：-f 优先，其次 -o 的扩展名，最后按命令与输入推断
+ */
+std::string OutputFormat(const CliOptions& opt, const std::string& input, bool output_is_file) {
+    if (!opt.format.empty()) return opt.format;
+    if (output_is_file) {
+        std::string ext = ExtensionOf(opt.output);
+        if (IsKnownFormat(ext)) return ext;
+    }
+    if (opt.command == Command::kDecompress) return "png";
+    std::string ext = input == "-" ? "" : ExtensionOf(input);
+    // 灰度结果没有三通道的 .ppm，改为 .pgm
+    if (opt.command == Command::kGray && ext == "ppm") return "pgm";
+    return (IsKnownFormat(ext) && ext != "trip") ? ext : "png";
+}
+
+// 比较路径用的规范形式：已存在的部分解析符号链接与 . / ..，其余按字面规范化
+std::string PathKey(const std::string& path) {
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(path, ec);
+    return (ec ? fs::path(path).lexically_normal() : canonical).string();
+}
+
+// 输出文件的扩展名与 -f 指定的格式不一致时报错
+bool CheckOutputFile(const CliOptions& opt, const std::string& output) {
+    if (opt.format.empty() || ImageFile::FormatOf(output) == ImageFile::FormatOf("x." + opt.format)) return true;
+    std::cerr << output << " does not match output format " << opt.format << std::endl;
+    return false;
+}
+
+// ---------------------------------------------------------------------
+// 标准输入输出
+// ---------------------------------------------------------------------
+
+/**
+ * @brief 临时文件，析构时删除
+ *
+ * @details .trip 与 PPM 编解码只支持文件，经标准输入输出时借助临时文件中转。
+ */
+class TempFile {
+public:
+    explicit TempFile(const std::string& ext) {
+        std::random_device rd;
+        path_ = (fs::temp_directory_path() / ("imgproc_cli_" + std::to_string(rd()) + "_" + std::to_string(rd()) + "." + ext)).string();
+    }
+    ~TempFile() {
+        std::error_code ec;
+        fs::remove(path_, ec);
+    }
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+bool WriteBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(ofs);
+}
+
+bool ReadBytes(const std::string& path, std::vector<uint8_t>* bytes) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    bytes->assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void SetBinaryStdio() {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+// 从标准输入读一张图像，按魔数识别格式
+cv::Mat ReadStdin() {
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    if (bytes.size() >= 4 && bytes[0] == 'T' && bytes[1] == 'R' && bytes[2] == 'I' && bytes[3] == 'P') {
+        TempFile tmp("trip");
+        return WriteBytes(tmp.path(), bytes) ? ImageFile::Load(tmp.path()) : cv::Mat();
+    }
+    if (bytes.size() >= 2 && bytes[0] == 'P' && bytes[1] >= '1' && bytes[1] <= '6') {
+        TempFile tmp("ppm");
+        return WriteBytes(tmp.path(), bytes) ? ImageFile::Load(tmp.path()) : cv::Mat();
+    }
+    return ImageIO::DecodeFromBuffer(bytes.data(), bytes.size());
+}
+
+bool WriteStdout(const cv::Mat& img, const std::string& format) {
+    std::vector<uint8_t> bytes;
+    if (format == "png") {
+        if (!ImageIO::EncodeToBuffer(img, "png", &bytes)) return false;
+    } else {
+        TempFile tmp(format);
+        if (!ImageFile::Save(tmp.path(), img) || !ReadBytes(tmp.path(), &bytes)) return false;
+    }
+    std::cout.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    std::cout.flush();
+    return static_cast<bool>(std::cout);
+}
+
+// ---------------------------------------------------------------------
+// 统计输出
+// ---------------------------------------------------------------------
+
+void PrintStats(double seconds, size_t files) {
+    std::fprintf(stderr, "%-18s %8s %12s %10s %10s %10s\n", "stage", "calls", "total ms", "avg ms", "max ms", "MB/s");
+    for (const Stats::StageStats& s : Stats::Snapshot()) {
+        if (s.count == 0) continue;
+        double total_ms = s.total_ns / 1e6;
+        double mbps = (s.bytes > 0 && s.total_ns > 0) ? (s.bytes / 1048576.0) / (s.total_ns / 1e9) : 0.0;
+        std::fprintf(stderr, "%-18s %8llu %12.2f %10.3f %10.3f %10.1f\n", s.name,
+                     static_cast<unsigned long long>(s.count), total_ms, total_ms / s.count, s.max_ns / 1e6, mbps);
+    }
+    std::fprintf(stderr, "%zu file(s) in %.3f s, %.1f files/s\n", files, seconds, seconds > 0 ? files / seconds : 0.0);
+}
+
+// ---------------------------------------------------------------------
+// 执行
+// ---------------------------------------------------------------------
+
+// 单张图像经标准输入或输出
+int RunStream(const CliOptions& opt, const std::vector<Operation>& ops, size_t* done) {
+    const std::string& input = opt.inputs[0];
+    bool to_stdout = opt.output.empty() || opt.output == "-";
+    std::string format = OutputFormat(opt, input, !to_stdout);
+    std::string output = to_stdout ? "-" : opt.output;
+    if (!to_stdout && fs::is_directory(output)) output = (fs::path(output) / ("stdin." + format)).string();
+    if (!to_stdout && !CheckOutputFile(opt, output)) return 2;
+
+    cv::Mat img = input == "-" ? ReadStdin() : ImageFile::Load(input);
+    if (img.empty()) {
+        std::cerr << "imgproc_cli: " << input << ": failed to load" << std::endl;
+        return 1;
+    }
+    size_t step = 0;
+    cv::Mat out = Operation::ApplyAll(ops, img, &step);
+    if (out.empty()) {
+        std::cerr << "imgproc_cli: " << input << ": operation " << step << " (" << ops[step].Name() << ") failed" << std::endl;
+        return 1;
+    }
+    bool ok = to_stdout ? WriteStdout(out, format) : ImageFile::Save(output, out);
+    if (!ok) {
+        std::cerr << "imgproc_cli: failed to save " << output << std::endl;
+        return 1;
+    }
+    *done = 1;
+    return 0;
+}
+
+// 帧序列：-o 为 %d 模式
+int RunSequence(const CliOptions& opt, const std::vector<Operation>& ops, size_t* done) {
+    std::string pattern = opt.output;
+    if (!opt.format.empty()) pattern = fs::path(pattern).replace_extension(opt.format).string();
+    if (SequencePipeline::FrameName(pattern, 0).empty()) {
+        std::cerr << "invalid output pattern: " << pattern << std::endl;
+        return 2;
+    }
+    fs::path dir = fs::path(pattern).parent_path();
+    std::error_code ec;
+    if (!dir.empty()) fs::create_directories(dir, ec);
+
+    SequenceOptions options;
+    options.workers = opt.jobs;
+    options.start_number = opt.start_number;
+    SequenceResult result = SequencePipeline(options).Run(opt.inputs, ops, pattern, [&](const SequenceEvent& ev) {
+        if (ev.type == SequenceEvent::Type::kFailed) {
+            std::cerr << "imgproc_cli: " << opt.inputs[ev.index] << ": " << ev.message << std::endl;
+        }
+    });
+    std::fprintf(stderr, "%zu frame(s) written, %zu failed, %.1f fps\n", result.written, result.failed, result.fps);
+    *done = result.written + result.failed;
+    return result.failed == 0 ? 0 : 1;
+}
+
+// 多个文件，每个文件一个批处理作业
+int RunFiles(const CliOptions& opt, const std::vector<Operation>& ops, size_t* done) {
+    bool to_dir = !opt.output.empty() && (opt.inputs.size() > 1 || fs::is_directory(opt.output) ||
+                                          opt.output.back() == '/' || opt.output.back() == '\\');
+    bool to_file = !opt.output.empty() && !to_dir;
+    if (to_file && !CheckOutputFile(opt, opt.output)) return 2;
+    if (to_dir) {
+        std::error_code ec;
+        fs::create_directories(opt.output, ec);
+    }
+
+    std::vector<BatchJob> jobs;
+    jobs.reserve(opt.inputs.size());
+    for (const std::string& input : opt.inputs) {
+        if (input == "-") {
+            std::cerr << "stdin can only be used as the sole input" << std::endl;
+            return 2;
+        }
+        std::string format = OutputFormat(opt, input, to_file);
+        fs::path in(input);
+        std::string output;
+        if (to_file) {
+            output = opt.output;
+        } else {
+            fs::path dir = to_dir ? fs::path(opt.output) : in.parent_path();
+            fs::path out = dir / (in.stem().string() + "." + format);
+            // 输出在输入旁边且格式不变时加上命令名，避免覆盖输入
+            if (!to_dir && out == in) out = dir / (in.stem().string() + "_" + opt.command_name + "." + format);
+            output = out.string();
+        }
+        if (ImageFile::FormatOf(output) == ImageFile::Format::kUnknown) {
+            std::cerr << "unsupported output format: " << output << std::endl;
+            return 2;
+        }
+        jobs.push_back(BatchJob{input, output, ops});
+    }
+
+    // 作业并行执行，两个作业写同一个文件或一个作业覆盖另一个作业的输入时结果不确定，开始前拒绝
+    std::map<std::string, size_t> inputs, outputs;
+    for (size_t i = 0; i < jobs.size(); ++i) inputs.emplace(PathKey(jobs[i].input), i);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const std::string key = PathKey(jobs[i].output);
+        auto dup = outputs.emplace(key, i);
+        if (!dup.second) {
+            std::cerr << jobs[dup.first->second].input << " and " << jobs[i].input << " both write "
+                      << jobs[i].output << std::endl;
+            return 2;
+        }
+        auto in = inputs.find(key);
+        if (in != inputs.end() && in->second != i) {
+            std::cerr << jobs[i].output << " would overwrite input " << jobs[in->second].input << std::endl;
+            return 2;
+        }
+    }
+
+    BatchOptions options;
+    options.concurrency = opt.jobs;
+    BatchResult result = BatchPipeline(options).Run(jobs, [&](const BatchEvent& ev) {
+        if (ev.type == BatchEvent::Type::kFailed) {
+            // 回调在工作线程中并发执行，整行一次写出
+            std::string line = "imgproc_cli: " + jobs[ev.index].input + ": " + ev.message + "\n";
+            std::fputs(line.c_str(), stderr);
+        }
+    });
+    *done = result.succeeded + result.failed;
+    return result.failed == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CliOptions opt;
+    if (!ParseArgs(argc, argv, &opt)) return Usage();
+    if (!ExpandInputs(&opt.inputs)) return 1;
+    SetBinaryStdio();
+
+    if (opt.stats || !opt.trace_path.empty()) {
+        Stats::SetEnabled(true);
+        Stats::SetTracing(!opt.trace_path.empty());
+    }
+
+    std::vector<Operation> ops = OperationsOf(opt);
+    bool stream = opt.output == "-" || (opt.inputs.size() == 1 && opt.inputs[0] == "-");
+    if (opt.output == "-" && opt.inputs.size() != 1) {
+        std::cerr << "stdout can only take a single input" << std::endl;
+        return 2;
+    }
+    if (opt.command == Command::kConvert && opt.format.empty() && !stream &&
+        (opt.output.empty() || !IsKnownFormat(ExtensionOf(opt.output)))) {
+        std::cerr << "convert needs -f or an output file extension" << std::endl;
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t done = 0;
+    int rc = 0;
+    if (stream) {
+        rc = RunStream(opt, ops, &done);
+    } else if (opt.output.find('%') != std::string::npos) {
+        rc = RunSequence(opt, ops, &done);
+    } else {
+        rc = RunFiles(opt, ops, &done);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (opt.stats) PrintStats(seconds, done);
+    if (!opt.trace_path.empty() && !Stats::WriteChromeTrace(opt.trace_path)) {
+        std::cerr << "cannot write " << opt.trace_path << std::endl;
+        if (rc == 0) rc = 1;
+    }
+    return rc;
+}
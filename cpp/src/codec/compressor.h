@@ -10,10 +10,13 @@
  */
 
 #pragma once
+#include <functional>
 #include <string>
 #include <vector>
 #include <opencv2/core/mat.hpp>
+#include "../common/progress.h"
 #include "../data_structure/triplet.h"
+#include "../imgproc/image_stats.h"
 
 /**
  * @brief 压缩与解压类，调用 Triplet 相关函数实现图像的三元组压缩存储与重建。
@@ -24,12 +27,79 @@ public:
     /**
      * @brief 将图像压缩并保存为 .trip 文件。
      * 流程：统计背景色 -> 转换为三元组 -> 写入文件头 -> 写入数据。
+     * 
+     * @details 背景色由 ImageStats 并行统计，统计出的非背景像素个数同时用于一次性分配三元组容量。
+     * 
+     * @param file_path 输出 .trip 文件路径
+     * @param img 输入图像，8 位或 16 位，1/3/4 通道
+     * @param arena 三元组使用的内存池，为 nullptr 时临时申请。
+     *              传入时会在调用开始处被 Reset()，批量处理时复用同一个 arena 可以避免反复申请内存
+     * @param progress 进度回调，统计完成时汇报 0.4、三元组提取完成时汇报 0.8，之后写入文件；
+     *                 返回 false 时不进入下一阶段，返回 false 且不写文件
      */
-    static bool Save(const std::string& file_path, const cv::Mat& img);
+    static bool Save(const std::string& file_path, const cv::Mat& img, TripletArena* arena = nullptr,
+                     const ProgressFn& progress = nullptr);
+
+    /**
+     * @brief 使用已有的统计结果压缩保存，不再重新扫描图像统计背景色。
+     * 
+     * @param stats 同一张图像的 ImageStats 统计结果，须统计了颜色众数（has_mode）
+     * @param progress 进度回调，只汇报三元组提取完成（0.8）这一阶段，语义同上一个重载
+     * @return 除与上一个重载相同的失败情况外，stats 与 img 的通道数、位深或像素数不一致时返回 false
+     */
+    static bool Save(const std::string& file_path, const cv::Mat& img, const ImageStats& stats, TripletArena* arena = nullptr,
+                     const ProgressFn& progress = nullptr);
 
     /**
      * @brief 加载 .trip 文件并重建图像。
      * 流程：读取文件头校验魔数 -> 创建背景画布 -> 覆盖三元组像素。
+     * 
+     * @details 启用 ImageCache 时命中则返回缓存图像的拷贝，不再解码。
+     * 
+     * @param file_path .trip 文件路径
+     * @param arena 三元组使用的内存池，语义同 Save
+     */
+    static cv::Mat Load(const std::string& file_path, TripletArena* arena = nullptr);
+
+    /**
+     * @brief 从内存中的 .trip 文件内容重建图像，不经过 ImageCache。
+     * 
+     * @param data 文件内容，只在调用期间使用
+     * @param size 文件内容长度
+     * @param arena 三元组使用的内存池，语义同 Save
+     * @return 数据非法时返回空 cv::Mat
+     */
+    static cv::Mat LoadFromBuffer(const uint8_t* data, size_t size, TripletArena* arena = nullptr);
+
+    /**
+     * @brief 压缩域变换：把一个 TripletBuffer 变换为另一个，例如 TripletOps 中的各个操作
+     */
+    using TripletTransform = std::function<bool(const TripletBuffer&, TripletBuffer&)>;
+
+    /**
+     * @brief 读取 .trip 文件，在三元组上执行变换后写成新的 .trip 文件，全程不重建 cv::Mat。
+     * 
+     * @details 代价与非背景像素个数成正比，例如
+     * Compressor::Transform(in, out, [](const TripletBuffer& s, TripletBuffer& d) { return TripletOps::ToGray(s, d); });
+     * 
+     * @param input_path 输入 .trip 文件
+     * @param output_path 输出 .trip 文件，可以与输入相同
+     * @param op 变换，返回 false 时不写输出文件
+     * @param arena 两份三元组使用的内存池，语义同 Save
+     * @return 读取、变换与写入都成功时为 true
+     */
+    static bool Transform(const std::string& input_path, const std::string& output_path, const TripletTransform& op,
+                          TripletArena* arena = nullptr);
+
+private:
+    /**
+     * @brief 按统计结果中的背景色与非背景像素个数写出 .trip 文件
+     */
+    static bool Encode(const std::string& file_path, const cv::Mat& img, const ImageStats& stats, TripletArena* arena,
+                       const ProgressFn& progress);
+
+    /**
+     * @brief 不经过缓存，直接从文件解码
      */
-    static cv::Mat Load(const std::string& file_path);
+    static cv::Mat Decode(const std::string& file_path, TripletArena* arena);
 };
\ No newline at end of file
@@ -0,0 +1,280 @@
+/**
+ * @file trip_sequence.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 多帧三元组容器实现
+ * @version 0.1
+ * @date 2025-12-04
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "trip_sequence.h"
+#include <cstring>
+#include <limits>
+#include "../data_structure/triplet.h"
+#include "../imgproc/image_stats.h"
+#include "../io/image_io.h"
+#include "../common/stats.h"
+
+// 尾部魔数，8 字节
+static const char kIndexMagic[8] = {'T', 'S', 'E', 'Q', 'I', 'D', 'X', '\n'};
+static constexpr std::streamoff kFooterBytes = 24;
+
+// 每帧记录的头：KEY count bg0 bg1 bg2 bg3 或 DELTA count
+static bool ParseFrameHeader(std::istream& is, bool* keyframe, uint64_t* count, uint16_t background[4]) {
+    std::string tag; is >> tag;
+    if (tag == "KEY") {
+        *keyframe = true;
+        is >> *count;
+        for (int k = 0; k < 4; ++k) {
+            int v = 0; is >> v;
+            background[k] = static_cast<uint16_t>(v);
+        }
+    } else if (tag == "DELTA") {
+        *keyframe = false;
+        is >> *count;
+    } else {
+        return false;
+    }
+    is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    return !is.fail();
+}
+
+// ===================== TripSequenceWriter =====================
+
+TripSequenceWriter::TripSequenceWriter(TripSequenceOptions options) : options_(options) {}
+
+TripSequenceWriter::~TripSequenceWriter() {
+    Close();
+}
+
+bool TripSequenceWriter::Open(const std::string& file_path) {
+    Close();
+    ofs_.open(file_path, std::ios::binary | std::ios::trunc);
+    ok_ = static_cast<bool>(ofs_);
+    ref_.release();
+    index_.clear();
+    keyframes_ = 0;
+    since_keyframe_ = 0;
+    return ok_;
+}
+
+bool TripSequenceWriter::WriteFrame(const TripletBuffer& triplets, bool keyframe) {
+    STATS_SCOPE(kSerialize);
+    TripSequenceEntry entry;
+    entry.offset = static_cast<uint64_t>(ofs_.tellp());
+    entry.keyframe = keyframe;
+    if (keyframe) {
+        const uint16_t* bg = triplets.background();
+        ofs_ << "KEY " << static_cast<unsigned long long>(triplets.size()) << ' '
+             << bg[0] << ' ' << bg[1] << ' ' << bg[2] << ' ' << bg[3] << '\n';
+    } else {
+        ofs_ << "DELTA " << static_cast<unsigned long long>(triplets.size()) << '\n';
+    }
+    if (!ImageIO::WriteTripRecords(ofs_, triplets)) return false;
+    index_.push_back(entry);
+    return true;
+}
+
+bool TripSequenceWriter::Append(const cv::Mat& frame) {
+    STATS_SCOPE_BYTES(kCompress, frame.total() * frame.elemSize());
+    if (!ok_ || frame.empty()) return false;
+    if (frame.depth() != CV_8U && frame.depth() != CV_16U) return false;
+    if (frame.channels() != 1 && frame.channels() != 3 && frame.channels() != 4) return false;
+
+    // 第一帧写文件头，之后的帧必须与之一致
+    if (index_.empty()) {
+        ofs_ << "TRIPSEQ " << frame.cols << ' ' << frame.rows << ' ' << frame.channels() << ' '
+             << 8 * static_cast<int>(frame.elemSize1()) << '\n';
+    } else if (frame.size() != ref_.size() || frame.type() != ref_.type()) {
+        return false;
+    }
+
+    arena_.Reset();
+    TripletBuffer triplets(&arena_);
+    bool keyframe = index_.empty() || options_.keyframe_interval <= 1 || since_keyframe_ + 1 >= options_.keyframe_interval;
+    if (!keyframe) {
+        // 变化像素过多（场景切换）时差分反而比关键帧大，改写关键帧
+        TripletUtils::DiffToTriplets(frame, ref_, options_.tolerance, triplets);
+        keyframe = static_cast<double>(triplets.size()) > options_.max_delta_ratio * static_cast<double>(frame.total());
+    }
+
+    if (keyframe) {
+        // 背景色与非背景像素个数一起统计，转换时只需扫描一遍
+        ImageStatsOptions stats_options;
+        stats_options.histograms = false;
+        stats_options.unique_colors = false;
+        stats_options.color_mode = true;
+        ImageStats stats;
+        ImageStats::Compute(frame, stats, stats_options);
+        arena_.Reset();
+        TripletBuffer key(&arena_);
+        TripletUtils::MatToTriplets(frame, stats.mode, static_cast<size_t>(stats.pixels - stats.mode_count), key);
+        ok_ = WriteFrame(key, true);
+        frame.copyTo(ref_);
+        ++keyframes_;
+        since_keyframe_ = 0;
+    } else {
+        ok_ = WriteFrame(triplets, false);
+        // 参考帧取解码端的重建结果：只覆盖变化的像素，有容差时误差不会累积
+        TripletUtils::ApplyTriplets(triplets, ref_);
+        ++since_keyframe_;
+    }
+    return ok_;
+}
+
+bool TripSequenceWriter::Close() {
+    if (!ofs_.is_open()) return ok_;
+    if (ok_) {
+        // 没有任何帧时也写一个合法的文件头
+        if (index_.empty()) ofs_ << "TRIPSEQ 0 0 1 8\n";
+        uint64_t index_offset = static_cast<uint64_t>(ofs_.tellp());
+        for (const TripSequenceEntry& e : index_) {
+            uint64_t flags = e.keyframe ? 1 : 0;
+            ofs_.write(reinterpret_cast<const char*>(&e.offset), sizeof(e.offset));
+            ofs_.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+        }
+        uint64_t count = index_.size();
+        ofs_.write(reinterpret_cast<const char*>(&index_offset), sizeof(index_offset));
+        ofs_.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        ofs_.write(kIndexMagic, sizeof(kIndexMagic));
+        ok_ = static_cast<bool>(ofs_);
+    }
+    ofs_.close();
+    ref_.release();
+    return ok_;
+}
+
+// ===================== TripSequenceReader =====================
+
+bool TripSequenceReader::Open(const std::string& file_path) {
+    ifs_.close();
+    ifs_.clear();
+    index_.clear();
+    current_.release();
+    current_index_ = SIZE_MAX;
+
+    ifs_.open(file_path, std::ios::binary);
+    if (!ifs_) return false;
+    std::string magic; int bits = 0;
+    ifs_ >> magic >> width_ >> height_ >> channels_ >> bits;
+    ifs_.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (!ifs_ || magic != "TRIPSEQ" || (bits != 8 && bits != 16)) return false;
+    if (channels_ != 1 && channels_ != 3 && channels_ != 4) return false;
+    if (width_ < 0 || height_ < 0) return false;
+    depth_ = bits == 16 ? CV_16U : CV_8U;
+    type_ = CV_MAKETYPE(depth_, channels_);
+
+    std::streamoff data_begin = ifs_.tellg();
+    if (ReadIndex()) return true;
+    return ScanIndex(data_begin);
+}
+
+bool TripSequenceReader::ReadIndex() {
+    ifs_.clear();
+    ifs_.seekg(0, std::ios::end);
+    std::streamoff size = ifs_.tellg();
+    if (size < kFooterBytes) return false;
+
+    uint64_t index_offset = 0, count = 0;
+    char magic[8];
+    ifs_.seekg(size - kFooterBytes);
+    ifs_.read(reinterpret_cast<char*>(&index_offset), sizeof(index_offset));
+    ifs_.read(reinterpret_cast<char*>(&count), sizeof(count));
+    ifs_.read(magic, sizeof(magic));
+    if (!ifs_ || std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0) return false;
+    // 索引必须恰好填满尾部之前的区域，防止损坏的尾部导致过量分配
+    if (index_offset > static_cast<uint64_t>(size - kFooterBytes) ||
+        (static_cast<uint64_t>(size - kFooterBytes) - index_offset) != count * 16) {
+        return false;
+    }
+
+    ifs_.seekg(static_cast<std::streamoff>(index_offset));
+    index_.resize(static_cast<size_t>(count));
+    for (TripSequenceEntry& e : index_) {
+        uint64_t flags = 0;
+        ifs_.read(reinterpret_cast<char*>(&e.offset), sizeof(e.offset));
+        ifs_.read(reinterpret_cast<char*>(&flags), sizeof(flags));
+        e.keyframe = (flags & 1) != 0;
+        if (e.offset >= index_offset) {
+            index_.clear();
+            return false;
+        }
+    }
+    if (!ifs_ || (!index_.empty() && !index_[0].keyframe)) {
+        index_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TripSequenceReader::ScanIndex(std::streamoff data_begin) {
+    ifs_.clear();
+    ifs_.seekg(0, std::ios::end);
+    const std::streamoff size = ifs_.tellg();
+    const std::streamoff rec = 8 + static_cast<std::streamoff>(channels_) * (depth_ == CV_16U ? 2 : 1);
+
+    std::streamoff pos = data_begin;
+    ifs_.seekg(pos);
+    for (;;) {
+        bool keyframe = false; uint64_t count = 0; uint16_t bg[4];
+        if (!ParseFrameHeader(ifs_, &keyframe, &count, bg)) break;
+        std::streamoff end = ifs_.tellg();
+        if (count > static_cast<uint64_t>(size) || end + static_cast<std::streamoff>(count) * rec > size) break;
+        if (index_.empty() && !keyframe) break;
+        index_.push_back(TripSequenceEntry{static_cast<uint64_t>(pos), keyframe});
+        pos = end + static_cast<std::streamoff>(count) * rec;
+        ifs_.seekg(pos);
+    }
+    ifs_.clear();
+    return true;
+}
+
+bool TripSequenceReader::DecodeFrame(size_t index) {
+    STATS_SCOPE(kDeserialize);
+    ifs_.clear();
+    ifs_.seekg(static_cast<std::streamoff>(index_[index].offset));
+    bool keyframe = false; uint64_t count = 0; uint16_t bg[4] = {0, 0, 0, 0};
+    if (!ParseFrameHeader(ifs_, &keyframe, &count, bg) || keyframe != index_[index].keyframe) return false;
+
+    arena_.Reset();
+    TripletBuffer triplets(&arena_);
+    triplets.Reset(width_, height_, channels_, depth_);
+    triplets.SetBackground(bg);
+    if (!ImageIO::ReadTripRecords(ifs_, count, triplets)) return false;
+
+    if (keyframe) {
+        TripletUtils::TripletsToMat(triplets, current_);
+        return !current_.empty();
+    }
+    return TripletUtils::ApplyTriplets(triplets, current_);
+}
+
+bool TripSequenceReader::ReadFrame(size_t index, cv::Mat& out) {
+    STATS_SCOPE(kDecompress);
+    if (index >= index_.size()) return false;
+
+    // 不晚于 index 的最近关键帧
+    size_t key = index;
+    while (key > 0 && !index_[key].keyframe) --key;
+
+    // 当前帧位于 [key, index] 之间时直接继续应用差分，否则从关键帧重新开始
+    size_t from = key;
+    if (current_index_ != SIZE_MAX && current_index_ >= key && current_index_ <= index) from = current_index_ + 1;
+    for (size_t i = from; i <= index; ++i) {
+        if (!DecodeFrame(i)) {
+            current_index_ = SIZE_MAX;
+            return false;
+        }
+        current_index_ = i;
+    }
+    current_.copyTo(out);
+    return true;
+}
+
+cv::Mat TripSequenceReader::ReadFrame(size_t index) {
+    cv::Mat out;
+    if (!ReadFrame(index, out)) return cv::Mat();
+    return out;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file trip_sequence.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 多帧三元组容器（.tripseq）：关键帧 + 帧间差分，带可随机访问的索引
+ * @version 0.1
+ * @date 2025-12-04
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "../data_structure/triplet_buffer.h"
+
+/**
+ * @brief 帧序列压缩参数
+ */
+struct TripSequenceOptions {
+    int keyframe_interval = 30;     ///< 每隔多少帧强制写一个关键帧，<= 1 时每帧都是关键帧
+    int tolerance = 0;              ///< 差分容差，任一通道差值超过它的像素才记录；0 为无损
+    double max_delta_ratio = 0.5;   ///< 变化像素占比超过该值时改写关键帧（场景切换）
+};
+
+/**
+ * @brief .tripseq 文件的一帧索引
+ */
+struct TripSequenceEntry {
+    uint64_t offset = 0;    ///< 帧记录在文件中的起始偏移
+    bool keyframe = false;
+};
+
+/**
+ * @brief 写入 .tripseq 帧序列
+ *
+ * @details 文件格式：
+ * - 文件头（文本）：TRIPSEQ width height channels bits\n
+ * - 每帧一条记录，关键帧为 KEY count bg0 bg1 bg2 bg3\n，差分帧为 DELTA count\n，
+ *   其后是 count 条与 .trip 相同的二进制记录（int32 row, int32 col, channels 个取值）；
+ *   关键帧与单张 .trip 一样只记录非背景像素，差分帧只记录与上一帧不同的像素；
+ * - 索引：每帧 16 字节（uint64 偏移, uint64 标志，bit0 为关键帧）；
+ * - 尾部 24 字节：uint64 索引偏移, uint64 帧数, 魔数 "TSEQIDX\n"。
+ *
+ * 有容差时差分以编码端重建出的上一帧为参考，误差不会逐帧累积，每个像素与原图的差不超过 tolerance。
+ * 三元组的内存来自写入器持有的 arena，连续追加同尺寸的帧时不再申请内存。
+ */
+class TripSequenceWriter {
+public:
+    explicit TripSequenceWriter(TripSequenceOptions options = TripSequenceOptions());
+
+    /**
+     * @brief 未调用 Close 时自动写入索引
+     */
+    ~TripSequenceWriter();
+
+    TripSequenceWriter(const TripSequenceWriter&) = delete;
+    TripSequenceWriter& operator=(const TripSequenceWriter&) = delete;
+
+    /**
+     * @brief 创建输出文件，文件已打开时先关闭
+     */
+    bool Open(const std::string& file_path);
+
+    /**
+     * @brief 追加一帧
+     *
+     * @param frame 8 位或 16 位、1/3/4 通道的图像；第一帧决定序列的尺寸与类型，之后的帧必须一致
+     * @return 未打开、类型不一致或写入失败时返回 false
+     */
+    bool Append(const cv::Mat& frame);
+
+    /**
+     * @brief 写入索引与尾部并关闭文件
+     */
+    bool Close();
+
+    size_t frame_count() const { return index_.size(); }
+    size_t keyframe_count() const { return keyframes_; }
+
+private:
+    bool WriteFrame(const TripletBuffer& triplets, bool keyframe);
+
+    TripSequenceOptions options_;
+    std::ofstream ofs_;
+    bool ok_ = false;
+    cv::Mat ref_;                   ///< 解码端将会重建出的上一帧
+    TripletArena arena_;
+    std::vector<TripSequenceEntry> index_;
+    size_t keyframes_ = 0;
+    int since_keyframe_ = 0;
+};
+
+/**
+ * @brief 读取 .tripseq 帧序列，支持顺序读取与随机访问
+ *
+ * @details 读取第 i 帧时从不晚于 i 的最近关键帧开始依次应用差分；顺序读取时直接在上一帧的
+ * 基础上应用一帧差分。文件缺少尾部索引（例如写入端未正常关闭）时顺序扫描帧记录重建索引，
+ * 被截断的最后一帧会被丢弃。
+ */
+class TripSequenceReader {
+public:
+    TripSequenceReader() = default;
+    TripSequenceReader(const TripSequenceReader&) = delete;
+    TripSequenceReader& operator=(const TripSequenceReader&) = delete;
+
+    /**
+     * @brief 打开文件并读取索引
+     */
+    bool Open(const std::string& file_path);
+
+    size_t frame_count() const { return index_.size(); }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int type() const { return type_; }
+    bool IsKeyframe(size_t index) const { return index < index_.size() && index_[index].keyframe; }
+
+    /**
+     * @brief 读取第 index 帧到 out，out 的尺寸与类型已符合时复用其内存
+     *
+     * @return 越界或文件损坏时返回 false
+     */
+    bool ReadFrame(size_t index, cv::Mat& out);
+
+    /**
+     * @brief 读取第 index 帧，失败时返回空 cv::Mat
+     */
+    cv::Mat ReadFrame(size_t index);
+
+private:
+    bool ReadIndex();
+    bool ScanIndex(std::streamoff data_begin);
+    bool DecodeFrame(size_t index);
+
+    std::ifstream ifs_;
+    int width_ = 0;
+    int height_ = 0;
+    int channels_ = 1;
+    int depth_ = CV_8U;
+    int type_ = CV_8UC1;
+    std::vector<TripSequenceEntry> index_;
+    cv::Mat current_;                       ///< 最近一次解码出的帧
+    size_t current_index_ = SIZE_MAX;       ///< current_ 对应的帧号，无效时为 SIZE_MAX
+    TripletArena arena_;
+};
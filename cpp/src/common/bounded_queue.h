@@ -0,0 +1,124 @@
+/**
+ * @file bounded_queue.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 有界无锁多生产者多消费者队列，用于流水线阶段之间传递帧
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief 固定容量的无锁 MPMC 环形队列
+ *
+ * @details 每个单元带一个序号，生产者与消费者各自用 CAS 推进 tail_/head_ 抢占单元，
+ * 再通过单元序号的 release/acquire 交接数据，入队出队都不加锁。容量向上取整为 2 的幂。
+ * 队列本身不阻塞：满时 TryPush、空时 TryPop 返回 false，由调用方配合 Backoff 等待。
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask_ = n - 1;
+        cells_.reset(new Cell[n]);
+        for (size_t i = 0; i < n; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief 入队，队列满时返回 false 且 value 保持不变
+     */
+    bool TryPush(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;   // 该单元上一轮的数据还未被取走：队列满
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief 出队，队列空时返回 false
+     */
+    bool TryPop(T& out) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.value = T();
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;   // 该单元尚未写入：队列空
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};   ///< 下一个写入位置
+    alignas(64) std::atomic<size_t> head_{0};   ///< 下一个读取位置
+};
+
+/**
+ * @brief 无锁等待的退避策略：先自旋，再让出时间片，最后短暂休眠
+ *
+ * @details 阶段间等待通常只有几微秒，自旋与 yield 就能接上；等待磁盘或慢阶段时
+ * 退到 100 微秒的休眠，避免空转占满核心。条件满足后调用 Reset 重新开始计数。
+ */
+class Backoff {
+public:
+    void Wait() {
+        if (count_ < 64) {
+            ++count_;
+        } else if (count_ < 128) {
+            ++count_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void Reset() { count_ = 0; }
+
+private:
+    int count_ = 0;
+};
@@ -0,0 +1,191 @@
+/**
+ * @file memory.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 内存记账实现与记账用的 cv::MatAllocator
+ * @version 0.1
+ * @date 2025-11-30
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "memory.h"
+#include <atomic>
+#include <mutex>
+#include "stats.h"
+
+namespace {
+
+struct Counter {
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> peak{0};
+};
+
+Counter g_total;
+Counter g_categories[MemoryTracker::kNumCategories];
+std::atomic<size_t> g_budget{0};
+std::atomic<uint64_t> g_budget_failures{0};
+
+void UpdatePeak(std::atomic<size_t>& peak, size_t value) {
+    size_t prev = peak.load(std::memory_order_relaxed);
+    while (value > prev && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+}
+
+/**
+ * @brief 记账用的 cv::MatAllocator：实际分配转交给内层分配器，只负责增减 kImage 计数
+ *
+ * @details 分配成功后把 UMatData::currAllocator 改为自身，释放时再改回内层分配器
+ * （记录在 prevAllocator 中）并转交，因此内层分配器在此期间被替换也不影响已分配的图像。
+ * 包装调用方已有内存的 cv::Mat 不经过记账。
+ */
+class TrackingMatAllocator : public cv::MatAllocator {
+public:
+    void SetInner(const cv::MatAllocator* inner) { inner_.store(inner, std::memory_order_release); }
+    const cv::MatAllocator* inner() const { return inner_.load(std::memory_order_acquire); }
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        const cv::MatAllocator* a = Resolve();
+        if (data != nullptr) return a->allocate(dims, sizes, type, data, step, flags, usage_flags);
+
+        size_t bytes = CV_ELEM_SIZE(type);
+        for (int i = 0; i < dims; ++i) bytes *= static_cast<size_t>(sizes[i]);
+        MemoryTracker::Allocate(MemoryTracker::Category::kImage, bytes);
+
+        cv::UMatData* u = nullptr;
+        try {
+            u = a->allocate(dims, sizes, type, data, step, flags, usage_flags);
+        } catch (...) {
+            MemoryTracker::Free(MemoryTracker::Category::kImage, bytes);
+            throw;
+        }
+        if (u == nullptr) {
+            MemoryTracker::Free(MemoryTracker::Category::kImage, bytes);
+            return nullptr;
+        }
+        // 内层分配器可能按对齐多分配，释放时按 u->size 扣减，这里补齐差额
+        if (u->size > bytes) MemoryTracker::Allocate(MemoryTracker::Category::kImage, u->size - bytes);
+        else if (u->size < bytes) MemoryTracker::Free(MemoryTracker::Category::kImage, bytes - u->size);
+        u->prevAllocator = a;
+        u->currAllocator = this;
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        return u != nullptr && u->prevAllocator->allocate(u, flags, usage_flags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (u == nullptr) return;
+        size_t bytes = u->size;
+        const cv::MatAllocator* owner = u->prevAllocator;
+        u->currAllocator = owner;
+        owner->deallocate(u);
+        MemoryTracker::Free(MemoryTracker::Category::kImage, bytes);
+    }
+
+private:
+    const cv::MatAllocator* Resolve() const {
+        const cv::MatAllocator* a = inner();
+        return a != nullptr ? a : cv::Mat::getStdAllocator();
+    }
+
+    std::atomic<const cv::MatAllocator*> inner_{nullptr};
+};
+
+// 永不析构：进程退出前仍可能有经过它分配的图像被释放
+TrackingMatAllocator& MatTracker() {
+    static TrackingMatAllocator* tracker = new TrackingMatAllocator();
+    return *tracker;
+}
+
+std::mutex g_mat_mutex;
+bool g_tracking_mats = false;
+
+// 持有 g_mat_mutex 时调用：按当前设置更新 OpenCV 的默认分配器
+void ApplyDefaultAllocator() {
+    cv::MatAllocator* inner = const_cast<cv::MatAllocator*>(MatTracker().inner());
+    if (g_tracking_mats) {
+        cv::Mat::setDefaultAllocator(&MatTracker());
+    } else {
+        cv::Mat::setDefaultAllocator(inner != nullptr ? inner : cv::Mat::getStdAllocator());
+    }
+}
+
+}  // namespace
+
+void MemoryTracker::Allocate(Category category, size_t bytes) {
+    if (bytes == 0) return;
+    size_t budget = g_budget.load(std::memory_order_relaxed);
+    size_t after = g_total.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (budget != 0 && after > budget) {
+        g_total.current.fetch_sub(bytes, std::memory_order_relaxed);
+        g_budget_failures.fetch_add(1, std::memory_order_relaxed);
+        throw MemoryBudgetExceeded("memory budget exceeded: " + std::string(Name(category)) + " requested " +
+                                   std::to_string(bytes) + " bytes, " + std::to_string(after - bytes) +
+                                   " of " + std::to_string(budget) + " bytes in use");
+    }
+    UpdatePeak(g_total.peak, after);
+
+    Counter& c = g_categories[static_cast<int>(category)];
+    UpdatePeak(c.peak, c.current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    Stats::AddThreadBytes(static_cast<int64_t>(bytes));
+}
+
+void MemoryTracker::Free(Category category, size_t bytes) {
+    if (bytes == 0) return;
+    g_total.current.fetch_sub(bytes, std::memory_order_relaxed);
+    g_categories[static_cast<int>(category)].current.fetch_sub(bytes, std::memory_order_relaxed);
+    Stats::AddThreadBytes(-static_cast<int64_t>(bytes));
+}
+
+void MemoryTracker::SetBudget(size_t bytes) { g_budget.store(bytes, std::memory_order_relaxed); }
+size_t MemoryTracker::budget() { return g_budget.load(std::memory_order_relaxed); }
+
+MemoryTracker::Report MemoryTracker::GetReport() {
+    Report r;
+    r.total.current = g_total.current.load(std::memory_order_relaxed);
+    r.total.peak = g_total.peak.load(std::memory_order_relaxed);
+    for (int i = 0; i < kNumCategories; ++i) {
+        r.categories[i].current = g_categories[i].current.load(std::memory_order_relaxed);
+        r.categories[i].peak = g_categories[i].peak.load(std::memory_order_relaxed);
+    }
+    r.budget = budget();
+    r.budget_failures = g_budget_failures.load(std::memory_order_relaxed);
+    return r;
+}
+
+void MemoryTracker::ResetPeaks() {
+    g_total.peak.store(g_total.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (Counter& c : g_categories) c.peak.store(c.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    g_budget_failures.store(0, std::memory_order_relaxed);
+}
+
+const char* MemoryTracker::Name(Category category) {
+    switch (category) {
+        case Category::kImage: return "image";
+        case Category::kHistogram: return "histogram";
+        case Category::kTriplets: return "triplets";
+        case Category::kIoBuffer: return "io_buffer";
+        case Category::kScratch: return "scratch";
+        case Category::kCount: break;
+    }
+    return "unknown";
+}
+
+void MemoryTracker::TrackMats(bool enabled) {
+    std::lock_guard<std::mutex> lock(g_mat_mutex);
+    g_tracking_mats = enabled;
+    ApplyDefaultAllocator();
+}
+
+bool MemoryTracker::tracking_mats() {
+    std::lock_guard<std::mutex> lock(g_mat_mutex);
+    return g_tracking_mats;
+}
+
+void MemoryTracker::SetMatAllocator(cv::MatAllocator* allocator) {
+    std::lock_guard<std::mutex> lock(g_mat_mutex);
+    MatTracker().SetInner(allocator);
+    ApplyDefaultAllocator();
+}
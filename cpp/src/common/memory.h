@@ -0,0 +1,155 @@
+/**
+ * @file memory.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 核心库的内存记账：按类别统计当前与峰值字节数，并可设置硬性预算
+ * @version 0.1
+ * @date 2025-11-30
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 超出内存预算时抛出
+ *
+ * @details 继承自 std::bad_alloc，因此标准容器与 cv::Mat 的分配失败路径都能正确传播；
+ * what() 给出申请的类别、字节数、当前用量与预算。
+ */
+class MemoryBudgetExceeded : public std::bad_alloc {
+public:
+    explicit MemoryBudgetExceeded(std::string message) : message_(std::move(message)) {}
+    const char* what() const noexcept override { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * @brief 进程级的内存记账
+ *
+ * @details 被记账的内存：
+ * - kImage：经 TrackMats(true) 安装的 cv::MatAllocator 分配的像素内存；
+ * - kHistogram：背景色检测的直方图；
+ * - kTriplets：TripletArena 向系统申请的块；
+ * - kIoBuffer：.trip 读写时的分块缓冲区；
+ * - kScratch：多遍内核的每线程暂存区（见 ScratchPool）。
+ *
+ * 每次分配同时计入全局（按类别）与当前线程的计数，线程计数通过 Stats 导出；
+ * 开启 Stats 时，每个计时阶段还会记录单次调用期间本线程新增内存的峰值。
+ *
+ * 设置预算（SetBudget）后，任何一次会使全局用量超过预算的分配都会立即抛出
+ * MemoryBudgetExceeded，而不是等到系统内存耗尽被 OOM 终止。
+ */
+class MemoryTracker {
+public:
+    enum class Category { kImage, kHistogram, kTriplets, kIoBuffer, kScratch, kCount };
+    static constexpr int kNumCategories = static_cast<int>(Category::kCount);
+
+    /**
+     * @brief 当前与峰值字节数
+     */
+    struct Usage {
+        size_t current = 0;
+        size_t peak = 0;
+    };
+
+    /**
+     * @brief 全局记账结果
+     */
+    struct Report {
+        Usage total;
+        Usage categories[kNumCategories];
+        size_t budget = 0;              ///< 0 表示不限制
+        uint64_t budget_failures = 0;   ///< 因超出预算被拒绝的分配次数
+    };
+
+    /**
+     * @brief 记入一次分配，超出预算时抛出 MemoryBudgetExceeded（此时不计入）
+     */
+    static void Allocate(Category category, size_t bytes);
+
+    /**
+     * @brief 记入一次释放
+     */
+    static void Free(Category category, size_t bytes);
+
+    /**
+     * @brief 设置预算（字节），0 表示不限制
+     */
+    static void SetBudget(size_t bytes);
+    static size_t budget();
+
+    static Report GetReport();
+
+    /**
+     * @brief 把各项峰值重置为当前值
+     */
+    static void ResetPeaks();
+
+    static const char* Name(Category category);
+
+    /**
+     * @brief 是否对 cv::Mat 的像素内存记账
+     *
+     * @details 开启时把记账分配器设为 OpenCV 的默认分配器，实际分配转交给 SetMatAllocator
+     * 指定的分配器（默认为 OpenCV 自带的分配器）。关闭后已分配的图像释放时仍会正确扣减。
+     */
+    static void TrackMats(bool enabled);
+    static bool tracking_mats();
+
+    /**
+     * @brief 设置实际负责分配像素内存的 cv::MatAllocator（nullptr 表示 OpenCV 自带的分配器）
+     *
+     * @details 需要替换默认分配器的模块（如内存池）应调用此函数而不是
+     * cv::Mat::setDefaultAllocator，这样记账开启与否都能正确组合。
+     */
+    static void SetMatAllocator(cv::MatAllocator* allocator);
+};
+
+/**
+ * @brief 对分配记账的标准库分配器，用于核心库内部的容器
+ *
+ * @tparam T 元素类型
+ * @tparam C 记账类别
+ */
+template <typename T, MemoryTracker::Category C>
+struct TrackingAllocator {
+    using value_type = T;
+
+    TrackingAllocator() = default;
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, C>&) noexcept {}
+
+    template <typename U>
+    struct rebind { using other = TrackingAllocator<U, C>; };
+
+    T* allocate(size_t n) {
+        MemoryTracker::Allocate(C, n * sizeof(T));
+        try {
+            return std::allocator<T>().allocate(n);
+        } catch (...) {
+            MemoryTracker::Free(C, n * sizeof(T));
+            throw;
+        }
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+        MemoryTracker::Free(C, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, C>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, C>&) const noexcept { return false; }
+};
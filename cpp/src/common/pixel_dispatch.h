@@ -0,0 +1,98 @@
+/**
+ * @file pixel_dispatch.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 按（元素类型, 通道数）编译期实例化像素内核，并在运行时一次性分派
+ * @version 0.1
+ * @date 2025-11-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 像素内核分派工具
+ *
+ * @details 内核写成类模板 Kernel<T, CN>，T 为元素类型（uint8_t / uint16_t），
+ * CN 为通道数（1 / 3 / 4），并提供：
+ * - static constexpr bool kSupported：该组合是否可用；
+ * - static Ret Run(Args...)：内核本体。通道循环的次数是编译期常量，编译器会完全展开。
+ *
+ * KernelTable 在编译期为全部 6 种组合生成函数指针表，调用方每次调用只根据
+ * cv::Mat::type() 查一次表，像素循环内部不再出现任何与通道数、位深有关的分支。
+ */
+namespace pixel {
+
+constexpr int kNumDepths = 2;      ///< 支持的元素类型个数：8U, 16U
+constexpr int kNumChannels = 3;    ///< 支持的通道数个数：1, 3, 4
+constexpr int kChannelsOf[kNumChannels] = {1, 3, 4};
+
+template <int DepthIdx> struct DepthType;
+template <> struct DepthType<0> { using type = uint8_t; };
+template <> struct DepthType<1> { using type = uint16_t; };
+
+/**
+ * @brief OpenCV depth 到表下标，不支持时返回 -1
+ */
+inline int DepthIndex(int depth) {
+    return depth == CV_8U ? 0 : (depth == CV_16U ? 1 : -1);
+}
+
+/**
+ * @brief 通道数到表下标，不支持时返回 -1
+ */
+inline int ChannelIndex(int channels) {
+    return channels == 1 ? 0 : (channels == 3 ? 1 : (channels == 4 ? 2 : -1));
+}
+
+/**
+ * @brief 按通道逐个比较两个像素是否相同，不产生分支
+ */
+template <int CN, typename T, typename U>
+inline bool PixelEquals(const T* a, const U* b) {
+    bool same = true;
+    for (int k = 0; k < CN; ++k) same &= (a[k] == static_cast<T>(b[k]));
+    return same;
+}
+
+/**
+ * @brief 编译期生成的内核函数指针表
+ *
+ * @tparam Kernel 内核类模板 Kernel<T, CN>
+ * @tparam Ret 内核返回类型
+ * @tparam Args 内核参数类型
+ */
+template <template <typename, int> class Kernel, typename Ret, typename... Args>
+struct KernelTable {
+    using Fn = Ret (*)(Args...);
+
+    template <int D, int C>
+    static constexpr Fn Entry() {
+        using T = typename DepthType<D>::type;
+        if constexpr (Kernel<T, kChannelsOf[C]>::kSupported) {
+            return &Kernel<T, kChannelsOf[C]>::Run;
+        } else {
+            return nullptr;
+        }
+    }
+
+    static constexpr Fn kTable[kNumDepths][kNumChannels] = {
+        {Entry<0, 0>(), Entry<0, 1>(), Entry<0, 2>()},
+        {Entry<1, 0>(), Entry<1, 1>(), Entry<1, 2>()},
+    };
+
+    /**
+     * @brief 根据 cv::Mat 类型查找内核，不支持的类型返回 nullptr
+     */
+    static Fn Lookup(int type) {
+        int d = DepthIndex(CV_MAT_DEPTH(type));
+        int c = ChannelIndex(CV_MAT_CN(type));
+        if (d < 0 || c < 0) return nullptr;
+        return kTable[d][c];
+    }
+};
+
+}  // namespace pixel
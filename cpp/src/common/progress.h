@@ -0,0 +1,67 @@
+/**
+ * @file progress.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 长任务的进度汇报与协作式取消
+ * @version 0.1
+ * @date 2025-12-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+/**
+ * @brief 进度回调：参数为已完成比例 [0, 1]，返回 false 表示调用方要求取消
+ *
+ * @details 接受回调的函数在阶段或条带边界调用它，收到 false 后不再开始新的工作，
+ * 按参数非法的方式返回失败。回调可能在线程池的线程中被调用，但同一次调用内不会并发，
+ * 汇报的比例单调不减。为空时不汇报进度，行为与不传回调相同。
+ */
+using ProgressFn = std::function<bool(double)>;
+
+/**
+ * @brief 汇报一个阶段边界，progress 为空时总是继续
+ */
+inline bool ReportProgress(const ProgressFn& progress, double fraction) {
+    return !progress || progress(fraction);
+}
+
+/**
+ * @brief 把已完成的条带数映射为 [begin, end] 内的进度，供 ParallelBands 的各条带共用
+ *
+ * @details Done() 在锁内计数并调用回调，保证回调串行、比例单调；任一次回调返回 false 后
+ * cancelled() 为 true，尚未开始的条带应直接跳过。
+ */
+class BandProgress {
+public:
+    BandProgress(const ProgressFn& progress, int total, double begin = 0.0, double end = 1.0)
+        : progress_(progress), total_(total > 0 ? total : 1), begin_(begin), end_(end) {}
+
+    /**
+     * @brief 标记一个条带完成，返回 false 表示已取消
+     */
+    bool Done() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_) return false;
+        ++done_;
+        if (!ReportProgress(progress_, begin_ + (end_ - begin_) * done_ / total_)) cancelled_ = true;
+        return !cancelled_;
+    }
+
+    bool cancelled() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cancelled_;
+    }
+
+private:
+    const ProgressFn& progress_;
+    int total_;
+    double begin_, end_;
+    int done_ = 0;
+    bool cancelled_ = false;
+    std::mutex mutex_;
+};
@@ -0,0 +1,91 @@
+/**
+ * @file scratch.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 每线程暂存区实现
+ * @version 0.1
+ * @date 2025-12-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "scratch.h"
+#include <new>
+#include "memory.h"
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+struct Slot {
+    void* data = nullptr;
+    size_t capacity = 0;
+};
+
+// 一个线程的全部槽位，线程退出时归还内存并扣减记账
+struct ThreadScratch {
+    Slot slots[ScratchPool::kNumSlots];
+
+    void Free(Slot& s) {
+        if (s.data == nullptr) return;
+        ::operator delete(s.data, std::align_val_t(kAlignment));
+        MemoryTracker::Free(MemoryTracker::Category::kScratch, s.capacity);
+        s.data = nullptr;
+        s.capacity = 0;
+    }
+
+    ~ThreadScratch() {
+        for (Slot& s : slots) Free(s);
+    }
+};
+
+ThreadScratch& Local() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+}  // namespace
+
+void* ScratchPool::GetBytes(int slot, size_t bytes) {
+    Slot& s = Local().slots[slot];
+    if (bytes <= s.capacity) return s.data;
+
+    // 按 2 倍增长，容量取对齐的整数倍。先记账再分配，超出预算时原有内存保持不变
+    size_t capacity = s.capacity * 2 > bytes ? s.capacity * 2 : bytes;
+    capacity = (capacity + kAlignment - 1) / kAlignment * kAlignment;
+    MemoryTracker::Allocate(MemoryTracker::Category::kScratch, capacity);
+    void* data = nullptr;
+    try {
+        data = ::operator new(capacity, std::align_val_t(kAlignment));
+    } catch (...) {
+        MemoryTracker::Free(MemoryTracker::Category::kScratch, capacity);
+        throw;
+    }
+    Local().Free(s);
+    s.data = data;
+    s.capacity = capacity;
+    return data;
+}
+
+size_t ScratchPool::BytesReserved() {
+    size_t total = 0;
+    for (const Slot& s : Local().slots) total += s.capacity;
+    return total;
+}
+
+void ScratchPool::Release() {
+    for (Slot& s : Local().slots) Local().Free(s);
+}
+
+void ScratchPool::Trim(size_t max_bytes) {
+    ThreadScratch& local = Local();
+    size_t total = BytesReserved();
+    while (total > max_bytes) {
+        Slot* largest = &local.slots[0];
+        for (Slot& s : local.slots) {
+            if (s.capacity > largest->capacity) largest = &s;
+        }
+        total -= largest->capacity;
+        local.Free(*largest);
+    }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file scratch.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 多遍像素内核中间结果使用的每线程暂存区
+ * @version 0.1
+ * @date 2025-12-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief 每线程的暂存内存池
+ *
+ * @details 每个线程有 kNumSlots 个独立的槽位，同一次内核调用中需要的几块中间内存
+ * 各用一个槽位。槽位只在容量不足时按 2 倍增长，之后同尺寸的调用不再申请内存，
+ * 因此处理同尺寸的连续帧时，稳态下内核本身不产生任何堆分配。
+ *
+ * 返回的内存未初始化，只在下一次以同一槽位调用 Get 之前有效；内核不得在持有槽位时
+ * 调用其他使用同一槽位的函数。容量计入 MemoryTracker 的 kScratch 类别，线程退出时释放。
+ *
+ * 槽位不会自动缩小。长期存活的工作线程（流水线工作线程、共享线程池）在每个作业结束后
+ * 调用 Trim，处理过一张超大图像后不会一直占着对应的暂存区。
+ */
+class ScratchPool {
+public:
+    static constexpr int kNumSlots = 4;
+    static constexpr size_t kDefaultTrimBytes = size_t(32) << 20;   ///< Trim 默认保留的上限
+
+    /**
+     * @brief 获取当前线程第 slot 个槽位中至少 count 个 T 的内存
+     *
+     * @details T 须为平凡类型，内存按 64 字节对齐。超出预算时抛出 MemoryBudgetExceeded。
+     */
+    template <typename T>
+    static T* Get(int slot, size_t count) {
+        return static_cast<T*>(GetBytes(slot, count * sizeof(T)));
+    }
+
+    /**
+     * @brief 当前线程全部槽位占用的字节数
+     */
+    static size_t BytesReserved();
+
+    /**
+     * @brief 释放当前线程的全部槽位
+     */
+    static void Release();
+
+    /**
+     * @brief 当前线程占用超过 max_bytes 时从最大的槽位开始释放，直到不超过 max_bytes
+     *
+     * @details 不超过上限时什么也不做，同尺寸连续处理的稳态复用不受影响。
+     */
+    static void Trim(size_t max_bytes = kDefaultTrimBytes);
+
+private:
+    static void* GetBytes(int slot, size_t bytes);
+};
@@ -0,0 +1,292 @@
+/**
+ * @file stats.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 耗时统计实现：每线程槽位、注册表与 trace 导出
+ * @version 0.1
+ * @date 2025-11-29
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "stats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+std::atomic<bool> g_enabled{false};
+std::atomic<bool> g_tracing{false};
+
+// 每次 Reset 加一。槽位记录自己所属的代，代不一致时由所属线程在下一次写入前清零，
+// 这样计数器始终只有一个写者，Reset 不需要触碰其他线程的槽位
+std::atomic<uint64_t> g_generation{1};
+
+struct StageCounter {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> peak_bytes{0};
+};
+
+struct TraceEvent {
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> dur_ns{0};
+    std::atomic<int> stage{0};
+};
+
+// 一个线程的计数槽位，对齐到缓存行，避免不同线程的槽位伪共享
+struct alignas(64) Slot {
+    int id = 0;
+    std::atomic<uint64_t> generation{0};
+    StageCounter stages[Stats::kNumStages];
+    std::atomic<TraceEvent*> events{nullptr};   ///< 首次记录事件时分配，之后不再释放
+    std::atomic<uint64_t> trace_head{0};         ///< 已写入的事件总数，环形缓冲区下标为 head % kTraceCapacity
+    std::atomic<int64_t> mem_current{0};         ///< 本线程记账内存的当前值（不随 Reset 清零）
+    std::atomic<int64_t> mem_peak{0};
+    int64_t scope_peak = 0;                      ///< 最内层计时作用域内的内存峰值，只由所属线程访问
+};
+
+// 槽位注册表：只在线程首次计时和线程退出时加锁
+class Registry {
+public:
+    Slot* Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            Slot* slot = free_.back();
+            free_.pop_back();
+            return slot;
+        }
+        slots_.push_back(std::make_unique<Slot>());
+        slots_.back()->id = static_cast<int>(slots_.size());
+        return slots_.back().get();
+    }
+
+    void Release(Slot* slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(slot);
+    }
+
+    template <typename Fn>
+    void ForEach(Fn fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& slot : slots_) fn(*slot);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<Slot*> free_;
+};
+
+// 故意不析构：线程局部变量的析构可能晚于静态对象
+Registry& GetRegistry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+struct SlotHolder {
+    Slot* slot;
+    SlotHolder() : slot(GetRegistry().Acquire()) {}
+    ~SlotHolder() { GetRegistry().Release(slot); }
+};
+
+Slot& LocalSlot() {
+    thread_local SlotHolder holder;
+    return *holder.slot;
+}
+
+// 所属线程调用：代不一致时清零计数与事件
+void SyncGeneration(Slot& slot) {
+    uint64_t gen = g_generation.load(std::memory_order_acquire);
+    if (slot.generation.load(std::memory_order_relaxed) == gen) return;
+    for (StageCounter& c : slot.stages) {
+        c.count.store(0, std::memory_order_relaxed);
+        c.total_ns.store(0, std::memory_order_relaxed);
+        c.max_ns.store(0, std::memory_order_relaxed);
+        c.bytes.store(0, std::memory_order_relaxed);
+        c.peak_bytes.store(0, std::memory_order_relaxed);
+    }
+    slot.trace_head.store(0, std::memory_order_relaxed);
+    slot.mem_peak.store(slot.mem_current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    slot.generation.store(gen, std::memory_order_release);
+}
+
+// 单写者累加：读、改、写都由所属线程完成，不需要原子的读改写指令
+inline void Add(std::atomic<uint64_t>& v, uint64_t delta) {
+    v.store(v.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+const uint64_t g_epoch_ns = Stats::NowNs();
+
+}  // namespace
+
+void Stats::SetEnabled(bool enabled) { g_enabled.store(enabled, std::memory_order_relaxed); }
+bool Stats::enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void Stats::SetTracing(bool tracing) { g_tracing.store(tracing, std::memory_order_relaxed); }
+bool Stats::tracing() { return g_tracing.load(std::memory_order_relaxed); }
+
+uint64_t Stats::NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const char* Stats::Name(Stage stage) {
+    switch (stage) {
+        case Stage::kDecode: return "decode";
+        case Stage::kEncode: return "encode";
+        case Stage::kBackground: return "background";
+        case Stage::kTripletExtract: return "triplet_extract";
+        case Stage::kTripletRebuild: return "triplet_rebuild";
+        case Stage::kSerialize: return "serialize";
+        case Stage::kDeserialize: return "deserialize";
+        case Stage::kResize: return "resize";
+        case Stage::kGray: return "gray";
+        case Stage::kCompress: return "compress";
+        case Stage::kDecompress: return "decompress";
+        case Stage::kTripletDiff: return "triplet_diff";
+        case Stage::kImageStats: return "image_stats";
+        case Stage::kBlur: return "blur";
+        case Stage::kCount: break;
+    }
+    return "unknown";
+}
+
+void Stats::Record(Stage stage, uint64_t start_ns, uint64_t end_ns, uint64_t bytes, uint64_t peak_bytes) {
+    int idx = static_cast<int>(stage);
+    if (idx < 0 || idx >= kNumStages) return;
+    Slot& slot = LocalSlot();
+    SyncGeneration(slot);
+
+    uint64_t dur = end_ns > start_ns ? end_ns - start_ns : 0;
+    StageCounter& c = slot.stages[idx];
+    Add(c.count, 1);
+    Add(c.total_ns, dur);
+    Add(c.bytes, bytes);
+    if (dur > c.max_ns.load(std::memory_order_relaxed)) c.max_ns.store(dur, std::memory_order_relaxed);
+    if (peak_bytes > c.peak_bytes.load(std::memory_order_relaxed)) c.peak_bytes.store(peak_bytes, std::memory_order_relaxed);
+
+    if (!tracing()) return;
+    TraceEvent* events = slot.events.load(std::memory_order_relaxed);
+    if (events == nullptr) {
+        events = new TraceEvent[kTraceCapacity];
+        slot.events.store(events, std::memory_order_release);
+    }
+    uint64_t head = slot.trace_head.load(std::memory_order_relaxed);
+    TraceEvent& e = events[head % kTraceCapacity];
+    e.start_ns.store(start_ns, std::memory_order_relaxed);
+    e.dur_ns.store(dur, std::memory_order_relaxed);
+    e.stage.store(idx, std::memory_order_relaxed);
+    slot.trace_head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<Stats::StageStats> Stats::Snapshot() {
+    std::vector<StageStats> out(kNumStages);
+    for (int i = 0; i < kNumStages; ++i) out[i].name = Name(static_cast<Stage>(i));
+
+    uint64_t gen = g_generation.load(std::memory_order_acquire);
+    GetRegistry().ForEach([&](Slot& slot) {
+        // 尚未在本代写入过的槽位视为全零
+        if (slot.generation.load(std::memory_order_acquire) != gen) return;
+        for (int i = 0; i < kNumStages; ++i) {
+            const StageCounter& c = slot.stages[i];
+            out[i].count += c.count.load(std::memory_order_relaxed);
+            out[i].total_ns += c.total_ns.load(std::memory_order_relaxed);
+            out[i].bytes += c.bytes.load(std::memory_order_relaxed);
+            out[i].max_ns = std::max(out[i].max_ns, c.max_ns.load(std::memory_order_relaxed));
+            out[i].peak_bytes = std::max(out[i].peak_bytes, c.peak_bytes.load(std::memory_order_relaxed));
+        }
+    });
+    return out;
+}
+
+std::vector<Stats::ThreadStats> Stats::Threads() {
+    std::vector<ThreadStats> out;
+    uint64_t gen = g_generation.load(std::memory_order_acquire);
+    GetRegistry().ForEach([&](Slot& slot) {
+        ThreadStats t;
+        t.id = slot.id;
+        t.current_bytes = slot.mem_current.load(std::memory_order_relaxed);
+        // 本代尚未写入过的槽位，峰值按当前值计
+        t.peak_bytes = slot.generation.load(std::memory_order_acquire) == gen
+                           ? slot.mem_peak.load(std::memory_order_relaxed) : t.current_bytes;
+        out.push_back(t);
+    });
+    return out;
+}
+
+void Stats::AddThreadBytes(int64_t delta) {
+    Slot& slot = LocalSlot();
+    SyncGeneration(slot);
+    int64_t cur = slot.mem_current.load(std::memory_order_relaxed) + delta;
+    slot.mem_current.store(cur, std::memory_order_relaxed);
+    if (cur > slot.mem_peak.load(std::memory_order_relaxed)) slot.mem_peak.store(cur, std::memory_order_relaxed);
+    if (cur > slot.scope_peak) slot.scope_peak = cur;
+}
+
+void Stats::EnterScope(int64_t* base, int64_t* saved_peak) {
+    Slot& slot = LocalSlot();
+    *base = slot.mem_current.load(std::memory_order_relaxed);
+    *saved_peak = slot.scope_peak;
+    slot.scope_peak = *base;
+}
+
+uint64_t Stats::LeaveScope(int64_t base, int64_t saved_peak) {
+    Slot& slot = LocalSlot();
+    int64_t peak = slot.scope_peak;
+    slot.scope_peak = std::max(saved_peak, peak);
+    return peak > base ? static_cast<uint64_t>(peak - base) : 0;
+}
+
+void Stats::Reset() {
+    g_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Stats::WriteChromeTrace(std::ostream& os) {
+    uint64_t gen = g_generation.load(std::memory_order_acquire);
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    char line[256];
+    GetRegistry().ForEach([&](Slot& slot) {
+        if (slot.generation.load(std::memory_order_acquire) != gen) return;
+        TraceEvent* events = slot.events.load(std::memory_order_acquire);
+        if (events == nullptr) return;
+
+        // 线程名元数据，时间线上每个槽位一行
+        std::snprintf(line, sizeof(line),
+                      "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"core-%d\"}}",
+                      first ? "" : ",", slot.id, slot.id);
+        os << line;
+        first = false;
+
+        // 写者可能同时在覆盖最旧的事件，导出的是尽力而为的快照
+        uint64_t head = slot.trace_head.load(std::memory_order_acquire);
+        uint64_t n = std::min<uint64_t>(head, kTraceCapacity);
+        for (uint64_t i = head - n; i < head; ++i) {
+            const TraceEvent& e = events[i % kTraceCapacity];
+            uint64_t start = e.start_ns.load(std::memory_order_relaxed);
+            uint64_t dur = e.dur_ns.load(std::memory_order_relaxed);
+            int stage = e.stage.load(std::memory_order_relaxed);
+            double ts_us = start >= g_epoch_ns ? (start - g_epoch_ns) / 1e3 : 0.0;
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\":\"%s\",\"cat\":\"core\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                          Name(static_cast<Stage>(stage)), ts_us, dur / 1e3, slot.id);
+            os << line;
+        }
+    });
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Stats::WriteChromeTrace(const std::string& file_path) {
+    std::ofstream ofs(file_path);
+    if (!ofs) return false;
+    WriteChromeTrace(ofs);
+    return static_cast<bool>(ofs);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file stats.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 核心库热路径的耗时统计与 Chrome trace 导出
+ * @version 0.1
+ * @date 2025-11-29
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 按阶段聚合的耗时计数器
+ *
+ * @details 各主要阶段（解码、背景色检测、三元组提取等）用 STATS_SCOPE 包裹，
+ * 作用域结束时把耗时累加到当前线程自己的槽位中。槽位只由所属线程写入，
+ * 写入是无锁的 relaxed 原子操作；Snapshot 时把所有线程的槽位相加。
+ * 线程退出后槽位归还给注册表，由之后创建的线程复用，已累计的计数不会丢失。
+ *
+ * 默认关闭：关闭时 STATS_SCOPE 只有一次 relaxed 原子读，开销为纳秒级。
+ * 编译时定义 IMGPROC_NO_STATS 则 STATS_SCOPE 展开为空，完全不产生代码。
+ *
+ * 开启 tracing 后每次计时还会记录一条事件（开始时间、时长、线程），
+ * 每个线程最多保留最近 kTraceCapacity 条，可用 WriteChromeTrace 导出为
+ * chrome://tracing / Perfetto 可以直接打开的 JSON。
+ */
+class Stats {
+public:
+    /**
+     * @brief 被统计的阶段
+     */
+    enum class Stage {
+        kDecode,            ///< 图像解码（PNG / PPM / 内存缓冲区）
+        kEncode,            ///< 图像编码（PNG / 内存缓冲区）
+        kBackground,        ///< 背景色检测
+        kTripletExtract,    ///< 图像转三元组
+        kTripletRebuild,    ///< 三元组还原为图像
+        kSerialize,         ///< 三元组写入 .trip 文件
+        kDeserialize,       ///< 从 .trip 文件读取三元组
+        kResize,            ///< 缩放
+        kGray,              ///< 灰度转换
+        kCompress,          ///< Compressor::Save 整体（含背景色检测、三元组提取与写文件）
+        kDecompress,        ///< Compressor::Load 的解码部分
+        kTripletDiff,       ///< 帧间差分提取三元组
+        kImageStats,        ///< 图像统计（直方图、颜色众数等）
+        kBlur,              ///< 盒式 / 高斯模糊（高斯模糊按三次盒式模糊分别计入）
+        kCount
+    };
+
+    static constexpr int kNumStages = static_cast<int>(Stage::kCount);
+    static constexpr size_t kTraceCapacity = 1 << 14;
+
+    /**
+     * @brief 一个阶段的聚合结果
+     */
+    struct StageStats {
+        const char* name = "";
+        uint64_t count = 0;         ///< 计时次数
+        uint64_t total_ns = 0;      ///< 累计耗时
+        uint64_t max_ns = 0;        ///< 单次最长耗时
+        uint64_t bytes = 0;         ///< 累计处理的字节数（由调用点给出，未给出时为 0）
+        uint64_t peak_bytes = 0;    ///< 单次调用期间本线程新增的记账内存（见 MemoryTracker）的最大值
+    };
+
+    /**
+     * @brief 一个线程的记账内存
+     *
+     * @details 内存可能在一个线程分配、另一个线程释放，所以单个线程的 current_bytes 可能为负。
+     */
+    struct ThreadStats {
+        int id = 0;                 ///< 与 trace 中的 tid 一致
+        int64_t current_bytes = 0;
+        int64_t peak_bytes = 0;     ///< 自上次 Reset 以来的峰值
+    };
+
+    /**
+     * @brief 开启或关闭计时（默认关闭）
+     */
+    static void SetEnabled(bool enabled);
+    static bool enabled();
+
+    /**
+     * @brief 开启或关闭事件记录（只在计时开启时生效，默认关闭）
+     */
+    static void SetTracing(bool tracing);
+    static bool tracing();
+
+    /**
+     * @brief 所有线程的计数之和，每个阶段一项，按 Stage 顺序排列
+     */
+    static std::vector<StageStats> Snapshot();
+
+    /**
+     * @brief 各线程的记账内存，按线程槽位编号排列
+     */
+    static std::vector<ThreadStats> Threads();
+
+    /**
+     * @brief 清零全部计数并丢弃已记录的事件
+     *
+     * @details 与正在进行的计时并发执行时，个别计时可能落在清零之前或之后，不影响后续统计。
+     */
+    static void Reset();
+
+    /**
+     * @brief 以 Chrome trace-event 格式输出已记录的事件
+     */
+    static void WriteChromeTrace(std::ostream& os);
+
+    /**
+     * @brief 输出到文件，失败时返回 false
+     */
+    static bool WriteChromeTrace(const std::string& file_path);
+
+    static const char* Name(Stage stage);
+
+    /**
+     * @brief 单调时钟的纳秒数
+     */
+    static uint64_t NowNs();
+
+    /**
+     * @brief 把一次计时累加到当前线程的槽位
+     */
+    static void Record(Stage stage, uint64_t start_ns, uint64_t end_ns, uint64_t bytes, uint64_t peak_bytes);
+
+    /**
+     * @brief 增减当前线程的记账内存，由 MemoryTracker 调用
+     */
+    static void AddThreadBytes(int64_t delta);
+
+    /**
+     * @brief 进入计时作用域：记录当前线程的内存基线并开始跟踪作用域内的峰值
+     */
+    static void EnterScope(int64_t* base, int64_t* saved_peak);
+
+    /**
+     * @brief 离开计时作用域，返回作用域内相对基线的内存峰值，并恢复外层作用域的峰值
+     */
+    static uint64_t LeaveScope(int64_t base, int64_t saved_peak);
+};
+
+/**
+ * @brief 作用域计时器，析构时调用 Stats::Record
+ *
+ * @details 构造时若计时未开启，start_ns_ 为 0，析构时直接返回。
+ * 开启时同时跟踪作用域内本线程的内存峰值，作用域可以嵌套。
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stats::Stage stage) : stage_(stage), start_ns_(0) {
+        if (Stats::enabled()) {
+            Stats::EnterScope(&mem_base_, &saved_peak_);
+            start_ns_ = Stats::NowNs();
+        }
+    }
+    ~ScopedTimer() {
+        if (start_ns_ != 0) {
+            uint64_t end_ns = Stats::NowNs();
+            Stats::Record(stage_, start_ns_, end_ns, bytes_, Stats::LeaveScope(mem_base_, saved_peak_));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    /**
+     * @brief 设置本次处理的字节数，用于计算吞吐量
+     */
+    void set_bytes(uint64_t bytes) { bytes_ = bytes; }
+
+private:
+    Stats::Stage stage_;
+    uint64_t start_ns_;
+    uint64_t bytes_ = 0;
+    int64_t mem_base_ = 0;
+    int64_t saved_peak_ = 0;
+};
+
+#ifdef IMGPROC_NO_STATS
+#define STATS_SCOPE(stage)
+#define STATS_SCOPE_BYTES(stage, bytes)
+#else
+#define STATS_CONCAT_INNER(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_INNER(a, b)
+/**
+ * @brief 统计当前作用域的耗时
+ */
+#define STATS_SCOPE(stage) ScopedTimer STATS_CONCAT(stats_timer_, __LINE__)(Stats::Stage::stage)
+/**
+ * @brief 统计当前作用域的耗时与处理的字节数
+ */
+#define STATS_SCOPE_BYTES(stage, bytes) \
+    ScopedTimer STATS_CONCAT(stats_timer_, __LINE__)(Stats::Stage::stage); \
+    STATS_CONCAT(stats_timer_, __LINE__).set_bytes(bytes)
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file thread_pool.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 线程池实现
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+#include "scratch.h"
+
+int ThreadPool::ResolveThreads(int num_threads) {
+    if (num_threads > 0) return num_threads;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+ThreadPool::ThreadPool(int num_threads) {
+    int n = ResolveThreads(num_threads);
+    workers_.reserve(n);
+    for (int i = 0; i < n; ++i) workers_.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    task_cv_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    task_cv_.notify_one();
+}
+
+void ThreadPool::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            // 停止时仍先把队列中的任务做完
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++running_;
+        }
+
+        try {
+            task();
+        } catch (...) {
+            // 任务应自行处理异常，这里只保证工作线程不退出
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_;
+            if (tasks_.empty() && running_ == 0) idle_cv_.notify_all();
+        }
+    }
+}
+
+namespace {
+
+// ParallelBands 的共享线程池，首次使用时创建
+ThreadPool& SharedPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// 一次 ParallelBands 调用的状态。调用返回后仍可能有排队中的辅助任务被执行，
+// 它们只会发现下标已领完，因此状态由 shared_ptr 持有
+struct BandState {
+    explicit BandState(int n) : count(n), errors(n) {}
+
+    const int count;
+    std::atomic<int> next{0};
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    int done = 0;
+    std::vector<std::exception_ptr> errors;
+};
+
+// 领取并执行下标直到全部领完
+void DrainBands(BandState& state, const std::function<void(int)>& fn) {
+    for (int i = state.next++; i < state.count; i = state.next++) {
+        try {
+            fn(i);
+        } catch (...) {
+            state.errors[i] = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (++state.done == state.count) state.done_cv.notify_all();
+    }
+}
+
+}  // namespace
+
+void ParallelBands(int n, const std::function<void(int)>& fn) {
+    if (n <= 0) return;
+    if (n == 1) {
+        fn(0);
+        return;
+    }
+
+    auto state = std::make_shared<BandState>(n);
+    ThreadPool& pool = SharedPool();
+    const int helpers = std::min(n - 1, pool.size());
+    for (int h = 0; h < helpers; ++h) {
+        // fn 只在领到下标时使用，而调用方在全部下标结束前不会返回
+        pool.Submit([state, &fn] {
+            DrainBands(*state, fn);
+            ScratchPool::Trim();   // 池中线程长期存活，不一直占着大图留下的暂存区
+        });
+    }
+    DrainBands(*state, fn);
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done_cv.wait(lock, [&] { return state->done == state->count; });
+    }
+    for (const std::exception_ptr& e : state->errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file thread_pool.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 固定线程数的任务线程池
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 固定线程数的 FIFO 线程池
+ *
+ * @details 任务按提交顺序取出执行，任务本身不应抛出异常（抛出的异常会被吞掉以保护工作线程）。
+ * 析构时等待已提交的任务全部完成后再回收线程。
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief 创建线程池
+     *
+     * @param num_threads 线程数，<= 0 时使用硬件并发数
+     */
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief 提交任务
+     */
+    void Submit(std::function<void()> task);
+
+    /**
+     * @brief 阻塞直到队列为空且没有正在执行的任务
+     */
+    void Wait();
+
+    /**
+     * @brief 线程数
+     */
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    /**
+     * @brief 把 <= 0 的线程数解析为硬件并发数（至少为 1）
+     */
+    static int ResolveThreads(int num_threads);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_cv_;   ///< 有新任务或停止
+    std::condition_variable idle_cv_;   ///< 全部任务完成
+    size_t running_ = 0;
+    bool stopping_ = false;
+};
+
+/**
+ * @brief 把 fn(0) ... fn(n - 1) 分到进程内共享的线程池上并行执行，阻塞直到全部结束
+ *
+ * @details 共享线程池在第一次调用时创建（硬件并发数个线程）并一直复用，调用本身不创建线程，
+ * 因此实际并行度不超过硬件并发数。调用线程同样领取下标执行，池中线程繁忙或在池中线程里
+ * 嵌套调用时退化为在调用线程内串行完成，不会死锁。
+ * fn 抛出的异常在全部下标结束后向调用方重新抛出（多个时取下标最小的一个）。
+ *
+ * @param n 下标个数，<= 0 时直接返回
+ * @param fn 对每个下标调用一次，会被多个线程并发调用
+ */
+void ParallelBands(int n, const std::function<void(int)>& fn);
@@ -10,126 +10,330 @@
  */
 
 #include "triplet.h"
-#include <unordered_map>
-#include <array>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "../common/pixel_dispatch.h"
+#include "../common/scratch.h"
+#include "../common/stats.h"
+#include "../imgproc/image_stats.h"
 
-// 统计所有颜色出现频次，选出频次最高的为背景色
-void TripletUtils::FindBackgroundColor(const cv::Mat& img, uint8_t bg_color[3]) {
-    int channels = img.channels();
-    
-    if (channels == 1) {
-        // 单通道图像，直接用 array 统计
-        std::array<size_t, 256> hist{}; // hist : histogram
+// ===================== 像素内核 =====================
+// 每个内核都是 Kernel<T, CN> 形式的类模板，由 pixel::KernelTable 在编译期实例化，
+// 对外的静态方法只按图像类型查一次表，像素循环内部不再判断通道数。
+
+// TripletNode 只能保存 3 个 8 位通道；SoA 的 TripletBuffer 支持全部组合
+template <typename T, int CN>
+constexpr bool kNodeSupported = std::is_same<T, uint8_t>::value && (CN == 1 || CN == 3);
 
-        // 遍历图像统计频次
+// 将图像转换为 std::vector<TripletNode>
+template <typename T, int CN>
+struct ToNodesKernel {
+    static constexpr bool kSupported = kNodeSupported<T, CN>;
+
+    static void Run(const cv::Mat& img, const uint8_t* bg_color, std::vector<TripletNode>& triplets) {
         for (int r = 0; r < img.rows; ++r) {
-            const uint8_t* rowp = img.ptr<uint8_t>(r);
+            const T* rowp = img.ptr<T>(r);  // 获取行指针
             for (int c = 0; c < img.cols; ++c) {
-                ++hist[rowp[c]];
+                // 生成三元组，跳过背景色
+                const T* pix = rowp + CN * c;
+                if (pixel::PixelEquals<CN>(pix, bg_color)) continue;
+                TripletNode node{}; node.row_ = r; node.col_ = c;
+                for (int k = 0; k < CN; ++k) node.val_[k] = static_cast<uint8_t>(pix[k]);
+                triplets.push_back(node);
             }
         }
+    }
+};
+
+// 将 std::vector<TripletNode> 写回已按背景色初始化的图像
+template <typename T, int CN>
+struct FromNodesKernel {
+    static constexpr bool kSupported = kNodeSupported<T, CN>;
 
-        // 找出频次最高的灰度值
-        size_t maxcnt = 0; int maxval = 0;
-        for (int v = 0; v < 256; ++v) {
-            if (hist[v] > maxcnt) { maxcnt = hist[v]; maxval = v; }
+    static void Run(const std::vector<TripletNode>& triplets, cv::Mat& img) {
+        for (const auto& node : triplets) {
+            if (node.row_ < 0 || node.row_ >= img.rows || node.col_ < 0 || node.col_ >= img.cols) continue;
+            T* pix = img.ptr<T>(node.row_) + CN * node.col_;
+            for (int k = 0; k < CN; ++k) pix[k] = node.val_[k];
         }
+    }
+};
 
-        // 写入背景色，灰度图只用第一个通道
-        bg_color[0] = static_cast<uint8_t>(maxval);
-        bg_color[1] = 0; bg_color[2] = 0;
-    } else if (channels == 3) {
-        // 多通道情况，用哈希表统计颜色出现频次。预留空间减少扩容开销
-        std::unordered_map<uint32_t, size_t> hist;
-        hist.reserve(static_cast<size_t>(img.rows) * img.cols / 8 + 256);
-        
-        // 遍历图像统计频次
-        for (int r = 0; r < img.rows; ++r) {
-            const cv::Vec3b* rowp = img.ptr<cv::Vec3b>(r);  // 获取行指针
-            for (int c = 0; c < img.cols; ++c) {
-                const cv::Vec3b& pix = rowp[c]; // B,G,R
-                uint32_t key = (static_cast<uint32_t>(pix[0]) << 16) |
-                               (static_cast<uint32_t>(pix[1]) << 8) |
-                               (static_cast<uint32_t>(pix[2]));
-                ++hist[key];
+// 按坐标类型 CoordT 写入 SoA 三元组，count 为预先统计好的非背景像素个数。
+// count 由调用方给出时未必准确，最多写入 count 个，实际更少时截短
+template <typename T, int CN, typename CoordT>
+static void FillTriplets(const cv::Mat& img, const uint16_t* bg_color, size_t count, TripletBuffer& triplets) {
+    triplets.Resize(count);
+    CoordT* rows = triplets.Rows<CoordT>();
+    CoordT* cols = triplets.Cols<CoordT>();
+    T* vals[CN];
+    for (int k = 0; k < CN; ++k) vals[k] = triplets.Values<T>(k);
+
+    size_t n = 0;
+    for (int r = 0; r < img.rows && n < count; ++r) {
+        const T* rowp = img.ptr<T>(r);
+        for (int c = 0; c < img.cols; ++c) {
+            const T* pix = rowp + CN * c;
+            if (pixel::PixelEquals<CN>(pix, bg_color)) continue;
+            if (n == count) break;
+            rows[n] = static_cast<CoordT>(r); cols[n] = static_cast<CoordT>(c);
+            for (int k = 0; k < CN; ++k) vals[k][n] = pix[k];
+            ++n;
+        }
+    }
+    if (n < count) triplets.Resize(n);
+}
+
+// 将图像转换为 SoA 三元组
+template <typename T, int CN>
+struct ToBufferKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const cv::Mat& img, const uint16_t* bg_color, size_t known_count, TripletBuffer& triplets) {
+        // 第一遍：统计非背景像素个数，调用方已知时跳过。循环体只有比较和累加，没有分支，可以被向量化
+        size_t count = known_count;
+        if (count == SIZE_MAX) {
+            count = 0;
+            for (int r = 0; r < img.rows; ++r) {
+                const T* rowp = img.ptr<T>(r);
+                size_t same = 0;
+                for (int c = 0; c < img.cols; ++c) same += pixel::PixelEquals<CN>(rowp + CN * c, bg_color);
+                count += static_cast<size_t>(img.cols) - same;
             }
         }
-        uint32_t best_key = 0; size_t best_cnt = 0;
-        for (const auto& kv : hist) {
-            if (kv.second > best_cnt) { best_cnt = kv.second; best_key = kv.first; }
+
+        // 第二遍：按 plane 写入，容量一次分配到位
+        if (triplets.wide_coords()) {
+            FillTriplets<T, CN, uint32_t>(img, bg_color, count, triplets);
+        } else {
+            FillTriplets<T, CN, uint16_t>(img, bg_color, count, triplets);
         }
-        // 按照 BGR 通道顺序提取背景色
-        bg_color[0] = static_cast<uint8_t>((best_key >> 16) & 0xFF);
-        bg_color[1] = static_cast<uint8_t>((best_key >> 8) & 0xFF);
-        bg_color[2] = static_cast<uint8_t>(best_key & 0xFF);
-    } else {
-        // 非 1/3 通道，默认背景设为 0
-        bg_color[0] = bg_color[1] = bg_color[2] = 0;
+    }
+};
+
+// 按坐标类型 CoordT 把 SoA 三元组写回图像
+template <typename T, int CN, typename CoordT>
+static void ScatterTriplets(const TripletBuffer& triplets, cv::Mat& img) {
+    const CoordT* rows = triplets.Rows<CoordT>();
+    const CoordT* cols = triplets.Cols<CoordT>();
+    const T* vals[CN];
+    for (int k = 0; k < CN; ++k) vals[k] = triplets.Values<T>(k);
+
+    const uint32_t height = static_cast<uint32_t>(img.rows);
+    const uint32_t width = static_cast<uint32_t>(img.cols);
+    const size_t n = triplets.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (rows[i] >= height || cols[i] >= width) continue;
+        T* pix = img.ptr<T>(rows[i]) + CN * static_cast<size_t>(cols[i]);
+        for (int k = 0; k < CN; ++k) pix[k] = vals[k][i];
     }
 }
 
-// 将图像转换为三元组表示
-void TripletUtils::MatToTriplets(const cv::Mat& img, const uint8_t bg_color[3], std::vector<TripletNode>& triplets) {
-    // 清空输出向量防止，有脏数据
-    triplets.clear();
+// 将 SoA 三元组写回已按背景色初始化的图像
+template <typename T, int CN>
+struct FromBufferKernel {
+    static constexpr bool kSupported = true;
 
-    // 遍历图像，将非背景色的像素转换为三元组
-    int channels = img.channels();
-    if (channels == 1) {
-        for (int r = 0; r < img.rows; ++r) {
-            const uint8_t* rowp = img.ptr<uint8_t>(r);  // 获取行指针
-            for (int c = 0; c < img.cols; ++c) {
-                // 获取当前像素值
-                uint8_t v = rowp[c]; 
+    static void Run(const TripletBuffer& triplets, cv::Mat& img) {
+        if (triplets.wide_coords()) {
+            ScatterTriplets<T, CN, uint32_t>(triplets, img);
+        } else {
+            ScatterTriplets<T, CN, uint16_t>(triplets, img);
+        }
+    }
+};
 
-                // 生成三元组，跳过背景色
-                if (v == bg_color[0]) continue; 
-                TripletNode node; node.row_ = r; node.col_ = c;
-                node.val_[0] = v; node.val_[1] = 0; node.val_[2] = 0;
-                triplets.push_back(node);
+// 帧间差分：先按段比较，再只在有变化的段内逐像素压缩
+template <typename T, int CN>
+struct DiffKernel {
+    static constexpr bool kSupported = true;
+    static constexpr int kSpan = 32;    ///< 每段的像素数
+
+    static T AbsDiff(T a, T b) { return static_cast<T>(std::max(a, b) - std::min(a, b)); }
+
+    // 一段内所有通道差值的最大值：只有 max 归约、没有分支，编译器会展开为 SIMD 比较
+    static T SpanMaxDiff(const T* a, const T* b, int n) {
+        T acc = 0;
+        for (int i = 0; i < n; ++i) acc = std::max(acc, AbsDiff(a[i], b[i]));
+        return acc;
+    }
+
+    static bool PixelChanged(const T* a, const T* b, T tol) {
+        bool changed = false;
+        for (int k = 0; k < CN; ++k) changed |= AbsDiff(a[k], b[k]) > tol;
+        return changed;
+    }
+
+    // 按坐标类型 CoordT 写出 spans 中各段的变化像素。写入位置每次都写、只在像素有变化时前进，
+    // 压缩过程没有分支，因此 triplets 的容量须比 count 多 1
+    template <typename CoordT>
+    static void Compact(const cv::Mat& img, const cv::Mat& ref, T tol, const size_t* spans, size_t num_spans,
+                        size_t spans_per_row, size_t count, TripletBuffer& triplets) {
+        triplets.Resize(count + 1);
+        CoordT* rows = triplets.Rows<CoordT>();
+        CoordT* cols = triplets.Cols<CoordT>();
+        T* vals[CN];
+        for (int k = 0; k < CN; ++k) vals[k] = triplets.Values<T>(k);
+
+        size_t n = 0;
+        for (size_t s = 0; s < num_spans; ++s) {
+            const int r = static_cast<int>(spans[s] / spans_per_row);
+            const int begin = static_cast<int>(spans[s] % spans_per_row) * kSpan;
+            const int end = std::min(begin + kSpan, img.cols);
+            const T* a = img.ptr<T>(r);
+            const T* b = ref.ptr<T>(r);
+            for (int c = begin; c < end; ++c) {
+                const T* pix = a + CN * c;
+                rows[n] = static_cast<CoordT>(r); cols[n] = static_cast<CoordT>(c);
+                for (int k = 0; k < CN; ++k) vals[k][n] = pix[k];
+                n += PixelChanged(pix, b + CN * c, tol);
             }
         }
-    } else if (channels == 3) {
-        for (int r = 0; r < img.rows; ++r) {
-            const cv::Vec3b* rowp = img.ptr<cv::Vec3b>(r);  // 获取行指针
-            for (int c = 0; c < img.cols; ++c) {
-                // 获取当前像素值
-                const cv::Vec3b& pix = rowp[c];
+        triplets.Resize(n);
+    }
 
-                // 生成三元组，跳过背景色
-                if (pix[0] == bg_color[0] && pix[1] == bg_color[1] && pix[2] == bg_color[2]) continue;
-                TripletNode node; node.row_ = r; node.col_ = c;
-                node.val_[0] = pix[0]; node.val_[1] = pix[1]; node.val_[2] = pix[2];
-                triplets.push_back(node);
+    static void Run(const cv::Mat& img, const cv::Mat& ref, int tolerance, TripletBuffer& triplets) {
+        const T tol = static_cast<T>(std::clamp<int>(tolerance, 0, std::numeric_limits<T>::max()));
+        const size_t spans_per_row = (static_cast<size_t>(img.cols) + kSpan - 1) / kSpan;
+
+        // 第一遍：找出有变化的段并统计变化像素数，段号暂存在每线程的 ScratchPool 中
+        size_t* spans = ScratchPool::Get<size_t>(0, spans_per_row * img.rows);
+        size_t num_spans = 0, count = 0;
+        for (int r = 0; r < img.rows; ++r) {
+            const T* a = img.ptr<T>(r);
+            const T* b = ref.ptr<T>(r);
+            for (size_t s = 0; s < spans_per_row; ++s) {
+                const int begin = static_cast<int>(s) * kSpan;
+                const int end = std::min(begin + kSpan, img.cols);
+                if (SpanMaxDiff(a + CN * begin, b + CN * begin, CN * (end - begin)) <= tol) continue;
+                size_t changed = 0;
+                for (int c = begin; c < end; ++c) changed += PixelChanged(a + CN * c, b + CN * c, tol);
+                spans[num_spans++] = static_cast<size_t>(r) * spans_per_row + s;
+                count += changed;
             }
         }
+
+        // 第二遍：只访问有变化的段
+        if (triplets.wide_coords()) {
+            Compact<uint32_t>(img, ref, tol, spans, num_spans, spans_per_row, count, triplets);
+        } else {
+            Compact<uint16_t>(img, ref, tol, spans, num_spans, spans_per_row, count, triplets);
+        }
     }
+};
+
+using ToNodesTable = pixel::KernelTable<ToNodesKernel, void, const cv::Mat&, const uint8_t*, std::vector<TripletNode>&>;
+using FromNodesTable = pixel::KernelTable<FromNodesKernel, void, const std::vector<TripletNode>&, cv::Mat&>;
+using ToBufferTable = pixel::KernelTable<ToBufferKernel, void, const cv::Mat&, const uint16_t*, size_t, TripletBuffer&>;
+using FromBufferTable = pixel::KernelTable<FromBufferKernel, void, const TripletBuffer&, cv::Mat&>;
+using DiffTable = pixel::KernelTable<DiffKernel, void, const cv::Mat&, const cv::Mat&, int, TripletBuffer&>;
+
+// ===================== TripletUtils =====================
+
+// 统计所有颜色出现频次，选出频次最高的为背景色
+void TripletUtils::FindBackgroundColor(const cv::Mat& img, uint8_t bg_color[3]) {
+    // 8 位接口只服务 8 位灰度/彩色图，其他类型与以前一样返回 0
+    bg_color[0] = bg_color[1] = bg_color[2] = 0;
+    if (img.depth() != CV_8U || (img.channels() != 1 && img.channels() != 3)) return;
+    uint16_t background[4];
+    FindBackgroundColor(img, background);
+    for (int k = 0; k < 3; ++k) bg_color[k] = static_cast<uint8_t>(background[k]);
+}
+
+// 任意支持类型的背景色：只统计 ImageStats 的颜色众数，与 Compressor::Save 选出的背景色一致
+void TripletUtils::FindBackgroundColor(const cv::Mat& img, uint16_t background[4]) {
+    STATS_SCOPE_BYTES(kBackground, img.total() * img.elemSize());
+    // 不支持的类型，默认背景设为 0
+    background[0] = background[1] = background[2] = background[3] = 0;
+    ImageStatsOptions options;
+    options.histograms = false;
+    options.unique_colors = false;
+    options.color_mode = true;
+    ImageStats stats;
+    if (!ImageStats::Compute(img, stats, options) || !stats.has_mode) return;
+    std::copy(stats.mode, stats.mode + 4, background);
+}
+
+// 将图像转换为三元组表示
+void TripletUtils::MatToTriplets(const cv::Mat& img, const uint8_t bg_color[3], std::vector<TripletNode>& triplets) {
+    STATS_SCOPE_BYTES(kTripletExtract, img.total() * img.elemSize());
+    // 清空输出向量防止，有脏数据
+    triplets.clear();
+
+    auto kernel = ToNodesTable::Lookup(img.type());
+    if (kernel != nullptr) kernel(img, bg_color, triplets);
 }
 
 // 将三元组表示转换为图像
 void TripletUtils::TripletsToMat(const std::vector<TripletNode>& triplets, int width, int height, int channels, const uint8_t bg_color[3], cv::Mat& img) {
-    if (channels == 1) {
-        // 创建单通道图像，初始化为背景色
-        img = cv::Mat(height, width, CV_8UC1, cv::Scalar(bg_color[0]));
-
-        // 填充非背景色像素
-        for (const auto& node : triplets) {
-            if (node.row_ >= 0 && node.row_ < height && node.col_ >= 0 && node.col_ < width) {
-                img.at<uint8_t>(node.row_, node.col_) = node.val_[0];
-            }
-        }
-    } else if (channels == 3) {
-        // 创建三通道图像，初始化为背景色
-        img = cv::Mat(height, width, CV_8UC3, cv::Scalar(bg_color[0], bg_color[1], bg_color[2]));
-        
-        // 填充非背景色像素
-        for (const auto& node : triplets) {
-            if (node.row_ >= 0 && node.row_ < height && node.col_ >= 0 && node.col_ < width) {
-                img.at<cv::Vec3b>(node.row_, node.col_) = cv::Vec3b(node.val_[0], node.val_[1], node.val_[2]);
-            }
-        }
-    } else {
+    STATS_SCOPE(kTripletRebuild);
+    auto kernel = FromNodesTable::Lookup(CV_MAKETYPE(CV_8U, channels));
+    if (kernel == nullptr || width <= 0 || height <= 0) {
         // 不支持的通道，创建空图
         img = cv::Mat();
+        return;
+    }
+
+    // 创建图像并初始化为背景色，再填充非背景色像素
+    img = cv::Mat(height, width, CV_MAKETYPE(CV_8U, channels), cv::Scalar(bg_color[0], bg_color[1], bg_color[2]));
+    kernel(triplets, img);
+}
+
+// 将图像转换为 SoA 三元组表示
+void TripletUtils::MatToTriplets(const cv::Mat& img, const uint8_t bg_color[3], TripletBuffer& triplets) {
+    const uint16_t background[4] = {bg_color[0], bg_color[1], bg_color[2], 0};
+    MatToTriplets(img, background, triplets);
+}
+
+// 任意支持类型的图像转换为 SoA 三元组表示
+void TripletUtils::MatToTriplets(const cv::Mat& img, const uint16_t background[4], TripletBuffer& triplets) {
+    MatToTriplets(img, background, SIZE_MAX, triplets);
+}
+
+// 已知非背景像素个数时只需一遍扫描，count 为 SIZE_MAX 时先统计
+void TripletUtils::MatToTriplets(const cv::Mat& img, const uint16_t background[4], size_t count, TripletBuffer& triplets) {
+    STATS_SCOPE_BYTES(kTripletExtract, img.total() * img.elemSize());
+    triplets.Reset(img.cols, img.rows, img.channels(), img.depth());
+    triplets.SetBackground(background);
+
+    auto kernel = ToBufferTable::Lookup(img.type());
+    if (kernel != nullptr) kernel(img, background, count, triplets);
+}
+
+// 将 SoA 三元组表示转换为图像
+void TripletUtils::TripletsToMat(const TripletBuffer& triplets, cv::Mat& img) {
+    STATS_SCOPE(kTripletRebuild);
+    const uint16_t* bg = triplets.background();
+    const int type = CV_MAKETYPE(triplets.depth(), triplets.channels());
+    auto kernel = FromBufferTable::Lookup(type);
+    if (kernel == nullptr || triplets.width() <= 0 || triplets.height() <= 0) {
+        img = cv::Mat();
+        return;
     }
-}
\ No newline at end of file
+
+    img = cv::Mat(triplets.height(), triplets.width(), type, cv::Scalar(bg[0], bg[1], bg[2], bg[3]));
+    kernel(triplets, img);
+}
+
+// 提取与参考帧不同的像素
+bool TripletUtils::DiffToTriplets(const cv::Mat& img, const cv::Mat& ref, int tolerance, TripletBuffer& triplets) {
+    STATS_SCOPE_BYTES(kTripletDiff, img.total() * img.elemSize());
+    triplets.Reset(img.cols, img.rows, img.channels(), img.depth());
+
+    auto kernel = DiffTable::Lookup(img.type());
+    if (kernel == nullptr || img.empty() || ref.size() != img.size() || ref.type() != img.type()) return false;
+    kernel(img, ref, tolerance, triplets);
+    return true;
+}
+
+// 在已有图像上覆盖三元组
+bool TripletUtils::ApplyTriplets(const TripletBuffer& triplets, cv::Mat& img) {
+    STATS_SCOPE(kTripletRebuild);
+    const int type = CV_MAKETYPE(triplets.depth(), triplets.channels());
+    auto kernel = FromBufferTable::Lookup(type);
+    if (kernel == nullptr || img.type() != type || img.cols != triplets.width() || img.rows != triplets.height()) return false;
+    kernel(triplets, img);
+    return true;
+}
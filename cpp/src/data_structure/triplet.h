@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <vector>
 #include <opencv2/core/mat.hpp>
+#include "triplet_buffer.h"
 
 /**
  * @brief 三元组节点结构体，表示图像中非背景色的像素信息 
@@ -30,9 +31,11 @@ struct CompressedHeader {
     char magic_[4] = {'T', 'R', 'I', 'P'};  ///< 魔术数字，作为文件标识
     int32_t width_;                         ///< 图像宽度
     int32_t height_;                        ///< 图像高度
-    int32_t channels_;                      ///< 通道数，1 表示灰度图，3 表示彩色图
+    int32_t channels_;                      ///< 通道数，1 表示灰度图，3 表示彩色图，4 表示带 alpha 的彩色图
     uint64_t count_;                        ///< 三元组数量
     uint8_t bg_color_[3];                   ///< 背景色（BGR），灰度图时仅用 bg_color_[0]
+    int32_t depth_ = CV_8U;                 ///< 取值位深，CV_8U 或 CV_16U
+    uint16_t background_[4] = {0, 0, 0, 0}; ///< 任意位深的背景色（BGRA），前 channels_ 个元素有效
 };
 
 /**
@@ -48,6 +51,16 @@ public:
      */
     static void FindBackgroundColor(const cv::Mat& img, uint8_t bg_color[3]);
 
+    /**
+     * @brief 统计任意支持类型（8 位或 16 位，1/3/4 通道）图像的背景色
+     * 
+     * @details 即 ImageStats 的颜色众数（频次相同时取较小的值），与 Compressor::Save 选出的背景色相同。
+     * 
+     * @param img[in] 输入图像
+     * @param background[out] 接受背景色的数组，按 BGR(A) 顺序，前 img.channels() 个元素有效，其余为 0
+     */
+    static void FindBackgroundColor(const cv::Mat& img, uint16_t background[4]);
+
     /**
      * @brief 将 cv::Mat 图像转换为三元组表示
      * 
@@ -68,4 +81,71 @@ public:
      * @param img[out] 接受转换后图像的 cv::Mat 对象
      */
     static void TripletsToMat(const std::vector<TripletNode>& triplets, int width, int height, int channels, const uint8_t bg_color[3], cv::Mat& img);
+
+    /**
+     * @brief 将 cv::Mat 图像转换为 SoA 形式的三元组
+     * 
+     * @details 先逐行统计非背景像素个数以一次性分配容量，再按 plane 写入。
+     * 转换后 triplets 记录图像宽高、通道数和背景色。
+     * 
+     * @param img[in] 输入图像
+     * @param bg_color[in] 背景颜色（BGR 或灰度）
+     * @param triplets[out] 接受三元组结果的容器
+     */
+    static void MatToTriplets(const cv::Mat& img, const uint8_t bg_color[3], TripletBuffer& triplets);
+
+    /**
+     * @brief 将任意支持类型（8 位或 16 位，1/3/4 通道）的图像转换为 SoA 形式的三元组
+     * 
+     * @details 取值按图像位深保存，triplets 同时记录位深。
+     * 
+     * @param img[in] 输入图像
+     * @param background[in] 背景颜色，按 BGR(A) 顺序，前 img.channels() 个元素有效
+     * @param triplets[out] 接受三元组结果的容器
+     */
+    static void MatToTriplets(const cv::Mat& img, const uint16_t background[4], TripletBuffer& triplets);
+
+    /**
+     * @brief 已知非背景像素个数时的转换，省去统计个数的一遍扫描
+     * 
+     * @param img[in] 输入图像
+     * @param background[in] 背景颜色，按 BGR(A) 顺序，前 img.channels() 个元素有效
+     * @param count[in] img 中与 background 不同的像素个数（如 ImageStats 的 pixels - mode_count），
+     *                  比实际少时结果只保留前 count 个三元组
+     * @param triplets[out] 接受三元组结果的容器
+     */
+    static void MatToTriplets(const cv::Mat& img, const uint16_t background[4], size_t count, TripletBuffer& triplets);
+
+    /**
+     * @brief 将 SoA 形式的三元组转换回 cv::Mat 图像，宽高、通道数、位深和背景色取自 triplets
+     * 
+     * @param triplets[in] 输入的三元组
+     * @param img[out] 接受转换后图像的 cv::Mat 对象
+     */
+    static void TripletsToMat(const TripletBuffer& triplets, cv::Mat& img);
+
+    /**
+     * @brief 提取当前帧中与参考帧不同的像素，作为帧间差分三元组
+     * 
+     * @details 任一通道与参考帧的差值超过 tolerance 的像素记为一个三元组，取值来自 img。
+     * 每行按固定宽度的段先做无分支的差值归约（可被编译器展开为 SIMD 比较），
+     * 整段不变时直接跳过，只在有变化的段内逐像素压缩写出，静态画面几乎只有比较的开销。
+     * triplets 的背景色为 0，不参与差分。
+     * 
+     * @param img[in] 当前帧，8 位或 16 位，1/3/4 通道
+     * @param ref[in] 参考帧，尺寸与类型须与 img 相同
+     * @param tolerance[in] 容差，0 表示无损
+     * @param triplets[out] 接受差分结果的容器
+     * @return 类型不支持或两帧尺寸、类型不一致时返回 false，triplets 被清空
+     */
+    static bool DiffToTriplets(const cv::Mat& img, const cv::Mat& ref, int tolerance, TripletBuffer& triplets);
+
+    /**
+     * @brief 把三元组覆盖写到已有图像上（不按背景色重新初始化），用于在参考帧上应用差分
+     * 
+     * @param triplets[in] 输入的三元组，越界坐标被跳过
+     * @param img[in,out] 目标图像，尺寸、通道数与位深须与 triplets 一致
+     * @return 不一致时返回 false，img 不变
+     */
+    static bool ApplyTriplets(const TripletBuffer& triplets, cv::Mat& img);
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+/**
+ * @file triplet_buffer.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief SoA 三元组容器及线性内存池实现
+ * @version 0.1
+ * @date 2025-11-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "triplet_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include "../common/memory.h"
+
+// ===================== TripletArena =====================
+
+TripletArena::TripletArena(size_t block_size) : block_size_(block_size == 0 ? kDefaultBlockSize : block_size) {}
+
+TripletArena::~TripletArena() {
+    MemoryTracker::Free(MemoryTracker::Category::kTriplets, BytesReserved());
+}
+
+// 向系统申请一个块并记账
+static std::unique_ptr<uint8_t[]> NewBlock(size_t bytes) {
+    MemoryTracker::Allocate(MemoryTracker::Category::kTriplets, bytes);
+    try {
+        return std::unique_ptr<uint8_t[]>(new uint8_t[bytes]);
+    } catch (...) {
+        MemoryTracker::Free(MemoryTracker::Category::kTriplets, bytes);
+        throw;
+    }
+}
+
+void* TripletArena::Allocate(size_t bytes, size_t align) {
+    // 从当前块开始寻找能放下的位置，放不下就换到下一块
+    for (; current_ < blocks_.size(); ++current_) {
+        Block& b = blocks_[current_];
+        uintptr_t base = reinterpret_cast<uintptr_t>(b.data.get());
+        uintptr_t p = (base + b.used + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        size_t end = static_cast<size_t>(p - base) + bytes;
+        if (end <= b.size) {
+            b.used = end;
+            return reinterpret_cast<void*>(p);
+        }
+    }
+
+    // 已有的块都放不下，申请新块（预留对齐余量）
+    Block b;
+    b.size = std::max(block_size_, bytes + align);
+    b.data = NewBlock(b.size);
+    blocks_.push_back(std::move(b));
+    current_ = blocks_.size() - 1;
+    return Allocate(bytes, align);
+}
+
+void TripletArena::Reset() {
+    // 多个块时合并为一个大块，下一轮同尺寸图像只需要一个块
+    if (blocks_.size() > 1) {
+        size_t total = BytesReserved();
+        blocks_.clear();
+        MemoryTracker::Free(MemoryTracker::Category::kTriplets, total);
+        Block b;
+        b.size = total;
+        b.data = NewBlock(b.size);
+        blocks_.push_back(std::move(b));
+    }
+    for (auto& b : blocks_) b.used = 0;
+    current_ = 0;
+}
+
+size_t TripletArena::BytesReserved() const {
+    size_t total = 0;
+    for (const auto& b : blocks_) total += b.size;
+    return total;
+}
+
+size_t TripletArena::BytesUsed() const {
+    size_t total = 0;
+    for (const auto& b : blocks_) total += b.used;
+    return total;
+}
+
+// ===================== TripletBuffer =====================
+
+TripletBuffer::TripletBuffer(TripletArena* arena) : arena_(arena) {
+    if (arena_ == nullptr) {
+        owned_arena_.reset(new TripletArena());
+        arena_ = owned_arena_.get();
+    }
+}
+
+void TripletBuffer::Reset(int width, int height, int channels, int depth) {
+    width_ = width;
+    height_ = height;
+    channels_ = (channels == 3 || channels == 4) ? channels : 1;
+    depth_ = (depth == CV_16U) ? CV_16U : CV_8U;
+    wide_coords_ = width > 0xFFFF || height > 0xFFFF;
+    bg_color_[0] = bg_color_[1] = bg_color_[2] = 0;
+    background_[0] = background_[1] = background_[2] = background_[3] = 0;
+
+    // 旧 plane 的内存仍属于 arena，直接丢弃指针即可。自带的 arena 只服务于本容器，一并重置，
+    // 否则每次 Reset 后重新分配 plane 都会在 arena 中累积；共享的 arena 由其所有者负责 Reset
+    if (owned_arena_) owned_arena_->Reset();
+    rows_ = cols_ = nullptr;
+    vals_[0] = vals_[1] = vals_[2] = vals_[3] = nullptr;
+    size_ = capacity_ = 0;
+}
+
+void TripletBuffer::Reserve(size_t n) {
+    if (n > capacity_) Grow(n);
+}
+
+void TripletBuffer::Resize(size_t n) {
+    Reserve(n);
+    size_ = n;
+}
+
+void TripletBuffer::PushBack(uint32_t row, uint32_t col, const uint8_t* val) {
+    if (size_ == capacity_) Grow(capacity_ == 0 ? 1024 : capacity_ * 2);
+    if (wide_coords_) {
+        static_cast<uint32_t*>(rows_)[size_] = row;
+        static_cast<uint32_t*>(cols_)[size_] = col;
+    } else {
+        static_cast<uint16_t*>(rows_)[size_] = static_cast<uint16_t>(row);
+        static_cast<uint16_t*>(cols_)[size_] = static_cast<uint16_t>(col);
+    }
+    for (int k = 0; k < channels_; ++k) Values(k)[size_] = val[k];
+    ++size_;
+}
+
+size_t TripletBuffer::BytesPerTriplet() const {
+    return (wide_coords_ ? 8 : 4) + static_cast<size_t>(channels_) * value_bytes();
+}
+
+void TripletBuffer::SetBackground(const uint8_t bg_color[3]) {
+    for (int k = 0; k < 3; ++k) background_[k] = bg_color_[k] = bg_color[k];
+    background_[3] = 0;
+}
+
+void TripletBuffer::SetBackground(const uint16_t background[4]) {
+    for (int k = 0; k < 4; ++k) background_[k] = background[k];
+    for (int k = 0; k < 3; ++k) bg_color_[k] = static_cast<uint8_t>(background[k]);
+}
+
+// 从 arena 申请更大的 plane 并拷贝已有数据。旧 plane 留在 arena 中直到下一次 Reset
+void TripletBuffer::Grow(size_t min_capacity) {
+    size_t coord_bytes = wide_coords_ ? sizeof(uint32_t) : sizeof(uint16_t);
+    void* rows = arena_->Allocate(min_capacity * coord_bytes);
+    void* cols = arena_->Allocate(min_capacity * coord_bytes);
+    if (size_ > 0) {
+        std::memcpy(rows, rows_, size_ * coord_bytes);
+        std::memcpy(cols, cols_, size_ * coord_bytes);
+    }
+    rows_ = rows;
+    cols_ = cols;
+
+    const size_t vb = value_bytes();
+    for (int k = 0; k < channels_; ++k) {
+        void* v = arena_->Allocate(min_capacity * vb);
+        if (size_ > 0) std::memcpy(v, vals_[k], size_ * vb);
+        vals_[k] = v;
+    }
+    capacity_ = min_capacity;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file triplet_buffer.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 结构数组（SoA）形式的三元组容器及其线性内存池声明
+ * @version 0.1
+ * @date 2025-11-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 可重置的线性内存池（arena）
+ *
+ * @details 按块向系统申请内存，分配时只移动块内偏移量，不支持单独释放。
+ * - Reset() 之后已申请的内存全部保留，供下一张图像复用；
+ * - 若上一轮用到了多个块，Reset() 会把它们合并成一个足够大的块，
+ *   这样处理同样尺寸的下一张图像时不会再向系统申请内存。
+ * - 向系统申请的块计入 MemoryTracker 的 kTriplets 类别，超出预算时抛出 MemoryBudgetExceeded。
+ */
+class TripletArena {
+public:
+    static constexpr size_t kDefaultBlockSize = 1 << 20;  ///< 默认块大小 1 MiB
+
+    explicit TripletArena(size_t block_size = kDefaultBlockSize);
+    ~TripletArena();
+
+    TripletArena(const TripletArena&) = delete;
+    TripletArena& operator=(const TripletArena&) = delete;
+
+    /**
+     * @brief 从内存池中分配一段内存
+     *
+     * @param bytes 需要的字节数
+     * @param align 对齐要求（必须是 2 的幂）
+     * @return void* 指向分配内存的指针，生命周期持续到下一次 Reset()
+     */
+    void* Allocate(size_t bytes, size_t align = 64);
+
+    /**
+     * @brief 回收全部分配，保留已申请的内存以便复用
+     */
+    void Reset();
+
+    /**
+     * @brief 已向系统申请的总字节数
+     */
+    size_t BytesReserved() const;
+
+    /**
+     * @brief 自上次 Reset() 以来已分配出去的字节数（含对齐填充）
+     */
+    size_t BytesUsed() const;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0;    ///< 当前正在分配的块下标
+    size_t block_size_;
+};
+
+/**
+ * @brief SoA 形式的三元组容器
+ *
+ * @details 行坐标、列坐标和每个通道的取值分别存放在独立的连续数组（plane）中：
+ * - 图像宽高都不超过 65535 时坐标使用 uint16_t，否则使用 uint32_t；
+ * - 每个通道一个取值 plane：灰度图一个，BGR 三个，BGRA 四个；
+ * - 取值按图像位深存储，8 位图像为 uint8_t，16 位图像为 uint16_t；
+ * - 内存来自 TripletArena，调用方可以在多张图像之间复用同一个 arena。
+ *
+ * 与 std::vector<TripletNode>（每个节点 12 字节）相比，8 位彩色图每个三元组占 7 字节，
+ * 灰度图占 5 字节，并且按 plane 存储的循环可以被编译器向量化。
+ * 容器同时记录图像宽高、通道数、位深和背景色，因此可以独立描述一张稀疏图像。
+ */
+class TripletBuffer {
+public:
+    /**
+     * @brief 构造三元组容器
+     *
+     * @param arena 内存来源；为 nullptr 时容器使用自己持有的 arena
+     */
+    explicit TripletBuffer(TripletArena* arena = nullptr);
+
+    TripletBuffer(const TripletBuffer&) = delete;
+    TripletBuffer& operator=(const TripletBuffer&) = delete;
+
+    /**
+     * @brief 清空容器并设置图像几何信息，据此选择坐标宽度
+     *
+     * @details 容器使用自己持有的 arena 时同时重置它，反复 Reset 与填充时内存不增长；
+     * 外部传入的 arena 不会被重置。
+     *
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param channels 通道数（1、3 或 4）
+     * @param depth 取值位深（CV_8U 或 CV_16U）
+     */
+    void Reset(int width, int height, int channels, int depth = CV_8U);
+
+    /**
+     * @brief 保证容量至少为 n 个三元组
+     */
+    void Reserve(size_t n);
+
+    /**
+     * @brief 设置元素个数（不超过容量），供批量写入 plane 之后使用
+     */
+    void Resize(size_t n);
+
+    /**
+     * @brief 追加一个三元组
+     *
+     * @param row 行索引
+     * @param col 列索引
+     * @param val 像素值，彩色图时为 B,G,R 三个元素，灰度图时仅用第一个元素（仅限 8 位容器）
+     */
+    void PushBack(uint32_t row, uint32_t col, const uint8_t* val);
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int channels() const { return channels_; }
+    int depth() const { return depth_; }
+
+    /**
+     * @brief 每个通道取值占用的字节数（1 或 2）
+     */
+    size_t value_bytes() const { return depth_ == CV_16U ? 2 : 1; }
+
+    /**
+     * @brief 坐标是否使用 uint32_t 存储（宽或高超过 65535 时为 true）
+     */
+    bool wide_coords() const { return wide_coords_; }
+
+    /**
+     * @brief 每个三元组实际占用的字节数
+     */
+    size_t BytesPerTriplet() const;
+
+    /**
+     * @brief 8 位背景色（BGR），供 8 位灰度/彩色容器使用
+     */
+    const uint8_t* bg_color() const { return bg_color_; }
+    void SetBackground(const uint8_t bg_color[3]);
+
+    /**
+     * @brief 任意位深的背景色，共 4 个元素，前 channels() 个有效
+     */
+    const uint16_t* background() const { return background_; }
+    void SetBackground(const uint16_t background[4]);
+
+    /**
+     * @brief 按下标读取行/列坐标（与坐标宽度无关）
+     */
+    uint32_t Row(size_t i) const {
+        return wide_coords_ ? static_cast<const uint32_t*>(rows_)[i] : static_cast<const uint16_t*>(rows_)[i];
+    }
+    uint32_t Col(size_t i) const {
+        return wide_coords_ ? static_cast<const uint32_t*>(cols_)[i] : static_cast<const uint16_t*>(cols_)[i];
+    }
+
+    /**
+     * @brief 访问坐标 plane，CoordT 必须与 wide_coords() 对应（uint16_t 或 uint32_t）
+     */
+    template <typename CoordT> CoordT* Rows() { return static_cast<CoordT*>(rows_); }
+    template <typename CoordT> const CoordT* Rows() const { return static_cast<const CoordT*>(rows_); }
+    template <typename CoordT> CoordT* Cols() { return static_cast<CoordT*>(cols_); }
+    template <typename CoordT> const CoordT* Cols() const { return static_cast<const CoordT*>(cols_); }
+
+    /**
+     * @brief 访问第 k 个通道的 8 位取值 plane（k < channels()，depth() 为 CV_8U）
+     */
+    uint8_t* Values(int k) { return static_cast<uint8_t*>(vals_[k]); }
+    const uint8_t* Values(int k) const { return static_cast<const uint8_t*>(vals_[k]); }
+
+    /**
+     * @brief 按元素类型访问第 k 个通道的取值 plane，T 必须与 depth() 对应（uint8_t 或 uint16_t）
+     */
+    template <typename T> T* Values(int k) { return static_cast<T*>(vals_[k]); }
+    template <typename T> const T* Values(int k) const { return static_cast<const T*>(vals_[k]); }
+
+private:
+    void Grow(size_t min_capacity);
+
+    std::unique_ptr<TripletArena> owned_arena_;
+    TripletArena* arena_;
+
+    void* rows_ = nullptr;
+    void* cols_ = nullptr;
+    void* vals_[4] = {nullptr, nullptr, nullptr, nullptr};
+
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    int channels_ = 1;
+    int depth_ = CV_8U;
+    bool wide_coords_ = false;
+    uint8_t bg_color_[3] = {0, 0, 0};
+    uint16_t background_[4] = {0, 0, 0, 0};
+};
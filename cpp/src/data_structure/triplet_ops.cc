@@ -0,0 +1,258 @@
+/**
+ * @file triplet_ops.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 压缩域操作实现
+ * @version 0.1
+ * @date 2025-12-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "triplet_ops.h"
+#include <algorithm>
+#include <cstdint>
+#include "../common/pixel_dispatch.h"
+#include "../common/scratch.h"
+#include "../imgproc/image_processor.h"
+
+namespace {
+
+// 按输入、输出的坐标宽度调用 f(CoordS(), CoordD())，宽度由各自的尺寸决定，裁剪后可能变窄
+template <typename F>
+void WithCoords(const TripletBuffer& src, const TripletBuffer& dst, F&& f) {
+    if (src.wide_coords()) {
+        if (dst.wide_coords()) f(uint32_t(), uint32_t()); else f(uint32_t(), uint16_t());
+    } else {
+        if (dst.wide_coords()) f(uint16_t(), uint32_t()); else f(uint16_t(), uint16_t());
+    }
+}
+
+// 所有坐标都落在图像内
+template <typename CoordT>
+bool InBounds(const TripletBuffer& src) {
+    const CoordT* rows = src.Rows<CoordT>();
+    const CoordT* cols = src.Cols<CoordT>();
+    const uint32_t width = static_cast<uint32_t>(src.width()), height = static_cast<uint32_t>(src.height());
+    bool ok = true;
+    for (size_t i = 0; i < src.size(); ++i) ok &= (rows[i] < height) & (cols[i] < width);
+    return ok;
+}
+
+constexpr size_t kGrayChunk = 1 << 14;  ///< 灰度化每批转换的三元组个数，中间数据留在缓存中
+
+// 翻转与旋转统一表示的坐标变换
+enum class Transform { kFlipHorizontal, kFlipVertical, kRotate180, kRotateClockwise, kRotateCounterClockwise };
+
+}  // namespace
+
+// 灰度化：背景色与取值分批打包成 1 x m 的图像交给 Processor::ToGray，保证与图像域的结果逐位相同
+template <typename T, int CN>
+struct GrayOpKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const TripletBuffer& src, TripletBuffer& dst) {
+        const int type = CV_MAKETYPE(src.depth(), CN);
+        const int gray_type = CV_MAKETYPE(src.depth(), 1);
+
+        T bg[CN];
+        for (int k = 0; k < CN; ++k) bg[k] = static_cast<T>(src.background()[k]);
+        const T gray_bg = Processor::ToGray(cv::Mat(1, 1, type, bg)).template at<T>(0, 0);
+        const uint16_t background[4] = {gray_bg, 0, 0, 0};
+
+        dst.Reset(src.width(), src.height(), 1, src.depth());
+        dst.SetBackground(background);
+        // 与 DiffToTriplets 一样无分支地压缩：每个位置都写、只在与背景不同时前进，容量多留 1 个
+        dst.Resize(src.size() + 1);
+
+        T* packed = ScratchPool::Get<T>(0, kGrayChunk * CN);
+        T* gray = ScratchPool::Get<T>(1, kGrayChunk);
+        size_t n = 0;
+        WithCoords(src, dst, [&](auto s, auto d) {
+            using CoordS = decltype(s);
+            using CoordD = decltype(d);
+            const CoordS* rows = src.Rows<CoordS>();
+            const CoordS* cols = src.Cols<CoordS>();
+            CoordD* out_rows = dst.Rows<CoordD>();
+            CoordD* out_cols = dst.Cols<CoordD>();
+            T* out_vals = dst.Values<T>(0);
+            const T* vals[CN];
+            for (int k = 0; k < CN; ++k) vals[k] = src.Values<T>(k);
+
+            for (size_t begin = 0; begin < src.size(); begin += kGrayChunk) {
+                const size_t m = std::min(kGrayChunk, src.size() - begin);
+                for (size_t j = 0; j < m; ++j) {
+                    for (int k = 0; k < CN; ++k) packed[j * CN + k] = vals[k][begin + j];
+                }
+                // 输出图像头建立在暂存区上，尺寸与类型已符合要求，ToGray 直接写入
+                cv::Mat in(1, static_cast<int>(m), type, packed);
+                cv::Mat out(1, static_cast<int>(m), gray_type, gray);
+                Processor::ToGray(in, out);
+                for (size_t j = 0; j < m; ++j) {
+                    out_rows[n] = static_cast<CoordD>(rows[begin + j]);
+                    out_cols[n] = static_cast<CoordD>(cols[begin + j]);
+                    out_vals[n] = gray[j];
+                    n += gray[j] != gray_bg;
+                }
+            }
+        });
+        dst.Resize(n);
+    }
+};
+
+// 裁剪：行号有序，二分得到 [y, y + h) 的行区间后只扫描这一段
+template <typename T, int CN>
+struct CropOpKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const TripletBuffer& src, const cv::Rect& roi, TripletBuffer& dst) {
+        dst.Reset(roi.width, roi.height, CN, src.depth());
+        dst.SetBackground(src.background());
+
+        WithCoords(src, dst, [&](auto s, auto d) {
+            using CoordS = decltype(s);
+            using CoordD = decltype(d);
+            const CoordS* rows = src.Rows<CoordS>();
+            const CoordS* cols = src.Cols<CoordS>();
+            const size_t lo = std::lower_bound(rows, rows + src.size(), static_cast<uint32_t>(roi.y),
+                                               [](CoordS a, uint32_t b) { return a < b; }) - rows;
+            const size_t hi = std::lower_bound(rows + lo, rows + src.size(), static_cast<uint32_t>(roi.y + roi.height),
+                                               [](CoordS a, uint32_t b) { return a < b; }) - rows;
+
+            dst.Resize(hi - lo + 1);
+            CoordD* out_rows = dst.Rows<CoordD>();
+            CoordD* out_cols = dst.Cols<CoordD>();
+            const T* vals[CN];
+            T* out_vals[CN];
+            for (int k = 0; k < CN; ++k) {
+                vals[k] = src.Values<T>(k);
+                out_vals[k] = dst.Values<T>(k);
+            }
+
+            // 列平移后用无符号比较一次判断是否落在 [0, w) 内
+            const uint32_t x = static_cast<uint32_t>(roi.x), w = static_cast<uint32_t>(roi.width);
+            const uint32_t y = static_cast<uint32_t>(roi.y);
+            size_t n = 0;
+            for (size_t i = lo; i < hi; ++i) {
+                const uint32_t c = static_cast<uint32_t>(cols[i]) - x;
+                out_rows[n] = static_cast<CoordD>(rows[i] - y);
+                out_cols[n] = static_cast<CoordD>(c);
+                for (int k = 0; k < CN; ++k) out_vals[k][n] = vals[k][i];
+                n += c < w;
+            }
+            dst.Resize(n);
+        });
+    }
+};
+
+// 翻转与旋转：先为每个输入三元组算出它在输出中的下标（行优先顺序），再一次性写出变换后的坐标与取值
+template <typename T, int CN>
+struct TransformOpKernel {
+    static constexpr bool kSupported = true;
+
+    static bool Run(const TripletBuffer& src, Transform op, TripletBuffer& dst) {
+        const bool swap = op == Transform::kRotateClockwise || op == Transform::kRotateCounterClockwise;
+        const uint32_t width = static_cast<uint32_t>(src.width()), height = static_cast<uint32_t>(src.height());
+        dst.Reset(swap ? src.height() : src.width(), swap ? src.width() : src.height(), CN, src.depth());
+        dst.SetBackground(src.background());
+        const size_t n = src.size();
+        // 文件中可能有越界坐标（TripletsToMat 会跳过），它们没有合法的变换结果，先拒绝
+        if (!(src.wide_coords() ? InBounds<uint32_t>(src) : InBounds<uint16_t>(src))) return false;
+        dst.Resize(n);
+
+        size_t* order = ScratchPool::Get<size_t>(0, n);
+        WithCoords(src, dst, [&](auto s, auto d) {
+            using CoordS = decltype(s);
+            using CoordD = decltype(d);
+            const CoordS* rows = src.Rows<CoordS>();
+            const CoordS* cols = src.Cols<CoordS>();
+
+            if (op == Transform::kFlipHorizontal || op == Transform::kFlipVertical) {
+                // 逐段处理同一行的三元组：水平翻转反转段内顺序，垂直翻转反转段的顺序
+                for (size_t b = 0; b < n;) {
+                    size_t e = b + 1;
+                    while (e < n && rows[e] == rows[b]) ++e;
+                    for (size_t i = b; i < e; ++i) order[i] = op == Transform::kFlipHorizontal ? b + e - 1 - i : n - e + (i - b);
+                    b = e;
+                }
+            } else if (op == Transform::kRotate180) {
+                for (size_t i = 0; i < n; ++i) order[i] = n - 1 - i;
+            } else {
+                // 新行号为原列号（顺时针）或 width-1-列号（逆时针），按新行号做稳定的计数排序。
+                // 新列号为 height-1-行号（顺时针）或行号（逆时针），分别倒序、顺序遍历输入即可让同一新行内列号递增
+                size_t* offset = ScratchPool::Get<size_t>(1, static_cast<size_t>(width) + 1);
+                std::fill(offset, offset + width + 1, size_t(0));
+                for (size_t i = 0; i < n; ++i) {
+                    const uint32_t key = op == Transform::kRotateClockwise ? cols[i] : width - 1 - cols[i];
+                    ++offset[key + 1];
+                }
+                for (uint32_t k = 0; k < width; ++k) offset[k + 1] += offset[k];
+                if (op == Transform::kRotateClockwise) {
+                    for (size_t i = n; i-- > 0;) order[i] = offset[cols[i]]++;
+                } else {
+                    for (size_t i = 0; i < n; ++i) order[i] = offset[width - 1 - cols[i]]++;
+                }
+            }
+
+            CoordD* out_rows = dst.Rows<CoordD>();
+            CoordD* out_cols = dst.Cols<CoordD>();
+            for (size_t i = 0; i < n; ++i) {
+                const uint32_t r = rows[i], c = cols[i];
+                uint32_t nr = r, nc = c;
+                switch (op) {
+                    case Transform::kFlipHorizontal: nc = width - 1 - c; break;
+                    case Transform::kFlipVertical: nr = height - 1 - r; break;
+                    case Transform::kRotate180: nr = height - 1 - r; nc = width - 1 - c; break;
+                    case Transform::kRotateClockwise: nr = c; nc = height - 1 - r; break;
+                    case Transform::kRotateCounterClockwise: nr = width - 1 - c; nc = r; break;
+                }
+                out_rows[order[i]] = static_cast<CoordD>(nr);
+                out_cols[order[i]] = static_cast<CoordD>(nc);
+            }
+        });
+        for (int k = 0; k < CN; ++k) {
+            const T* vals = src.Values<T>(k);
+            T* out_vals = dst.Values<T>(k);
+            for (size_t i = 0; i < n; ++i) out_vals[order[i]] = vals[i];
+        }
+        return true;
+    }
+};
+
+using GrayOpTable = pixel::KernelTable<GrayOpKernel, void, const TripletBuffer&, TripletBuffer&>;
+using CropOpTable = pixel::KernelTable<CropOpKernel, void, const TripletBuffer&, const cv::Rect&, TripletBuffer&>;
+using TransformOpTable = pixel::KernelTable<TransformOpKernel, bool, const TripletBuffer&, Transform, TripletBuffer&>;
+
+// ===================== TripletOps =====================
+
+bool TripletOps::ToGray(const TripletBuffer& src, TripletBuffer& dst) {
+    auto kernel = GrayOpTable::Lookup(CV_MAKETYPE(src.depth(), src.channels()));
+    if (kernel == nullptr || &src == &dst) return false;
+    kernel(src, dst);
+    return true;
+}
+
+bool TripletOps::Crop(const TripletBuffer& src, const cv::Rect& roi, TripletBuffer& dst) {
+    auto kernel = CropOpTable::Lookup(CV_MAKETYPE(src.depth(), src.channels()));
+    if (kernel == nullptr || &src == &dst) return false;
+    if (roi.width <= 0 || roi.height <= 0 || roi.x < 0 || roi.y < 0 ||
+        roi.x > src.width() - roi.width || roi.y > src.height() - roi.height) {
+        return false;
+    }
+    kernel(src, roi, dst);
+    return true;
+}
+
+bool TripletOps::Flip(const TripletBuffer& src, FlipMode mode, TripletBuffer& dst) {
+    auto kernel = TransformOpTable::Lookup(CV_MAKETYPE(src.depth(), src.channels()));
+    if (kernel == nullptr || &src == &dst || src.width() <= 0 || src.height() <= 0) return false;
+    return kernel(src, mode == FlipMode::kHorizontal ? Transform::kFlipHorizontal
+                : (mode == FlipMode::kVertical ? Transform::kFlipVertical : Transform::kRotate180), dst);
+}
+
+bool TripletOps::Rotate(const TripletBuffer& src, Rotation rotation, TripletBuffer& dst) {
+    auto kernel = TransformOpTable::Lookup(CV_MAKETYPE(src.depth(), src.channels()));
+    if (kernel == nullptr || &src == &dst || src.width() <= 0 || src.height() <= 0) return false;
+    return kernel(src, rotation == Rotation::k180 ? Transform::kRotate180
+                : (rotation == Rotation::kClockwise90 ? Transform::kRotateClockwise : Transform::kRotateCounterClockwise), dst);
+}
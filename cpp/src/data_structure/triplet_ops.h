@@ -0,0 +1,77 @@
+/**
+ * @file triplet_ops.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 压缩域操作：直接在 SoA 三元组上做灰度化、裁剪、翻转与 90° 旋转，不重建完整图像
+ * @version 0.1
+ * @date 2025-12-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <opencv2/core/mat.hpp>
+#include "triplet_buffer.h"
+
+/**
+ * @brief 三元组上的图像操作
+ *
+ * @details 稀疏图像由背景色与非背景像素的三元组组成，很多几何与逐像素操作可以只作用在这两部分上：
+ * - 灰度化：只转换背景色和每个三元组的取值，灰度与新背景相同的三元组被丢弃；
+ * - 裁剪：按行号二分查找裁剪区域的行区间，再按列过滤并平移坐标；
+ * - 翻转与旋转：坐标变换后重新排成行优先顺序。水平、垂直翻转和 180° 旋转只是反转行内或行间的顺序，
+ *   90° 旋转按新行号做一次稳定的计数排序，都是线性时间。
+ *
+ * 代价与非背景像素个数成正比，与图像面积无关。结果与先 TripletsToMat、再用 Processor 或 OpenCV
+ * 处理、最后 MatToTriplets 得到的图像逐像素相同（灰度化的结果可能少掉与背景相同的三元组）。
+ *
+ * 输入须按行优先顺序排列（MatToTriplets、DiffToTriplets 与 .trip 文件都满足），输出也保持这一顺序。
+ * 输出容器先被 Reset，因此不能与输入是同一个对象；失败时输出内容未定义。
+ * 翻转与旋转要求所有坐标都在图像内，否则返回 false。
+ */
+class TripletOps {
+public:
+    /**
+     * @brief 翻转方向
+     */
+    enum class FlipMode {
+        kHorizontal,    ///< 左右翻转
+        kVertical,      ///< 上下翻转
+        kBoth,          ///< 同时翻转，等价于旋转 180°
+    };
+
+    /**
+     * @brief 旋转角度
+     */
+    enum class Rotation {
+        kClockwise90,           ///< 顺时针 90°，宽高互换
+        k180,                   ///< 180°
+        kCounterClockwise90,    ///< 逆时针 90°，宽高互换
+    };
+
+    /**
+     * @brief 灰度化，公式与 Processor::ToGray 相同（BGRA 合成到白色背景）
+     *
+     * @param src 输入三元组，1/3/4 通道，8 位或 16 位；单通道时为拷贝
+     * @param dst 输出的单通道三元组，位深不变
+     * @return 成功时为 true，类型不支持或 dst 与 src 为同一对象时为 false
+     */
+    static bool ToGray(const TripletBuffer& src, TripletBuffer& dst);
+
+    /**
+     * @brief 裁剪，roi 须完全位于图像内且非空
+     *
+     * @param dst 输出三元组，尺寸为 roi 的尺寸，背景色不变
+     */
+    static bool Crop(const TripletBuffer& src, const cv::Rect& roi, TripletBuffer& dst);
+
+    /**
+     * @brief 翻转
+     */
+    static bool Flip(const TripletBuffer& src, FlipMode mode, TripletBuffer& dst);
+
+    /**
+     * @brief 旋转 90° 的整数倍
+     */
+    static bool Rotate(const TripletBuffer& src, Rotation rotation, TripletBuffer& dst);
+};
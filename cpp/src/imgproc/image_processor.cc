@@ -10,105 +10,654 @@
  */
 
 #include "image_processor.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "../common/memory.h"
+#include "../common/pixel_dispatch.h"
+#include "../common/scratch.h"
+#include "../common/stats.h"
+#include "../common/thread_pool.h"
 
-// 辅助函数：将像素值 clamp 到 [0, 255] 范围
-static inline uint8_t Clamp255(int v) { 
-    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); 
+// ===================== 像素内核 =====================
+// 内核按 (元素类型 T, 通道数 CN) 编译期实例化，对外接口只按图像类型查一次表。
+
+// 彩色转灰度：Gray = 0.299*R + 0.587*G + 0.114*B，默认按 BGR 顺序读取，rgb 为 true 时按 RGB 顺序，结果截断。
+// 单通道图像原样拷贝；BGRA 图像按 alpha 合成到白色背景上再转灰度，
+// 即 Gray' = Gray * a / max + max * (1 - a / max)，max 为该位深的最大值
+template <typename T, int CN>
+struct GrayKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const cv::Mat& input, cv::Mat& gray, bool rgb) {
+        constexpr double kMax = static_cast<double>(std::numeric_limits<T>::max());
+        const int ib = rgb ? 2 : 0, ir = 2 - ib;   // 蓝、红通道的下标
+        for (int r = 0; r < input.rows; ++r) {
+            const T* inrow = input.ptr<T>(r);   // 获取 input 图像第 r 行的起始指针
+            T* outrow = gray.ptr<T>(r);         // 获取 gray 图像第 r 行的起始指针
+            for (int c = 0; c < input.cols; ++c) {
+                const T* bgr = inrow + CN * c;
+                if constexpr (CN == 1) {
+                    outrow[c] = bgr[0];
+                } else if constexpr (CN == 3) {
+                    // 加权和不会超过通道最大值，直接截断即可
+                    outrow[c] = static_cast<T>(0.299 * bgr[ir] + 0.587 * bgr[1] + 0.114 * bgr[ib]);
+                } else {
+                    double y = 0.299 * bgr[ir] + 0.587 * bgr[1] + 0.114 * bgr[ib];
+                    double a = bgr[3] / kMax;
+                    // 合成结果落在 [y, max] 之间，加 0.5 后截断即四舍五入
+                    outrow[c] = static_cast<T>(y * a + kMax * (1.0 - a) + 0.5);
+                }
+            }
+        }
+    }
+};
+
+// 双线性插值在一个轴上的采样：输出位置 i 取输入 i0、i1 两点，i1 的权重为 w，越界时钳制到边缘
+static inline void BilinearTap(int i, double scale, int src_len, int& i0, int& i1, double& w) {
+    // 输出像素中心 (i + 0.5) 映射回输入图像，再减 0.5 对齐到输入像素中心
+    double src = (i + 0.5) * scale - 0.5;
+    i0 = static_cast<int>(std::floor(src));
+    i1 = i0 + 1;
+    w = src - i0;
+    if (i0 < 0) { i0 = 0; i1 = 0; w = 0; }
+    if (i1 >= src_len) { i1 = src_len - 1; i0 = i1; w = 0; }
 }
 
-// 将彩色图像转换为灰度图像
-cv::Mat Processor::ToGray(const cv::Mat& input) {
-    // 输入为空或不是三通道图像时返回空 cv::Mat;
-    if (input.empty()) return cv::Mat();
-    if (input.channels() != 3) return cv::Mat();
-
-    // 初始化空的灰度图像并逐个填充利用经验公式计算得到的灰度值
-    cv::Mat gray(input.rows, input.cols, CV_8UC1);
-    for (int r = 0; r < input.rows; ++r) {
-        const cv::Vec3b* inrow = input.ptr<cv::Vec3b>(r);   // 获取 input 图像第 r 行的起始指针 
-        uint8_t* outrow = gray.ptr<uint8_t>(r);     // 获取 gray 图像第 r 行的起始指针
-        for (int c = 0; c < input.cols; ++c) {
-            const cv::Vec3b& bgr = inrow[c];    // 通过行指针 inrow 和列偏移 c 访问到当前的 cv::Vec3b 像素
-            // Gray = 0.299*R + 0.587*G + 0.114*B，按 BGR 顺序填充之后 clamp
-            int g = static_cast<int>(0.299 * bgr[2] + 0.587 * bgr[1] + 0.114 * bgr[0]);
-            outrow[c] = Clamp255(g);
+// 双线性插值缩放，只计算输出行 [row_begin, row_end)。列方向的采样位置和权重在进入像素循环前一次性算好
+template <typename T, int CN>
+struct ResizeKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const cv::Mat& input, cv::Mat& out, int row_begin, int row_end) {
+        const int new_width = out.cols, new_height = out.rows;
+
+        // 计算输入图像到输出图像的缩放比例
+        const double scale_x = static_cast<double>(input.cols) / new_width;
+        const double scale_y = static_cast<double>(input.rows) / new_height;
+
+        // 预计算每个输出列对应的左右两个输入元素偏移和水平权重，越界情况在这里处理掉
+        int* xofs0 = ScratchPool::Get<int>(0, new_width);
+        int* xofs1 = ScratchPool::Get<int>(1, new_width);
+        float* wxs = ScratchPool::Get<float>(2, new_width);
+        for (int x = 0; x < new_width; ++x) {
+            int x0, x1;
+            double wx;
+            BilinearTap(x, scale_x, input.cols, x0, x1, wx);
+            xofs0[x] = x0 * CN; xofs1[x] = x1 * CN; wxs[x] = static_cast<float>(wx);
+        }
+
+        for (int y = row_begin; y < row_end; ++y) {
+            // 同理计算垂直方向的两行和权重
+            int y0, y1;
+            double wy_d;
+            BilinearTap(y, scale_y, input.rows, y0, y1, wy_d);
+            const float wy = static_cast<float>(wy_d);
+
+            const T* row0 = input.ptr<T>(y0);
+            const T* row1 = input.ptr<T>(y1);
+            T* outrow = out.ptr<T>(y);
+            for (int x = 0; x < new_width; ++x) {
+                const T* p00 = row0 + xofs0[x];
+                const T* p10 = row0 + xofs1[x];
+                const T* p01 = row1 + xofs0[x];
+                const T* p11 = row1 + xofs1[x];
+                const float wx = wxs[x];
+                T* dst = outrow + CN * x;
+                // 先水平再垂直插值，结果非负，加 0.5 后截断即四舍五入
+                for (int k = 0; k < CN; ++k) {
+                    float top = p00[k] + wx * (p10[k] - static_cast<float>(p00[k]));
+                    float bottom = p01[k] + wx * (p11[k] - static_cast<float>(p01[k]));
+                    dst[k] = static_cast<T>(top + wy * (bottom - top) + 0.5f);
+                }
+            }
+        }
+    }
+};
+
+// ===================== 可分离滤波缩放 =====================
+
+namespace {
+
+// 一个轴上的采样表：每个输出位置从 start[i] 开始取 taps 个输入，权重为 weights[i * taps, (i + 1) * taps)。
+// 所有位置的抽头数相同，靠近边界的位置把 start 向内平移并用 0 权重补齐，内层循环不需要边界判断
+struct AxisWeights {
+    int taps = 0;
+    std::vector<int> start;
+    std::vector<float> weights;
+};
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Keys 三次卷积核，a = -0.5
+double CubicFilter(double x) {
+    constexpr double a = -0.5;
+    x = std::fabs(x);
+    if (x < 1.0) return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    if (x < 2.0) return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    return 0.0;
+}
+
+double Sinc(double x) {
+    if (x == 0.0) return 1.0;
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+// Lanczos 窗口 sinc，半径 3
+double Lanczos3Filter(double x) {
+    if (x <= -3.0 || x >= 3.0) return 0.0;
+    return Sinc(x) * Sinc(x / 3.0);
+}
+
+// 按像素中心对齐计算采样表。缩小时滤波器支撑按比例放宽，每个输出像素覆盖对应的整个输入区域
+AxisWeights BuildAxisWeights(int src_len, int dst_len, Processor::Interpolation mode) {
+    const bool cubic = mode == Processor::Interpolation::kBicubic;
+    const double radius = cubic ? 2.0 : 3.0;
+    const double scale = static_cast<double>(src_len) / dst_len;
+    const double filter_scale = std::max(scale, 1.0);
+    const double support = radius * filter_scale;
+
+    AxisWeights w;
+    w.taps = std::min(static_cast<int>(std::ceil(support)) * 2 + 1, src_len);
+    w.start.resize(dst_len);
+    w.weights.assign(static_cast<size_t>(dst_len) * w.taps, 0.0f);
+
+    std::vector<double> tmp(w.taps);
+    for (int i = 0; i < dst_len; ++i) {
+        const double center = (i + 0.5) * scale;
+        int lo = std::max(static_cast<int>(std::floor(center - support + 0.5)), 0);
+        int hi = std::min(static_cast<int>(std::floor(center + support + 0.5)), src_len);
+        hi = std::min(hi, lo + w.taps);
+
+        // 计算原始权重并归一化，保证常数图像缩放后不变
+        double sum = 0.0;
+        for (int j = lo; j < hi; ++j) {
+            double x = (j + 0.5 - center) / filter_scale;
+            tmp[j - lo] = cubic ? CubicFilter(x) : Lanczos3Filter(x);
+            sum += tmp[j - lo];
+        }
+
+        // 靠近右边界时整体左移起点，前面补 0 权重
+        const int start = std::min(lo, src_len - w.taps);
+        float* dst = &w.weights[static_cast<size_t>(i) * w.taps];
+        for (int j = lo; j < hi; ++j) dst[j - start] = static_cast<float>(sum != 0.0 ? tmp[j - lo] / sum : 0.0);
+        w.start[i] = start;
+    }
+    return w;
+}
+
+// 采样表缓存：每个线程保留最近使用的若干张表，查找与构建都不需要加锁
+const AxisWeights& CachedAxisWeights(int src_len, int dst_len, Processor::Interpolation mode) {
+    struct Entry {
+        int src_len;
+        int dst_len;
+        Processor::Interpolation mode;
+        AxisWeights weights;
+    };
+    constexpr size_t kCapacity = 8;
+    thread_local std::vector<std::unique_ptr<Entry>> cache;   // 最近使用的在前
+
+    for (size_t i = 0; i < cache.size(); ++i) {
+        if (cache[i]->src_len == src_len && cache[i]->dst_len == dst_len && cache[i]->mode == mode) {
+            std::rotate(cache.begin(), cache.begin() + i, cache.begin() + i + 1);
+            return cache.front()->weights;
         }
     }
+    if (cache.size() == kCapacity) cache.pop_back();
+    cache.insert(cache.begin(), std::unique_ptr<Entry>(new Entry{src_len, dst_len, mode, BuildAxisWeights(src_len, dst_len, mode)}));
+    return cache.front()->weights;
+}
+
+// 四舍五入并钳制到 T 的取值范围
+template <typename T>
+inline T SaturateCast(float v) {
+    constexpr float kMax = static_cast<float>(std::numeric_limits<T>::max());
+    v = std::min(std::max(v + 0.5f, 0.0f), kMax);
+    return static_cast<T>(v);
+}
+
+}  // namespace
+
+// 可分离滤波缩放，只计算输出行 [row_begin, row_end)：先对输入行做水平滤波得到 float 中间行，再逐输出行做垂直滤波。
+// 各输出行用到的输入行区间随行号单调后移，中间行存放在容量为 taps 的环形缓冲区中，每个输入行只水平滤波一次，
+// 工作集只有 taps 行，不需要整幅中间图像。垂直遍内层循环连续访问、没有分支，可以被编译器向量化
+template <typename T, int CN>
+struct SeparableResizeKernel {
+    static constexpr bool kSupported = true;
 
+    // 对一个输入行做水平滤波，抽头数与通道数在循环内都是常量
+    static void Horizontal(const T* src, float* dst, int dst_w, const AxisWeights& xw) {
+        for (int x = 0; x < dst_w; ++x) {
+            const T* s = src + static_cast<size_t>(xw.start[x]) * CN;
+            const float* w = &xw.weights[static_cast<size_t>(x) * xw.taps];
+            float acc[CN] = {};
+            for (int t = 0; t < xw.taps; ++t) {
+                for (int k = 0; k < CN; ++k) acc[k] += w[t] * s[t * CN + k];
+            }
+            for (int k = 0; k < CN; ++k) dst[x * CN + k] = acc[k];
+        }
+    }
+
+    static void Run(const cv::Mat& input, cv::Mat& out, const AxisWeights& xw, const AxisWeights& yw,
+                    int row_begin, int row_end) {
+        const int dst_w = out.cols;
+        const size_t row_len = static_cast<size_t>(dst_w) * CN;
+
+        // 环形缓冲区：输入行 r 存放在 r % taps 处，tags 记录每个位置当前存放的输入行
+        // 三块中间内存都来自当前线程的暂存区，同尺寸的连续调用不再分配
+        float* ring = ScratchPool::Get<float>(0, static_cast<size_t>(yw.taps) * row_len);
+        int* tags = ScratchPool::Get<int>(1, yw.taps);
+        float* acc = ScratchPool::Get<float>(2, row_len);
+        std::fill(tags, tags + yw.taps, -1);
+        for (int y = row_begin; y < row_end; ++y) {
+            std::fill(acc, acc + row_len, 0.0f);
+            const float* w = &yw.weights[static_cast<size_t>(y) * yw.taps];
+            for (int t = 0; t < yw.taps; ++t) {
+                if (w[t] == 0.0f) continue;
+                const int src_row = yw.start[y] + t;
+                const int slot = src_row % yw.taps;
+                float* row = ring + static_cast<size_t>(slot) * row_len;
+                if (tags[slot] != src_row) {
+                    Horizontal(input.ptr<T>(src_row), row, dst_w, xw);
+                    tags[slot] = src_row;
+                }
+                const float wt = w[t];
+                for (size_t i = 0; i < row_len; ++i) acc[i] += wt * row[i];
+            }
+            T* outrow = out.ptr<T>(y);
+            for (size_t i = 0; i < row_len; ++i) outrow[i] = SaturateCast<T>(acc[i]);
+        }
+    }
+};
+
+// ===================== 盒式模糊 =====================
+
+namespace {
+
+// 窗口均值的定点归一化：round(sum / N) = ((sum + N / 2) * mul) >> shift，sum 与 mul 都不超过 32 位，
+// 乘积为 64 位，归一化循环可以被编译器向量化（如 SSE2 的 pmuludq），不需要逐像素做除法
+struct BoxScale {
+    uint32_t half = 0;
+    uint32_t mul = 0;
+    int shift = 0;
+};
+
+// 取最小的 shift 使 2^shift >= 2^bits * N^2，此时 mul = ceil(2^shift / N) 的乘移结果与整除完全相同
+// （误差项 sum * (mul - 2^shift / N) / 2^shift < 1 / N）。窗口过大、mul 超过 32 位时返回 false
+bool MakeBoxScale(int radius, int depth, BoxScale& scale) {
+    if (radius < 0 || radius > (1 << 14)) return false;
+    const uint64_t n = static_cast<uint64_t>(2 * radius + 1);
+    const uint64_t window = n * n;
+    const int bits = depth == CV_8U ? 8 : 16;
+    int shift = bits;
+    while (shift < 63 && (uint64_t(1) << (shift - bits)) < window * window) ++shift;
+    if ((uint64_t(1) << (shift - bits)) < window * window) return false;
+    const uint64_t mul = ((uint64_t(1) << shift) + window - 1) / window;
+    if (mul > std::numeric_limits<uint32_t>::max()) return false;
+    scale.half = static_cast<uint32_t>(window / 2);
+    scale.mul = static_cast<uint32_t>(mul);
+    scale.shift = shift;
+    return true;
+}
+
+using HaloRows = std::vector<uint8_t, TrackingAllocator<uint8_t, MemoryTracker::Category::kScratch>>;
+
+// 原地模糊时一个条带需要、但属于相邻条带的原始行，在任何条带开始写入之前拷贝出来
+struct BandHalo {
+    int above_begin = 0;    ///< above 存放行 [above_begin, 条带起始行)
+    HaloRows above;
+    int below_end = 0;      ///< below 存放行 [条带结束行, below_end)
+    HaloRows below;
+};
+
+}  // namespace
+
+// 盒式模糊，只计算输出行 [row_begin, row_end)，边界按复制边缘像素处理。
+// 先在垂直方向维护每列 2r+1 行的滑动和（每行一次加、一次减，连续访问，可向量化），
+// 再在水平方向对这一行列和做滑动求和，每个像素的代价与半径无关。
+// halo 不为空时为原地模糊：本条带已覆盖的行从容量 r+1 的环形缓冲区取原值，条带外的行从 halo 取
+template <typename T, int CN>
+struct BoxBlurKernel {
+    static constexpr bool kSupported = true;
+
+    static void Run(const cv::Mat& input, cv::Mat& out, int radius, const BoxScale& scale,
+                    int row_begin, int row_end, const BandHalo* halo) {
+        const int rows = input.rows, cols = input.cols;
+        const size_t row_len = static_cast<size_t>(cols) * CN;
+        const size_t row_bytes = row_len * sizeof(T);
+        const int ring_rows = radius + 1;
+
+        uint32_t* vsum = ScratchPool::Get<uint32_t>(0, row_len);
+        uint32_t* ext = ScratchPool::Get<uint32_t>(1, (static_cast<size_t>(cols) + 2 * radius + 1) * CN);
+        uint32_t* hsum = ScratchPool::Get<uint32_t>(2, row_len);
+        T* ring = halo != nullptr ? ScratchPool::Get<T>(3, static_cast<size_t>(ring_rows) * row_len) : nullptr;
+        int written = row_begin;    // 行 [row_begin, written) 已被覆盖
+        // 归一化参数放进局部变量：8 位输出可能与任何对象别名，否则每个像素都要重新读取
+        const uint32_t half = scale.half, mul = scale.mul;
+        const int shift = scale.shift;
+
+        // 第 y 行的原始像素，行号先钳制到图像内
+        auto source = [&](int y) -> const T* {
+            y = std::min(std::max(y, 0), rows - 1);
+            if (halo == nullptr) return input.ptr<T>(y);
+            if (y < row_begin) {
+                return reinterpret_cast<const T*>(halo->above.data() + static_cast<size_t>(y - halo->above_begin) * row_bytes);
+            }
+            if (y >= row_end) {
+                return reinterpret_cast<const T*>(halo->below.data() + static_cast<size_t>(y - row_end) * row_bytes);
+            }
+            if (y < written) return ring + static_cast<size_t>(y % ring_rows) * row_len;
+            return input.ptr<T>(y);
+        };
+
+        std::fill(vsum, vsum + row_len, 0u);
+        for (int k = -radius; k <= radius; ++k) {
+            const T* s = source(row_begin + k);
+            for (size_t i = 0; i < row_len; ++i) vsum[i] += s[i];
+        }
+
+        const size_t pad = static_cast<size_t>(radius) * CN;
+        const size_t span = static_cast<size_t>(2 * radius + 1) * CN;
+        for (int y = row_begin; y < row_end; ++y) {
+            // 列和两端各复制 r 个边缘像素，再多补一个供最后一次滑动读取，内层循环不需要边界判断
+            for (size_t i = 0; i < pad; ++i) ext[i] = vsum[i % CN];
+            std::memcpy(ext + pad, vsum, row_len * sizeof(uint32_t));
+            for (size_t i = 0; i < pad + CN; ++i) ext[pad + row_len + i] = vsum[row_len - CN + i % CN];
+
+            uint32_t acc[CN] = {};
+            for (size_t i = 0; i < span; ++i) acc[i % CN] += ext[i];
+            for (int x = 0; x < cols; ++x) {
+                const uint32_t* leave = ext + static_cast<size_t>(x) * CN;
+                for (int k = 0; k < CN; ++k) {
+                    hsum[x * CN + k] = acc[k];
+                    acc[k] += leave[span + k] - leave[k];
+                }
+            }
+
+            if (halo != nullptr) {
+                std::memcpy(ring + static_cast<size_t>(y % ring_rows) * row_len, input.ptr<T>(y), row_bytes);
+                written = y + 1;
+            }
+            T* outrow = out.ptr<T>(y);
+            for (size_t i = 0; i < row_len; ++i) {
+                outrow[i] = static_cast<T>((static_cast<uint64_t>(hsum[i] + half) * mul) >> shift);
+            }
+
+            // 窗口下移一行：加入第 y+r+1 行，移出第 y-r 行。无符号回绕下结果仍然精确
+            if (y + 1 < row_end) {
+                const T* add = source(y + radius + 1);
+                const T* sub = source(y - radius);
+                for (size_t i = 0; i < row_len; ++i) vsum[i] += static_cast<uint32_t>(add[i]) - sub[i];
+            }
+        }
+    }
+};
+
+using GrayTable = pixel::KernelTable<GrayKernel, void, const cv::Mat&, cv::Mat&, bool>;
+using ResizeTable = pixel::KernelTable<ResizeKernel, void, const cv::Mat&, cv::Mat&, int, int>;
+using SeparableResizeTable = pixel::KernelTable<SeparableResizeKernel, void, const cv::Mat&, cv::Mat&,
+                                                const AxisWeights&, const AxisWeights&, int, int>;
+using BoxBlurTable = pixel::KernelTable<BoxBlurKernel, void, const cv::Mat&, cv::Mat&, int, const BoxScale&,
+                                        int, int, const BandHalo*>;
+
+// ===================== Processor =====================
+
+// out 与 input 的像素是否有重叠。同一块内存上的两个视图（Crop 的结果）按行区间与行内字节区间判断，
+// 左右相邻或上下相邻的两个视图互不重叠；步长不同时退化为按首尾地址判断
+static bool Overlaps(const cv::Mat& out, const cv::Mat& input) {
+    if (out.empty() || input.empty() || out.datastart != input.datastart) return false;
+    const size_t out_bytes = static_cast<size_t>(out.cols) * out.elemSize();
+    const size_t in_bytes = static_cast<size_t>(input.cols) * input.elemSize();
+    const size_t out_begin = static_cast<size_t>(out.data - out.datastart);
+    const size_t in_begin = static_cast<size_t>(input.data - input.datastart);
+    if (out.step[0] != input.step[0] || out.step[0] == 0) {
+        const size_t out_end = out_begin + (out.rows - 1) * out.step[0] + out_bytes;
+        const size_t in_end = in_begin + (input.rows - 1) * input.step[0] + in_bytes;
+        return out_begin < in_end && in_begin < out_end;
+    }
+    const size_t step = out.step[0];
+    const size_t out_row = out_begin / step, out_col = out_begin % step;
+    const size_t in_row = in_begin / step, in_col = in_begin % step;
+    return out_row < in_row + input.rows && in_row < out_row + out.rows &&
+           out_col < in_col + in_bytes && in_col < out_col + out_bytes;
+}
+
+// 按需分配输出：尺寸与类型一致时 create 直接复用 out 的内存，out 可以是大图上的一个视图。
+// out 与 input 的像素重叠时内核无法原地写入，先解除 out 对该内存的引用
+static void PrepareOutput(const cv::Mat& input, int rows, int cols, int type, cv::Mat& out) {
+    if (Overlaps(out, input)) out.release();
+    out.create(rows, cols, type);
+}
+
+// 将图像转换为灰度图像
+cv::Mat Processor::ToGray(const cv::Mat& input) {
+    cv::Mat gray;
+    ToGray(input, gray);
     return gray;
 }
 
+bool Processor::ToGray(const cv::Mat& input, cv::Mat& out, bool rgb) {
+    STATS_SCOPE_BYTES(kGray, input.total() * input.elemSize());
+    // 输入为空或类型不支持时输出空 cv::Mat
+    auto kernel = input.empty() ? nullptr : GrayTable::Lookup(input.type());
+    if (kernel == nullptr) { out.release(); return false; }
+
+    // 与输入同位深的单通道图像，由内核逐个填充灰度值
+    PrepareOutput(input, input.rows, input.cols, CV_MAKETYPE(input.depth(), 1), out);
+    kernel(input, out, rgb);
+    return true;
+}
+
+// 裁剪：cv::Mat 的 ROI 构造只调整数据指针与尺寸，共享引用计数
+cv::Mat Processor::Crop(const cv::Mat& input, const cv::Rect& roi) {
+    if (input.empty() || roi.width <= 0 || roi.height <= 0 || roi.x < 0 || roi.y < 0 ||
+        roi.x > input.cols - roi.width || roi.y > input.rows - roi.height) {
+        return cv::Mat();
+    }
+    return input(roi);
+}
+
 // 图像缩放，用双线性插值实现
 cv::Mat Processor::Resize(const cv::Mat& input, int new_width, int new_height) {
-    // 有效性检查，输入为空或新宽度/高度非正时返回空 cv::Mat
-    if (input.empty() || new_width <= 0 || new_height <= 0) return cv::Mat();
-    int ch = input.channels();
-
-    // 初始化空输出图像
-    cv::Mat out(new_height, new_width, ch == 1 ? CV_8UC1 : CV_8UC3);
-
-    // 计算输入图像到输出图像的缩放比例
-    double scale_x = static_cast<double>(input.cols) / new_width;
-    double scale_y = static_cast<double>(input.rows) / new_height;
-
-    for (int y = 0; y < new_height; ++y) {
-        // 计算输出图像中当前像素 (x, y) 的中心点在输入图像上对应的垂直浮点坐标 src_y
-        // “y + 0.5” 将当前输出像素的整数行坐标 y 转换为其中心点的浮点行坐标
-        // “- 0.5” 是为了将 src_y 映射到输入图像的中心位置
-        double src_y = (y + 0.5) * scale_y - 0.5;
-
-        // 找到 src_y 上方（或等于 src_y ）最近的整数行坐标 y0 和 src_y 下方最近的整数行坐标 y1
-        int y0 = static_cast<int>(floor(src_y));
-        int y1 = y0 + 1;
-
-        // 计算 src_y 在 y0 和 y1 之间的相对位置，作为垂直方向的插值权重
-        double wy = src_y - y0;
-        
-        // 处理 src_y 超出输入图像边界的情况
-        if (y0 < 0) { y0 = 0; y1 = 0; wy = 0; }
-        if (y1 >= input.rows) { y1 = input.rows - 1; y0 = y1; wy = 0; }
+    return Resize(input, new_width, new_height, Interpolation::kBilinear);
+}
 
-        for (int x = 0; x < new_width; ++x) {
-            // 计算输出图像中当前像素 (x, y) 的中心点在输入图像上对应的水平浮点坐标 src_x
-            double src_x = (x + 0.5) * scale_x - 0.5;
-
-            // 找到 src_x 左侧（或等于 src_x ）最近的整数列坐标 x0 和 src_x 右侧最近的整数列坐标 x1
-            int x0 = static_cast<int>(floor(src_x));
-            int x1 = x0 + 1;
-
-            // 计算 src_x 在 x0 和 x1 之间的相对位置，作为水平方向的插值权重
-            double wx = src_x - x0;
-            
-            // 处理 src_x 超出输入图像边界的情况
-            if (x0 < 0) { x0 = 0; x1 = 0; wx = 0; }
-            if (x1 >= input.cols) { x1 = input.cols - 1; x0 = x1; wx = 0; }
-
-            // 计算出双线性插值的结果并写入输出图像
-            if (ch == 1) {  // 单通道时直接使用 uint8_t 类型
-                const uint8_t Q00 = input.at<uint8_t>(y0, x0);
-                const uint8_t Q10 = input.at<uint8_t>(y0, x1);
-                const uint8_t Q01 = input.at<uint8_t>(y1, x0);
-                const uint8_t Q11 = input.at<uint8_t>(y1, x1);
-
-                // 计算插值结果并写入输出图像
-                double v = (1 - wx) * (1 - wy) * Q00 + wx * (1 - wy) * Q10 + (1 - wx) * wy * Q01 + wx * wy * Q11;
-                out.at<uint8_t>(y, x) = Clamp255(static_cast<int>(std::round(v)));
-            } else {    // 三通道时使用 cv::Vec3b 类型
-                const cv::Vec3b Q00 = input.at<cv::Vec3b>(y0, x0);
-                const cv::Vec3b Q10 = input.at<cv::Vec3b>(y0, x1);
-                const cv::Vec3b Q01 = input.at<cv::Vec3b>(y1, x0);
-                const cv::Vec3b Q11 = input.at<cv::Vec3b>(y1, x1);
-
-                // 计算出浮点插值结果并四舍五入转换回 uint8_t 类型
-                cv::Vec3d v = (1 - wx) * (1 - wy) * cv::Vec3d(Q00) + wx * (1 - wy) * cv::Vec3d(Q10) + (1 - wx) * wy * cv::Vec3d(Q01) + wx * wy * cv::Vec3d(Q11);
-                cv::Vec3b vb(static_cast<uint8_t>(std::round(v[0])), static_cast<uint8_t>(std::round(v[1])), static_cast<uint8_t>(std::round(v[2])));
-                
-                // 将计算并转换好的最终像素颜色值 vb 赋值给输出图像 out 中当前 (y, x) 位置的像素
-                out.at<cv::Vec3b>(y, x) = vb;
-            }
+// 按指定插值方式缩放
+cv::Mat Processor::Resize(const cv::Mat& input, int new_width, int new_height, Interpolation mode) {
+    cv::Mat out;
+    Resize(input, new_width, new_height, out, mode);
+    return out;
+}
+
+// 传入进度回调时把输出行 [0, rows) 分成若干段依次交给 fn，每段结束汇报一次；被取消时置空 out。
+// 内核按行区间计算的结果与整幅计算逐位相同，分段只多算每段边界处的少量光环行
+static bool RunRowSegments(int rows, cv::Mat& out, const ProgressFn& progress,
+                           const std::function<void(int, int)>& fn) {
+    if (!progress) { fn(0, rows); return true; }
+    constexpr int kSegments = 16;
+    const int segments = std::min(rows, kSegments);
+    auto segment_begin = [&](int i) { return static_cast<int>(static_cast<int64_t>(rows) * i / segments); };
+    for (int i = 0; i < segments; ++i) {
+        fn(segment_begin(i), segment_begin(i + 1));
+        if (!progress(static_cast<double>(i + 1) / segments)) { out.release(); return false; }
+    }
+    return true;
+}
+
+bool Processor::Resize(const cv::Mat& input, int new_width, int new_height, cv::Mat& out, Interpolation mode,
+                       const ProgressFn& progress) {
+    STATS_SCOPE_BYTES(kResize, input.total() * input.elemSize());
+    // 有效性检查，输入为空、新宽度/高度非正或类型不支持时输出空 cv::Mat
+    if (input.empty() || new_width <= 0 || new_height <= 0) { out.release(); return false; }
+
+    if (mode == Interpolation::kBilinear) {
+        auto kernel = ResizeTable::Lookup(input.type());
+        if (kernel == nullptr) { out.release(); return false; }
+        PrepareOutput(input, new_height, new_width, input.type(), out);
+        return RunRowSegments(new_height, out, progress, [&](int begin, int end) { kernel(input, out, begin, end); });
+    }
+
+    auto kernel = SeparableResizeTable::Lookup(input.type());
+    if (kernel == nullptr) { out.release(); return false; }
+    const AxisWeights& xw = CachedAxisWeights(input.cols, new_width, mode);
+    const AxisWeights& yw = CachedAxisWeights(input.rows, new_height, mode);
+    PrepareOutput(input, new_height, new_width, input.type(), out);
+    return RunRowSegments(new_height, out, progress,
+                          [&](int begin, int end) { kernel(input, out, xw, yw, begin, end); });
+}
+
+// 只计算一段输出行，out 的内存由调用方提供（可以是映射文件上的图像头），不重新分配
+bool Processor::ResizeRows(const cv::Mat& input, cv::Mat& out, int row_begin, int row_end, Interpolation mode) {
+    if (input.empty() || out.empty() || out.type() != input.type()) return false;
+    if (row_begin < 0 || row_end > out.rows || row_begin >= row_end) return false;
+
+    int src_begin = 0, src_end = 0;
+    ResizeSourceRows(input.rows, out.rows, row_begin, row_end, mode, src_begin, src_end);
+    STATS_SCOPE_BYTES(kResize, static_cast<size_t>(src_end - src_begin) * input.cols * input.elemSize());
+
+    if (mode == Interpolation::kBilinear) {
+        auto kernel = ResizeTable::Lookup(input.type());
+        if (kernel == nullptr) return false;
+        kernel(input, out, row_begin, row_end);
+        return true;
+    }
+
+    auto kernel = SeparableResizeTable::Lookup(input.type());
+    if (kernel == nullptr) return false;
+    const AxisWeights& xw = CachedAxisWeights(input.cols, out.cols, mode);
+    const AxisWeights& yw = CachedAxisWeights(input.rows, out.rows, mode);
+    kernel(input, out, xw, yw, row_begin, row_end);
+    return true;
+}
+
+// 输出行区间用到的输入行区间。两种采样的起点都随输出行单调不减，只需看首尾两行
+void Processor::ResizeSourceRows(int src_rows, int dst_rows, int row_begin, int row_end, Interpolation mode,
+                                 int& src_begin, int& src_end) {
+    src_begin = src_end = 0;
+    if (src_rows <= 0 || dst_rows <= 0 || row_begin < 0 || row_end > dst_rows || row_begin >= row_end) return;
+
+    if (mode == Interpolation::kBilinear) {
+        const double scale = static_cast<double>(src_rows) / dst_rows;
+        int i0, i1;
+        double w;
+        BilinearTap(row_begin, scale, src_rows, i0, i1, w);
+        src_begin = i0;
+        BilinearTap(row_end - 1, scale, src_rows, i0, i1, w);
+        src_end = i1 + 1;
+        return;
+    }
+
+    const AxisWeights& yw = CachedAxisWeights(src_rows, dst_rows, mode);
+    src_begin = yw.start[row_begin];
+    src_end = yw.start[row_end - 1] + yw.taps;
+}
+
+// 盒式模糊
+cv::Mat Processor::BoxBlur(const cv::Mat& input, int radius) {
+    cv::Mat out;
+    BoxBlur(input, out, radius);
+    return out;
+}
+
+bool Processor::BoxBlur(const cv::Mat& input, cv::Mat& out, int radius, int num_threads, const ProgressFn& progress) {
+    STATS_SCOPE_BYTES(kBlur, input.total() * input.elemSize());
+    // out 就是 input（同一块像素、同样的尺寸与步长）时原地模糊，失败时不清空
+    const bool in_place = !input.empty() && out.data == input.data && out.rows == input.rows &&
+                          out.cols == input.cols && out.type() == input.type() && out.step[0] == input.step[0];
+    auto kernel = input.empty() ? nullptr : BoxBlurTable::Lookup(input.type());
+    BoxScale scale;
+    if (kernel == nullptr || !MakeBoxScale(radius, input.depth(), scale)) {
+        if (!in_place) out.release();
+        return false;
+    }
+    if (!in_place) PrepareOutput(input, input.rows, input.cols, input.type(), out);
+
+    // 条带数：指定了线程数时按指定的来，否则每个线程至少 2^18 个像素；
+    // 条带不矮于窗口高度，每个条带开头重新累加窗口的代价不超过条带本身
+    const int window = 2 * radius + 1;
+    int bands = ThreadPool::ResolveThreads(num_threads);
+    if (num_threads <= 0) bands = static_cast<int>(std::min<size_t>(bands, std::max<size_t>(1, input.total() >> 18)));
+    bands = std::max(1, std::min(bands, input.rows / window));
+    auto band_begin = [&](int b) { return static_cast<int>(static_cast<int64_t>(input.rows) * b / bands); };
+
+    // 原地模糊：先拷贝每个条带上方 r 行与下方 r 行的原值，之后各条带可以并行覆盖自己的行
+    std::vector<BandHalo> halos(in_place ? bands : 0);
+    const size_t row_bytes = static_cast<size_t>(input.cols) * input.elemSize();
+    for (size_t b = 0; b < halos.size(); ++b) {
+        const int begin = band_begin(static_cast<int>(b)), end = band_begin(static_cast<int>(b) + 1);
+        BandHalo& halo = halos[b];
+        halo.above_begin = std::max(0, begin - radius);
+        halo.below_end = std::min(input.rows, end + radius);
+        halo.above.resize(static_cast<size_t>(begin - halo.above_begin) * row_bytes);
+        halo.below.resize(static_cast<size_t>(halo.below_end - end) * row_bytes);
+        for (int y = halo.above_begin; y < begin; ++y) {
+            std::memcpy(halo.above.data() + static_cast<size_t>(y - halo.above_begin) * row_bytes, input.ptr(y), row_bytes);
+        }
+        for (int y = end; y < halo.below_end; ++y) {
+            std::memcpy(halo.below.data() + static_cast<size_t>(y - end) * row_bytes, input.ptr(y), row_bytes);
         }
     }
 
+    // 条带中的异常（如 MemoryBudgetExceeded）在全部条带结束后向调用方重新抛出；
+    // 取消后尚未开始的条带直接跳过，原地时各条带只写自己的行，已完成的条带不受影响
+    BandProgress tracker(progress, bands);
+    ParallelBands(bands, [&](int b) {
+        if (tracker.cancelled()) return;
+        kernel(input, out, radius, scale, band_begin(b), band_begin(b + 1), in_place ? &halos[b] : nullptr);
+        tracker.Done();
+    });
+    if (tracker.cancelled()) {
+        if (!in_place) out.release();
+        return false;
+    }
+    return true;
+}
+
+// 与标准差 sigma 的高斯核方差最接近的三次盒式模糊半径（W. Wells / P. Kovesi）：
+// 宽度为 w 的盒式核方差为 (w^2 - 1) / 12，三次卷积的方差相加；
+// 取相邻的两个奇数宽度 wl < wu，前 m 次用 wl、其余用 wu，使总方差最接近 sigma^2。半径从小到大
+static void GaussianBoxRadii(double sigma, int radii[3]) {
+    constexpr int n = 3;
+    const double ideal = std::sqrt(12.0 * sigma * sigma / n + 1.0);
+    int wl = static_cast<int>(std::floor(ideal));
+    if (wl % 2 == 0) --wl;
+    const int wu = wl + 2;
+    const double m_ideal = (12.0 * sigma * sigma - n * wl * wl - 4.0 * n * wl - 3.0 * n) / (-4.0 * wl - 4.0);
+    const int m = static_cast<int>(std::lround(m_ideal));
+    for (int i = 0; i < n; ++i) radii[i] = ((i < m ? wl : wu) - 1) / 2;
+}
+
+// 高斯模糊，用三次盒式模糊近似
+cv::Mat Processor::GaussianBlur(const cv::Mat& input, double sigma) {
+    cv::Mat out;
+    GaussianBlur(input, out, sigma);
     return out;
 }
+
+bool Processor::GaussianBlur(const cv::Mat& input, cv::Mat& out, double sigma, int num_threads,
+                             const ProgressFn& progress) {
+    const bool in_place = !input.empty() && out.data == input.data && out.rows == input.rows &&
+                          out.cols == input.cols && out.type() == input.type() && out.step[0] == input.step[0];
+    // 先确认最大的一次也能做，避免做到一半失败；sigma 为 NaN 时比较为假
+    int radii[3] = {0, 0, 0};
+    if (sigma >= 0.0 && sigma <= 1e4) GaussianBoxRadii(sigma, radii);
+    BoxScale scale;
+    if (input.empty() || !(sigma >= 0.0) || BoxBlurTable::Lookup(input.type()) == nullptr ||
+        !MakeBoxScale(radii[2], input.depth(), scale)) {
+        if (!in_place) out.release();
+        return false;
+    }
+    // 第一次从 input 写到 out，之后两次在 out 上原地进行；三次各占三分之一的进度
+    auto pass = [&progress](int i) -> ProgressFn {
+        if (!progress) return nullptr;
+        return [&progress, i](double f) { return progress((i + f) / 3.0); };
+    };
+    return BoxBlur(input, out, radii[0], num_threads, pass(0)) && BoxBlur(out, out, radii[1], num_threads, pass(1)) &&
+           BoxBlur(out, out, radii[2], num_threads, pass(2));
+}
@@ -1,7 +1,7 @@
 /**
  * @file image_processor.h
  * @author Runhui Mo (github.com/mugaaaaa)
- * @brief 图像处理器类头文件，包含灰度化和双线性插值缩放。
+ * @brief 图像处理器类头文件，包含灰度化、缩放（双线性、双三次、Lanczos-3）和模糊（盒式、高斯）。
  * @version 0.1
  * @date 2025-11-07
  * 
@@ -12,24 +12,59 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include "../common/progress.h"
 
 /**
  * @brief 图像处理器类
- * * 包含灰度化和双线性插值缩放算法
+ * * 包含灰度化和双线性插值缩放算法，以及双三次、Lanczos-3 可分离滤波缩放，盒式与高斯模糊
  */
 class Processor {
  public:
   /**
-   * @brief 将彩色图像转换为灰度图像。
+   * @brief 缩放使用的插值方式。
+   */
+  enum class Interpolation {
+    kBilinear,   ///< 双线性，2x2 邻域
+    kBicubic,    ///< 双三次（Keys 三次卷积，a = -0.5），4 抽头
+    kLanczos3,   ///< Lanczos 窗口 sinc，半径 3，6 抽头
+  };
+
+  /**
+   * @brief 将图像转换为灰度图像。
    * * 经验公式：Gray = 0.299*R + 0.587*G + 0.114*B
-   * @param input 输入图像 (CV_8UC3)。
-   * @return cv::Mat 灰度图像 (CV_8UC1)。
+   * * 4 通道 (BGRA) 图像先按 alpha 合成到白色背景上，完全透明的像素为白色；
+   * * 单通道图像返回其拷贝。
+   * @param input 输入图像，1/3/4 通道、8 位或 16 位。
+   * @return cv::Mat 与输入同位深的灰度图像，类型不支持时为空。
    */
   static cv::Mat ToGray(const cv::Mat& input);
 
+  /**
+   * @brief 灰度化到调用方持有的输出图像。
+   * * out 的尺寸与类型已符合要求时直接复用其内存，不分配新图像；
+   * * out 可以是另一幅图像上的视图（见 Crop），结果直接写入该区域；
+   * * out 与 input 的像素重叠时先解除共享再分配。
+   * @param input 输入图像，同 ToGray(input)。
+   * @param out 输出图像，失败时被置空。
+   * @param rgb 输入按 RGB(A) 而非 BGR(A) 顺序存放时为 true，如直接映射的 PPM 文件。
+   * @return 成功时为 true，输入为空或类型不支持时为 false。
+   */
+  static bool ToGray(const cv::Mat& input, cv::Mat& out, bool rgb = false);
+
+  /**
+   * @brief 裁剪，返回 input 中 roi 区域的视图，不拷贝像素。
+   * * 视图与 input 共享像素内存（引用计数），行步长沿用 input，通常不连续；
+   * * 本类与 TripletUtils、Compressor、ImageIO 的所有入口都按行步长访问，视图可以直接传入，
+   * * 例如先裁剪再缩放只读取 roi 覆盖的行和列。需要独立的连续图像时调用 clone()。
+   * @param input 输入图像，任意类型。
+   * @param roi 裁剪区域，须完全位于图像内且非空。
+   * @return cv::Mat roi 的视图，输入为空或 roi 越界时为空。
+   */
+  static cv::Mat Crop(const cv::Mat& input, const cv::Rect& roi);
+
   /**
    * @brief 使用双线性插值调整图像尺寸。
-   * * 支持单通道(灰度)和三通道(彩色)图像。
+   * * 支持 1/3/4 通道、8 位或 16 位图像，输出类型与输入相同。
    * @param input 输入图像。
    * @param new_width 目标宽度。
    * @param new_height 目标高度。
@@ -37,4 +72,103 @@ class Processor {
    */
   static cv::Mat Resize(const cv::Mat& input, int new_width,
                                 int new_height);
+
+  /**
+   * @brief 按指定插值方式调整图像尺寸。
+   * * 双三次与 Lanczos-3 先水平后垂直分两遍滤波，缩小时按缩放比例放宽滤波器，
+   * * 相当于先低通再采样，可以避免混叠。每个轴的采样起点与权重表按
+   * * （源长度, 目标长度, 插值方式）计算一次后缓存在当前线程中，
+   * * 同一几何尺寸的连续帧不会重复计算。
+   * @param input 输入图像，1/3/4 通道、8 位或 16 位。
+   * @param new_width 目标宽度。
+   * @param new_height 目标高度。
+   * @param mode 插值方式，kBilinear 与三参数版本相同。
+   * @return cv::Mat 调整尺寸后的图像，类型与输入相同；参数非法或类型不支持时为空。
+   */
+  static cv::Mat Resize(const cv::Mat& input, int new_width, int new_height,
+                        Interpolation mode);
+
+  /**
+   * @brief 缩放到调用方持有的输出图像。
+   * * out 的尺寸与类型已符合要求时直接复用其内存；内核的中间结果来自每线程的
+   * * ScratchPool，因此处理同尺寸的连续帧时稳态下每帧不分配内存。
+   * * out 可以是另一幅图像上的视图，out 与 input 的像素重叠时先解除共享再分配。
+   * * 传入 progress 时按输出行分段计算，每段结束汇报一次进度，结果与不分段逐位相同。
+   * @param input 输入图像。
+   * @param new_width 目标宽度。
+   * @param new_height 目标高度。
+   * @param out 输出图像，失败时被置空。
+   * @param mode 插值方式。
+   * @param progress 进度回调，返回 false 时停止计算，见 ProgressFn。
+   * @return 成功时为 true，参数非法、类型不支持或被取消时为 false。
+   */
+  static bool Resize(const cv::Mat& input, int new_width, int new_height, cv::Mat& out,
+                     Interpolation mode = Interpolation::kBilinear, const ProgressFn& progress = nullptr);
+
+  /**
+   * @brief 只计算缩放结果中的输出行 [row_begin, row_end)，供分块处理使用。
+   * * 目标尺寸取 out 的尺寸，out 必须已分配且类型与 input 相同，不会被重新分配，
+   * * 因此可以是映射文件上的图像头；区间外的输出行不被访问。
+   * * 只读取 ResizeSourceRows 给出的输入行，结果与 Resize 的对应行逐位相同。
+   * @param input 完整的输入图像（可以是映射文件上的图像头）。
+   * @param out 完整尺寸的输出图像。
+   * @param row_begin 起始输出行。
+   * @param row_end 结束输出行（不含）。
+   * @param mode 插值方式。
+   * @return 成功时为 true，参数非法或类型不支持时为 false。
+   */
+  static bool ResizeRows(const cv::Mat& input, cv::Mat& out, int row_begin, int row_end,
+                         Interpolation mode = Interpolation::kBilinear);
+
+  /**
+   * @brief 计算输出行 [row_begin, row_end) 用到的输入行区间 [src_begin, src_end)，
+   * * 即该段输出行的滤波支撑（含上下的光环行）。参数非法时两者均为 0。
+   * @param src_rows 输入图像高度。
+   * @param dst_rows 输出图像高度。
+   */
+  static void ResizeSourceRows(int src_rows, int dst_rows, int row_begin, int row_end, Interpolation mode,
+                               int& src_begin, int& src_end);
+
+  /**
+   * @brief 盒式模糊：每个像素取以它为中心的 (2r+1)x(2r+1) 窗口的均值（四舍五入），边界复制边缘像素。
+   * * 先垂直后水平维护滑动窗口和，每个像素的代价与半径无关；窗口和为 32 位整数，
+   * * 归一化用定点乘移代替除法，结果与精确均值逐位相同。
+   * @param input 输入图像，1/3/4 通道、8 位或 16 位。
+   * @param radius 窗口半径，0 时为拷贝。
+   * @return cv::Mat 模糊后的图像，参数非法或类型不支持时为空。
+   */
+  static cv::Mat BoxBlur(const cv::Mat& input, int radius);
+
+  /**
+   * @brief 盒式模糊到调用方持有的输出图像。
+   * * out 就是 input 本身（同一块像素）时原地模糊，只额外保存每个条带上下各 r 行与 r+1 行的环形缓冲区；
+   * * 否则按 Resize 的规则复用或分配 out。图像按行分成条带并行处理，结果与条带数无关。
+   * * 半径上限由 32 位定点归一化决定：8 位图像 r <= 1721，16 位图像 r <= 107。
+   * * 传入 progress 时每个条带结束汇报一次进度。
+   * @param input 输入图像。
+   * @param out 输出图像，失败时被置空（原地时保持不变；原地被取消时已完成的条带保留模糊结果）。
+   * @param radius 窗口半径。
+   * @param num_threads 条带数，<= 0 时按图像大小和硬件并发数自动决定。
+   * @param progress 进度回调，返回 false 时不再开始新的条带，见 ProgressFn。
+   * @return 成功时为 true，输入为空、类型不支持、半径超出上限或被取消时为 false。
+   */
+  static bool BoxBlur(const cv::Mat& input, cv::Mat& out, int radius, int num_threads = 0,
+                      const ProgressFn& progress = nullptr);
+
+  /**
+   * @brief 高斯模糊，用三次盒式模糊近似。
+   * * 三次的半径取两个相邻值，使总方差最接近 sigma^2（与真实高斯核的差别在 3% 以内）；
+   * * 每次都是常数时间的盒式模糊，代价与 sigma 无关。sigma 很小时三次半径都为 0，结果为拷贝。
+   * @param input 输入图像，1/3/4 通道、8 位或 16 位。
+   * @param sigma 标准差（像素），三次的半径都约等于 sigma，上限同 BoxBlur 的半径上限。
+   * @return cv::Mat 模糊后的图像，参数非法或类型不支持时为空。
+   */
+  static cv::Mat GaussianBlur(const cv::Mat& input, double sigma);
+
+  /**
+   * @brief 高斯模糊到调用方持有的输出图像，out 与 input 的约定同 BoxBlur。
+   * * 三次盒式模糊各占进度的三分之一。
+   */
+  static bool GaussianBlur(const cv::Mat& input, cv::Mat& out, double sigma, int num_threads = 0,
+                           const ProgressFn& progress = nullptr);
 };
\ No newline at end of file
@@ -0,0 +1,347 @@
+/**
+ * @file image_stats.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 单遍并行图像统计实现
+ * @version 0.1
+ * @date 2025-12-05
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "image_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "../common/memory.h"
+#include "../common/pixel_dispatch.h"
+#include "../common/stats.h"
+#include "../common/thread_pool.h"
+
+namespace {
+
+using Counts = std::vector<uint64_t, TrackingAllocator<uint64_t, MemoryTracker::Category::kHistogram>>;
+using ColorMap = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                    TrackingAllocator<std::pair<const uint64_t, uint64_t>, MemoryTracker::Category::kHistogram>>;
+
+constexpr int kHllBits = 12;                                // 寄存器个数为 2^kHllBits
+constexpr size_t kHllRegisters = size_t(1) << kHllBits;
+constexpr uint64_t kPixelsPerThread = uint64_t(1) << 18;   // 自动决定线程数时每个线程至少分到的像素数
+
+/**
+ * @brief 一个行条带的统计结果，合并后得到整张图像的结果
+ */
+struct BandStats {
+    Counts hist[4];             ///< 各通道直方图
+    ColorMap colors;            ///< 多通道图像的颜色计数（统计众数时）
+    bool overflow = false;      ///< colors 达到上限后出现了未计数的新颜色
+    std::vector<uint8_t> hll;   ///< 多通道图像的 HyperLogLog 寄存器（只统计不同颜色数，或 colors 达到上限后）
+};
+
+// splitmix64 的混合函数，把打包的颜色键打散为均匀分布的 64 位哈希
+uint64_t Mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// 高 kHllBits 位选寄存器，其余位的前导零个数 + 1 作为秩，寄存器保留最大的秩
+void HllAdd(uint8_t* registers, uint64_t key) {
+    const uint64_t h = Mix64(key);
+    const size_t idx = static_cast<size_t>(h >> (64 - kHllBits));
+    // 末尾补一个 1，秩最多为 64 - kHllBits + 1，循环一定结束
+    uint64_t w = (h << kHllBits) | (uint64_t(1) << (kHllBits - 1));
+    uint8_t rank = 1;
+    while ((w >> 63) == 0) { w <<= 1; ++rank; }
+    if (rank > registers[idx]) registers[idx] = rank;
+}
+
+// 标准 HyperLogLog 估计，基数较小时改用线性计数
+uint64_t HllEstimate(const std::vector<uint8_t>& registers) {
+    const double m = static_cast<double>(registers.size());
+    double sum = 0.0; size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -static_cast<int>(r));
+        zeros += r == 0;
+    }
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) estimate = m * std::log(m / static_cast<double>(zeros));
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+// 统计 [row_begin, row_end) 行：各通道直方图，以及多通道图像的颜色计数或 HyperLogLog
+template <typename T, int CN>
+struct StatsKernel {
+    static constexpr bool kSupported = true;
+    static constexpr int kBits = 8 * static_cast<int>(sizeof(T));
+    static constexpr size_t kBins = size_t(1) << kBits;
+    // 8 位直方图很小，相邻像素轮流写入 4 份子直方图，同一个桶的连续自增不再互相等待；
+    // 16 位直方图放不进 L1，只用一份
+    static constexpr int kLanes = sizeof(T) == 1 ? 4 : 1;
+
+    // 把一个像素的各通道打包成一个整数键，通道 0 在最高位（与背景色检测一致）
+    static uint64_t Key(const T* pix) {
+        uint64_t key = 0;
+        for (int k = 0; k < CN; ++k) key = (key << kBits) | pix[k];
+        return key;
+    }
+
+    static void Run(const cv::Mat& img, int row_begin, int row_end, const ImageStatsOptions& options, size_t max_colors,
+                    BandStats& band) {
+        // 单通道图像的直方图同时是颜色直方图，众数与不同颜色数都要用到
+        const bool histograms = options.histograms || CN == 1;
+        Counts lanes(histograms ? kLanes * CN * kBins : 0, 0);
+        const bool count_colors = CN > 1 && options.color_mode;
+        const bool sketch = CN > 1 && !options.color_mode && options.unique_colors;
+        if (count_colors) {
+            band.colors.reserve(std::min(static_cast<size_t>(row_end - row_begin) * img.cols / 16 + 256, max_colors));
+        }
+        if (sketch) band.hll.assign(kHllRegisters, 0);
+
+        if (!count_colors && !sketch) {
+            // 只有直方图：逐像素计数，相邻像素轮流写入子直方图
+            for (int r = row_begin; r < row_end && histograms; ++r) {
+                const T* rowp = img.ptr<T>(r);
+                int c = 0;
+                if constexpr (kLanes == 4) {
+                    for (; c + 4 <= img.cols; c += 4) {
+                        for (int l = 0; l < 4; ++l) {
+                            const T* pix = rowp + CN * (c + l);
+                            uint64_t* h = lanes.data() + static_cast<size_t>(l) * CN * kBins;
+                            for (int k = 0; k < CN; ++k) ++h[k * kBins + pix[k]];
+                        }
+                    }
+                }
+                for (; c < img.cols; ++c) {
+                    const T* pix = rowp + CN * c;
+                    for (int k = 0; k < CN; ++k) ++lanes[k * kBins + pix[k]];
+                }
+            }
+        } else {
+            // 直方图与颜色计数在同一遍中完成：行内连续相同的像素合并成段，
+            // 每段只做一次直方图累加（相邻的段轮流写入子直方图）和一次颜色计数
+            bool has_last = false;              // 上一段的颜色，同色的段不再查哈希表
+            uint64_t last_key = 0;
+            uint64_t* last_count = nullptr;     // 上一段颜色的计数，未计数（超出上限）时为空
+            size_t run = 0;
+            for (int r = row_begin; r < row_end; ++r) {
+                const T* rowp = img.ptr<T>(r);
+                int c = 0;
+                while (c < img.cols) {
+                    const T* pix = rowp + CN * c;
+                    int end = c + 1;
+                    while (end < img.cols && pixel::PixelEquals<CN>(rowp + CN * end, pix)) ++end;
+                    const uint64_t len = static_cast<uint64_t>(end - c);
+                    if (histograms) {
+                        uint64_t* h = lanes.data() + (run++ % kLanes) * CN * kBins;
+                        for (int k = 0; k < CN; ++k) h[k * kBins + pix[k]] += len;
+                    }
+
+                    const uint64_t key = Key(pix);
+                    if (!has_last || key != last_key) {
+                        if (count_colors) {
+                            // 未达到上限时插入新颜色；达到上限后只给已有的颜色计数，新颜色只进入 HyperLogLog。
+                            // 哈希表扩容不会使元素的指针失效
+                            if (band.colors.size() < max_colors) {
+                                last_count = &band.colors.emplace(key, 0).first->second;
+                            } else {
+                                auto it = band.colors.find(key);
+                                last_count = it == band.colors.end() ? nullptr : &it->second;
+                            }
+                            if (last_count == nullptr) {
+                                band.overflow = true;
+                                if (options.unique_colors) {
+                                    if (band.hll.empty()) band.hll.assign(kHllRegisters, 0);
+                                    HllAdd(band.hll.data(), key);
+                                }
+                            }
+                        } else {
+                            HllAdd(band.hll.data(), key);
+                        }
+                    }
+                    if (last_count != nullptr) *last_count += len;
+                    has_last = true;
+                    last_key = key;
+                    c = end;
+                }
+            }
+        }
+
+        // 合并子直方图
+        if (!histograms) return;
+        for (int k = 0; k < CN; ++k) {
+            band.hist[k].assign(kBins, 0);
+            for (int l = 0; l < kLanes; ++l) {
+                const uint64_t* h = lanes.data() + (static_cast<size_t>(l) * CN + k) * kBins;
+                for (size_t v = 0; v < kBins; ++v) band.hist[k][v] += h[v];
+            }
+        }
+    }
+};
+
+// 统计 [row_begin, row_end) 行中等于 color 的像素个数。循环体只有比较和累加，可以被向量化
+template <typename T, int CN>
+struct CountKernel {
+    static constexpr bool kSupported = true;
+
+    static uint64_t Run(const cv::Mat& img, int row_begin, int row_end, const uint16_t* color) {
+        uint64_t count = 0;
+        for (int r = row_begin; r < row_end; ++r) {
+            const T* rowp = img.ptr<T>(r);
+            uint64_t same = 0;
+            for (int c = 0; c < img.cols; ++c) same += pixel::PixelEquals<CN>(rowp + CN * c, color);
+            count += same;
+        }
+        return count;
+    }
+};
+
+using StatsTable = pixel::KernelTable<StatsKernel, void, const cv::Mat&, int, int, const ImageStatsOptions&, size_t,
+                                      BandStats&>;
+using CountTable = pixel::KernelTable<CountKernel, uint64_t, const cv::Mat&, int, int, const uint16_t*>;
+
+// 条带数：指定了线程数时按指定的来，否则每个线程至少分到 kPixelsPerThread 个像素
+int ResolveBands(const cv::Mat& img, int num_threads) {
+    int bands = num_threads > 0 ? num_threads : ThreadPool::ResolveThreads(0);
+    if (num_threads <= 0) {
+        const uint64_t by_size = std::max<uint64_t>(1, static_cast<uint64_t>(img.total()) / kPixelsPerThread);
+        bands = static_cast<int>(std::min<uint64_t>(bands, by_size));
+    }
+    return std::max(1, std::min(bands, img.rows));
+}
+
+}  // namespace
+
+bool ImageStats::Compute(const cv::Mat& img, ImageStats& stats, const ImageStatsOptions& options) {
+    STATS_SCOPE_BYTES(kImageStats, img.total() * img.elemSize());
+    stats = ImageStats();
+    auto kernel = StatsTable::Lookup(img.type());
+    if (kernel == nullptr || img.empty()) return false;
+
+    // 按行分条带并行统计
+    const int bands = ResolveBands(img, options.num_threads);
+    // 条带中的异常（如 MemoryBudgetExceeded）在全部条带结束后向调用方重新抛出
+    // 精确计数的颜色数上限按条带均分，合并后的哈希表也不超过上限
+    const size_t max_colors = std::max<size_t>(1, options.max_exact_colors / static_cast<size_t>(bands));
+    auto band_begin = [&](int b) { return static_cast<int>(static_cast<int64_t>(img.rows) * b / bands); };
+    std::vector<BandStats> partial(bands);
+    ParallelBands(bands, [&](int b) {
+        kernel(img, band_begin(b), band_begin(b + 1), options, max_colors, partial[b]);
+    });
+
+    const int cn = img.channels();
+    const int bits = 8 * static_cast<int>(img.elemSize1());
+    stats.channels = cn;
+    stats.depth = img.depth();
+    stats.pixels = static_cast<uint64_t>(img.total());
+
+    // 直方图求和，均值、方差与极值都从直方图得到
+    const double n = static_cast<double>(stats.pixels);
+    for (int k = 0; k < cn && !partial[0].hist[k].empty(); ++k) {
+        std::vector<uint64_t>& hist = stats.histogram[k];
+        hist.assign(partial[0].hist[k].begin(), partial[0].hist[k].end());
+        for (int b = 1; b < bands; ++b) {
+            for (size_t v = 0; v < hist.size(); ++v) hist[v] += partial[b].hist[k][v];
+        }
+
+        double sum = 0.0;
+        for (size_t v = 0; v < hist.size(); ++v) sum += static_cast<double>(v) * static_cast<double>(hist[v]);
+        stats.mean[k] = sum / n;
+        double sq = 0.0;
+        for (size_t v = 0; v < hist.size(); ++v) {
+            const double d = static_cast<double>(v) - stats.mean[k];
+            sq += static_cast<double>(hist[v]) * d * d;
+        }
+        stats.variance[k] = sq / n;
+
+        size_t lo = 0, hi = hist.size() - 1;
+        while (hist[lo] == 0) ++lo;
+        while (hist[hi] == 0) --hi;
+        stats.min[k] = static_cast<uint16_t>(lo);
+        stats.max[k] = static_cast<uint16_t>(hi);
+    }
+
+    // 颜色众数与不同颜色数
+    uint64_t best_key = 0, best_cnt = 0;
+    if (cn == 1) {
+        // 单通道的直方图就是颜色直方图，频次相同时取较小的值
+        const std::vector<uint64_t>& hist = stats.histogram[0];
+        uint64_t unique = 0;
+        for (size_t v = 0; v < hist.size(); ++v) {
+            if (hist[v] > best_cnt) { best_cnt = hist[v]; best_key = v; }
+            unique += hist[v] != 0;
+        }
+        stats.has_mode = options.color_mode;
+        stats.mode_exact = options.color_mode;
+        if (options.unique_colors) { stats.unique_colors = unique; stats.unique_exact = true; }
+    } else if (options.color_mode) {
+        // 合并到最大的哈希表中
+        size_t base = 0;
+        for (int b = 1; b < bands; ++b) {
+            if (partial[b].colors.size() > partial[base].colors.size()) base = static_cast<size_t>(b);
+        }
+        ColorMap& colors = partial[base].colors;
+        for (int b = 0; b < bands; ++b) {
+            if (static_cast<size_t>(b) == base) continue;
+            for (const auto& kv : partial[b].colors) colors[kv.first] += kv.second;
+            ColorMap().swap(partial[b].colors);
+        }
+        for (const auto& kv : colors) {
+            if (kv.second > best_cnt || (kv.second == best_cnt && kv.first < best_key)) {
+                best_cnt = kv.second; best_key = kv.first;
+            }
+        }
+        stats.has_mode = true;
+
+        const bool overflow = std::any_of(partial.begin(), partial.end(), [](const BandStats& b) { return b.overflow; });
+        stats.mode_exact = !overflow;
+        if (options.unique_colors && !overflow) {
+            stats.unique_colors = colors.size();
+            stats.unique_exact = true;
+        } else if (options.unique_colors) {
+            // 超出上限的颜色只在 HyperLogLog 中，哈希表中的颜色补进去后一起估计
+            std::vector<uint8_t> registers(kHllRegisters, 0);
+            for (const auto& kv : colors) HllAdd(registers.data(), kv.first);
+            for (const BandStats& band : partial) {
+                for (size_t i = 0; i < band.hll.size(); ++i) registers[i] = std::max(registers[i], band.hll[i]);
+            }
+            stats.unique_colors = HllEstimate(registers);
+        }
+        if (overflow) {
+            // 某些条带没有给这个颜色计数，候选众数的计数只是下界，只对它再精确计数一遍
+            uint16_t color[4] = {0, 0, 0, 0};
+            for (int k = 0; k < cn; ++k) {
+                color[k] = static_cast<uint16_t>((best_key >> (bits * (cn - 1 - k))) & ((uint64_t(1) << bits) - 1));
+            }
+            auto count = CountTable::Lookup(img.type());
+            std::vector<uint64_t> counts(bands, 0);
+            ParallelBands(bands, [&](int b) { counts[b] = count(img, band_begin(b), band_begin(b + 1), color); });
+            best_cnt = 0;
+            for (uint64_t c : counts) best_cnt += c;
+        }
+    } else if (options.unique_colors) {
+        std::vector<uint8_t> registers(kHllRegisters, 0);
+        for (const BandStats& band : partial) {
+            for (size_t i = 0; i < kHllRegisters; ++i) registers[i] = std::max(registers[i], band.hll[i]);
+        }
+        stats.unique_colors = HllEstimate(registers);
+    }
+
+    if (stats.has_mode) {
+        // 按照 BGR(A) 通道顺序拆出众数颜色
+        for (int k = 0; k < cn; ++k) {
+            stats.mode[k] = static_cast<uint16_t>((best_key >> (bits * (cn - 1 - k))) & ((uint64_t(1) << bits) - 1));
+        }
+        stats.mode_count = best_cnt;
+        stats.non_background_fraction = static_cast<double>(stats.pixels - best_cnt) / n;
+    }
+    return true;
+}
+
+ImageStats ImageStats::Compute(const cv::Mat& img, const ImageStatsOptions& options) {
+    ImageStats stats;
+    Compute(img, stats, options);
+    return stats;
+}
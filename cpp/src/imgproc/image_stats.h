@@ -0,0 +1,80 @@
+/**
+ * @file image_stats.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 单遍并行的图像统计：直方图、颜色众数、均值方差、极值与不同颜色数
+ * @version 0.1
+ * @date 2025-12-05
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief ImageStats::Compute 的统计选项
+ */
+struct ImageStatsOptions {
+    int num_threads = 0;        ///< 线程数，<= 0 时按图像大小和硬件并发数自动决定
+    bool histograms = true;     ///< 统计各通道直方图及由它推出的均值、方差与极值
+    bool color_mode = false;    ///< 统计颜色众数（即背景色）与非背景像素占比，需要逐颜色精确计数，只在用到背景色时打开
+    bool unique_colors = true;  ///< 统计不同颜色数
+    size_t max_exact_colors = size_t(1) << 20;  ///< 统计众数时精确计数的颜色数上限，限制哈希表的内存
+};
+
+/**
+ * @brief 一张图像的统计结果
+ *
+ * @details 各通道的直方图在一遍扫描中得到，均值、方差与极值都由直方图推出，不再逐像素计算。
+ * 多通道图像需要颜色计数时，行内连续相同的像素先合并成段，直方图与颜色计数在同一遍中按段累加。
+ * 统计众数时用哈希表逐颜色计数，此时不同颜色数就是哈希表的大小，是精确值；
+ * 不统计众数时改用 HyperLogLog 估计不同颜色数（4096 个寄存器，相对误差约 1.6%），
+ * 内存固定且各线程的结果可以直接合并。单通道图像的直方图本身就是颜色直方图，两者都是精确的。
+ *
+ * 哈希表的大小受 max_exact_colors 限制：达到上限后新出现的颜色不再计数，只进入 HyperLogLog，
+ * 不同颜色数改为估计值；众数取已计数颜色中最多的一个（mode_exact 为 false），
+ * 再单独扫描一遍得到它的精确像素数。背景色通常很早就出现，实际上仍是真正的众数。
+ *
+ * 图像按行分成若干条带并行统计，最后合并各条带的结果，统计结果与线程数无关
+ * （颜色数超出上限时众数可能随线程数变化）。
+ * Compressor::Save 只需要众数与它的像素个数，关闭直方图与不同颜色数后只剩按段计数一项工作。
+ */
+struct ImageStats {
+    int channels = 0;
+    int depth = CV_8U;
+    uint64_t pixels = 0;
+
+    std::vector<uint64_t> histogram[4];     ///< 各通道直方图，8 位 256 个桶，16 位 65536 个桶；未统计时为空，均值等为 0
+    double mean[4] = {0, 0, 0, 0};
+    double variance[4] = {0, 0, 0, 0};      ///< 总体方差
+    uint16_t min[4] = {0, 0, 0, 0};
+    uint16_t max[4] = {0, 0, 0, 0};
+
+    bool has_mode = false;                  ///< mode、mode_count 与 non_background_fraction 是否有效
+    bool mode_exact = false;                ///< mode 一定是真正的众数；颜色数超出上限时为 false，mode_count 仍是精确值
+    uint16_t mode[4] = {0, 0, 0, 0};        ///< 出现最多的颜色，按 BGR(A) 顺序，频次相同时取较小的值
+    uint64_t mode_count = 0;
+    double non_background_fraction = 0.0;   ///< 与 mode 不同的像素占比
+
+    uint64_t unique_colors = 0;             ///< 不同颜色数，未统计时为 0
+    bool unique_exact = false;              ///< unique_colors 是精确值还是 HyperLogLog 估计
+
+    /**
+     * @brief 单遍统计图像
+     *
+     * @param img[in] 8 位或 16 位，1/3/4 通道的图像
+     * @param stats[out] 统计结果
+     * @param options[in] 统计选项
+     * @return 图像为空或类型不支持时返回 false；统计线程中的异常（如超出内存预算）在所有线程结束后重新抛出
+     */
+    static bool Compute(const cv::Mat& img, ImageStats& stats, const ImageStatsOptions& options = ImageStatsOptions());
+
+    /**
+     * @brief 便于直接使用的重载，失败时返回 pixels 为 0 的结果
+     */
+    static ImageStats Compute(const cv::Mat& img, const ImageStatsOptions& options = ImageStatsOptions());
+};
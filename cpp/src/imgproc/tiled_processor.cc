@@ -0,0 +1,110 @@
+/**
+ * @file tiled_processor.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 分块的核外缩放与灰度化实现
+ * @version 0.1
+ * @date 2025-12-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "tiled_processor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "../common/thread_pool.h"
+
+namespace {
+
+// 每块的输出行数：一行输出连同它平均用到的输入行不超过 tile_bytes，至少一行
+int TileRows(const TileOptions& options, size_t src_row_bytes, double src_rows_per_dst_row, size_t dst_row_bytes,
+             int dst_rows) {
+    const double per_row = static_cast<double>(dst_row_bytes) + static_cast<double>(src_row_bytes) * src_rows_per_dst_row;
+    const double rows = static_cast<double>(options.tile_bytes) / std::max(per_row, 1.0);
+    return static_cast<int>(std::max(1.0, std::min(rows, static_cast<double>(dst_rows))));
+}
+
+// 把 [0, rows) 按 tile_rows 切块，由若干线程按块号递增的顺序领取并调用 tile(begin, end)。
+// 某块失败后其余线程不再领取新块；块中的异常（如 bad_alloc）在全部线程结束后向调用方重新抛出
+bool RunTiles(int rows, int tile_rows, int num_threads, const std::function<bool(int, int)>& tile) {
+    const int tiles = (rows + tile_rows - 1) / tile_rows;
+    const int threads = std::max(1, std::min(ThreadPool::ResolveThreads(num_threads), tiles));
+
+    std::atomic<int> next(0);
+    std::atomic<bool> failed(false);
+    ParallelBands(threads, [&](int) {
+        try {
+            for (int t = next++; t < tiles && !failed.load(std::memory_order_relaxed); t = next++) {
+                const int begin = t * tile_rows;
+                if (!tile(begin, std::min(rows, begin + tile_rows))) failed = true;
+            }
+        } catch (...) {
+            failed = true;
+            throw;
+        }
+    });
+    return !failed;
+}
+
+}  // namespace
+
+bool TiledProcessor::Resize(const MappedRaster& src, MappedRaster& dst, Processor::Interpolation mode,
+                            const TileOptions& options) {
+    if (!src.is_open() || !dst.is_open() || !dst.writable() || src.type() != dst.type()) return false;
+
+    // 两者都是整幅图像的图像头，只建立头部不访问像素，内核只触及当前块用到的行
+    const cv::Mat input = src.Image();
+    cv::Mat out = dst.Image();
+    const double src_per_dst = std::max(1.0, static_cast<double>(src.height()) / dst.height());
+    const int tile_rows = TileRows(options, src.row_bytes(), src_per_dst, dst.row_bytes(), dst.height());
+
+    return RunTiles(dst.height(), tile_rows, options.num_threads, [&](int begin, int end) {
+        cv::Mat band = out;   // 每个线程各用一个图像头
+        if (!Processor::ResizeRows(input, band, begin, end, mode)) return false;
+        if (options.release_pages) {
+            int src_begin = 0, src_end = 0;
+            Processor::ResizeSourceRows(src.height(), dst.height(), begin, end, mode, src_begin, src_end);
+            src.Release(src_begin, src_end);
+            dst.Release(begin, end);
+        }
+        return true;
+    });
+}
+
+bool TiledProcessor::ToGray(const MappedRaster& src, MappedRaster& dst, const TileOptions& options) {
+    if (!src.is_open() || !dst.is_open() || !dst.writable()) return false;
+    if (src.width() != dst.width() || src.height() != dst.height()) return false;
+    if (dst.type() != CV_MAKETYPE(CV_MAT_DEPTH(src.type()), 1)) return false;
+
+    const int tile_rows = TileRows(options, src.row_bytes(), 1.0, dst.row_bytes(), dst.height());
+    return RunTiles(dst.height(), tile_rows, options.num_threads, [&](int begin, int end) {
+        const cv::Mat input = src.Rows(begin, end);
+        cv::Mat band = dst.Rows(begin, end);
+        const uint8_t* target = band.data;
+        // 同尺寸同类型的输出直接写入映射，不会重新分配；万一分配了说明结果没有落到文件里
+        if (!Processor::ToGray(input, band, src.rgb()) || band.data != target) return false;
+        if (options.release_pages) {
+            src.Release(begin, end);
+            dst.Release(begin, end);
+        }
+        return true;
+    });
+}
+
+bool TiledProcessor::ResizePnm(const std::string& input_path, const std::string& output_path, int new_width,
+                               int new_height, Processor::Interpolation mode, const TileOptions& options) {
+    MappedRaster src, dst;
+    if (!src.OpenPnm(input_path)) return false;
+    if (!dst.CreatePnm(output_path, new_width, new_height, CV_MAT_CN(src.type()))) return false;
+    return Resize(src, dst, mode, options);
+}
+
+bool TiledProcessor::ToGrayPnm(const std::string& input_path, const std::string& output_path,
+                               const TileOptions& options) {
+    MappedRaster src, dst;
+    if (!src.OpenPnm(input_path)) return false;
+    if (!dst.CreatePnm(output_path, src.width(), src.height(), 1)) return false;
+    return ToGray(src, dst, options);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file tiled_processor.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 分块的核外缩放与灰度化：在内存映射的光栅文件上逐块处理，内存占用与块大小有关而与图像大小无关
+ * @version 0.1
+ * @date 2025-12-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include "image_processor.h"
+#include "../io/mapped_raster.h"
+
+/**
+ * @brief 分块处理参数
+ */
+struct TileOptions {
+    int num_threads = 0;                    ///< 并行处理的块数，<= 0 时使用硬件并发数
+    size_t tile_bytes = size_t(16) << 20;   ///< 每块读写的目标字节数（输入行 + 输出行），决定每块的输出行数，至少一行
+    bool release_pages = true;              ///< 每块处理完后归还其输入、输出页（MappedRaster::Release）
+};
+
+/**
+ * @brief 分块的核外图像处理
+ *
+ * @details 输入与输出都是 MappedRaster，输出按行切成若干块，每块是完整宽度的一段输出行：
+ * - 缩放时每块只读取它的滤波支撑覆盖的输入行（见 Processor::ResizeSourceRows），
+ *   相邻块共用的上下光环行各自读取、各自水平滤波，块之间没有依赖；
+ * - 多个线程从共享计数器领取块号，按行号递增的顺序推进，输出直接写进映射的目标文件；
+ * - 处理完一块后归还该块的页，常驻内存约为 num_threads × tile_bytes 加上滤波中间行，
+ *   不随图像尺寸增长。
+ *
+ * 每块调用 Processor::ResizeRows / Processor::ToGray，结果与对整幅图像调用 Processor::Resize /
+ * Processor::ToGray 逐位相同，与块大小和线程数无关。
+ */
+class TiledProcessor {
+ public:
+  /**
+   * @brief 分块缩放，目标尺寸取 dst 的尺寸
+   * @param src 输入映射。
+   * @param dst 可写的输出映射，类型与 src 相同。
+   * @param mode 插值方式。
+   * @return 成功时为 true，映射未打开、不可写、类型不一致或不支持时为 false。
+   */
+  static bool Resize(const MappedRaster& src, MappedRaster& dst,
+                     Processor::Interpolation mode = Processor::Interpolation::kBilinear,
+                     const TileOptions& options = TileOptions());
+
+  /**
+   * @brief 分块灰度化，P6 输入按 RGB 顺序解释
+   * @param src 输入映射。
+   * @param dst 可写的输出映射，与 src 同尺寸、同位深的单通道。
+   * @return 成功时为 true，参数不合法或类型不支持时为 false。
+   */
+  static bool ToGray(const MappedRaster& src, MappedRaster& dst, const TileOptions& options = TileOptions());
+
+  /**
+   * @brief 把 P5 / P6 文件缩放后写成同格式的新文件
+   * @param input_path 输入文件，二进制 PGM / PPM，最大值 255。
+   * @param output_path 输出文件，已存在时被覆盖。
+   * @return 成功时为 true。
+   */
+  static bool ResizePnm(const std::string& input_path, const std::string& output_path, int new_width,
+                        int new_height, Processor::Interpolation mode = Processor::Interpolation::kBilinear,
+                        const TileOptions& options = TileOptions());
+
+  /**
+   * @brief 把 P5 / P6 文件灰度化后写成 P5 文件
+   */
+  static bool ToGrayPnm(const std::string& input_path, const std::string& output_path,
+                        const TileOptions& options = TileOptions());
+};
@@ -0,0 +1,103 @@
+/**
+ * @file area_reducer.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 区域平均缩小器实现
+ * @version 0.1
+ * @date 2025-11-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "area_reducer.h"
+#include <algorithm>
+
+cv::Size AreaReducer::FitWithin(int width, int height, int max_dim) {
+    if (width <= 0 || height <= 0 || max_dim <= 0) return cv::Size();
+    int longest = std::max(width, height);
+    if (longest <= max_dim) return cv::Size(width, height);
+    int w = static_cast<int>(static_cast<int64_t>(width) * max_dim / longest);
+    int h = static_cast<int>(static_cast<int64_t>(height) * max_dim / longest);
+    return cv::Size(std::max(w, 1), std::max(h, 1));
+}
+
+cv::Mat AreaReducer::Reduce(const cv::Mat& src, cv::Size dst) {
+    if (src.empty()) return cv::Mat();
+    if (dst.width >= src.cols && dst.height >= src.rows) return src;
+    AreaReducer reducer(src.cols, src.rows, dst, src.type());
+    if (!reducer.valid()) return cv::Mat();
+    for (int r = 0; r < src.rows; ++r) reducer.PushRow(src.ptr(r));
+    return reducer.Finish();
+}
+
+AreaReducer::AreaReducer(int src_width, int src_height, cv::Size dst, int type)
+    : src_width_(src_width), src_height_(src_height), dst_(dst),
+      depth_(CV_MAT_DEPTH(type)), channels_(CV_MAT_CN(type)) {
+    bool depth_ok = depth_ == CV_8U || depth_ == CV_16U || depth_ == CV_32F;
+    valid_ = depth_ok && channels_ >= 1 && channels_ <= 4 &&
+             dst.width > 0 && dst.height > 0 && dst.width <= src_width && dst.height <= src_height;
+    if (!valid_) return;
+
+    col_map_.resize(src_width);
+    col_count_.assign(dst.width, 0);
+    for (int c = 0; c < src_width; ++c) {
+        col_map_[c] = static_cast<int>(static_cast<int64_t>(c) * dst.width / src_width);
+        ++col_count_[col_map_[c]];
+    }
+    sums_.assign(static_cast<size_t>(dst.width) * channels_, 0.0);
+    out_.create(dst.height, dst.width, type);
+}
+
+template <typename T>
+void AreaReducer::Accumulate(const T* row) {
+    for (int c = 0; c < src_width_; ++c) {
+        double* s = &sums_[static_cast<size_t>(col_map_[c]) * channels_];
+        for (int k = 0; k < channels_; ++k) s[k] += row[c * channels_ + k];
+    }
+}
+
+template <typename T>
+void AreaReducer::Flush() {
+    T* dst = out_.ptr<T>(dst_row_);
+    for (int oc = 0; oc < dst_.width; ++oc) {
+        double n = static_cast<double>(col_count_[oc]) * rows_in_strip_;
+        for (int k = 0; k < channels_; ++k) {
+            size_t i = static_cast<size_t>(oc) * channels_ + k;
+            dst[i] = cv::saturate_cast<T>(sums_[i] / n);
+        }
+    }
+}
+
+void AreaReducer::FlushRow() {
+    if (rows_in_strip_ == 0) return;
+    switch (depth_) {
+        case CV_8U: Flush<uint8_t>(); break;
+        case CV_16U: Flush<uint16_t>(); break;
+        default: Flush<float>(); break;
+    }
+    std::fill(sums_.begin(), sums_.end(), 0.0);
+    rows_in_strip_ = 0;
+}
+
+void AreaReducer::PushRow(const void* row) {
+    if (!valid_ || src_row_ >= src_height_) return;
+
+    // 源行映射到新的输出行时，先写出已完成的输出行
+    int dst_row = static_cast<int>(static_cast<int64_t>(src_row_) * dst_.height / src_height_);
+    if (dst_row != dst_row_) {
+        FlushRow();
+        dst_row_ = dst_row;
+    }
+    switch (depth_) {
+        case CV_8U: Accumulate(static_cast<const uint8_t*>(row)); break;
+        case CV_16U: Accumulate(static_cast<const uint16_t*>(row)); break;
+        default: Accumulate(static_cast<const float*>(row)); break;
+    }
+    ++rows_in_strip_;
+    if (++src_row_ == src_height_) FlushRow();
+}
+
+cv::Mat AreaReducer::Finish() {
+    if (!valid_ || src_row_ != src_height_) return cv::Mat();
+    return out_;
+}
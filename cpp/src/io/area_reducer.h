@@ -0,0 +1,80 @@
+/**
+ * @file area_reducer.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 逐行输入的区域平均缩小器，用于边解码边缩小的预览路径
+ * @version 0.1
+ * @date 2025-11-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 按源行顺序接收像素、输出区域平均后的缩小图像
+ *
+ * @details 每个输出像素等于映射到它的全部源像素的平均值（四舍五入）。
+ * 只保存一行输出的累加和与输出图像本身，不需要完整的源图像，
+ * 因此解码器可以逐行（按条带）喂入数据，峰值内存与输出尺寸成正比。
+ * 支持 CV_8U / CV_16U / CV_32F，1~4 通道。只缩小，不放大。
+ */
+class AreaReducer {
+public:
+    /**
+     * @brief 计算保持宽高比、长边不超过 max_dim 的尺寸（不放大，宽高至少为 1）
+     */
+    static cv::Size FitWithin(int width, int height, int max_dim);
+
+    /**
+     * @brief 对已完整解码的图像做区域平均缩小，dst 不小于 src 时返回 src 本身
+     */
+    static cv::Mat Reduce(const cv::Mat& src, cv::Size dst);
+
+    /**
+     * @param src_width 源图像宽度
+     * @param src_height 源图像高度
+     * @param dst 输出尺寸（每一维都不超过源尺寸）
+     * @param type 源与输出的像素类型
+     */
+    AreaReducer(int src_width, int src_height, cv::Size dst, int type);
+
+    /**
+     * @brief 类型与尺寸是否受支持
+     */
+    bool valid() const { return valid_; }
+
+    /**
+     * @brief 喂入下一行源像素（src_width 个像素，类型为构造时的 type）
+     */
+    void PushRow(const void* row);
+
+    /**
+     * @brief 全部源行都已喂入时返回结果，否则返回空 cv::Mat
+     */
+    cv::Mat Finish();
+
+private:
+    template <typename T> void Accumulate(const T* row);
+    template <typename T> void Flush();
+    void FlushRow();
+
+    int src_width_;
+    int src_height_;
+    cv::Size dst_;
+    int depth_;
+    int channels_;
+    bool valid_ = false;
+
+    std::vector<int> col_map_;       ///< 源列 -> 输出列
+    std::vector<int> col_count_;     ///< 每个输出列覆盖的源列数
+    std::vector<double> sums_;       ///< 当前输出行的累加和
+    int src_row_ = 0;                ///< 已喂入的源行数
+    int dst_row_ = 0;                ///< 当前正在累加的输出行
+    int rows_in_strip_ = 0;          ///< 当前输出行已累加的源行数
+    cv::Mat out_;
+};
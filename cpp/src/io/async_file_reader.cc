@@ -0,0 +1,546 @@
+/**
+ * @file async_file_reader.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批量异步读文件实现
+ * @version 0.1
+ * @date 2025-12-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "async_file_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// io_uring 直接走系统调用；OPENAT / READ 需要 5.6 及以上内核的头文件（以 IORING_FEAT_RW_CUR_POS 判断）
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define IMGPROC_HAS_IO_URING 1
+#endif
+#endif
+
+#ifndef IMGPROC_HAS_IO_URING
+#define IMGPROC_HAS_IO_URING 0
+#endif
+
+namespace {
+
+constexpr unsigned kMaxQueueDepth = 4096;
+constexpr size_t kMaxReadChunk = size_t(1) << 30;   // 单次读取的上限，READ 的长度字段为 32 位
+
+#if !defined(_WIN32)
+// 从 done 处起把文件读满 bytes，文件变短时截断到实际长度
+int PreadAll(int fd, std::vector<uint8_t>& bytes, size_t done) {
+    while (done < bytes.size()) {
+        const size_t len = std::min(bytes.size() - done, kMaxReadChunk);
+        const ssize_t n = ::pread(fd, bytes.data() + done, len, static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) {
+            bytes.resize(done);
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return 0;
+}
+#endif
+
+}  // namespace
+
+// ===================== io_uring 后端 =====================
+
+#if IMGPROC_HAS_IO_URING
+
+/**
+ * @brief 一个 io_uring 实例：提交队列、完成队列与 SQE 数组的映射
+ *
+ * @details 每个在途文件同一时刻最多占用一个 SQE：先提交 OPENAT，完成后 fstat 取得长度，
+ * 再提交 READ 直到读满。关闭文件是同步的（不涉及磁盘读写）。
+ */
+class AsyncFileReader::Uring {
+public:
+    static std::unique_ptr<Uring> Create(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return nullptr;
+        std::unique_ptr<Uring> ring(new Uring(fd));
+        if (!ring->Map(params)) return nullptr;
+        return ring;
+    }
+
+    ~Uring() {
+        if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+        if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ != nullptr) ::munmap(sq_ptr_, sq_size_);
+        ::close(fd_);
+    }
+
+    size_t ReadAll(const std::vector<std::string>& paths, const Callback& on_ready,
+                   const std::atomic<bool>* cancel, unsigned queue_depth);
+
+    /**
+     * @brief 出错后无法确认内核已停止写入缓冲区，实例不再使用
+     */
+    bool broken() const { return broken_; }
+
+private:
+    static constexpr uint64_t kCancelTag = ~uint64_t(0);   ///< 取消请求自身的 user_data
+
+    /**
+     * @brief 一个在途文件
+     */
+    struct Request {
+        size_t index = 0;
+        int fd = -1;
+        bool opening = false;       ///< 等待 OPENAT 完成还是 READ 完成
+        size_t done = 0;            ///< 已读字节数
+        std::vector<uint8_t> bytes;
+    };
+
+    explicit Uring(int fd) : fd_(fd) {}
+
+    bool Map(const io_uring_params& p) {
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        void* sq = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) return false;
+        sq_ptr_ = sq;
+        if (single) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            void* cq = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) return false;
+            cq_ptr_ = cq;
+        }
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sqp = static_cast<char*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sqp + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sqp + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sqp + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sqp + p.sq_off.array);
+        sq_entries_ = p.sq_entries;
+
+        char* cqp = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cqp + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cqp + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cqp + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cqp + p.cq_off.cqes);
+        return true;
+    }
+
+    // 取一个空闲 SQE 并清零，提交队列已满时返回 nullptr
+    io_uring_sqe* NextSqe() {
+        const unsigned tail = *sq_tail_;
+        const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (tail - head >= sq_entries_) return nullptr;
+        const unsigned idx = tail & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        return sqe;
+    }
+
+    // 填好的 SQE 对内核可见
+    void Commit() {
+        __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+        ++to_submit_;
+    }
+
+    // 提交全部待提交的 SQE，并等待至少 wait 个完成事件
+    void Enter(unsigned wait) {
+        for (;;) {
+            const long ret = ::syscall(__NR_io_uring_enter, fd_, to_submit_, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (ret >= 0) {
+                to_submit_ -= static_cast<unsigned>(ret);
+                return;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+            }
+            if (errno != EINTR) std::this_thread::yield();
+        }
+    }
+
+    bool QueueOpen(size_t slot, const char* path) {
+        io_uring_sqe* sqe = NextSqe();
+        if (sqe == nullptr) return false;
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(path);
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = slot;
+        Commit();
+        return true;
+    }
+
+    bool QueueRead(size_t slot, Request& rq) {
+        io_uring_sqe* sqe = NextSqe();
+        if (sqe == nullptr) return false;
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = rq.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(rq.bytes.data() + rq.done);
+        sqe->len = static_cast<uint32_t>(std::min(rq.bytes.size() - rq.done, kMaxReadChunk));
+        sqe->off = rq.done;
+        sqe->user_data = slot;
+        Commit();
+        return true;
+    }
+
+    // io_uring_enter 失败后调用：取消全部在途请求并收割它们的完成事件，之后缓冲区才能释放。
+    // 收割时再次失败则无法确认内核不再写入，在途缓冲区有意泄漏，实例标记为不可用
+    void Abort(std::vector<Request>& slots, const std::vector<size_t>& free_slots) {
+        std::vector<bool> busy(slots.size(), true);
+        for (size_t s : free_slots) busy[s] = false;
+        size_t outstanding = 0;
+        for (size_t s = 0; s < slots.size(); ++s) {
+            if (!busy[s]) continue;
+            ++outstanding;
+            io_uring_sqe* sqe = NextSqe();
+            if (sqe == nullptr) continue;   // 提交队列已满，这个请求等它自然完成
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = s;
+            sqe->user_data = kCancelTag;
+            Commit();
+        }
+        try {
+            while (outstanding > 0) {
+                Enter(1);
+                unsigned head = *cq_head_;
+                const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head) {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    if (cqe.user_data == kCancelTag) continue;
+                    // 取消之前已经打开成功的文件
+                    if (slots[static_cast<size_t>(cqe.user_data)].opening && cqe.res >= 0) ::close(cqe.res);
+                    --outstanding;
+                }
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            }
+        } catch (const std::system_error&) {
+            broken_ = true;
+            for (size_t s = 0; s < slots.size(); ++s) {
+                if (busy[s]) new std::vector<uint8_t>(std::move(slots[s].bytes));
+            }
+        }
+        for (Request& rq : slots) {
+            if (rq.fd >= 0) ::close(rq.fd);
+            rq.fd = -1;
+        }
+    }
+
+    int fd_ = -1;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned to_submit_ = 0;
+    bool broken_ = false;
+};
+
+size_t AsyncFileReader::Uring::ReadAll(const std::vector<std::string>& paths, const Callback& on_ready,
+                                       const std::atomic<bool>* cancel, unsigned queue_depth) {
+    // 每个在途文件最多占一个 SQE，在途数不超过提交队列长度
+    const size_t depth = std::min<size_t>(std::max(queue_depth, 1u), sq_entries_);
+    std::vector<Request> slots(depth);
+    std::vector<size_t> free_slots;
+    free_slots.reserve(depth);
+    for (size_t s = depth; s > 0; --s) free_slots.push_back(s - 1);
+
+    size_t next = 0, inflight = 0, delivered = 0;
+    std::exception_ptr error;   // 回调抛出的异常，等在途请求全部结束后再抛出
+
+    auto finish = [&](size_t slot, int err) {
+        Request& rq = slots[slot];
+        if (rq.fd >= 0) ::close(rq.fd);
+        rq.fd = -1;
+        FileData data;
+        data.index = rq.index;
+        data.error = err;
+        if (err == 0) data.bytes = std::move(rq.bytes);
+        rq.bytes = std::vector<uint8_t>();
+        free_slots.push_back(slot);
+        --inflight;
+        if (error) return;
+        try {
+            on_ready(data);
+            ++delivered;
+        } catch (...) {
+            error = std::current_exception();
+        }
+    };
+
+    // 内核不支持某个操作码（5.6 之前）时，这个文件改为同步读取
+    auto unsupported = [](int res) { return res == -EINVAL || res == -EOPNOTSUPP; };
+
+    auto handle = [&](size_t slot, int res) {
+        Request& rq = slots[slot];
+        if (rq.opening) {
+            if (unsupported(res)) {
+                finish(slot, ReadWholeFile(paths[rq.index], rq.bytes));
+                return;
+            }
+            if (res < 0) {
+                finish(slot, -res);
+                return;
+            }
+            rq.fd = res;
+            rq.opening = false;
+            struct stat st;
+            if (::fstat(rq.fd, &st) != 0) {
+                finish(slot, errno);
+                return;
+            }
+            try {
+                rq.bytes.resize(static_cast<size_t>(st.st_size));
+            } catch (const std::bad_alloc&) {
+                finish(slot, ENOMEM);
+                return;
+            }
+            if (rq.bytes.empty()) {
+                finish(slot, 0);
+                return;
+            }
+            QueueRead(slot, rq);
+            return;
+        }
+
+        if (res == -EINTR || res == -EAGAIN) {
+            QueueRead(slot, rq);
+        } else if (unsupported(res)) {
+            finish(slot, PreadAll(rq.fd, rq.bytes, rq.done));
+        } else if (res < 0) {
+            finish(slot, -res);
+        } else if (res == 0) {
+            rq.bytes.resize(rq.done);   // 文件在读取期间变短
+            finish(slot, 0);
+        } else {
+            rq.done += static_cast<size_t>(res);
+            if (rq.done < rq.bytes.size()) {
+                QueueRead(slot, rq);
+            } else {
+                finish(slot, 0);
+            }
+        }
+    };
+
+    for (;;) {
+        // 补满在途文件
+        while (!error && inflight < depth && next < paths.size() && !(cancel != nullptr && cancel->load())) {
+            const size_t slot = free_slots.back();
+            Request& rq = slots[slot];
+            if (!QueueOpen(slot, paths[next].c_str())) break;
+            free_slots.pop_back();
+            rq.index = next++;
+            rq.opening = true;
+            rq.done = 0;
+            ++inflight;
+        }
+        if (inflight == 0) break;
+
+        // 一次系统调用提交新请求并等待完成，然后收割全部已完成的事件
+        try {
+            Enter(1);
+        } catch (const std::system_error&) {
+            // 内核可能仍在向在途缓冲区写入，先取消并收割完再随 slots 一起释放
+            Abort(slots, free_slots);
+            throw;
+        }
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            const size_t slot = static_cast<size_t>(cqe.user_data);
+            const int res = cqe.res;
+            __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+            handle(slot, res);
+            tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    if (error) std::rethrow_exception(error);
+    return delivered;
+}
+
+#else
+
+// 不支持 io_uring 的平台：Create 总是失败，使用线程池后端
+class AsyncFileReader::Uring {
+public:
+    static std::unique_ptr<Uring> Create(unsigned) { return nullptr; }
+
+    size_t ReadAll(const std::vector<std::string>&, const Callback&, const std::atomic<bool>*, unsigned) { return 0; }
+
+    bool broken() const { return false; }
+};
+
+#endif
+
+// ===================== AsyncFileReader =====================
+
+AsyncFileReader::AsyncFileReader(AsyncReadOptions options) : options_(options) {
+    if (options_.backend != Backend::kThreads) {
+        uring_ = Uring::Create(std::min(std::max(options_.queue_depth, 1u), kMaxQueueDepth));
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+AsyncFileReader::Backend AsyncFileReader::backend() const {
+    return uring_ && !uring_->broken() ? Backend::kIoUring : Backend::kThreads;
+}
+
+bool AsyncFileReader::IoUringAvailable() {
+    static const bool available = Uring::Create(1) != nullptr;
+    return available;
+}
+
+size_t AsyncFileReader::ReadAll(const std::vector<std::string>& paths, const Callback& on_ready,
+                                const std::atomic<bool>* cancel) {
+    if (paths.empty() || !on_ready) return 0;
+    if (uring_ && !uring_->broken()) return uring_->ReadAll(paths, on_ready, cancel, options_.queue_depth);
+    return ReadWithThreads(paths, on_ready, cancel);
+}
+
+int AsyncFileReader::ReadWholeFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    try {
+#if defined(_WIN32)
+        std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+        if (!ifs) return ENOENT;
+        const std::streamoff size = ifs.tellg();
+        if (size < 0) return EIO;
+        bytes.resize(static_cast<size_t>(size));
+        ifs.seekg(0);
+        ifs.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return ifs ? 0 : EIO;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return errno;
+        struct stat st;
+        int err = ::fstat(fd, &st) == 0 ? 0 : errno;
+        if (err == 0) {
+            bytes.resize(static_cast<size_t>(st.st_size));
+            err = PreadAll(fd, bytes, 0);
+        }
+        ::close(fd);
+        if (err != 0) bytes.clear();
+        return err;
+#endif
+    } catch (const std::bad_alloc&) {
+        bytes = std::vector<uint8_t>();
+        return ENOMEM;
+    }
+}
+
+// 线程池后端：读取线程各自取下一个文件，读完放入完成队列，由调用线程取出回调
+size_t AsyncFileReader::ReadWithThreads(const std::vector<std::string>& paths, const Callback& on_ready,
+                                        const std::atomic<bool>* cancel) {
+    const size_t depth = std::max(options_.queue_depth, 1u);
+    int threads = options_.threads > 0 ? options_.threads : static_cast<int>(std::min<size_t>(depth, 16));
+    threads = static_cast<int>(std::min<size_t>(static_cast<size_t>(threads), paths.size()));
+
+    std::mutex mutex;
+    std::condition_variable ready_cv;   // 有新完成的文件或读取线程全部退出
+    std::condition_variable space_cv;   // 完成队列有空位或需要停止
+    std::deque<FileData> done;
+    size_t next = 0;
+    int running = threads;
+    bool stop = false;
+
+    auto worker = [&] {
+        for (;;) {
+            FileData data;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // 已读完但未回调的文件不超过 depth 个
+                space_cv.wait(lock, [&] { return stop || done.size() < depth; });
+                if (stop || next >= paths.size() || (cancel != nullptr && cancel->load())) break;
+                data.index = next++;
+            }
+            data.error = ReadWholeFile(paths[data.index], data.bytes);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.push_back(std::move(data));
+            }
+            ready_cv.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+        }
+        ready_cv.notify_one();
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker);
+
+    size_t delivered = 0;
+    try {
+        for (;;) {
+            FileData data;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready_cv.wait(lock, [&] { return !done.empty() || running == 0; });
+                if (done.empty()) break;
+                data = std::move(done.front());
+                done.pop_front();
+            }
+            space_cv.notify_one();
+            on_ready(data);
+            ++delivered;
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        space_cv.notify_all();
+        for (std::thread& t : pool) t.join();
+        throw;
+    }
+    for (std::thread& t : pool) t.join();
+    return delivered;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file async_file_reader.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批量异步读文件：Linux 上使用 io_uring，其他情况退回线程池 + pread
+ * @version 0.1
+ * @date 2025-12-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 一个文件的读取结果
+ */
+struct FileData {
+    size_t index = 0;               ///< 在请求列表中的下标
+    std::vector<uint8_t> bytes;     ///< 文件的全部内容
+    int error = 0;                  ///< 0 表示成功，否则为 errno
+};
+
+/**
+ * @brief 异步读取参数
+ */
+struct AsyncReadOptions {
+    enum class Backend {
+        kAuto,      ///< 可用时使用 io_uring，否则使用线程池
+        kIoUring,   ///< 要求 io_uring，不可用时同样退回线程池
+        kThreads,   ///< 线程池 + pread
+    };
+
+    Backend backend = Backend::kAuto;
+    unsigned queue_depth = 64;      ///< 同时在途的文件数上限，0 按 1 处理
+    int threads = 0;                ///< 线程池后端的读取线程数，<= 0 时取 min(queue_depth, 16)
+};
+
+/**
+ * @brief 批量异步读文件
+ *
+ * @details 面向大量小文件的场景：逐个阻塞读取时瓶颈是每个文件的打开与读取延迟，
+ * 而不是带宽，因此同时保持 queue_depth 个文件在途。
+ * - io_uring 后端：打开与读取都作为请求提交（IORING_OP_OPENAT / IORING_OP_READ），
+ *   一次系统调用批量提交并收割完成事件，不需要额外的读取线程。直接使用系统调用，不依赖 liburing；
+ *   内核不支持 io_uring（或被 seccomp 等禁用）时自动退回线程池。
+ * - 线程池后端：threads 个线程各自 open / fstat / pread。
+ *
+ * 两种后端的完成回调都在调用 ReadAll 的线程中按完成顺序调用，回调返回前该文件的内存归回调所有，
+ * 可以把 bytes 移走交给其他线程解码。已读完但尚未回调的文件不超过 queue_depth 个，内存占用有界。
+ * 同一个 AsyncFileReader 可以反复调用 ReadAll，但不能在多个线程中同时调用。
+ */
+class AsyncFileReader {
+public:
+    using Backend = AsyncReadOptions::Backend;
+    using Callback = std::function<void(FileData&)>;
+
+    explicit AsyncFileReader(AsyncReadOptions options = AsyncReadOptions());
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    /**
+     * @brief 实际使用的后端，kIoUring 或 kThreads
+     */
+    Backend backend() const;
+
+    /**
+     * @brief 当前系统能否使用 io_uring
+     */
+    static bool IoUringAvailable();
+
+    /**
+     * @brief 读取全部文件，阻塞直到结束
+     *
+     * @param paths 文件路径
+     * @param on_ready 每个文件读完（或失败）后调用一次，不能为空；回调抛出的异常在已提交的读取
+     *                 全部结束后向上传播
+     * @param cancel 取消标志，置为 true 后不再开始新的文件，已开始的照常回调，可为 nullptr
+     * @return 回调过的文件数
+     *
+     * @note io_uring_enter 失败时先取消并收割全部在途请求，再抛出 std::system_error；
+     *       收割也失败时这个实例此后改用线程池后端
+     */
+    size_t ReadAll(const std::vector<std::string>& paths, const Callback& on_ready,
+                   const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief 同步读取一个文件的全部内容，线程池后端使用的同一实现
+     *
+     * @return 0 表示成功，否则为 errno
+     */
+    static int ReadWholeFile(const std::string& path, std::vector<uint8_t>& bytes);
+
+private:
+    class Uring;
+
+    size_t ReadWithThreads(const std::vector<std::string>& paths, const Callback& on_ready,
+                           const std::atomic<bool>* cancel);
+
+    AsyncReadOptions options_;
+    std::unique_ptr<Uring> uring_;  ///< 为空时使用线程池后端
+};
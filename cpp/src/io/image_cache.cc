@@ -0,0 +1,138 @@
+/**
+ * @file image_cache.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 解码图像缓存实现
+ * @version 0.1
+ * @date 2025-11-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "image_cache.h"
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+// 规范化路径：解析符号链接与 ./..，使同一文件的不同写法得到同一个键
+static std::string CanonicalPath(const std::string& file_path) {
+    std::error_code ec;
+    fs::path p = fs::weakly_canonical(fs::path(file_path), ec);
+    return ec ? fs::path(file_path).lexically_normal().string() : p.string();
+}
+
+ImageCache& ImageCache::Instance() {
+    static ImageCache cache;
+    return cache;
+}
+
+void ImageCache::SetCapacity(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_.store(bytes, std::memory_order_relaxed);
+    if (bytes == 0) {
+        // 停用时直接清空，不计入淘汰次数
+        lru_.clear();
+        index_.clear();
+        bytes_ = 0;
+        return;
+    }
+    EvictTo(bytes);
+}
+
+cv::Mat ImageCache::Load(const std::string& file_path, const char* kind, const Loader& loader) {
+    if (!enabled()) return loader(file_path);
+
+    // 读取文件大小与修改时间，失败时（如文件不存在）不经过缓存
+    std::error_code ec;
+    std::string path = CanonicalPath(file_path);
+    uintmax_t file_size = fs::file_size(path, ec);
+    if (ec) return loader(file_path);
+    int64_t mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    if (ec) return loader(file_path);
+    std::string key = std::string(kind) + '\n' + path;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(key);
+        if (found != index_.end()) {
+            auto it = found->second;
+            if (it->file_size == file_size && it->mtime == mtime) {
+                ++hits_;
+                lru_.splice(lru_.begin(), lru_, it);
+                // 返回私有副本：调用方原地修改（如 BoxBlur(img, img, r)）不会改写缓存
+                return it->img.clone();
+            }
+            Erase(it);   // 文件已更新
+        }
+        ++misses_;
+    }
+
+    // 解码期间不持锁，其他线程可以继续命中
+    cv::Mat img = loader(file_path);
+    if (img.empty()) return img;
+    size_t bytes = img.total() * img.elemSize();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t capacity = capacity_.load(std::memory_order_relaxed);
+    if (bytes > capacity) return img;
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        // 另一线程同时解码了同一文件，保留先插入的条目
+        auto it = found->second;
+        if (it->file_size == file_size && it->mtime == mtime) {
+            lru_.splice(lru_.begin(), lru_, it);
+            return img;
+        }
+        Erase(it);
+    }
+    // 缓存保存一份副本，解码结果本身交给调用方
+    EvictTo(capacity - bytes);
+    lru_.push_front(Entry{key, path, file_size, mtime, img.clone(), bytes});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    return img;
+}
+
+void ImageCache::Invalidate(const std::string& file_path) {
+    if (!enabled()) return;   // 停用时没有条目，省去路径规范化
+    std::string path = CanonicalPath(file_path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        auto next = std::next(it);
+        if (it->path == path) Erase(it);
+        it = next;
+    }
+}
+
+void ImageCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+ImageCache::Stats ImageCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.bytes = bytes_;
+    stats.entries = lru_.size();
+    stats.capacity = capacity_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ImageCache::Erase(std::list<Entry>::iterator it) {
+    bytes_ -= it->bytes;
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+void ImageCache::EvictTo(size_t limit) {
+    while (bytes_ > limit && !lru_.empty()) {
+        Erase(std::prev(lru_.end()));
+        ++evictions_;
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file image_cache.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 进程级的解码图像缓存：同一文件重复加载时直接返回已解码的图像
+ * @version 0.1
+ * @date 2025-11-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 按字节容量淘汰的 LRU 解码图像缓存
+ *
+ * @details 键为（解码器种类, 规范化路径），每个条目同时记录文件大小与修改时间，
+ * 查找时二者任一变化即视为文件已更新，旧条目被丢弃并重新解码。
+ *
+ * 返回的 cv::Mat 总是调用方私有的一份像素（命中时为缓存条目的拷贝），
+ * 调用方可以原地修改（如 Processor::BoxBlur(img, img, r)），不会影响缓存与之后的加载。
+ * 命中省去的是解码，拷贝一次像素的代价远小于解码。
+ *
+ * ImageIO 的各个 Save 函数（以及经由它们写文件的 Compressor::Save / Transform）写完后
+ * 显式调用 Invalidate：同尺寸的改写可能落在修改时间的精度之内，仅靠大小与修改时间无法发现。
+ *
+ * 默认容量为 0，即不启用；SetCapacity 后 ImageIO::LoadPng / LoadPpm 和 Compressor::Load
+ * 自动经过缓存。所有接口线程安全，可在批处理流水线的工作线程中并发调用。
+ */
+class ImageCache {
+public:
+    /**
+     * @brief 缓存统计信息
+     */
+    struct Stats {
+        uint64_t hits = 0;          ///< 命中次数
+        uint64_t misses = 0;        ///< 未命中（含文件已更新）次数
+        uint64_t evictions = 0;     ///< 因容量不足被淘汰的条目数
+        size_t bytes = 0;           ///< 当前缓存的像素字节数
+        size_t entries = 0;         ///< 当前条目数
+        size_t capacity = 0;        ///< 容量上限（字节）
+    };
+
+    /**
+     * @brief 解码函数，失败时返回空 cv::Mat
+     */
+    using Loader = std::function<cv::Mat(const std::string&)>;
+
+    /**
+     * @brief 全局唯一实例
+     */
+    static ImageCache& Instance();
+
+    /**
+     * @brief 设置容量上限（字节），超出部分按 LRU 淘汰；0 表示停用并清空
+     */
+    void SetCapacity(size_t bytes);
+
+    /**
+     * @brief 是否已启用（容量大于 0）
+     */
+    bool enabled() const { return capacity_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief 经过缓存加载图像
+     *
+     * @details 未启用、文件不存在或解码失败时直接返回 loader 的结果，不缓存。
+     * 单张图像大于容量上限时同样不缓存。
+     *
+     * @param file_path 文件路径
+     * @param kind 解码器种类（如 "png"），同一文件按不同解码器加载时互不影响
+     * @param loader 解码函数，未命中时调用，调用期间不持有缓存的锁
+     * @return cv::Mat 解码结果，不与缓存共享像素内存
+     */
+    cv::Mat Load(const std::string& file_path, const char* kind, const Loader& loader);
+
+    /**
+     * @brief 丢弃某个文件的全部缓存条目（所有解码器种类）
+     */
+    void Invalidate(const std::string& file_path);
+
+    /**
+     * @brief 丢弃全部条目，统计计数保留
+     */
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    ImageCache() = default;
+
+    struct Entry {
+        std::string key;
+        std::string path;       ///< 规范化路径，用于 Invalidate
+        uintmax_t file_size = 0;
+        int64_t mtime = 0;
+        cv::Mat img;
+        size_t bytes = 0;
+    };
+
+    /**
+     * @brief 从链表和索引中移除条目（调用方持有锁）
+     */
+    void Erase(std::list<Entry>::iterator it);
+
+    /**
+     * @brief 淘汰最久未使用的条目直到总量不超过 limit（调用方持有锁）
+     */
+    void EvictTo(size_t limit);
+
+    std::list<Entry> lru_;     ///< 表头为最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    mutable std::mutex mutex_;
+    std::atomic<size_t> capacity_{0};
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
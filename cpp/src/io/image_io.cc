@@ -11,34 +11,95 @@
 
 #include "image_io.h"
 #include <opencv2/imgcodecs.hpp>
+#include "area_reducer.h"
+#include "image_cache.h"
+#include "memory_stream.h"
 #include "ppm.h"
+#include "../common/memory.h"
+#include "../common/stats.h"
 #include <fstream>
 #include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
 #include <limits>
 
-cv::Mat ImageIO::LoadPng(const std::string& file_path) {
+// 三元组数据段按块读写，每块最多包含的节点数
+static constexpr size_t kTripChunkNodes = 1 << 14;
+
+// 分块缓冲区，计入 MemoryTracker 的 kIoBuffer 类别
+using TripChunk = std::vector<char, TrackingAllocator<char, MemoryTracker::Category::kIoBuffer>>;
+
+static cv::Mat DecodePng(const std::string& file_path) {
+    STATS_SCOPE(kDecode);
     return cv::imread(file_path, cv::IMREAD_UNCHANGED);
 }
 
+cv::Mat ImageIO::LoadPng(const std::string& file_path) {
+    return ImageCache::Instance().Load(file_path, "png", DecodePng);
+}
+
 cv::Mat ImageIO::LoadPpm(const std::string& file_path) {
-    return Ppm::LoadPpmAsMat(file_path);
+    return ImageCache::Instance().Load(file_path, "ppm", Ppm::LoadPpmAsMat);
 }
 
-// 读取文件头：TRIP width height channels count bgB bgG bgR
+// 读取文件头，两种格式：
+//   TRIP width height channels count bgB bgG bgR            （8 位，1 或 3 通道）
+//   TRIP2 width height channels bits count bg0 bg1 bg2 bg3  （8 或 16 位，1、3 或 4 通道）
 static bool ParseHeader(std::istream& is, CompressedHeader& hdr) {
     std::string magic; is >> magic;
-    if (magic != "TRIP") return false;
-    is >> hdr.width_ >> hdr.height_ >> hdr.channels_ >> hdr.count_;
-    int b, g, r; is >> b >> g >> r;
-    hdr.bg_color_[0] = static_cast<uint8_t>(b);
-    hdr.bg_color_[1] = static_cast<uint8_t>(g);
-    hdr.bg_color_[2] = static_cast<uint8_t>(r);
+    if (magic == "TRIP") {
+        is >> hdr.width_ >> hdr.height_ >> hdr.channels_ >> hdr.count_;
+        int b, g, r; is >> b >> g >> r;
+        hdr.bg_color_[0] = static_cast<uint8_t>(b);
+        hdr.bg_color_[1] = static_cast<uint8_t>(g);
+        hdr.bg_color_[2] = static_cast<uint8_t>(r);
+        hdr.depth_ = CV_8U;
+        for (int k = 0; k < 3; ++k) hdr.background_[k] = hdr.bg_color_[k];
+        hdr.background_[3] = 0;
+    } else if (magic == "TRIP2") {
+        int bits = 0;
+        is >> hdr.width_ >> hdr.height_ >> hdr.channels_ >> bits >> hdr.count_;
+        if (bits != 8 && bits != 16) return false;
+        hdr.depth_ = bits == 16 ? CV_16U : CV_8U;
+        for (int k = 0; k < 4; ++k) {
+            int v = 0; is >> v;
+            hdr.background_[k] = static_cast<uint16_t>(v);
+        }
+        for (int k = 0; k < 3; ++k) hdr.bg_color_[k] = static_cast<uint8_t>(hdr.background_[k]);
+    } else {
+        return false;
+    }
     // 丢弃到行尾，确保后续二进制读取从正确位置开始
     is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     return !is.fail();
 }
 
+// 写入文件头：TRIP width height channels count bgB bgG bgR
+static void WriteHeader(std::ostream& os, int width, int height, int channels, uint64_t count, const uint8_t bg_color[3]) {
+    os << "TRIP " << width << ' ' << height << ' ' << channels << ' '
+       << static_cast<unsigned long long>(count) << ' '
+       << static_cast<int>(bg_color[0]) << ' '
+       << static_cast<int>(bg_color[1]) << ' '
+       << static_cast<int>(bg_color[2]) << '\n';
+}
+
+// 写入 SoA 三元组的文件头。8 位灰度/彩色图仍写旧格式，保证旧版本能读取；
+// 其他类型写 TRIP2 width height channels bits count bg0 bg1 bg2 bg3
+static void WriteHeader(std::ostream& os, const TripletBuffer& triplets) {
+    if (triplets.depth() == CV_8U && triplets.channels() != 4) {
+        WriteHeader(os, triplets.width(), triplets.height(), triplets.channels(), triplets.size(), triplets.bg_color());
+        return;
+    }
+    const uint16_t* bg = triplets.background();
+    os << "TRIP2 " << triplets.width() << ' ' << triplets.height() << ' ' << triplets.channels() << ' '
+       << 8 * triplets.value_bytes() << ' '
+       << static_cast<unsigned long long>(triplets.size()) << ' '
+       << bg[0] << ' ' << bg[1] << ' ' << bg[2] << ' ' << bg[3] << '\n';
+}
+
 std::vector<TripletNode> ImageIO::LoadTrip(const std::string& file_path) {
+    STATS_SCOPE(kDeserialize);
     // 打开文件流，二进制模式
     std::ifstream ifs(file_path, std::ios::binary);
     if (!ifs) return {};
@@ -46,6 +107,8 @@ std::vector<TripletNode> ImageIO::LoadTrip(const std::string& file_path) {
     // 初始化文件头结构体
     CompressedHeader hdr{};
     if (!ParseHeader(ifs, hdr)) return {};
+    // TripletNode 只能表示 8 位灰度/彩色图
+    if (hdr.depth_ != CV_8U || hdr.channels_ == 4) return {};
 
     // 初始化三元组，预留空间
     std::vector<TripletNode> triplets;
@@ -72,15 +135,225 @@ std::vector<TripletNode> ImageIO::LoadTrip(const std::string& file_path) {
     return triplets;
 }
 
+// 按坐标类型 CoordT、取值类型 T 把 SoA 三元组逐块解包进 triplets，越界坐标直接丢弃
+template <typename CoordT, typename T>
+static void UnpackRecords(const char* src, size_t n, int channels, TripletBuffer& triplets) {
+    const size_t rec = 8 + static_cast<size_t>(channels) * sizeof(T);
+    const uint32_t width = static_cast<uint32_t>(triplets.width());
+    const uint32_t height = static_cast<uint32_t>(triplets.height());
+    size_t out = triplets.size();
+    triplets.Resize(out + n);
+    CoordT* rows = triplets.Rows<CoordT>();
+    CoordT* cols = triplets.Cols<CoordT>();
+    for (size_t i = 0; i < n; ++i, src += rec) {
+        int32_t row, col;
+        std::memcpy(&row, src, sizeof(row));
+        std::memcpy(&col, src + 4, sizeof(col));
+        if (static_cast<uint32_t>(row) >= height || static_cast<uint32_t>(col) >= width) continue;
+        rows[out] = static_cast<CoordT>(row);
+        cols[out] = static_cast<CoordT>(col);
+        for (int k = 0; k < channels; ++k) std::memcpy(triplets.Values<T>(k) + out, src + 8 + k * sizeof(T), sizeof(T));
+        ++out;
+    }
+    triplets.Resize(out);
+}
+
+// 从流中读取 .trip 文件头与全部节点，文件与内存共用
+static bool ParseTrip(std::istream& is, TripletBuffer& triplets) {
+    // 读取并校验文件头
+    CompressedHeader hdr{};
+    if (!ParseHeader(is, hdr)) return false;
+    if (hdr.channels_ != 1 && hdr.channels_ != 3 && hdr.channels_ != 4) return false;
+    if (hdr.width_ <= 0 || hdr.height_ <= 0) return false;
+
+    triplets.Reset(hdr.width_, hdr.height_, hdr.channels_, hdr.depth_);
+    triplets.SetBackground(hdr.background_);
+
+    // 文件被截断时保留已完整读到的节点
+    ImageIO::ReadTripRecords(is, hdr.count_, triplets);
+    return true;
+}
+
+bool ImageIO::LoadTrip(const std::string& file_path, TripletBuffer& triplets) {
+    STATS_SCOPE(kDeserialize);
+    // 打开文件流，二进制模式
+    std::ifstream ifs(file_path, std::ios::binary);
+    if (!ifs) return false;
+    return ParseTrip(ifs, triplets);
+}
+
+bool ImageIO::DecodeTrip(const uint8_t* data, size_t size, TripletBuffer& triplets) {
+    STATS_SCOPE_BYTES(kDeserialize, size);
+    if (data == nullptr || size == 0) return false;
+    MemoryIStream is(data, size);
+    return ParseTrip(is, triplets);
+}
+
+bool ImageIO::ReadTripRecords(std::istream& is, uint64_t count, TripletBuffer& triplets) {
+    // 节点数不会超过像素总数，防止损坏的文件头导致过量分配
+    const int channels = triplets.channels();
+    uint64_t pixels = static_cast<uint64_t>(triplets.width()) * static_cast<uint64_t>(triplets.height());
+    triplets.Reserve(triplets.size() + static_cast<size_t>(std::min(count, pixels)));
+
+    // 逐块读取数据段
+    const bool wide_values = triplets.depth() == CV_16U;
+    const size_t rec = 8 + static_cast<size_t>(channels) * triplets.value_bytes();
+    TripChunk chunk(static_cast<size_t>(std::min<uint64_t>(count, kTripChunkNodes)) * rec);
+    uint64_t remaining = count;
+    while (remaining > 0) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, kTripChunkNodes));
+        is.read(chunk.data(), static_cast<std::streamsize>(want * rec));
+        size_t got = static_cast<size_t>(is.gcount()) / rec;
+        if (triplets.wide_coords()) {
+            if (wide_values) UnpackRecords<uint32_t, uint16_t>(chunk.data(), got, channels, triplets);
+            else UnpackRecords<uint32_t, uint8_t>(chunk.data(), got, channels, triplets);
+        } else {
+            if (wide_values) UnpackRecords<uint16_t, uint16_t>(chunk.data(), got, channels, triplets);
+            else UnpackRecords<uint16_t, uint8_t>(chunk.data(), got, channels, triplets);
+        }
+        if (got < want) return false;
+        remaining -= got;
+    }
+    return true;
+}
+
+// 不区分大小写的扩展名判断，suffix 须为小写
+static bool HasSuffix(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    if (s.size() < n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[s.size() - n + i])) != suffix[i]) return false;
+    }
+    return true;
+}
+
+// 从 JPEG 的 SOF 段读取宽高与分量数，不解码像素
+static bool ReadJpegInfo(const std::string& file_path, int& width, int& height, int& components) {
+    std::ifstream ifs(file_path, std::ios::binary);
+    unsigned char b[2];
+    if (!ifs.read(reinterpret_cast<char*>(b), 2) || b[0] != 0xFF || b[1] != 0xD8) return false;
+    while (ifs.read(reinterpret_cast<char*>(b), 2)) {
+        if (b[0] != 0xFF) return false;
+        unsigned char marker = b[1];
+        if (marker == 0xFF) { ifs.seekg(-1, std::ios::cur); continue; }   // 填充字节
+        unsigned char len_bytes[2];
+        if (!ifs.read(reinterpret_cast<char*>(len_bytes), 2)) return false;
+        int len = (len_bytes[0] << 8) | len_bytes[1];
+        // SOF0~SOF15，排除 DHT(C4)、JPG(C8)、DAC(CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            unsigned char sof[6];
+            if (!ifs.read(reinterpret_cast<char*>(sof), 6)) return false;
+            height = (sof[1] << 8) | sof[2];
+            width = (sof[3] << 8) | sof[4];
+            components = sof[5];
+            return width > 0 && height > 0;
+        }
+        if (len < 2) return false;
+        ifs.seekg(len - 2, std::ios::cur);
+    }
+    return false;
+}
+
+// JPEG：由解码器直接输出 1/2、1/4 或 1/8 分辨率，再区域平均到目标尺寸
+// 降分辨率标志默认会按 EXIF 旋转，而完整解码（IMREAD_UNCHANGED）不会，
+// 因此降分辨率路径加上 IMREAD_IGNORE_ORIENTATION，保证两条路径方向一致
+static cv::Mat LoadJpegPreview(const std::string& file_path, int max_dim) {
+    int width = 0, height = 0, components = 0;
+    int flags = cv::IMREAD_UNCHANGED;
+    if (ReadJpegInfo(file_path, width, height, components)) {
+        // 选择缩小后长边仍不小于 max_dim 的最大倍数
+        int longest = std::max(width, height);
+        bool gray = components == 1;
+        if (longest / 8 >= max_dim) flags = gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+        else if (longest / 4 >= max_dim) flags = gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        else if (longest / 2 >= max_dim) flags = gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        if (flags != cv::IMREAD_UNCHANGED) flags |= cv::IMREAD_IGNORE_ORIENTATION;
+    }
+    cv::Mat img = cv::imread(file_path, flags);
+    return AreaReducer::Reduce(img, AreaReducer::FitWithin(img.cols, img.rows, max_dim));
+}
+
+// TRIP：在缩小后的网格上累加，背景像素按覆盖面积一次性计入，不重建完整图像。T 为取值类型
+template <typename T>
+static cv::Mat ReduceTriplets(const TripletBuffer& triplets, int max_dim) {
+    const int width = triplets.width(), height = triplets.height(), channels = triplets.channels();
+    const cv::Size dst = AreaReducer::FitWithin(width, height, max_dim);
+
+    // 源坐标到输出坐标的映射，以及每个输出行/列覆盖的源行/列数
+    std::vector<int> row_map(height), col_map(width), row_count(dst.height, 0), col_count(dst.width, 0);
+    for (int r = 0; r < height; ++r) ++row_count[row_map[r] = static_cast<int>(static_cast<int64_t>(r) * dst.height / height)];
+    for (int c = 0; c < width; ++c) ++col_count[col_map[c] = static_cast<int>(static_cast<int64_t>(c) * dst.width / width)];
+
+    // 先假设全部为背景，再用每个三元组替换其所在位置的背景贡献
+    const uint16_t* bg = triplets.background();
+    std::vector<int64_t> sums(static_cast<size_t>(dst.area()) * channels);
+    for (int orow = 0; orow < dst.height; ++orow) {
+        for (int ocol = 0; ocol < dst.width; ++ocol) {
+            int64_t n = static_cast<int64_t>(row_count[orow]) * col_count[ocol];
+            for (int k = 0; k < channels; ++k) sums[(static_cast<size_t>(orow) * dst.width + ocol) * channels + k] = bg[k] * n;
+        }
+    }
+    for (size_t i = 0; i < triplets.size(); ++i) {
+        size_t o = (static_cast<size_t>(row_map[triplets.Row(i)]) * dst.width + col_map[triplets.Col(i)]) * channels;
+        for (int k = 0; k < channels; ++k) sums[o + k] += static_cast<int64_t>(triplets.Values<T>(k)[i]) - bg[k];
+    }
+
+    cv::Mat out(dst.height, dst.width, CV_MAKETYPE(triplets.depth(), channels));
+    for (int orow = 0; orow < dst.height; ++orow) {
+        T* p = out.ptr<T>(orow);
+        for (int ocol = 0; ocol < dst.width; ++ocol) {
+            int64_t n = static_cast<int64_t>(row_count[orow]) * col_count[ocol];
+            for (int k = 0; k < channels; ++k) {
+                size_t i = static_cast<size_t>(ocol) * channels + k;
+                p[i] = static_cast<T>((sums[static_cast<size_t>(orow) * dst.width * channels + i] + n / 2) / n);
+            }
+        }
+    }
+    return out;
+}
+
+static cv::Mat LoadTripPreview(const std::string& file_path, int max_dim) {
+    TripletBuffer triplets;
+    if (!ImageIO::LoadTrip(file_path, triplets)) return cv::Mat();
+    if (triplets.depth() == CV_16U) return ReduceTriplets<uint16_t>(triplets, max_dim);
+    return ReduceTriplets<uint8_t>(triplets, max_dim);
+}
+
+cv::Mat ImageIO::LoadPreview(const std::string& file_path, int max_dim) {
+    if (max_dim <= 0) return cv::Mat();
+    STATS_SCOPE(kDecode);
+    if (HasSuffix(file_path, ".ppm") || HasSuffix(file_path, ".pgm")) return Ppm::LoadPpmPreview(file_path, max_dim);
+    if (HasSuffix(file_path, ".trip")) return LoadTripPreview(file_path, max_dim);
+    if (HasSuffix(file_path, ".jpg") || HasSuffix(file_path, ".jpeg")) return LoadJpegPreview(file_path, max_dim);
+
+    // 其他格式（PNG 等）解码器不支持降分辨率解码，完整解码后区域平均
+    cv::Mat img = cv::imread(file_path, cv::IMREAD_UNCHANGED);
+    return AreaReducer::Reduce(img, AreaReducer::FitWithin(img.cols, img.rows, max_dim));
+}
+
+// 写文件的函数在返回前（无论成败）使该文件的缓存条目失效。
+// 同尺寸的改写可能落在修改时间的精度之内，ImageCache 仅靠大小与修改时间发现不了
+namespace {
+struct InvalidateOnExit {
+    const std::string& path;
+    ~InvalidateOnExit() { ImageCache::Instance().Invalidate(path); }
+};
+}  // namespace
+
 bool ImageIO::SavePng(const std::string& file_path, const cv::Mat& img) {
+    STATS_SCOPE_BYTES(kEncode, img.total() * img.elemSize());
+    InvalidateOnExit invalidate{file_path};
     return cv::imwrite(file_path, img);
 }
 
 bool ImageIO::SavePpm(const std::string& file_path, const cv::Mat& img) {
+    InvalidateOnExit invalidate{file_path};
     return Ppm::SaveNatAsPpm(file_path, img);
 }
 
 bool ImageIO::SaveTrip(const std::string& file_path, int width, int height, int channels, const uint8_t bg_color[3], const std::vector<TripletNode>& triplets) {
+    STATS_SCOPE(kSerialize);
+    InvalidateOnExit invalidate{file_path};
     // 校验参数
     if (channels != 1 && channels != 3) return false;
     if (width <= 0 || height <= 0) return false;
@@ -90,11 +363,7 @@ bool ImageIO::SaveTrip(const std::string& file_path, int width, int height, int
     if (!ofs) return false;
     
     // 写入文件头
-    ofs << "TRIP " << width << ' ' << height << ' ' << channels << ' '
-        << static_cast<unsigned long long>(triplets.size()) << ' '
-        << static_cast<int>(bg_color[0]) << ' '
-        << static_cast<int>(bg_color[1]) << ' '
-        << static_cast<int>(bg_color[2]) << '\n';
+    WriteHeader(ofs, width, height, channels, triplets.size(), bg_color);
 
     // 二进制写入 triplets
     for (const auto& t : triplets) {
@@ -116,13 +385,99 @@ bool ImageIO::SaveTrip(const std::string& file_path, int width, int height, int
     return true;
 }
 
+// 按坐标类型 CoordT、取值类型 T 把 SoA 三元组打包成文件中的节点格式
+template <typename CoordT, typename T>
+static void PackRecords(const TripletBuffer& triplets, size_t begin, size_t n, char* dst) {
+    const int channels = triplets.channels();
+    const size_t rec = 8 + static_cast<size_t>(channels) * sizeof(T);
+    const CoordT* rows = triplets.Rows<CoordT>();
+    const CoordT* cols = triplets.Cols<CoordT>();
+    for (size_t i = begin; i < begin + n; ++i, dst += rec) {
+        int32_t row = static_cast<int32_t>(rows[i]);
+        int32_t col = static_cast<int32_t>(cols[i]);
+        std::memcpy(dst, &row, sizeof(row));
+        std::memcpy(dst + 4, &col, sizeof(col));
+        for (int k = 0; k < channels; ++k) std::memcpy(dst + 8 + k * sizeof(T), triplets.Values<T>(k) + i, sizeof(T));
+    }
+}
+
+bool ImageIO::SaveTrip(const std::string& file_path, const TripletBuffer& triplets) {
+    STATS_SCOPE(kSerialize);
+    InvalidateOnExit invalidate{file_path};
+    // 校验参数
+    int channels = triplets.channels();
+    if (channels != 1 && channels != 3 && channels != 4) return false;
+    if (triplets.width() <= 0 || triplets.height() <= 0) return false;
+
+    // 打开文件流，二进制模式
+    std::ofstream ofs(file_path, std::ios::binary);
+    if (!ofs) return false;
+
+    // 写入文件头和数据段
+    WriteHeader(ofs, triplets);
+    return WriteTripRecords(ofs, triplets);
+}
+
+bool ImageIO::WriteTripRecords(std::ostream& os, const TripletBuffer& triplets) {
+    // 数据段逐块打包后整块写入，避免每个字段一次 write 调用
+    const int channels = triplets.channels();
+    const bool wide_values = triplets.depth() == CV_16U;
+    const size_t rec = 8 + static_cast<size_t>(channels) * triplets.value_bytes();
+    TripChunk chunk(std::min(kTripChunkNodes, triplets.size()) * rec);
+    for (size_t begin = 0; begin < triplets.size(); begin += kTripChunkNodes) {
+        size_t n = std::min(kTripChunkNodes, triplets.size() - begin);
+        if (triplets.wide_coords()) {
+            if (wide_values) PackRecords<uint32_t, uint16_t>(triplets, begin, n, chunk.data());
+            else PackRecords<uint32_t, uint8_t>(triplets, begin, n, chunk.data());
+        } else {
+            if (wide_values) PackRecords<uint16_t, uint16_t>(triplets, begin, n, chunk.data());
+            else PackRecords<uint16_t, uint8_t>(triplets, begin, n, chunk.data());
+        }
+        os.write(chunk.data(), static_cast<std::streamsize>(n * rec));
+        if (!os) return false;
+    }
+    return true;
+}
+
 cv::Mat ImageIO::DecodeFromBuffer(const uint8_t* data, size_t size) {
-    std::vector<uint8_t> buf(data, data + size);
-    cv::Mat img = cv::imdecode(buf, cv::IMREAD_UNCHANGED);
-    return img;
+    if (data == nullptr || size == 0 || size > static_cast<size_t>(std::numeric_limits<int>::max())) return cv::Mat();
+    // 不持有数据的 1×size 头，解码器只读
+    STATS_SCOPE_BYTES(kDecode, size);
+    cv::Mat raw(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    return cv::imdecode(raw, cv::IMREAD_UNCHANGED);
 }
 
 bool ImageIO::EncodeToBuffer(const cv::Mat& img, const std::string& format, std::vector<uint8_t>* buffer) {
-    std::vector<int> params; // 默认参数
-    return cv::imencode("." + format, img, *buffer, params);
-}
\ No newline at end of file
+    return EncodeToBuffer(img, format, EncodeOptions(), buffer);
+}
+
+// 把 EncodeOptions 转换为 cv::imencode 的参数列表，只传与格式相关的项
+static std::vector<int> EncodeParams(const std::string& ext, const ImageIO::EncodeOptions& options) {
+    using Strategy = ImageIO::EncodeOptions::PngStrategy;
+    std::vector<int> params;
+    if (ext == ".png") {
+        int strategy = cv::IMWRITE_PNG_STRATEGY_DEFAULT;
+        switch (options.png_strategy) {
+            case Strategy::kDefault: strategy = cv::IMWRITE_PNG_STRATEGY_DEFAULT; break;
+            case Strategy::kFiltered: strategy = cv::IMWRITE_PNG_STRATEGY_FILTERED; break;
+            case Strategy::kHuffmanOnly: strategy = cv::IMWRITE_PNG_STRATEGY_HUFFMAN_ONLY; break;
+            case Strategy::kRle: strategy = cv::IMWRITE_PNG_STRATEGY_RLE; break;
+            case Strategy::kFixed: strategy = cv::IMWRITE_PNG_STRATEGY_FIXED; break;
+        }
+        params = {cv::IMWRITE_PNG_COMPRESSION, std::clamp(options.png_compression, 0, 9), cv::IMWRITE_PNG_STRATEGY, strategy};
+    } else if (ext == ".jpg" || ext == ".jpeg") {
+        params = {cv::IMWRITE_JPEG_QUALITY, std::clamp(options.jpeg_quality, 0, 100)};
+    } else if (ext == ".ppm" || ext == ".pgm" || ext == ".pnm") {
+        params = {cv::IMWRITE_PXM_BINARY, options.ppm_binary ? 1 : 0};
+    }
+    return params;
+}
+
+bool ImageIO::EncodeToBuffer(const cv::Mat& img, const std::string& format, const EncodeOptions& options, std::vector<uint8_t>* buffer) {
+    if (buffer == nullptr || img.empty()) return false;
+    std::string ext = (!format.empty() && format[0] == '.') ? format : "." + format;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    STATS_SCOPE_BYTES(kEncode, img.total() * img.elemSize());
+    buffer->clear();   // 保留容量，供 imencode 复用
+    return cv::imencode(ext, img, *buffer, EncodeParams(ext, options));
+}
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <istream>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -22,6 +24,7 @@
  * 
  * @details 提供了加载和保存 .png、.ppm 和 .trip（自定义的压缩类型）图像的静态方法
  * - 和与 Node.js 互操作的接口。
+ * - 启用 ImageCache 后，LoadPng / LoadPpm 命中时返回缓存图像的拷贝；各 Save 函数写完后使该文件的缓存失效。
  */
 class ImageIO {
 public:
@@ -45,11 +48,52 @@ public:
     /**
      * @brief 从文件加载三元组压缩图像
      * 
+     * @details 只支持 8 位灰度/彩色图，其他类型的文件返回空结果，请使用 TripletBuffer 接口。
+     * 
      * @param file_path .trip 文件路径
      * @return std::vector<TripletNode> 加载的三元组
      */
     static std::vector<TripletNode> LoadTrip(const std::string& file_path);
 
+    /**
+     * @brief 从文件加载三元组压缩图像到 SoA 容器
+     * 
+     * @details 宽高、通道数、位深和背景色一并写入 triplets；同时支持 TRIP 与 TRIP2 文件头。
+     * 坐标越界的节点会被丢弃，文件被截断时保留已完整读到的节点。
+     * 
+     * @param file_path .trip 文件路径
+     * @param triplets[out] 接受三元组的容器
+     * @return true 读取成功
+     * @return false 文件无法打开或文件头非法
+     */
+    static bool LoadTrip(const std::string& file_path, TripletBuffer& triplets);
+
+    /**
+     * @brief 解析内存中的 .trip 文件内容到 SoA 容器，规则与 LoadTrip 相同
+     * 
+     * @param data 文件内容，只在调用期间使用，不拷贝
+     * @param size 文件内容长度
+     * @param triplets[out] 接受三元组的容器
+     * @return false 数据为空或文件头非法
+     */
+    static bool DecodeTrip(const uint8_t* data, size_t size, TripletBuffer& triplets);
+
+    /**
+     * @brief 加载缩小的预览图，长边不超过 max_dim（不放大）
+     * 
+     * @details 按扩展名选择最省的解码方式，结果均为区域平均：
+     * - .ppm / .pgm：逐行解析并立即缩小，不分配完整尺寸的图像；
+     * - .trip：直接在缩小后的网格上累加三元组，不重建完整图像；
+     * - .jpg / .jpeg：解码器直接输出 1/2、1/4 或 1/8 分辨率后再缩小；
+     * - 其他格式（.png 等）：完整解码后缩小。
+     * 预览不经过 ImageCache。
+     * 
+     * @param file_path 图像文件路径
+     * @param max_dim 长边上限，必须为正
+     * @return cv::Mat 预览图，失败时为空
+     */
+    static cv::Mat LoadPreview(const std::string& file_path, int max_dim);
+
     /**
      * @brief 将图像保存到文件
      * 
@@ -106,21 +150,70 @@ public:
                          const uint8_t bg_color[3],
                          const std::vector<TripletNode>& triplets);
 
+    /**
+     * @brief 保存 SoA 容器中的三元组，宽高、通道数、位深和背景色取自 triplets。
+     * 
+     * @details 8 位灰度/彩色图的文件格式与上面的接口完全相同；8 位 BGRA 和 16 位图像
+     * 使用带位深的 TRIP2 文件头，取值按位深写入。数据段按块打包后写入。
+     * 
+     * @param file_path 输出 .trip 文件路径
+     * @param triplets 要写入的三元组数据
+     * @return true 成功保存
+     * @return false 失败（参数非法或文件不可写）
+     */
+    static bool SaveTrip(const std::string& file_path, const TripletBuffer& triplets);
+
+    /**
+     * @brief 把三元组数据段（不含文件头）按 .trip 的记录格式写入流，供多帧容器复用。
+     * 
+     * @details 每条记录为 int32 行、int32 列和 channels 个按位深存储的取值，按块打包后写入。
+     * @return 写入失败时返回 false。
+     */
+    static bool WriteTripRecords(std::ostream& os, const TripletBuffer& triplets);
+
+    /**
+     * @brief 从流中读取 count 条 .trip 记录追加到 triplets。
+     * 
+     * @details triplets 的宽高、通道数和位深须已通过 Reset 设置；越界坐标被丢弃，
+     * 数据被截断时保留已完整读到的记录。
+     * @return 读满 count 条记录时为 true。
+     */
+    static bool ReadTripRecords(std::istream& is, uint64_t count, TripletBuffer& triplets);
+
 
     // =========================================================
     // Node.js 互操作接口 (Buffer I/O)
     // =========================================================
 
+    /**
+     * @brief 编码参数
+     * 
+     * @details 默认值偏向速度：PNG 使用压缩级别 1（OpenCV 默认为 3，
+     * 对预览图而言压缩率提升有限但耗时明显增加）。
+     */
+    struct EncodeOptions {
+        /**
+         * @brief PNG 压缩策略，对应 zlib 的 Z_DEFAULT_STRATEGY 等
+         */
+        enum class PngStrategy { kDefault, kFiltered, kHuffmanOnly, kRle, kFixed };
+
+        int png_compression = 1;                         ///< PNG 压缩级别 0~9，越大越慢
+        PngStrategy png_strategy = PngStrategy::kDefault;
+        int jpeg_quality = 95;                           ///< JPEG 质量 0~100
+        bool ppm_binary = true;                          ///< PPM/PGM 使用二进制（P5/P6）还是文本（P2/P3）
+    };
+
     /**
     * @brief 从内存缓冲区解码图像 (供 Node.js 调用)。
-    * @param data 指向 buffer 数据的指针。
+    * @details 直接在调用方的内存上构造不持有数据的 cv::Mat 交给解码器，不拷贝输入。
+    * @param data 指向 buffer 数据的指针，解码期间必须保持有效。
     * @param size buffer 数据长度。
     * @return cv::Mat 解码后的图像。
     */
     static cv::Mat DecodeFromBuffer(const uint8_t* data, size_t size);
 
     /**
-    * @brief 将图像编码到内存缓冲区 (供 Node.js 调用)。
+    * @brief 将图像编码到内存缓冲区 (供 Node.js 调用)，使用默认编码参数。
     * @param img 输入图像。
     * @param format 编码格式
     * @param[out] buffer 输出的二进制数据。
@@ -128,4 +221,17 @@ public:
     */
     static bool EncodeToBuffer(const cv::Mat& img, const std::string& format,
                                 std::vector<uint8_t>* buffer);
+
+    /**
+    * @brief 按指定参数将图像编码到调用方提供的缓冲区。
+    * @details buffer 先被清空但保留容量，反复编码同尺寸图像时复用同一个 buffer
+    * 可以避免每次重新分配输出内存。
+    * @param img 输入图像。
+    * @param format 编码格式（"png"、"jpg"、"ppm"、"pgm" 等，可带前导点）
+    * @param options 编码参数
+    * @param[out] buffer 输出的二进制数据。
+    * @return true 成功，false 失败。
+    */
+    static bool EncodeToBuffer(const cv::Mat& img, const std::string& format,
+                                const EncodeOptions& options, std::vector<uint8_t>* buffer);
 };
\ No newline at end of file
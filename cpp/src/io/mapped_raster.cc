@@ -0,0 +1,218 @@
+/**
+ * @file mapped_raster.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 内存映射的光栅文件实现
+ * @version 0.1
+ * @date 2025-12-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "mapped_raster.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if !defined(_WIN32)
+#define IMGPROC_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 支持的像素类型：8/16 位，1/3/4 通道
+bool SupportedType(int type) {
+    const int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    return (depth == CV_8U || depth == CV_16U) && (cn == 1 || cn == 3 || cn == 4);
+}
+
+// 像素区字节数，溢出时返回 0
+size_t PixelBytes(int width, int height, int type) {
+    if (width <= 0 || height <= 0) return 0;
+    const size_t row = static_cast<size_t>(width) * CV_ELEM_SIZE(type);
+    if (row > std::numeric_limits<size_t>::max() / static_cast<size_t>(height)) return 0;
+    return row * static_cast<size_t>(height);
+}
+
+// 读取 PNM 文件头中的下一个非负整数，跳过空白和注释
+bool ReadHeaderInt(std::istream& is, int& value) {
+    int ch = is.get();
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') ch = is.get();
+        } else if (!std::isspace(ch)) {
+            break;
+        } else {
+            ch = is.get();
+        }
+    }
+    if (ch < '0' || ch > '9') return false;
+    long long v = 0;
+    while (ch >= '0' && ch <= '9') {
+        v = v * 10 + (ch - '0');
+        if (v > std::numeric_limits<int>::max()) return false;
+        ch = is.get();
+    }
+    // 数字后必须紧跟一个空白字符，最大值之后的这个字符就是像素区前的分隔符
+    if (!std::isspace(ch)) return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+}  // namespace
+
+MappedRaster::~MappedRaster() {
+    Close();
+}
+
+bool MappedRaster::Supported() {
+#if defined(IMGPROC_HAS_MMAP)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool MappedRaster::OpenRaw(const std::string& path, int width, int height, int type, bool writable) {
+    Close();
+    if (!SupportedType(type)) return false;
+    const size_t bytes = PixelBytes(width, height, type);
+    if (bytes == 0 || !Map(path, false, writable, 0, bytes)) return false;
+    format_ = Format::kRaw;
+    width_ = width; height_ = height; type_ = type;
+    return true;
+}
+
+bool MappedRaster::OpenPnm(const std::string& path, bool writable) {
+    Close();
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+
+    // 文件头："P5"/"P6"、宽、高、最大值，之后紧跟一个空白字符和像素区
+    char magic[2] = {};
+    if (!ifs.read(magic, 2) || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) return false;
+    int width = 0, height = 0, maxv = 0;
+    if (!ReadHeaderInt(ifs, width) || !ReadHeaderInt(ifs, height) || !ReadHeaderInt(ifs, maxv)) return false;
+    if (maxv != 255) return false;   // 16 位 PNM 为大端序，不能直接映射为 CV_16U
+    const std::streamoff offset = ifs.tellg();
+    if (offset <= 0) return false;
+
+    const int type = CV_MAKETYPE(CV_8U, magic[1] == '5' ? 1 : 3);
+    const size_t bytes = PixelBytes(width, height, type);
+    if (bytes == 0 || !Map(path, false, writable, static_cast<size_t>(offset), static_cast<size_t>(offset) + bytes)) return false;
+    format_ = Format::kPnm;
+    width_ = width; height_ = height; type_ = type;
+    return true;
+}
+
+bool MappedRaster::CreateRaw(const std::string& path, int width, int height, int type) {
+    Close();
+    if (!SupportedType(type)) return false;
+    const size_t bytes = PixelBytes(width, height, type);
+    if (bytes == 0 || !Map(path, true, true, 0, bytes)) return false;
+    format_ = Format::kRaw;
+    width_ = width; height_ = height; type_ = type;
+    return true;
+}
+
+bool MappedRaster::CreatePnm(const std::string& path, int width, int height, int channels) {
+    Close();
+    if (channels != 1 && channels != 3) return false;
+    const int type = CV_MAKETYPE(CV_8U, channels);
+    const size_t bytes = PixelBytes(width, height, type);
+    if (bytes == 0) return false;
+
+    const std::string header = std::string(channels == 1 ? "P5" : "P6") + "\n" + std::to_string(width) + " " +
+                               std::to_string(height) + "\n255\n";
+    if (!Map(path, true, true, header.size(), header.size() + bytes)) return false;
+    std::memcpy(base_, header.data(), header.size());
+    format_ = Format::kPnm;
+    width_ = width; height_ = height; type_ = type;
+    return true;
+}
+
+// 打开（或创建）文件并映射前 file_size 个字节。已有文件的长度不足 file_size 时失败
+bool MappedRaster::Map(const std::string& path, bool create, bool writable, size_t data_offset, size_t file_size) {
+#if defined(IMGPROC_HAS_MMAP)
+    const int flags = create ? (O_RDWR | O_CREAT | O_TRUNC) : (writable ? O_RDWR : O_RDONLY);
+    const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    bool ok = true;
+    if (create) {
+        // 新文件是稀疏的，只有写到的页才占用磁盘
+        ok = ::ftruncate(fd, static_cast<off_t>(file_size)) == 0;
+    } else {
+        struct stat st;
+        ok = ::fstat(fd, &st) == 0 && static_cast<unsigned long long>(st.st_size) >= file_size;
+    }
+
+    void* addr = MAP_FAILED;
+    if (ok) {
+        const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        addr = ::mmap(nullptr, file_size, prot, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);   // 映射持有自己的引用，描述符可以立即关闭
+    if (addr == MAP_FAILED) return false;
+
+    // 分块处理时每块内按行顺序访问，请求更积极的预读
+    ::madvise(addr, file_size, MADV_SEQUENTIAL);
+    base_ = static_cast<uint8_t*>(addr);
+    map_size_ = file_size;
+    offset_ = data_offset;
+    writable_ = writable;
+    return true;
+#else
+    (void)path; (void)create; (void)writable; (void)data_offset; (void)file_size;
+    return false;
+#endif
+}
+
+void MappedRaster::Close() {
+#if defined(IMGPROC_HAS_MMAP)
+    if (base_ != nullptr) ::munmap(base_, map_size_);
+#endif
+    base_ = nullptr;
+    map_size_ = offset_ = 0;
+    width_ = height_ = type_ = 0;
+    writable_ = false;
+    format_ = Format::kRaw;
+}
+
+size_t MappedRaster::row_bytes() const {
+    return static_cast<size_t>(width_) * CV_ELEM_SIZE(type_);
+}
+
+cv::Mat MappedRaster::Rows(int begin, int end) const {
+    if (base_ == nullptr || begin < 0 || end > height_ || begin >= end) return cv::Mat();
+    uint8_t* data = base_ + offset_ + static_cast<size_t>(begin) * row_bytes();
+    return cv::Mat(end - begin, width_, type_, data, row_bytes());
+}
+
+void MappedRaster::Release(int begin, int end) const {
+#if defined(IMGPROC_HAS_MMAP)
+    if (base_ == nullptr || begin < 0 || end > height_ || begin >= end) return;
+    // 只归还完整落在区间内的页，相邻区间共享的首尾页留给它们自己处理
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t lo = (offset_ + static_cast<size_t>(begin) * row_bytes() + page - 1) / page * page;
+    const size_t hi = (offset_ + static_cast<size_t>(end) * row_bytes()) / page * page;
+    // 共享文件映射上的 MADV_DONTNEED 只解除页表映射，脏页仍留在页缓存中写回文件
+    if (lo < hi) ::madvise(base_ + lo, hi - lo, MADV_DONTNEED);
+#else
+    (void)begin; (void)end;
+#endif
+}
+
+bool MappedRaster::Flush() const {
+#if defined(IMGPROC_HAS_MMAP)
+    if (base_ == nullptr || !writable_) return false;
+    return ::msync(base_, map_size_, MS_SYNC) == 0;
+#else
+    return false;
+#endif
+}
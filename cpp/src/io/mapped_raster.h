@@ -0,0 +1,130 @@
+/**
+ * @file mapped_raster.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 内存映射的光栅文件：无文件头的原始像素或二进制 PGM/PPM（P5/P6），用于处理放不进内存的大图
+ * @version 0.1
+ * @date 2025-12-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 内存映射的光栅文件
+ *
+ * @details 把整个像素区映射到地址空间，Rows 返回建立在映射上的 cv::Mat 图像头，不拷贝像素，
+ * 访问到的页才会被读入。配合 Release 在处理完一块后归还该块的页，进程常驻内存只与块大小有关，
+ * 与图像大小无关。支持两种布局：
+ * - kRaw：没有文件头，按行紧密排列，像素类型由调用方给出，通道顺序与 cv::Mat 相同（BGR/BGRA）；
+ * - kPnm：二进制 P5（单通道）/ P6（三通道），最大值必须为 255。注意 P6 的通道顺序为 RGB。
+ *
+ * 只在 POSIX 系统上可用（mmap），其他平台上打开与创建都返回 false。映射不可拷贝，
+ * 由析构函数或 Close 解除；可写映射中写入的像素在解除映射后由系统写回文件。
+ */
+class MappedRaster {
+public:
+    enum class Format {
+        kRaw,   ///< 无文件头的原始像素
+        kPnm,   ///< 二进制 PGM / PPM
+    };
+
+    MappedRaster() = default;
+    ~MappedRaster();
+
+    MappedRaster(const MappedRaster&) = delete;
+    MappedRaster& operator=(const MappedRaster&) = delete;
+
+    /**
+     * @brief 当前平台是否支持内存映射
+     */
+    static bool Supported();
+
+    /**
+     * @brief 映射已有的原始像素文件，文件长度不能小于 width * height 个像素
+     *
+     * @param type 像素类型，CV_8U / CV_16U，1/3/4 通道
+     * @param writable 为 true 时可写
+     */
+    bool OpenRaw(const std::string& path, int width, int height, int type, bool writable = false);
+
+    /**
+     * @brief 映射已有的 P5 / P6 文件，尺寸与类型取自文件头
+     */
+    bool OpenPnm(const std::string& path, bool writable = false);
+
+    /**
+     * @brief 创建（或截断）原始像素文件并以可写方式映射，像素初始为 0
+     */
+    bool CreateRaw(const std::string& path, int width, int height, int type);
+
+    /**
+     * @brief 创建（或截断）P5 / P6 文件并以可写方式映射，像素初始为 0
+     *
+     * @param channels 1 时为 P5，3 时为 P6
+     */
+    bool CreatePnm(const std::string& path, int width, int height, int channels);
+
+    /**
+     * @brief 解除映射，未打开时什么也不做
+     */
+    void Close();
+
+    bool is_open() const { return base_ != nullptr; }
+    Format format() const { return format_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int type() const { return type_; }
+    bool writable() const { return writable_; }
+
+    /**
+     * @brief 三通道像素按 RGB 顺序存放（P6 文件）
+     */
+    bool rgb() const { return format_ == Format::kPnm && CV_MAT_CN(type_) == 3; }
+
+    /**
+     * @brief 每行的字节数
+     */
+    size_t row_bytes() const;
+
+    /**
+     * @brief 行 [begin, end) 上的图像头，不拷贝像素，映射解除后失效；未打开或区间非法时为空
+     *
+     * @details 只读映射上的图像头不能写入。
+     */
+    cv::Mat Rows(int begin, int end) const;
+
+    /**
+     * @brief 整幅图像的图像头，等价于 Rows(0, height())
+     */
+    cv::Mat Image() const { return Rows(0, height_); }
+
+    /**
+     * @brief 归还行 [begin, end) 完整覆盖的页，之后再访问会重新从文件读入
+     *
+     * @details 可写映射中已写入的内容不会丢失，由系统稍后写回文件。只是提示，不影响结果。
+     */
+    void Release(int begin, int end) const;
+
+    /**
+     * @brief 把可写映射中已写入的内容同步写回文件
+     */
+    bool Flush() const;
+
+private:
+    bool Map(const std::string& path, bool create, bool writable, size_t data_offset, size_t file_size);
+
+    uint8_t* base_ = nullptr;   ///< 映射起点（文件开头）
+    size_t map_size_ = 0;
+    size_t offset_ = 0;         ///< 像素区在文件中的偏移，即文件头长度
+    Format format_ = Format::kRaw;
+    int width_ = 0;
+    int height_ = 0;
+    int type_ = 0;
+    bool writable_ = false;
+};
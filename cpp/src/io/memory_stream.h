@@ -0,0 +1,55 @@
+/**
+ * @file memory_stream.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 只读内存流：让基于 std::istream 的解析器直接解析内存中的文件内容
+ * @version 0.1
+ * @date 2025-12-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <streambuf>
+
+/**
+ * @brief 建立在调用方内存上的只读 streambuf，不拷贝数据
+ *
+ * @details 数据在流的整个生命周期内必须保持有效。支持 tellg / seekg。
+ */
+class MemoryStreambuf : public std::streambuf {
+public:
+    MemoryStreambuf(const uint8_t* data, size_t size) {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if ((which & std::ios_base::in) == 0) return pos_type(off_type(-1));
+        char* base = dir == std::ios_base::beg ? eback() : (dir == std::ios_base::cur ? gptr() : egptr());
+        if (off < eback() - base || off > egptr() - base) return pos_type(off_type(-1));
+        setg(eback(), base + off, egptr());
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/**
+ * @brief 读取内存数据的 std::istream
+ */
+class MemoryIStream : public std::istream {
+public:
+    MemoryIStream(const uint8_t* data, size_t size) : std::istream(nullptr), buf_(data, size) {
+        rdbuf(&buf_);
+    }
+
+private:
+    MemoryStreambuf buf_;
+};
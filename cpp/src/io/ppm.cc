@@ -13,6 +13,10 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include "area_reducer.h"
+#include "memory_stream.h"
+#include "../common/stats.h"
 
 // 辅助函数：读取下一个有效的 token，跳过注释和空白
 static bool readToken(std::istream& is, std::string& tok) {
@@ -41,16 +45,29 @@ static bool readToken(std::istream& is, std::string& tok) {
     return !tok.empty();
 }
 
-// 读取 PPM 文件(P2 或 P3 格式) 为 cv::Mat
-cv::Mat Ppm::LoadPpmAsMat(const std::string& file_path) {
-    // 打开文件流，若打开失败则返回空 cv::Mat
-    std::ifstream ifs(file_path);
-    if (!ifs) return cv::Mat();
+// 辅助函数：读取二进制 PPM(P5 或 P6 格式) 的一行像素到 dst
+// - maxv < 256 时每个样本 1 字节，否则 2 字节大端
+// - 与文本格式相同，归一化到 0-255 并按 BGR 顺序存入
+static bool readBinaryRow(std::istream& is, int width, int channels, int maxv, std::vector<uint8_t>& raw, uint8_t* dst) {
+    const size_t samples = static_cast<size_t>(width) * channels;
+    const size_t bytes_per_sample = maxv < 256 ? 1 : 2;
+    raw.resize(samples * bytes_per_sample);
+    if (!is.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()))) return false;
+    for (size_t i = 0; i < samples; ++i) {
+        int v = bytes_per_sample == 1 ? raw[i] : (raw[2 * i] << 8) | raw[2 * i + 1];
+        if (v > maxv) v = maxv;
+        size_t c = i / channels, k = i % channels;
+        dst[c * channels + (channels - 1 - k)] = static_cast<uint8_t>(v * 255 / maxv);
+    }
+    return true;
+}
 
+// 从流中解析 PPM(P2、P3、P5 或 P6 格式) 为 cv::Mat，文件与内存共用
+static cv::Mat ParsePpm(std::istream& ifs) {
     // 读取魔术数字，如果读入异常或魔术数字不合法则返回空 cv::Mat
     std::string magic;
     if (!readToken(ifs, magic)) return cv::Mat();
-    if (magic != "P2" && magic != "P3") return cv::Mat();
+    if (magic != "P2" && magic != "P3" && magic != "P5" && magic != "P6") return cv::Mat();
 
     // 读取宽度、高度、最大像素值，读入异常或不合法则返回空 cv::Mat
     std::string wtok, htok, maxtok;
@@ -60,9 +77,18 @@ cv::Mat Ppm::LoadPpmAsMat(const std::string& file_path) {
     int width = std::stoi(wtok);
     int height = std::stoi(htok);
     int maxv = std::stoi(maxtok);
-    if (width <= 0 || height <= 0 || maxv <= 0) return cv::Mat();
+    if (width <= 0 || height <= 0 || maxv <= 0 || maxv > 65535) return cv::Mat();
 
-    if (magic == "P2") {
+    if (magic == "P5" || magic == "P6") {
+        // 二进制格式：maxv 后的单个空白已被 readToken 消耗，随后为逐行的像素数据
+        int channels = magic == "P5" ? 1 : 3;
+        cv::Mat img(height, width, CV_MAKETYPE(CV_8U, channels));
+        std::vector<uint8_t> raw;
+        for (int r = 0; r < height; ++r) {
+            if (!readBinaryRow(ifs, width, channels, maxv, raw, img.ptr<uint8_t>(r))) return cv::Mat();
+        }
+        return img;
+    } else if (magic == "P2") {
         cv::Mat img(height, width, CV_8UC1);
         for (int r = 0; r < height; ++r) {
             for (int c = 0; c < width; ++c) {
@@ -110,6 +136,88 @@ cv::Mat Ppm::LoadPpmAsMat(const std::string& file_path) {
     }
 }
 
+// 读取 PPM 文件(P2、P3、P5 或 P6 格式) 为 cv::Mat
+cv::Mat Ppm::LoadPpmAsMat(const std::string& file_path) {
+    STATS_SCOPE(kDecode);
+    // 打开文件流，若打开失败则返回空 cv::Mat；二进制格式要求以二进制方式打开
+    std::ifstream ifs(file_path, std::ios::binary);
+    if (!ifs) return cv::Mat();
+    return ParsePpm(ifs);
+}
+
+// 解析内存中的 PPM 文件内容
+cv::Mat Ppm::DecodePpm(const uint8_t* data, size_t size) {
+    STATS_SCOPE_BYTES(kDecode, size);
+    if (data == nullptr || size == 0) return cv::Mat();
+    MemoryIStream is(data, size);
+    return ParsePpm(is);
+}
+
+// 辅助函数：直接从 streambuf 读取下一个非负整数，跳过空白和注释，不构造临时字符串
+static bool readInt(std::streambuf* sb, int& value) {
+    int ch = sb->sbumpc();
+    while (ch != std::char_traits<char>::eof()) {
+        if (ch == '#') {
+            while (ch != std::char_traits<char>::eof() && ch != '\n') ch = sb->sbumpc();
+        } else if (!std::isspace(ch)) {
+            break;
+        } else {
+            ch = sb->sbumpc();
+        }
+    }
+    if (ch < '0' || ch > '9') return false;
+    int v = 0;
+    while (ch >= '0' && ch <= '9') {
+        v = v * 10 + (ch - '0');
+        ch = sb->sbumpc();
+    }
+    value = v;
+    return true;   // 数字后的一个分隔符已被消耗
+}
+
+// 读取 PPM 文件的缩小预览：逐行解析，每行立即送入区域平均缩小器
+cv::Mat Ppm::LoadPpmPreview(const std::string& file_path, int max_dim) {
+    std::ifstream ifs(file_path, std::ios::binary);
+    if (!ifs || max_dim <= 0) return cv::Mat();
+
+    // 文件头与 LoadPpmAsMat 相同
+    std::string magic, wtok, htok, maxtok;
+    if (!readToken(ifs, magic) || (magic != "P2" && magic != "P3" && magic != "P5" && magic != "P6")) return cv::Mat();
+    if (!readToken(ifs, wtok) || !readToken(ifs, htok) || !readToken(ifs, maxtok)) return cv::Mat();
+    int width = std::stoi(wtok);
+    int height = std::stoi(htok);
+    int maxv = std::stoi(maxtok);
+    if (width <= 0 || height <= 0 || maxv <= 0 || maxv > 65535) return cv::Mat();
+
+    bool binary = magic == "P5" || magic == "P6";
+    int channels = magic == "P2" || magic == "P5" ? 1 : 3;
+    AreaReducer reducer(width, height, AreaReducer::FitWithin(width, height, max_dim), CV_MAKETYPE(CV_8U, channels));
+    if (!reducer.valid()) return cv::Mat();
+
+    // 只缓存一行像素
+    std::vector<uint8_t> row(static_cast<size_t>(width) * channels);
+    std::vector<uint8_t> raw;
+    std::streambuf* sb = ifs.rdbuf();
+    for (int r = 0; r < height; ++r) {
+        if (binary) {
+            if (!readBinaryRow(ifs, width, channels, maxv, raw, row.data())) return cv::Mat();
+            reducer.PushRow(row.data());
+            continue;
+        }
+        for (int c = 0; c < width; ++c) {
+            // 文件中为 RGB，按 BGR 顺序存入
+            for (int k = 0; k < channels; ++k) {
+                int v;
+                if (!readInt(sb, v)) return cv::Mat();
+                if (v > maxv) v = maxv;
+                row[static_cast<size_t>(c) * channels + (channels - 1 - k)] = static_cast<uint8_t>(v * 255 / maxv);
+            }
+        }
+        reducer.PushRow(row.data());
+    }
+    return reducer.Finish();
+}
+
 // 保存 cv::Mat 为 PPM 格式
 bool Ppm::SaveNatAsPpm(const std::string& file_path, const cv::Mat& img) {
     // 打开文件流，若打开失败则返回 false
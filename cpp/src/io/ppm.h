@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <opencv2/opencv.hpp>
 
@@ -22,11 +24,25 @@
 class Ppm {
 public:
     /**
-     * @brief 读取 .ppm 文件(P2 或 P3 格式) 为 cv::Mat
+     * @brief 读取 .ppm 文件(P2、P3、P5 或 P6 格式) 为 cv::Mat
      * - 在读取数据时将 RGB 转换为 OpenCV 默认的 BGR 顺序
+     * - 结果总是 8 位，样本按 maxval 归一化到 0-255（二进制格式 maxval > 255 时每个样本 2 字节大端）
      */
     static cv::Mat LoadPpmAsMat(const std::string& file_path);
 
+    /**
+     * @brief 解析内存中的 .ppm 文件内容(P2、P3、P5 或 P6 格式)，结果与 LoadPpmAsMat 相同
+     * - data 只在调用期间使用，不拷贝
+     */
+    static cv::Mat DecodePpm(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 读取 .ppm 文件(P2、P3、P5 或 P6 格式) 的缩小预览，长边不超过 max_dim
+     * - 逐行解析（二进制格式逐行读取）并立即做区域平均，不分配完整尺寸的图像
+     * - max_dim 不小于原图长边时结果与 LoadPpmAsMat 相同
+     */
+    static cv::Mat LoadPpmPreview(const std::string& file_path, int max_dim);
+
     /**
      * @brief 手动保存为 .ppm 格式
      * - 输入 cv::Mat 格式图像 (CV_8UC1 或 CV_8UC3, 分别用 P2 或 P3 格式保存)
@@ -0,0 +1,96 @@
+/**
+ * @file async_image_loader.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批量加载图像实现
+ * @version 0.1
+ * @date 2025-12-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "async_image_loader.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include "image_file.h"
+
+AsyncImageLoader::AsyncImageLoader(AsyncLoadOptions options)
+    : options_(options), reader_(options.read), decoders_(options.decode_threads) {}
+
+size_t AsyncImageLoader::LoadAll(const std::vector<std::string>& paths, const Callback& on_loaded,
+                                 const std::atomic<bool>* cancel) {
+    if (paths.empty() || !on_loaded) return 0;
+
+    // 已读入但未解码完的文件数，达到上限时读取线程（即当前线程）等待
+    const size_t max_pending = std::max(options_.read.queue_depth, 1u);
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = 0;
+    std::atomic<size_t> decoded{0};
+
+    auto decode = [&](const std::shared_ptr<FileData>& data) {
+        LoadedImage loaded;
+        loaded.index = data->index;
+        const std::string& path = paths[data->index];
+        if (data->error != 0) {
+            loaded.error = "failed to read " + path + ": " + std::generic_category().message(data->error);
+        } else {
+            try {
+                loaded.img = ImageFile::Decode(path, data->bytes.data(), data->bytes.size());
+                if (loaded.img.empty()) {
+                    loaded.error = "failed to decode " + path;
+                } else {
+                    ++decoded;
+                }
+            } catch (const std::exception& e) {
+                loaded.error = e.what();
+            }
+        }
+        data->bytes = std::vector<uint8_t>();   // 先释放文件内容再回调
+        on_loaded(loaded);
+    };
+
+    try {
+        reader_.ReadAll(paths, [&](FileData& file) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return pending < max_pending; });
+                ++pending;
+            }
+            // ThreadPool 的任务须可拷贝，文件内容放进 shared_ptr 移交给解码线程
+            auto data = std::make_shared<FileData>(std::move(file));
+            decoders_.Submit([&, data] {
+                try {
+                    decode(data);
+                } catch (...) {
+                    // 回调抛出的异常与 ThreadPool 的约定一样被吞掉，计数照常归还
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --pending;
+                }
+                cv.notify_one();
+            });
+        }, cancel);
+    } catch (...) {
+        decoders_.Wait();
+        throw;
+    }
+    decoders_.Wait();
+    return decoded.load();
+}
+
+std::vector<cv::Mat> AsyncImageLoader::LoadAll(const std::vector<std::string>& paths, std::vector<std::string>* errors) {
+    std::vector<cv::Mat> images(paths.size());
+    if (errors != nullptr) errors->assign(paths.size(), std::string());
+    // 每个回调只写自己的下标，互不冲突
+    LoadAll(paths, [&](LoadedImage& loaded) {
+        images[loaded.index] = std::move(loaded.img);
+        if (errors != nullptr) (*errors)[loaded.index] = std::move(loaded.error);
+    });
+    return images;
+}
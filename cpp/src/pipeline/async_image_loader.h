@@ -0,0 +1,84 @@
+/**
+ * @file async_image_loader.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批量加载图像：异步读文件，每个文件读完立即在解码线程中解码
+ * @version 0.1
+ * @date 2025-12-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "../common/thread_pool.h"
+#include "../io/async_file_reader.h"
+
+/**
+ * @brief 批量加载参数
+ */
+struct AsyncLoadOptions {
+    AsyncReadOptions read;      ///< 读文件的后端与队列深度
+    int decode_threads = 0;     ///< 解码线程数，<= 0 时使用硬件并发数
+};
+
+/**
+ * @brief 一个文件的加载结果
+ */
+struct LoadedImage {
+    size_t index = 0;       ///< 在请求列表中的下标
+    cv::Mat img;            ///< 失败时为空
+    std::string error;      ///< 失败原因，成功时为空
+};
+
+/**
+ * @brief 批量加载图像
+ *
+ * @details 由 AsyncFileReader 同时读取多个文件（Linux 上为 io_uring），每个文件的内容一到，
+ * 立即交给解码线程按扩展名在内存中解码（见 ImageFile::Decode：PNG 走 ImageIO::DecodeFromBuffer，
+ * PPM/PGM 与 .trip 走各自的内存解析器），读盘与解码同时进行。
+ * 已读入但未解码的文件不超过 read.queue_depth 个，解码跟不上时读取会暂停。
+ * 不经过 ImageCache。同一个加载器不能在多个线程中同时调用 LoadAll。
+ */
+class AsyncImageLoader {
+public:
+    /**
+     * @brief 加载回调，在解码线程中调用，不同文件的回调可能并发，不应抛出异常
+     */
+    using Callback = std::function<void(LoadedImage&)>;
+
+    explicit AsyncImageLoader(AsyncLoadOptions options = AsyncLoadOptions());
+
+    /**
+     * @brief 读文件实际使用的后端
+     */
+    AsyncFileReader::Backend backend() const { return reader_.backend(); }
+
+    /**
+     * @brief 加载全部文件，阻塞直到所有回调结束
+     *
+     * @param paths 文件路径，格式由扩展名决定
+     * @param on_loaded 每个文件加载（或失败）后调用一次
+     * @param cancel 取消标志，置为 true 后不再读取新文件，可为 nullptr
+     * @return 成功解码的文件数（读取或解码失败的文件同样回调，但不计入）
+     */
+    size_t LoadAll(const std::vector<std::string>& paths, const Callback& on_loaded,
+                   const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief 加载全部文件，按输入顺序返回，失败的位置为空 cv::Mat
+     *
+     * @param errors 不为空时按输入顺序写入每个文件的错误信息，成功时为空字符串
+     */
+    std::vector<cv::Mat> LoadAll(const std::vector<std::string>& paths, std::vector<std::string>* errors = nullptr);
+
+private:
+    AsyncLoadOptions options_;
+    AsyncFileReader reader_;
+    ThreadPool decoders_;
+};
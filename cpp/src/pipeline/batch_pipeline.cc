@@ -0,0 +1,171 @@
+/**
+ * @file batch_pipeline.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批处理流水线实现
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "batch_pipeline.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include "../common/scratch.h"
+#include "../common/thread_pool.h"
+#include "image_file.h"
+
+namespace {
+
+/**
+ * @brief 在途像素字节数的计数与等待
+ */
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t limit) : limit_(limit) {}
+
+    // 预算用尽时等待；没有在途字节时总是放行
+    void WaitForRoom() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return in_flight_ == 0 || in_flight_ < limit_; });
+    }
+
+    void Charge(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_ += bytes;
+    }
+
+    void Release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_ -= bytes;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t limit_;
+    size_t in_flight_ = 0;
+};
+
+size_t PixelBytes(const cv::Mat& img) {
+    return img.total() * img.elemSize();
+}
+
+}  // namespace
+
+BatchPipeline::BatchPipeline(BatchOptions options) : options_(options) {}
+
+BatchResult BatchPipeline::Run(const std::vector<BatchJob>& jobs,
+                               const EventCallback& on_event,
+                               const std::atomic<bool>* cancel) const {
+    BatchResult result;
+    result.errors.resize(jobs.size());
+    if (jobs.empty()) return result;
+
+    MemoryBudget budget(options_.memory_budget);
+    std::mutex result_mutex;
+    std::atomic<bool> skipped{false};
+    size_t completed = 0;
+
+    // 记录作业结束并发出事件；completed 在锁内递增，保证事件中的计数单调
+    auto finish = [&](size_t index, BatchEvent::Type type, std::string error) {
+        BatchEvent ev;
+        ev.type = type;
+        ev.index = index;
+        ev.total = jobs.size();
+        {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (type == BatchEvent::Type::kFinished) {
+                ++result.succeeded;
+            } else if (type == BatchEvent::Type::kFailed) {
+                ++result.failed;
+                result.errors[index] = error;
+            }
+            ev.completed = ++completed;
+        }
+        ev.message = std::move(error);
+        if (on_event) on_event(ev);
+    };
+
+    auto cancelled = [cancel] { return cancel != nullptr && cancel->load(); };
+
+    {
+        ThreadPool pool(options_.concurrency);
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            pool.Submit([&, i] {
+                if (cancelled()) { skipped = true; return; }
+                const BatchJob& job = jobs[i];
+                if (on_event) {
+                    BatchEvent ev;
+                    ev.type = BatchEvent::Type::kStarted;
+                    ev.index = i;
+                    ev.total = jobs.size();
+                    on_event(ev);
+                }
+
+                budget.WaitForRoom();
+                if (cancelled()) {
+                    // 等待预算期间被取消
+                    skipped = true;
+                    finish(i, BatchEvent::Type::kCancelled, std::string());
+                    return;
+                }
+
+                size_t charged = 0;
+                bool aborted = false;
+                std::string error;
+                try {
+                    // 解码
+                    cv::Mat img = ImageFile::Load(job.input);
+                    if (img.empty()) {
+                        error = "failed to load " + job.input;
+                    } else {
+                        charged = PixelBytes(img);
+                        budget.Charge(charged);
+
+                        // 处理；输出与输入同时驻留，输出另行计入预算（原地结果不重复计）
+                        size_t step = 0;
+                        cv::Mat out = Operation::ApplyAll(job.ops, img, &step);
+                        if (!out.empty() && out.datastart != img.datastart) {
+                            size_t out_bytes = PixelBytes(out);
+                            budget.Charge(out_bytes);
+                            img.release();
+                            budget.Release(charged);
+                            charged = out_bytes;
+                        }
+                        if (out.empty()) {
+                            error = "operation " + std::to_string(step) + " (" + job.ops[step].Name() + ") failed";
+                        } else if ((aborted = cancelled())) {
+                            // 处理期间被取消，不再写出
+                        } else if (!ImageFile::Save(job.output, out)) {
+                            // 编码保存
+                            error = "failed to save " + job.output;
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+                if (charged > 0) budget.Release(charged);
+                BatchEvent::Type type = BatchEvent::Type::kFinished;
+                if (aborted) {
+                    skipped = true;
+                    type = BatchEvent::Type::kCancelled;
+                } else if (!error.empty()) {
+                    type = BatchEvent::Type::kFailed;
+                }
+                finish(i, type, std::move(error));
+                // 作业之间归还超大图像留下的暂存区
+                ScratchPool::Trim();
+            });
+        }
+        pool.Wait();
+    }
+
+    result.cancelled = skipped.load();
+    return result;
+}
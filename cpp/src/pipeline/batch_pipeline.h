@@ -0,0 +1,104 @@
+/**
+ * @file batch_pipeline.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 多文件批处理流水线：解码 -> 处理 -> 编码保存，在线程池中并行执行
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "operation.h"
+
+/**
+ * @brief 一个批处理作业：读取 input，依次执行 ops，保存到 output
+ *
+ * @details 输入输出格式由扩展名决定（见 ImageFile）。
+ */
+struct BatchJob {
+    std::string input;
+    std::string output;
+    std::vector<Operation> ops;
+};
+
+/**
+ * @brief 批处理参数
+ */
+struct BatchOptions {
+    int concurrency = 0;                            ///< 并行作业数，<= 0 时使用硬件并发数
+    size_t memory_budget = size_t(512) << 20;       ///< 同时驻留的解码像素字节数上限
+};
+
+/**
+ * @brief 批处理事件，在工作线程中回调
+ */
+struct BatchEvent {
+    enum class Type {
+        kStarted,   ///< 作业开始
+        kFinished,  ///< 作业成功完成
+        kFailed,    ///< 作业失败，message 为原因
+        kCancelled, ///< 作业已开始但因取消而中止，未写出结果
+    };
+
+    Type type = Type::kStarted;
+    size_t index = 0;       ///< 作业下标
+    size_t completed = 0;   ///< 事件发生时已结束（成功、失败或中止）的作业数
+    size_t total = 0;       ///< 作业总数
+    std::string message;
+};
+
+/**
+ * @brief 批处理结果
+ */
+struct BatchResult {
+    size_t succeeded = 0;
+    size_t failed = 0;
+    bool cancelled = false;             ///< 是否因取消而跳过了部分作业
+    std::vector<std::string> errors;    ///< 每个作业的错误信息，成功或被跳过时为空
+};
+
+/**
+ * @brief 批处理流水线
+ *
+ * @details 每个作业作为一个任务提交到线程池，在任务内依次解码、处理、编码保存。
+ * 多个作业同时处于不同阶段，解码、计算与写盘在各线程间自然重叠，可以占满全部核心。
+ *
+ * 背压：在途像素字节数（解码出的输入与处理得到的输出，二者共享内存时只计一次）达到
+ * memory_budget 后，新的作业在解码前等待，直到有作业释放内存。解码前无法得知图像大小，
+ * 因此实际峰值最多超出预算 concurrency 张图像；只有一个作业在途时总是放行，
+ * 单张超大图像不会死锁。处理步骤内部的临时缓冲不计入预算。
+ *
+ * 每个发出了 kStarted 的作业都恰好再发出一个 kFinished、kFailed 或 kCancelled 事件。
+ */
+class BatchPipeline {
+public:
+    /**
+     * @brief 事件回调，会被多个工作线程并发调用，实现必须线程安全
+     */
+    using EventCallback = std::function<void(const BatchEvent&)>;
+
+    explicit BatchPipeline(BatchOptions options = BatchOptions());
+
+    /**
+     * @brief 执行全部作业，阻塞直到结束
+     *
+     * @param jobs 作业列表
+     * @param on_event 事件回调，可为空
+     * @param cancel 取消标志，置为 true 后尚未开始的作业被跳过，
+     *               进行中的作业在下一个阶段边界中止，可为 nullptr
+     * @return BatchResult 统计结果
+     */
+    BatchResult Run(const std::vector<BatchJob>& jobs,
+                    const EventCallback& on_event = EventCallback(),
+                    const std::atomic<bool>* cancel = nullptr) const;
+
+private:
+    BatchOptions options_;
+};
@@ -0,0 +1,63 @@
+/**
+ * @file image_file.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 按扩展名选择格式的图像文件读写实现
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "image_file.h"
+#include <cctype>
+#include "../codec/compressor.h"
+#include "../io/image_io.h"
+#include "../io/ppm.h"
+
+// 不区分大小写的后缀判断，suffix 须为小写
+static bool EndsWith(const std::string& s, const std::string& suffix) {
+    if (s.size() < suffix.size()) return false;
+    size_t off = s.size() - suffix.size();
+    for (size_t i = 0; i < suffix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[off + i])) != suffix[i]) return false;
+    }
+    return true;
+}
+
+ImageFile::Format ImageFile::FormatOf(const std::string& file_path) {
+    if (EndsWith(file_path, ".png")) return Format::kPng;
+    if (EndsWith(file_path, ".ppm") || EndsWith(file_path, ".pgm")) return Format::kPpm;
+    if (EndsWith(file_path, ".trip")) return Format::kTrip;
+    return Format::kUnknown;
+}
+
+cv::Mat ImageFile::Load(const std::string& file_path) {
+    switch (FormatOf(file_path)) {
+        case Format::kPng: return ImageIO::LoadPng(file_path);
+        case Format::kPpm: return ImageIO::LoadPpm(file_path);
+        case Format::kTrip: return Compressor::Load(file_path);
+        case Format::kUnknown: break;
+    }
+    return cv::Mat();
+}
+
+cv::Mat ImageFile::Decode(const std::string& file_path, const uint8_t* data, size_t size, TripletArena* arena) {
+    switch (FormatOf(file_path)) {
+        case Format::kPng: return ImageIO::DecodeFromBuffer(data, size);
+        case Format::kPpm: return Ppm::DecodePpm(data, size);
+        case Format::kTrip: return Compressor::LoadFromBuffer(data, size, arena);
+        case Format::kUnknown: break;
+    }
+    return cv::Mat();
+}
+
+bool ImageFile::Save(const std::string& file_path, const cv::Mat& img) {
+    switch (FormatOf(file_path)) {
+        case Format::kPng: return ImageIO::SavePng(file_path, img);
+        case Format::kPpm: return ImageIO::SavePpm(file_path, img);
+        case Format::kTrip: return Compressor::Save(file_path, img);
+        case Format::kUnknown: break;
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file image_file.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 按扩展名选择格式的图像文件读写
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <opencv2/core/mat.hpp>
+#include "../data_structure/triplet_buffer.h"
+
+/**
+ * @brief 按扩展名在 ImageIO（.png / .ppm / .pgm）与 Compressor（.trip）之间分派
+ */
+class ImageFile {
+public:
+    enum class Format { kUnknown, kPng, kPpm, kTrip };
+
+    /**
+     * @brief 由扩展名（不区分大小写）确定格式
+     */
+    static Format FormatOf(const std::string& file_path);
+
+    /**
+     * @brief 加载图像，格式未知或读取失败时返回空 cv::Mat
+     */
+    static cv::Mat Load(const std::string& file_path);
+
+    /**
+     * @brief 按 file_path 的扩展名解码已读入内存的文件内容，不经过 ImageCache
+     *
+     * @param file_path 只用于确定格式
+     * @param data 文件内容，只在调用期间使用
+     * @param size 文件内容长度
+     * @param arena .trip 解码使用的内存池，可为 nullptr
+     * @return 格式未知或解码失败时返回空 cv::Mat
+     */
+    static cv::Mat Decode(const std::string& file_path, const uint8_t* data, size_t size, TripletArena* arena = nullptr);
+
+    /**
+     * @brief 保存图像，格式未知或写入失败时返回 false
+     */
+    static bool Save(const std::string& file_path, const cv::Mat& img);
+};
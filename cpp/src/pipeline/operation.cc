@@ -0,0 +1,48 @@
+/**
+ * @file operation.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 图像处理步骤实现
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "operation.h"
+#include "../imgproc/image_processor.h"
+
+cv::Mat Operation::Apply(const cv::Mat& img) const {
+    switch (kind) {
+        case Kind::kGray:
+            // 单通道已是灰度，共享输入即可
+            return img.channels() == 1 ? img : Processor::ToGray(img);
+        case Kind::kResize:
+            return Processor::Resize(img, width, height, interpolation);
+        case Kind::kCrop:
+            // 视图与输入共享像素，后续步骤按行步长读取，只触及裁剪区域
+            return Processor::Crop(img, cv::Rect(x, y, width, height));
+    }
+    return cv::Mat();
+}
+
+std::string Operation::Name() const {
+    switch (kind) {
+        case Kind::kGray: return "gray";
+        case Kind::kResize: return "resize";
+        case Kind::kCrop: return "crop";
+    }
+    return "unknown";
+}
+
+cv::Mat Operation::ApplyAll(const std::vector<Operation>& ops, const cv::Mat& img, size_t* failed_step) {
+    cv::Mat cur = img;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        cur = ops[i].Apply(cur);
+        if (cur.empty()) {
+            if (failed_step) *failed_step = i;
+            return cv::Mat();
+        }
+    }
+    return cur;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file operation.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 可组合的图像处理步骤描述
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "../imgproc/image_processor.h"
+
+/**
+ * @brief 一个图像处理步骤，对应 Processor 的一个操作
+ *
+ * @details 批处理、命令行工具等场景用一串 Operation 描述处理流程，
+ * 在工作线程中依次作用于解码后的图像。
+ */
+struct Operation {
+    enum class Kind {
+        kGray,      ///< 灰度化，单通道输入原样通过
+        kResize,    ///< 按 interpolation 缩放到 width x height
+        kCrop,      ///< 裁剪出 (x, y, width, height) 区域的视图，不拷贝像素
+    };
+
+    Kind kind = Kind::kGray;
+    int width = 0;
+    int height = 0;
+    Processor::Interpolation interpolation = Processor::Interpolation::kBilinear;
+    int x = 0;
+    int y = 0;
+
+    static Operation Gray() { return Operation{Kind::kGray, 0, 0}; }
+    static Operation Resize(int w, int h, Processor::Interpolation mode = Processor::Interpolation::kBilinear) {
+        return Operation{Kind::kResize, w, h, mode};
+    }
+    static Operation Crop(int x, int y, int w, int h) {
+        return Operation{Kind::kCrop, w, h, Processor::Interpolation::kBilinear, x, y};
+    }
+
+    /**
+     * @brief 作用于图像，参数非法或类型不支持时返回空 cv::Mat
+     */
+    cv::Mat Apply(const cv::Mat& img) const;
+
+    /**
+     * @brief 步骤名称，用于错误消息
+     */
+    std::string Name() const;
+
+    /**
+     * @brief 依次执行全部步骤
+     *
+     * @param ops 处理步骤
+     * @param img 输入图像
+     * @param failed_step 失败时写入失败步骤的下标，可为 nullptr
+     * @return cv::Mat 结果图像，任一步骤失败时为空
+     */
+    static cv::Mat ApplyAll(const std::vector<Operation>& ops, const cv::Mat& img, size_t* failed_step = nullptr);
+};
@@ -0,0 +1,337 @@
+/**
+ * @file sequence_pipeline.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 帧序列流水线实现
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "sequence_pipeline.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include "../common/bounded_queue.h"
+#include "../common/scratch.h"
+#include "../common/thread_pool.h"
+#include "../io/image_io.h"
+#include "image_file.h"
+
+namespace {
+
+/**
+ * @brief 读入阶段交给处理阶段的一帧
+ */
+struct Frame {
+    size_t index = 0;
+    cv::Mat img;
+    std::string error;
+};
+
+/**
+ * @brief 处理阶段交给写出阶段的结果，按 index % max_in_flight 放入槽位
+ *
+ * @details ready 由处理线程以 release 置位、写出线程以 acquire 读取，
+ * 槽位里的其余字段随之交接。
+ */
+struct Slot {
+    std::atomic<bool> ready{false};
+    cv::Mat img;                    ///< 待写出的图像，encoded 非空时为空
+    std::vector<uint8_t> encoded;   ///< 已在处理线程中编码好的文件内容
+    std::string output;
+    std::string error;
+};
+
+// '*' 匹配任意个字符，'?' 匹配单个字符
+bool WildcardMatch(const char* pat, const char* s) {
+    const char* star = nullptr;
+    const char* retry = nullptr;
+    while (*s) {
+        if (*pat == '?' || (*pat != '*' && *pat == *s)) {
+            ++pat;
+            ++s;
+        } else if (*pat == '*') {
+            star = pat++;
+            retry = s;
+        } else if (star) {
+            pat = star + 1;
+            s = ++retry;
+        } else {
+            return false;
+        }
+    }
+    while (*pat == '*') ++pat;
+    return *pat == '\0';
+}
+
+// 自然顺序：数字段按数值比较，frame_2 排在 frame_10 之前
+bool NaturalLess(const std::string& a, const std::string& b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        bool da = std::isdigit(static_cast<unsigned char>(a[i])) != 0;
+        bool db = std::isdigit(static_cast<unsigned char>(b[j])) != 0;
+        if (da && db) {
+            size_t ei = i, ej = j;
+            while (ei < a.size() && std::isdigit(static_cast<unsigned char>(a[ei]))) ++ei;
+            while (ej < b.size() && std::isdigit(static_cast<unsigned char>(b[ej]))) ++ej;
+            // 去掉前导零后先比长度再逐位比较，不受整数范围限制
+            size_t zi = i, zj = j;
+            while (zi + 1 < ei && a[zi] == '0') ++zi;
+            while (zj + 1 < ej && b[zj] == '0') ++zj;
+            if (ei - zi != ej - zj) return ei - zi < ej - zj;
+            int cmp = a.compare(zi, ei - zi, b, zj, ej - zj);
+            if (cmp != 0) return cmp < 0;
+            i = ei;
+            j = ej;
+        } else {
+            if (a[i] != b[j]) return a[i] < b[j];
+            ++i;
+            ++j;
+        }
+    }
+    if (a.size() - i != b.size() - j) return a.size() - i < b.size() - j;
+    return a < b;
+}
+
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs) return false;
+    ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(ofs);
+}
+
+}  // namespace
+
+SequencePipeline::SequencePipeline(SequenceOptions options) : options_(options) {}
+
+std::vector<std::string> SequencePipeline::Glob(const std::string& pattern) {
+    namespace fs = std::filesystem;
+    fs::path p(pattern);
+    fs::path dir = p.parent_path();
+    std::string name = p.filename().string();
+
+    std::vector<std::string> names;
+    std::error_code ec;
+    fs::directory_iterator it(dir.empty() ? fs::path(".") : dir, ec);
+    if (ec) return {};
+    for (const fs::directory_entry& entry : it) {
+        if (!entry.is_regular_file(ec)) continue;
+        std::string file = entry.path().filename().string();
+        if (WildcardMatch(name.c_str(), file.c_str())) names.push_back(file);
+    }
+    std::sort(names.begin(), names.end(), NaturalLess);
+
+    std::vector<std::string> paths;
+    paths.reserve(names.size());
+    for (const std::string& file : names) paths.push_back(dir.empty() ? file : (dir / file).string());
+    return paths;
+}
+
+std::string SequencePipeline::FrameName(const std::string& pattern, long long number) {
+    std::string out;
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != '%') {
+            out += pattern[i];
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+        // %[0][width]d
+        size_t j = i + 1;
+        bool zero = j < pattern.size() && pattern[j] == '0';
+        if (zero) ++j;
+        int width = 0;
+        while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j])) && width < 100) {
+            width = width * 10 + (pattern[j] - '0');
+            ++j;
+        }
+        if (j >= pattern.size() || pattern[j] != 'd' || width >= 100) return std::string();
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), zero ? "%0*lld" : "%*lld", width, number);
+        out += buf;
+        ++conversions;
+        i = j;
+    }
+    return conversions == 1 ? out : std::string();
+}
+
+SequenceResult SequencePipeline::Run(const std::vector<std::string>& frames,
+                                     const std::vector<Operation>& ops,
+                                     const std::string& output_pattern,
+                                     const EventCallback& on_event,
+                                     const std::atomic<bool>* cancel) const {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const size_t total = frames.size();
+
+    SequenceResult result;
+    result.errors.resize(total);
+    if (total == 0) return result;
+    if (FrameName(output_pattern, options_.start_number).empty()) {
+        for (std::string& e : result.errors) e = "invalid output pattern " + output_pattern;
+        result.failed = total;
+        return result;
+    }
+
+    const size_t depth = std::max<size_t>(options_.max_in_flight, 1);
+    const int workers = ThreadPool::ResolveThreads(options_.workers);
+    const bool pre_encode = ImageFile::FormatOf(output_pattern) == ImageFile::Format::kPng;
+    auto cancelled = [cancel] { return cancel != nullptr && cancel->load(); };
+
+    BoundedQueue<Frame> decoded(depth);
+    std::unique_ptr<Slot[]> slots(new Slot[depth]);
+    std::atomic<size_t> read_count{0};      // 已交给处理阶段的帧数
+    std::atomic<size_t> written{0};         // 已由写出阶段结束的帧数
+    std::atomic<bool> reader_done{false};
+    std::atomic<bool> stop{false};          // 写出阶段异常退出时通知其他阶段
+
+    // 读入阶段：按帧序解码；第 i 帧要等第 i - depth 帧写出后才读入
+    std::thread reader([&] {
+        Backoff backoff;
+        for (size_t i = 0; i < total && !stop.load(); ++i) {
+            while (i >= written.load(std::memory_order_acquire) + depth && !stop.load()) backoff.Wait();
+            backoff.Reset();
+            if (cancelled() || stop.load()) break;
+
+            Frame frame;
+            frame.index = i;
+            try {
+                frame.img = ImageFile::Load(frames[i]);
+                if (frame.img.empty()) frame.error = "failed to load " + frames[i];
+            } catch (const std::exception& e) {
+                frame.error = e.what();
+            }
+            // 在途帧数不超过 depth，队列容量足够，这里不会长时间等待
+            while (!decoded.TryPush(frame)) backoff.Wait();
+            backoff.Reset();
+            read_count.store(i + 1, std::memory_order_release);
+        }
+        reader_done.store(true, std::memory_order_release);
+    });
+
+    // 处理阶段：并行执行处理步骤，结果放入对应槽位
+    auto process = [&](Frame& frame) {
+        Slot& slot = slots[frame.index % depth];
+        slot.output = FrameName(output_pattern, options_.start_number + static_cast<long long>(frame.index));
+        slot.error = std::move(frame.error);
+        if (slot.error.empty()) {
+            try {
+                size_t step = 0;
+                cv::Mat out = Operation::ApplyAll(ops, frame.img, &step);
+                frame.img.release();
+                if (out.empty()) {
+                    slot.error = "operation " + std::to_string(step) + " (" + ops[step].Name() + ") failed";
+                } else if (pre_encode) {
+                    if (!ImageIO::EncodeToBuffer(out, "png", &slot.encoded)) slot.error = "failed to encode " + slot.output;
+                } else {
+                    slot.img = out;
+                }
+            } catch (const std::exception& e) {
+                slot.error = e.what();
+            }
+        }
+        frame.img.release();
+        slot.ready.store(true, std::memory_order_release);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&] {
+            Backoff backoff;
+            Frame frame;
+            for (;;) {
+                // 先读 reader_done 再尝试出队：读入已结束且队列为空才能退出
+                bool done = reader_done.load(std::memory_order_acquire);
+                if (decoded.TryPop(frame)) {
+                    process(frame);
+                    ScratchPool::Trim();
+                    backoff.Reset();
+                } else if (done || stop.load()) {
+                    break;
+                } else {
+                    backoff.Wait();
+                }
+            }
+        });
+    }
+
+    // 写出阶段：在当前线程按帧序写出并回调
+    auto elapsed = [&] { return std::chrono::duration<double>(Clock::now() - start).count(); };
+    try {
+        Backoff backoff;
+        size_t next = 0;
+        for (;;) {
+            bool done = reader_done.load(std::memory_order_acquire);
+            if (next >= read_count.load(std::memory_order_acquire)) {
+                if (done) break;
+                backoff.Wait();
+                continue;
+            }
+            Slot& slot = slots[next % depth];
+            if (!slot.ready.load(std::memory_order_acquire)) {
+                backoff.Wait();
+                continue;
+            }
+            backoff.Reset();
+
+            std::string error = std::move(slot.error);
+            if (error.empty()) {
+                bool ok = slot.img.empty() ? WriteFile(slot.output, slot.encoded) : ImageFile::Save(slot.output, slot.img);
+                if (!ok) error = "failed to save " + slot.output;
+            }
+            SequenceEvent ev;
+            ev.index = next;
+            ev.total = total;
+            ev.output = std::move(slot.output);
+            slot.img.release();
+            slot.encoded.clear();   // 保留容量，供之后落在同一槽位的帧复用
+            slot.error.clear();
+            slot.ready.store(false, std::memory_order_relaxed);
+            written.store(next + 1, std::memory_order_release);
+            ++next;
+
+            if (error.empty()) {
+                ++result.written;
+            } else {
+                ++result.failed;
+                result.errors[ev.index] = error;
+            }
+            if (on_event) {
+                ev.type = error.empty() ? SequenceEvent::Type::kWritten : SequenceEvent::Type::kFailed;
+                ev.completed = next;
+                double secs = elapsed();
+                ev.fps = secs > 0.0 ? result.written / secs : 0.0;
+                ev.message = std::move(error);
+                on_event(ev);
+            }
+        }
+    } catch (...) {
+        // 回调抛出异常：通知其他阶段退出后再向上传播
+        stop.store(true);
+        reader.join();
+        for (std::thread& t : pool) t.join();
+        throw;
+    }
+
+    reader.join();
+    for (std::thread& t : pool) t.join();
+
+    result.cancelled = result.written + result.failed < total;
+    result.seconds = elapsed();
+    result.fps = result.seconds > 0.0 ? result.written / result.seconds : 0.0;
+    return result;
+}
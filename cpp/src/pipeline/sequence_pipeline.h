@@ -0,0 +1,117 @@
+/**
+ * @file sequence_pipeline.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 帧序列流水线：预读解码、并行处理、按序写出三级流水
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "operation.h"
+
+/**
+ * @brief 帧序列处理参数
+ */
+struct SequenceOptions {
+    int workers = 0;            ///< 处理线程数，<= 0 时使用硬件并发数
+    size_t max_in_flight = 8;   ///< 已读入但尚未写出的帧数上限，0 按 1 处理
+    long long start_number = 1; ///< 输出文件名模式中第一帧的编号
+};
+
+/**
+ * @brief 帧写出事件，按帧序在调用 Run 的线程中回调
+ */
+struct SequenceEvent {
+    enum class Type {
+        kWritten,   ///< 帧已写出
+        kFailed,    ///< 帧失败（读入、处理或写出），message 为原因
+    };
+
+    Type type = Type::kWritten;
+    size_t index = 0;       ///< 帧下标
+    size_t completed = 0;   ///< 已结束（写出或失败）的帧数
+    size_t total = 0;       ///< 帧总数
+    double fps = 0.0;       ///< 从开始到当前的平均帧率
+    std::string output;     ///< 输出文件路径
+    std::string message;
+};
+
+/**
+ * @brief 帧序列处理结果
+ */
+struct SequenceResult {
+    size_t written = 0;
+    size_t failed = 0;
+    bool cancelled = false;             ///< 是否因取消而跳过了后续帧
+    double seconds = 0.0;               ///< 总耗时
+    double fps = 0.0;                   ///< 写出帧数 / 总耗时
+    std::vector<std::string> errors;    ///< 每帧的错误信息，成功或被跳过时为空
+};
+
+/**
+ * @brief 帧序列流水线
+ *
+ * @details 与 BatchPipeline 把每个文件作为独立作业不同，这里把整个序列拆成三级流水：
+ * - 读入线程按帧序预读并解码；
+ * - workers 个处理线程并行执行处理步骤；PNG 输出在这里按 ImageIO::EncodeOptions 的默认参数
+ *   预先编码到内存，写出阶段只剩写盘；
+ * - 调用 Run 的线程按帧序写出，写盘与后续帧的解码、计算同时进行。
+ *
+ * 阶段之间通过无锁有界队列（BoundedQueue）和按帧号取模的重排槽位交接，不使用互斥锁。
+ * 在途帧数不超过 max_in_flight：读入线程在第 i 帧写出之前不会读入第 i + max_in_flight 帧，
+ * 因此内存占用有界，慢速磁盘会反压到解码阶段。
+ *
+ * 单帧失败不会中断序列，对应输出被跳过并记录错误。
+ */
+class SequencePipeline {
+public:
+    /**
+     * @brief 事件回调，只在调用 Run 的线程中按帧序调用
+     */
+    using EventCallback = std::function<void(const SequenceEvent&)>;
+
+    explicit SequencePipeline(SequenceOptions options = SequenceOptions());
+
+    /**
+     * @brief 展开文件名通配符，按自然顺序（数字段按数值比较）排序
+     *
+     * @details 只有最后一级文件名可以含 '*'（任意个字符）和 '?'（单个字符），
+     * 目录部分按原样使用。目录不存在或没有匹配时返回空列表。
+     */
+    static std::vector<std::string> Glob(const std::string& pattern);
+
+    /**
+     * @brief 按 printf 风格的模式生成第 number 帧的文件名
+     *
+     * @details 模式中必须恰好有一个 %d，可带宽度和补零（如 %05d），"%%" 表示字面的 '%'。
+     * 模式不合法时返回空字符串。
+     */
+    static std::string FrameName(const std::string& pattern, long long number);
+
+    /**
+     * @brief 处理整个序列，阻塞直到结束
+     *
+     * @param frames 输入帧路径，按顺序处理，格式由扩展名决定（见 ImageFile）
+     * @param ops 每帧依次执行的处理步骤
+     * @param output_pattern 输出文件名模式，第 i 帧的编号为 start_number + i
+     * @param on_event 事件回调，可为空
+     * @param cancel 取消标志，置为 true 后不再读入新帧，已读入的帧照常写出，可为 nullptr
+     * @return SequenceResult 统计结果；模式不合法时全部帧失败
+     */
+    SequenceResult Run(const std::vector<std::string>& frames,
+                       const std::vector<Operation>& ops,
+                       const std::string& output_pattern,
+                       const EventCallback& on_event = EventCallback(),
+                       const std::atomic<bool>* cancel = nullptr) const;
+
+private:
+    SequenceOptions options_;
+};
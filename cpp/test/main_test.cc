@@ -12,6 +12,13 @@
 int test_io();
 int test_codec();
 int test_imgproc();
+int test_pipeline();
+int test_sequence();
+int test_image_cache();
+int test_preview();
+int test_buffer_codec();
+int test_stats();
+int test_memory();
 
 static int test_integration() {
     int failed = 0;
@@ -44,6 +51,20 @@ int main() {
     failed += test_codec();
     std::cout << "[RUN] ImgProc tests..." << std::endl;
     failed += test_imgproc();
+    std::cout << "[RUN] Pipeline tests..." << std::endl;
+    failed += test_pipeline();
+    std::cout << "[RUN] Sequence tests..." << std::endl;
+    failed += test_sequence();
+    std::cout << "[RUN] ImageCache tests..." << std::endl;
+    failed += test_image_cache();
+    std::cout << "[RUN] Preview tests..." << std::endl;
+    failed += test_preview();
+    std::cout << "[RUN] Buffer codec tests..." << std::endl;
+    failed += test_buffer_codec();
+    std::cout << "[RUN] Stats tests..." << std::endl;
+    failed += test_stats();
+    std::cout << "[RUN] Memory tests..." << std::endl;
+    failed += test_memory();
     std::cout << "[RUN] Integration test..." << std::endl;
     failed += test_integration();
     if (failed == 0) {
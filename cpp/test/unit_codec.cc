@@ -1,17 +1,397 @@
 // 压缩/解压模块单元测试：Triplet 文本格式 Save/Load 循环一致
 #include <iostream>
 #include <opencv2/opencv.hpp>
+#include "../src/common/memory.h"
 #include "../src/codec/compressor.h"
+#include "../src/codec/trip_sequence.h"
+#include "../src/data_structure/triplet_ops.h"
+#include "../src/imgproc/image_processor.h"
 #include "../src/io/image_io.h"
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 
 static bool compareMat(const cv::Mat& a, const cv::Mat& b) {
     if (a.size() != b.size() || a.type() != b.type()) return false;
     return std::memcmp(a.data, b.data, a.total() * a.elemSize()) == 0;
 }
 
-int test_codec() {
+// SoA 三元组容器：与 vector 版本结果一致、坐标宽度选择、arena 复用
+static int test_triplet_buffer() {
     int failed = 0;
+
+    // 构造带少量非背景像素的彩色图
+    cv::Mat img(64, 80, CV_8UC3, cv::Scalar(10, 20, 30));
+    for (int i = 0; i < 64; ++i) img.at<cv::Vec3b>(i, (i * 7) % 80) = cv::Vec3b(i, 255 - i, 7);
+    uint8_t bg[3];
+    TripletUtils::FindBackgroundColor(img, bg);
+
+    std::vector<TripletNode> nodes;
+    TripletUtils::MatToTriplets(img, bg, nodes);
+    TripletArena arena;
+    TripletBuffer buf(&arena);
+    TripletUtils::MatToTriplets(img, bg, buf);
+    if (buf.size() != nodes.size() || buf.wide_coords() || buf.BytesPerTriplet() != 7) {
+        std::cerr << "[Codec] TripletBuffer size/layout mismatch" << std::endl; ++failed;
+    } else {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (buf.Row(i) != static_cast<uint32_t>(nodes[i].row_) || buf.Col(i) != static_cast<uint32_t>(nodes[i].col_) ||
+                buf.Values(0)[i] != nodes[i].val_[0] || buf.Values(2)[i] != nodes[i].val_[2]) {
+                std::cerr << "[Codec] TripletBuffer content mismatch" << std::endl; ++failed; break;
+            }
+        }
+    }
+    cv::Mat back;
+    TripletUtils::TripletsToMat(buf, back);
+    if (!compareMat(img, back)) { std::cerr << "[Codec] TripletBuffer round-trip mismatch" << std::endl; ++failed; }
+
+    // SaveTrip/LoadTrip 与 Compressor 复用同一个 arena
+    const std::string trip_path = std::string(OUTPUT_DIR) + "/out_buffer.trip";
+    TripletBuffer loaded(&arena);
+    if (!ImageIO::SaveTrip(trip_path, buf) || !ImageIO::LoadTrip(trip_path, loaded) || loaded.size() != buf.size()) {
+        std::cerr << "[Codec] SaveTrip/LoadTrip(TripletBuffer) failed" << std::endl; ++failed;
+    }
+    if (!Compressor::Save(trip_path, img, &arena)) { std::cerr << "[Codec] Save with arena failed" << std::endl; ++failed; }
+    size_t reserved = arena.BytesReserved();
+    cv::Mat recon = Compressor::Load(trip_path, &arena);
+    if (!compareMat(img, recon) || arena.BytesReserved() != reserved) {
+        std::cerr << "[Codec] Load with arena mismatch or arena not reused" << std::endl; ++failed;
+    }
+
+    // 自带 arena 的容器反复 Reset 与填充（含逐个追加时的扩容）：预留内存在第一轮之后不再增长
+    const int trip_idx = static_cast<int>(MemoryTracker::Category::kTriplets);
+    TripletBuffer own;
+    size_t own_reserved = 0;
+    for (int round = 0; round < 5; ++round) {
+        TripletUtils::MatToTriplets(img, bg, own);
+        own.Reset(img.cols, img.rows, 3);
+        const uint8_t val[3] = {1, 2, 3};
+        for (int i = 0; i < 100000; ++i) own.PushBack(static_cast<uint32_t>(i % 64), static_cast<uint32_t>(i % 80), val);
+        const size_t now = MemoryTracker::GetReport().categories[trip_idx].current;
+        if (round == 1) own_reserved = now;
+        if (round > 1 && now != own_reserved) {
+            std::cerr << "[Codec] owned arena grows across Reset: " << own_reserved << " -> " << now << std::endl; ++failed; break;
+        }
+    }
+
+    // 宽度超过 65535 时坐标使用 uint32_t
+    cv::Mat wide(1, 70000, CV_8UC1, cv::Scalar(0));
+    wide.at<uint8_t>(0, 69999) = 9;
+    TripletBuffer wbuf;
+    uint8_t zero[3] = {0, 0, 0};
+    TripletUtils::MatToTriplets(wide, zero, wbuf);
+    if (!wbuf.wide_coords() || wbuf.size() != 1 || wbuf.Col(0) != 69999) {
+        std::cerr << "[Codec] TripletBuffer wide coords failed" << std::endl; ++failed;
+    }
+
+    return failed;
+}
+
+// 8UC4、16UC1、16UC3 图像：按原位深压缩、还原，以及 TRIP2 文件头
+static int test_deep_triplets() {
+    int failed = 0;
+    cv::Mat bgra(24, 32, CV_8UC4, cv::Scalar(255, 255, 255, 0));
+    cv::Mat gray16(24, 32, CV_16UC1, cv::Scalar(40000));
+    cv::Mat color16(24, 32, CV_16UC3, cv::Scalar(1000, 2000, 3000));
+    for (int i = 0; i < 40; ++i) {
+        int r = (i * 7) % 24, c = (i * 11) % 32;
+        bgra.at<cv::Vec4b>(r, c) = cv::Vec4b(10, 20, 30, static_cast<uint8_t>(i * 6));
+        gray16.at<uint16_t>(r, c) = static_cast<uint16_t>(300 + i * 1000);
+        color16.at<cv::Vec3w>(r, c) = cv::Vec3w(static_cast<uint16_t>(i), 65535, static_cast<uint16_t>(i * 256));
+    }
+
+    const cv::Mat images[] = {bgra, gray16, color16};
+    const char* names[] = {"8UC4", "16UC1", "16UC3"};
+    for (int i = 0; i < 3; ++i) {
+        const std::string path = std::string(OUTPUT_DIR) + "/deep_" + names[i] + ".trip";
+        if (!Compressor::Save(path, images[i])) { std::cerr << "[Codec] Save " << names[i] << " failed" << std::endl; ++failed; continue; }
+        if (!compareMat(images[i], Compressor::Load(path))) {
+            std::cerr << "[Codec] Round-trip " << names[i] << " mismatch" << std::endl; ++failed;
+        }
+        // 新格式的文件头记录位深；TripletNode 接口拒绝读取
+        std::ifstream ifs(path);
+        std::string magic; ifs >> magic;
+        if (magic != "TRIP2" || !ImageIO::LoadTrip(path).empty()) {
+            std::cerr << "[Codec] " << names[i] << " header mismatch" << std::endl; ++failed;
+        }
+    }
+
+    // 背景色按原位深检测，16 位取值不被截断
+    uint16_t bg[4];
+    TripletUtils::FindBackgroundColor(color16, bg);
+    TripletBuffer buf;
+    TripletUtils::MatToTriplets(color16, bg, buf);
+    if (bg[0] != 1000 || bg[2] != 3000 || buf.depth() != CV_16U || buf.size() != 40 ||
+        buf.Values<uint16_t>(1)[0] != 65535 || buf.BytesPerTriplet() != 4 + 6) {
+        std::cerr << "[Codec] 16-bit TripletBuffer mismatch" << std::endl; ++failed;
+    }
+
+    // 8 位灰度/彩色图仍写旧格式
+    cv::Mat color(8, 8, CV_8UC3, cv::Scalar(1, 2, 3));
+    const std::string legacy = std::string(OUTPUT_DIR) + "/legacy_color.trip";
+    Compressor::Save(legacy, color);
+    std::ifstream ifs(legacy);
+    std::string magic; ifs >> magic;
+    if (magic != "TRIP") { std::cerr << "[Codec] 8UC3 header changed" << std::endl; ++failed; }
+    return failed;
+}
+
+// 合成屏幕录制：纯色背景上的几行文字和移动的小方块，第 20 帧整屏切换
+static cv::Mat ScreenFrame(int i) {
+    const int scene = i < 20 ? 0 : 1;
+    cv::Mat img(48, 70, CV_8UC3, scene ? cv::Scalar(30, 30, 30) : cv::Scalar(240, 240, 240));
+    for (int r = 30; r < 36; ++r) {
+        for (int c = 2; c < 60; c += 2) img.at<cv::Vec3b>(r, c) = cv::Vec3b((r * 3 + scene * 90) & 255, (c * 5) & 255, 40);
+    }
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) img.at<cv::Vec3b>(10 + r, (i * 3 + c) % 70) = cv::Vec3b(255, 255, 255);
+    }
+    return img;
+}
+
+// 帧间差分与 .tripseq 容器：差分正确性、关键帧策略、随机访问、容差、缺少索引时的恢复
+static int test_trip_sequence() {
+    int failed = 0;
+
+    // 差分：宽度不是段长的整数倍，变化落在段边界两侧
+    cv::Mat a(5, 70, CV_8UC3, cv::Scalar(1, 2, 3));
+    cv::Mat b = a.clone();
+    b.at<cv::Vec3b>(0, 31) = cv::Vec3b(9, 2, 3);
+    b.at<cv::Vec3b>(0, 32) = cv::Vec3b(1, 2, 9);
+    b.at<cv::Vec3b>(4, 69) = cv::Vec3b(1, 4, 3);
+    TripletBuffer diff;
+    if (!TripletUtils::DiffToTriplets(b, a, 0, diff) || diff.size() != 3 || diff.Row(2) != 4 || diff.Col(2) != 69 ||
+        diff.Col(0) != 31 || diff.Col(1) != 32 || diff.Values(2)[1] != 9) {
+        std::cerr << "[Codec] DiffToTriplets mismatch" << std::endl; ++failed;
+    }
+    if (!TripletUtils::DiffToTriplets(b, a, 2, diff) || diff.size() != 2) {
+        std::cerr << "[Codec] DiffToTriplets tolerance mismatch" << std::endl; ++failed;
+    }
+    cv::Mat applied = a.clone();
+    TripletUtils::DiffToTriplets(b, a, 0, diff);
+    if (!TripletUtils::ApplyTriplets(diff, applied) || !compareMat(applied, b)) {
+        std::cerr << "[Codec] ApplyTriplets mismatch" << std::endl; ++failed;
+    }
+    cv::Mat other(5, 70, CV_8UC1, cv::Scalar(0));
+    if (TripletUtils::DiffToTriplets(b, other, 0, diff) || TripletUtils::ApplyTriplets(diff, other)) {
+        std::cerr << "[Codec] mismatched frames accepted" << std::endl; ++failed;
+    }
+
+    // 无损序列：关键帧为 0、16、20（场景切换）和 36
+    const std::string path = std::string(OUTPUT_DIR) + "/screen.tripseq";
+    const int kFrames = 40;
+    TripSequenceOptions options;
+    options.keyframe_interval = 16;
+    {
+        TripSequenceWriter writer(options);
+        if (!writer.Open(path)) { std::cerr << "[Codec] open tripseq failed" << std::endl; return ++failed; }
+        for (int i = 0; i < kFrames; ++i) {
+            if (!writer.Append(ScreenFrame(i))) { std::cerr << "[Codec] Append " << i << " failed" << std::endl; ++failed; }
+        }
+        if (writer.Append(cv::Mat(48, 70, CV_8UC1, cv::Scalar(0)))) { std::cerr << "[Codec] mismatched frame accepted" << std::endl; ++failed; }
+        if (!writer.Close() || writer.frame_count() != static_cast<size_t>(kFrames) || writer.keyframe_count() != 4) {
+            std::cerr << "[Codec] tripseq writer stats mismatch" << std::endl; ++failed;
+        }
+    }
+    // 差分帧只有移动方块的像素，整个序列远小于逐帧存储的原始像素
+    if (std::filesystem::file_size(path) * 5 > static_cast<uintmax_t>(kFrames) * 48 * 70 * 3) {
+        std::cerr << "[Codec] tripseq not smaller than raw frames" << std::endl; ++failed;
+    }
+
+    TripSequenceReader reader;
+    if (!reader.Open(path) || reader.frame_count() != static_cast<size_t>(kFrames) || reader.type() != CV_8UC3 ||
+        !reader.IsKeyframe(20) || reader.IsKeyframe(21)) {
+        std::cerr << "[Codec] tripseq reader header mismatch" << std::endl; return ++failed;
+    }
+    cv::Mat frame;
+    for (int i = 0; i < kFrames; ++i) {
+        if (!reader.ReadFrame(i, frame) || !compareMat(frame, ScreenFrame(i))) { std::cerr << "[Codec] sequential frame " << i << " mismatch" << std::endl; ++failed; }
+    }
+    for (int i = kFrames - 1; i >= 0; i -= 7) {
+        if (!compareMat(reader.ReadFrame(i), ScreenFrame(i))) { std::cerr << "[Codec] random frame " << i << " mismatch" << std::endl; ++failed; }
+    }
+    if (!reader.ReadFrame(kFrames).empty()) { std::cerr << "[Codec] out-of-range frame returned" << std::endl; ++failed; }
+
+    // 尾部索引丢失、最后一帧被截断：扫描恢复前 kFrames - 1 帧
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        size_t frames_end = bytes.size() - 24 - 16 * kFrames;
+        std::ofstream(std::string(OUTPUT_DIR) + "/truncated.tripseq", std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(frames_end - 3));
+    }
+    TripSequenceReader recovered;
+    if (!recovered.Open(std::string(OUTPUT_DIR) + "/truncated.tripseq") || recovered.frame_count() != static_cast<size_t>(kFrames - 1) ||
+        !compareMat(recovered.ReadFrame(kFrames - 2), ScreenFrame(kFrames - 2))) {
+        std::cerr << "[Codec] tripseq recovery failed" << std::endl; ++failed;
+    }
+
+    // 16 位灰度、带噪声：容差吸收噪声，重建误差不超过容差
+    const std::string noisy_path = std::string(OUTPUT_DIR) + "/noisy.tripseq";
+    options.tolerance = 4;
+    options.keyframe_interval = 100;
+    std::vector<cv::Mat> noisy;
+    {
+        TripSequenceWriter writer(options);
+        writer.Open(noisy_path);
+        for (int i = 0; i < 12; ++i) {
+            cv::Mat img(20, 40, CV_16UC1);
+            for (int r = 0; r < img.rows; ++r) {
+                for (int c = 0; c < img.cols; ++c) img.at<uint16_t>(r, c) = static_cast<uint16_t>(1000 + r * 40 + c + (r * 7 + c * 3 + i * 5) % 4);
+            }
+            noisy.push_back(img);
+            writer.Append(img);
+        }
+    }
+    TripSequenceReader noisy_reader;
+    bool within = noisy_reader.Open(noisy_path) && noisy_reader.frame_count() == noisy.size() && noisy_reader.type() == CV_16UC1;
+    for (size_t i = 0; within && i < noisy.size(); ++i) {
+        cv::Mat out = noisy_reader.ReadFrame(i);
+        for (int r = 0; within && r < out.rows; ++r) {
+            for (int c = 0; c < out.cols; ++c) within &= std::abs(out.at<uint16_t>(r, c) - noisy[i].at<uint16_t>(r, c)) <= 4;
+        }
+    }
+    if (!within) { std::cerr << "[Codec] tolerant tripseq exceeds tolerance" << std::endl; ++failed; }
+    return failed;
+}
+
+// 逐像素搬运得到翻转/旋转的参考结果：op 依次为水平、垂直、双向翻转，顺时针 90°、逆时针 90°
+static cv::Mat MoveReference(const cv::Mat& img, int op) {
+    const bool swap = op >= 3;
+    cv::Mat out(swap ? img.cols : img.rows, swap ? img.rows : img.cols, img.type());
+    const size_t elem = img.elemSize();
+    for (int r = 0; r < out.rows; ++r) {
+        for (int c = 0; c < out.cols; ++c) {
+            int sr = r, sc = c;
+            switch (op) {
+                case 0: sc = img.cols - 1 - c; break;
+                case 1: sr = img.rows - 1 - r; break;
+                case 2: sr = img.rows - 1 - r; sc = img.cols - 1 - c; break;
+                case 3: sr = img.rows - 1 - c; sc = r; break;
+                default: sr = c; sc = img.cols - 1 - r; break;
+            }
+            std::memcpy(out.ptr(r) + c * elem, img.ptr(sr) + sc * elem, elem);
+        }
+    }
+    return out;
+}
+
+// 三元组按行优先顺序排列且坐标在图像内
+static bool RowMajor(const TripletBuffer& buf) {
+    for (size_t i = 0; i < buf.size(); ++i) {
+        if (buf.Row(i) >= static_cast<uint32_t>(buf.height()) || buf.Col(i) >= static_cast<uint32_t>(buf.width())) return false;
+        if (i > 0 && (buf.Row(i) < buf.Row(i - 1) || (buf.Row(i) == buf.Row(i - 1) && buf.Col(i) <= buf.Col(i - 1)))) return false;
+    }
+    return true;
+}
+
+// 压缩域操作：与图像域的 Processor::ToGray、ROI、翻转/旋转逐像素相同，输出保持行优先，以及 Compressor::Transform
+static int test_triplet_ops() {
+    int failed = 0;
+    cv::Mat color(37, 53, CV_8UC3, cv::Scalar(200, 180, 160));
+    cv::Mat bgra(37, 53, CV_8UC4, cv::Scalar(255, 255, 255, 0));
+    cv::Mat gray16(37, 53, CV_16UC1, cv::Scalar(40000));
+    cv::Mat gray(37, 53, CV_8UC1, cv::Scalar(7));
+    for (int i = 0; i < 300; ++i) {
+        const int r = (i * 13) % 37, c = (i * 29) % 53;
+        // 第 0 个像素与背景灰度相同、颜色不同，灰度化后应被丢弃
+        color.at<cv::Vec3b>(r, c) = i == 0 ? cv::Vec3b(160, 180, 200) : cv::Vec3b(i & 255, (i * 3) & 255, 9);
+        bgra.at<cv::Vec4b>(r, c) = cv::Vec4b(10, 20, 30, static_cast<uint8_t>(i));
+        gray16.at<uint16_t>(r, c) = static_cast<uint16_t>(i * 211);
+        gray.at<uint8_t>(r, c) = static_cast<uint8_t>(i * 5);
+    }
+
+    const cv::Mat images[] = {color, bgra, gray16, gray};
+    const char* names[] = {"8UC3", "8UC4", "16UC1", "8UC1"};
+    const cv::Rect roi(3, 5, 20, 17);
+    for (int i = 0; i < 4; ++i) {
+        uint16_t bg[4];
+        TripletUtils::FindBackgroundColor(images[i], bg);
+        TripletBuffer src, dst;
+        TripletUtils::MatToTriplets(images[i], bg, src);
+
+        cv::Mat out;
+        if (!TripletOps::ToGray(src, dst) || !RowMajor(dst)) {
+            std::cerr << "[Codec] TripletOps::ToGray " << names[i] << " failed" << std::endl; ++failed;
+        } else {
+            TripletUtils::TripletsToMat(dst, out);
+            if (!compareMat(out, Processor::ToGray(images[i]))) {
+                std::cerr << "[Codec] TripletOps::ToGray " << names[i] << " mismatch" << std::endl; ++failed;
+            }
+        }
+        if (i == 0 && dst.size() + 1 != src.size()) {
+            std::cerr << "[Codec] TripletOps::ToGray kept a background triplet" << std::endl; ++failed;
+        }
+
+        if (!TripletOps::Crop(src, roi, dst) || !RowMajor(dst)) {
+            std::cerr << "[Codec] TripletOps::Crop " << names[i] << " failed" << std::endl; ++failed;
+        } else {
+            TripletUtils::TripletsToMat(dst, out);
+            if (!compareMat(out, images[i](roi).clone())) {
+                std::cerr << "[Codec] TripletOps::Crop " << names[i] << " mismatch" << std::endl; ++failed;
+            }
+        }
+
+        for (int op = 0; op < 5; ++op) {
+            bool ok = false;
+            switch (op) {
+                case 0: ok = TripletOps::Flip(src, TripletOps::FlipMode::kHorizontal, dst); break;
+                case 1: ok = TripletOps::Flip(src, TripletOps::FlipMode::kVertical, dst); break;
+                case 2: ok = TripletOps::Flip(src, TripletOps::FlipMode::kBoth, dst); break;
+                case 3: ok = TripletOps::Rotate(src, TripletOps::Rotation::kClockwise90, dst); break;
+                default: ok = TripletOps::Rotate(src, TripletOps::Rotation::kCounterClockwise90, dst); break;
+            }
+            if (ok) TripletUtils::TripletsToMat(dst, out);
+            if (!ok || !RowMajor(dst) || !compareMat(out, MoveReference(images[i], op))) {
+                std::cerr << "[Codec] TripletOps transform " << op << " " << names[i] << " mismatch" << std::endl; ++failed;
+            }
+        }
+        // 旋转 180° 与双向翻转相同
+        TripletBuffer flipped;
+        TripletOps::Flip(src, TripletOps::FlipMode::kBoth, flipped);
+        if (!TripletOps::Rotate(src, TripletOps::Rotation::k180, dst) || dst.size() != flipped.size() ||
+            std::memcmp(dst.Values<uint8_t>(0), flipped.Values<uint8_t>(0), dst.size() * (dst.depth() == CV_16U ? 2 : 1)) != 0) {
+            std::cerr << "[Codec] TripletOps::Rotate 180 " << names[i] << " mismatch" << std::endl; ++failed;
+        }
+    }
+
+    // 非法参数：越界或空的 roi、输入输出为同一对象、越界坐标
+    uint16_t bg[4];
+    TripletUtils::FindBackgroundColor(color, bg);
+    TripletBuffer src, dst;
+    TripletUtils::MatToTriplets(color, bg, src);
+    if (TripletOps::Crop(src, cv::Rect(40, 0, 20, 5), dst) || TripletOps::Crop(src, cv::Rect(0, 0, 0, 5), dst) ||
+        TripletOps::Crop(src, cv::Rect(-1, 0, 5, 5), dst) || TripletOps::ToGray(src, src) ||
+        TripletOps::Flip(src, TripletOps::FlipMode::kHorizontal, src)) {
+        std::cerr << "[Codec] TripletOps accepted invalid arguments" << std::endl; ++failed;
+    }
+    src.Cols<uint16_t>()[0] = static_cast<uint16_t>(color.cols);
+    if (TripletOps::Rotate(src, TripletOps::Rotation::kClockwise90, dst)) {
+        std::cerr << "[Codec] TripletOps::Rotate accepted out-of-range coords" << std::endl; ++failed;
+    }
+
+    // 文件到文件：灰度化后顺时针旋转，与图像域结果相同
+    const std::string in_path = std::string(OUTPUT_DIR) + "/ops_in.trip";
+    const std::string out_path = std::string(OUTPUT_DIR) + "/ops_out.trip";
+    TripletArena arena;
+    const bool transformed = Compressor::Save(in_path, color) &&
+        Compressor::Transform(in_path, out_path, [](const TripletBuffer& s, TripletBuffer& d) {
+            TripletBuffer g;
+            return TripletOps::ToGray(s, g) && TripletOps::Rotate(g, TripletOps::Rotation::kClockwise90, d);
+        }, &arena);
+    if (!transformed || !compareMat(Compressor::Load(out_path), MoveReference(Processor::ToGray(color), 3))) {
+        std::cerr << "[Codec] Compressor::Transform mismatch" << std::endl; ++failed;
+    }
+    if (Compressor::Transform(in_path, out_path, [](const TripletBuffer&, TripletBuffer&) { return false; })) {
+        std::cerr << "[Codec] Compressor::Transform ignored a failed op" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+int test_codec() {
+    int failed = test_triplet_buffer();
+    failed += test_deep_triplets();
+    failed += test_trip_sequence();
+    failed += test_triplet_ops();
     // 使用彩色块图测试，便于出现非均匀背景
     cv::Mat color = ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
     if (color.empty()) { std::cerr << "[Codec] load color failed" << std::endl; return ++failed; }
@@ -0,0 +1,183 @@
+// 公共模块单元测试：耗时统计的开关、跨线程聚合、清零与 trace 导出；内存记账与预算；共享线程池的条带并行
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../src/codec/compressor.h"
+#include "../src/common/memory.h"
+#include "../src/common/stats.h"
+#include "../src/common/thread_pool.h"
+#include "../src/data_structure/triplet.h"
+#include "../src/imgproc/image_processor.h"
+
+int test_stats() {
+    int failed = 0;
+#ifdef IMGPROC_NO_STATS
+    return failed;   // 统计代码未编译进核心库
+#endif
+    cv::Mat color(64, 48, CV_8UC3, cv::Scalar(10, 20, 30));
+    const auto gray_idx = static_cast<size_t>(Stats::Stage::kGray);
+    const auto resize_idx = static_cast<size_t>(Stats::Stage::kResize);
+
+    // 默认关闭，关闭时不计数
+    Stats::Reset();
+    if (Stats::enabled()) { std::cerr << "[Stats] enabled by default" << std::endl; ++failed; }
+    Processor::ToGray(color);
+    std::vector<Stats::StageStats> snap = Stats::Snapshot();
+    if (snap.size() != static_cast<size_t>(Stats::kNumStages) || snap[gray_idx].count != 0) {
+        std::cerr << "[Stats] counted while disabled" << std::endl; ++failed;
+    }
+
+    // 开启后计数与字节数
+    Stats::SetEnabled(true);
+    Processor::ToGray(color);
+    snap = Stats::Snapshot();
+    if (snap[gray_idx].count != 1 || snap[gray_idx].bytes != color.total() * color.elemSize() ||
+        snap[gray_idx].max_ns > snap[gray_idx].total_ns || std::string(snap[gray_idx].name) != "gray") {
+        std::cerr << "[Stats] gray stage mismatch" << std::endl; ++failed;
+    }
+
+    // 多线程计数汇总
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&color] {
+            for (int i = 0; i < 10; ++i) Processor::Resize(color, 32, 32);
+        });
+    }
+    for (auto& th : threads) th.join();
+    snap = Stats::Snapshot();
+    if (snap[resize_idx].count != 40) {
+        std::cerr << "[Stats] resize count expected 40, got " << snap[resize_idx].count << std::endl; ++failed;
+    }
+
+    // trace 导出
+    Stats::SetTracing(true);
+    Processor::ToGray(color);
+    std::ostringstream trace;
+    Stats::WriteChromeTrace(trace);
+    const std::string json = trace.str();
+    if (json.find("\"traceEvents\"") == std::string::npos || json.find("\"name\":\"gray\"") == std::string::npos ||
+        json.find("\"ph\":\"X\"") == std::string::npos) {
+        std::cerr << "[Stats] chrome trace missing events" << std::endl; ++failed;
+    }
+    Stats::SetTracing(false);
+
+    // 清零
+    Stats::Reset();
+    snap = Stats::Snapshot();
+    if (snap[gray_idx].count != 0 || snap[resize_idx].count != 0) {
+        std::cerr << "[Stats] reset failed" << std::endl; ++failed;
+    }
+    Processor::Resize(color, 16, 16);
+    if (Stats::Snapshot()[resize_idx].count != 1) { std::cerr << "[Stats] count after reset" << std::endl; ++failed; }
+    Stats::SetEnabled(false);
+    Stats::Reset();
+    return failed;
+}
+
+// 共享线程池上的条带并行：每个下标恰好执行一次，嵌套调用不死锁，异常传回调用方
+static int test_parallel_bands() {
+    int failed = 0;
+    const int n = 4 * ThreadPool::ResolveThreads(0) + 3;
+    std::vector<std::atomic<int>> hits(n);
+    std::atomic<int> inner{0};
+    ParallelBands(n, [&](int i) {
+        ++hits[i];
+        ParallelBands(3, [&](int) { ++inner; });
+    });
+    for (int i = 0; i < n; ++i) {
+        if (hits[i] != 1) { std::cerr << "[Parallel] index " << i << " ran " << hits[i] << " times" << std::endl; ++failed; break; }
+    }
+    if (inner != 3 * n) { std::cerr << "[Parallel] nested bands incomplete" << std::endl; ++failed; }
+
+    bool thrown = false;
+    std::atomic<int> ran{0};
+    try {
+        ParallelBands(8, [&](int i) {
+            ++ran;
+            if (i == 5) throw std::runtime_error("band 5");
+        });
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()) == "band 5";
+    }
+    if (!thrown || ran != 8) { std::cerr << "[Parallel] exception not propagated after all bands" << std::endl; ++failed; }
+    return failed;
+}
+
+int test_memory() {
+    int failed = 0;
+    using Category = MemoryTracker::Category;
+    const auto hist_idx = static_cast<int>(Category::kHistogram);
+    const auto trip_idx = static_cast<int>(Category::kTriplets);
+    const auto image_idx = static_cast<int>(Category::kImage);
+
+    // 彩色噪声图，背景色检测走哈希表
+    cv::Mat noisy(128, 128, CV_8UC3);
+    for (int r = 0; r < noisy.rows; ++r) {
+        for (int c = 0; c < noisy.cols * 3; ++c) noisy.ptr<uint8_t>(r)[c] = static_cast<uint8_t>((r * 131 + c * 17) & 0xFF);
+    }
+
+    // 容器的分配与释放都被记账
+    MemoryTracker::ResetPeaks();
+    MemoryTracker::Report before = MemoryTracker::GetReport();
+    uint8_t bg[3];
+    TripletUtils::FindBackgroundColor(noisy, bg);
+    MemoryTracker::Report after = MemoryTracker::GetReport();
+    if (after.categories[hist_idx].peak <= before.categories[hist_idx].current ||
+        after.categories[hist_idx].current != before.categories[hist_idx].current) {
+        std::cerr << "[Memory] histogram not accounted" << std::endl; ++failed;
+    }
+
+    // 开启统计时，压缩阶段记录单次调用的内存峰值
+    Stats::SetEnabled(true);
+    Stats::Reset();
+    const std::string trip_path = std::string(OUTPUT_DIR) + "/memory_noisy.trip";
+    if (!Compressor::Save(trip_path, noisy)) { std::cerr << "[Memory] save failed" << std::endl; ++failed; }
+    std::vector<Stats::StageStats> snap = Stats::Snapshot();
+    const Stats::StageStats& compress = snap[static_cast<size_t>(Stats::Stage::kCompress)];
+    if (compress.count != 1 || compress.peak_bytes == 0 ||
+        compress.peak_bytes < snap[static_cast<size_t>(Stats::Stage::kBackground)].peak_bytes) {
+        std::cerr << "[Memory] compress peak not recorded" << std::endl; ++failed;
+    }
+    if (MemoryTracker::GetReport().categories[trip_idx].current != before.categories[trip_idx].current) {
+        std::cerr << "[Memory] triplet arena leaked in accounting" << std::endl; ++failed;
+    }
+    if (Stats::Threads().empty()) { std::cerr << "[Memory] no thread stats" << std::endl; ++failed; }
+    Stats::SetEnabled(false);
+    Stats::Reset();
+
+    // cv::Mat 的像素内存
+    MemoryTracker::TrackMats(true);
+    size_t image_before = MemoryTracker::GetReport().categories[image_idx].current;
+    {
+        cv::Mat m(100, 100, CV_8UC3);
+        if (MemoryTracker::GetReport().categories[image_idx].current < image_before + 30000) {
+            std::cerr << "[Memory] mat allocation not accounted" << std::endl; ++failed;
+        }
+    }
+    if (MemoryTracker::GetReport().categories[image_idx].current != image_before) {
+        std::cerr << "[Memory] mat release not accounted" << std::endl; ++failed;
+    }
+    MemoryTracker::TrackMats(false);
+
+    // 超出预算立即失败
+    MemoryTracker::SetBudget(MemoryTracker::GetReport().total.current + 1024);
+    bool thrown = false;
+    try {
+        Compressor::Save(trip_path, noisy);
+    } catch (const MemoryBudgetExceeded& e) {
+        thrown = std::string(e.what()).find("memory budget exceeded") != std::string::npos;
+    }
+    MemoryTracker::SetBudget(0);
+    if (!thrown || MemoryTracker::GetReport().budget_failures == 0) {
+        std::cerr << "[Memory] budget not enforced" << std::endl; ++failed;
+    }
+    if (!Compressor::Save(trip_path, noisy)) { std::cerr << "[Memory] save after budget reset failed" << std::endl; ++failed; }
+
+    failed += test_parallel_bands();
+    return failed;
+}
@@ -1,11 +1,606 @@
-// 图像处理模块单元测试：灰度转换与双线性缩放
+// 图像处理模块单元测试：灰度转换（含 BGRA 与 16 位）、双线性与可分离滤波缩放、输出复用、图像统计、分块核外处理、盒式与高斯模糊、进度回调
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "../src/common/memory.h"
+#include "../src/common/scratch.h"
+#include "../src/codec/compressor.h"
+#include "../src/data_structure/triplet.h"
 #include "../src/imgproc/image_processor.h"
+#include "../src/imgproc/image_stats.h"
+#include "../src/imgproc/tiled_processor.h"
 #include "../src/io/image_io.h"
+#include "../src/io/mapped_raster.h"
+#include "../src/pipeline/operation.h"
 
-int test_imgproc() {
+// 输出复用：同尺寸连续调用复用 out 与暂存区，稳态下不分配内存
+static int test_output_reuse() {
+    int failed = 0;
+    cv::Mat frame(120, 160, CV_8UC3, cv::Scalar(30, 60, 90));
+    cv::Mat gray, small, sharp;
+    MemoryTracker::TrackMats(true);
+    for (int i = 0; i < 2; ++i) {
+        Processor::ToGray(frame, gray);
+        Processor::Resize(frame, 80, 60, small);
+        Processor::Resize(frame, 200, 150, sharp, Processor::Interpolation::kLanczos3);
+    }
+
+    // 预热后再处理若干帧：像素地址不变，记账的总峰值不增长
+    const uint8_t* gray_data = gray.data;
+    const uint8_t* small_data = small.data;
+    const uint8_t* sharp_data = sharp.data;
+    MemoryTracker::ResetPeaks();
+    const size_t before = MemoryTracker::GetReport().total.current;
+    for (int i = 0; i < 5; ++i) {
+        frame.at<cv::Vec3b>(i, i) = cv::Vec3b(255, 255, 255);
+        if (!Processor::ToGray(frame, gray) || !Processor::Resize(frame, 80, 60, small) ||
+            !Processor::Resize(frame, 200, 150, sharp, Processor::Interpolation::kLanczos3)) {
+            std::cerr << "[ImgProc] output-reuse call failed" << std::endl; ++failed;
+        }
+    }
+    MemoryTracker::Report report = MemoryTracker::GetReport();
+    MemoryTracker::TrackMats(false);
+    if (gray.data != gray_data || small.data != small_data || sharp.data != sharp_data) {
+        std::cerr << "[ImgProc] output buffers were reallocated" << std::endl; ++failed;
+    }
+    if (report.total.peak != before || report.total.current != before) {
+        std::cerr << "[ImgProc] steady-state frames allocated " << report.total.peak - before << " bytes" << std::endl; ++failed;
+    }
+    if (ScratchPool::BytesReserved() == 0) { std::cerr << "[ImgProc] scratch pool unused" << std::endl; ++failed; }
+
+    // 结果与返回新图像的版本一致
+    cv::Mat expected = Processor::Resize(frame, 200, 150, Processor::Interpolation::kLanczos3);
+    if (std::memcmp(expected.data, sharp.data, expected.total() * expected.elemSize()) != 0) {
+        std::cerr << "[ImgProc] output-reuse result mismatch" << std::endl; ++failed;
+    }
+
+    // 输出与输入共享内存时不原地写入；失败时输出置空
+    cv::Mat alias = frame;
+    if (!Processor::Resize(alias, 40, 30, alias) || alias.cols != 40 || frame.cols != 160) {
+        std::cerr << "[ImgProc] aliased output failed" << std::endl; ++failed;
+    }
+    if (Processor::ToGray(cv::Mat(), gray) || !gray.empty()) { std::cerr << "[ImgProc] failed call kept output" << std::endl; ++failed; }
+
+    // Trim 在上限以内不释放，超出时从最大的槽位开始释放
+    const size_t reserved = ScratchPool::BytesReserved();
+    ScratchPool::Trim(reserved);
+    if (ScratchPool::BytesReserved() != reserved) { std::cerr << "[ImgProc] scratch trim below limit freed memory" << std::endl; ++failed; }
+    ScratchPool::Get<uint8_t>(3, reserved + 1);
+    ScratchPool::Trim(reserved);
+    if (ScratchPool::BytesReserved() > reserved) { std::cerr << "[ImgProc] scratch trim above limit kept memory" << std::endl; ++failed; }
+    ScratchPool::Release();
+    if (ScratchPool::BytesReserved() != 0) { std::cerr << "[ImgProc] scratch release failed" << std::endl; ++failed; }
+    return failed;
+}
+
+// 与逐像素暴力统计比对，结果与线程数无关；Compressor::Save 复用统计结果
+template <typename T, int CN>
+static int check_image_stats(const cv::Mat& img, const char* name) {
+    int failed = 0;
+    const uint64_t n = static_cast<uint64_t>(img.total());
+    std::map<std::vector<int>, uint64_t> colors;
+    double sum[4] = {0, 0, 0, 0}, sq[4] = {0, 0, 0, 0};
+    int lo[4] = {65535, 65535, 65535, 65535}, hi[4] = {0, 0, 0, 0};
+    for (int r = 0; r < img.rows; ++r) {
+        const T* row = img.ptr<T>(r);
+        for (int c = 0; c < img.cols; ++c) {
+            std::vector<int> key(row + CN * c, row + CN * c + CN);
+            ++colors[key];
+            for (int k = 0; k < CN; ++k) {
+                sum[k] += key[k]; sq[k] += double(key[k]) * key[k];
+                lo[k] = std::min(lo[k], key[k]); hi[k] = std::max(hi[k], key[k]);
+            }
+        }
+    }
+    // std::map 按字典序遍历，严格大于才替换即得到频次相同时较小的颜色
+    std::vector<int> mode; uint64_t mode_count = 0;
+    for (const auto& kv : colors) {
+        if (kv.second > mode_count) { mode = kv.first; mode_count = kv.second; }
+    }
+
+    for (int threads : {1, 3, 0}) {
+        ImageStatsOptions options; options.num_threads = threads; options.color_mode = true;
+        ImageStats stats;
+        if (!ImageStats::Compute(img, stats, options) || stats.pixels != n || stats.channels != CN) {
+            std::cerr << "[ImgProc] " << name << " stats failed" << std::endl; ++failed; continue;
+        }
+        for (int k = 0; k < CN; ++k) {
+            const double mean = sum[k] / n, var = sq[k] / n - mean * mean;
+            if (std::abs(stats.mean[k] - mean) > 1e-6 * (1 + mean) || std::abs(stats.variance[k] - var) > 1e-6 * (1 + var) ||
+                stats.min[k] != lo[k] || stats.max[k] != hi[k] || stats.histogram[k].size() != (sizeof(T) == 1 ? 256u : 65536u)) {
+                std::cerr << "[ImgProc] " << name << " channel " << k << " moments mismatch" << std::endl; ++failed;
+            }
+        }
+        bool same_mode = stats.has_mode && stats.mode_exact && stats.mode_count == mode_count;
+        for (int k = 0; k < CN; ++k) same_mode = same_mode && stats.mode[k] == mode[k];
+        if (!same_mode || std::abs(stats.non_background_fraction - double(n - mode_count) / n) > 1e-12) {
+            std::cerr << "[ImgProc] " << name << " mode mismatch (threads=" << threads << ")" << std::endl; ++failed;
+        }
+        if (!stats.unique_exact || stats.unique_colors != colors.size()) {
+            std::cerr << "[ImgProc] " << name << " unique colors " << stats.unique_colors << " != " << colors.size() << std::endl; ++failed;
+        }
+    }
+
+    // 默认不统计众数；多通道图像的不同颜色数改为估计
+    ImageStats plain = ImageStats::Compute(img);
+    if (plain.has_mode || plain.unique_exact != (CN == 1) ||
+        std::abs(double(plain.unique_colors) - double(colors.size())) > 0.05 * colors.size()) {
+        std::cerr << "[ImgProc] " << name << " default stats computed the mode or a bad estimate" << std::endl; ++failed;
+    }
+
+    // 颜色数超出精确计数上限：不同颜色数改为估计，众数仍是背景色且像素数精确
+    ImageStatsOptions capped; capped.color_mode = true; capped.max_exact_colors = 8; capped.num_threads = 3;
+    ImageStats bounded = ImageStats::Compute(img, capped);
+    const bool over = CN > 1 && colors.size() > 8;
+    bool capped_ok = bounded.has_mode && bounded.mode_exact == !over && bounded.unique_exact == !over &&
+                     bounded.mode_count == mode_count &&
+                     std::abs(double(bounded.unique_colors) - double(colors.size())) <= 0.05 * colors.size();
+    for (int k = 0; k < CN; ++k) capped_ok = capped_ok && bounded.mode[k] == mode[k];
+    if (!capped_ok) {
+        std::cerr << "[ImgProc] " << name << " stats over the exact color limit mismatch" << std::endl; ++failed;
+    }
+
+    // 复用统计结果压缩，与内部自行统计的结果一致
+    ImageStatsOptions with_mode; with_mode.color_mode = true;
+    ImageStats stats = ImageStats::Compute(img, with_mode);
+    uint16_t bg[4];
+    TripletUtils::FindBackgroundColor(img, bg);
+    if (!std::equal(bg, bg + 4, stats.mode)) {
+        std::cerr << "[ImgProc] " << name << " FindBackgroundColor differs from stats mode" << std::endl; ++failed;
+    }
+    const std::string path = std::string(OUTPUT_DIR) + "/stats_" + name + ".trip";
+    if (!Compressor::Save(path, img, stats)) { std::cerr << "[ImgProc] " << name << " save with stats failed" << std::endl; return ++failed; }
+    cv::Mat back = Compressor::Load(path);
+    if (back.size() != img.size() || back.type() != img.type() ||
+        std::memcmp(back.data, img.data, img.total() * img.elemSize()) != 0) {
+        std::cerr << "[ImgProc] " << name << " round trip with stats mismatch" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+static int test_image_stats() {
+    int failed = 0;
+    // 大片背景上的随机像素，部分像素只改变一个通道
+    uint32_t seed = 12345;
+    auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    cv::Mat bgr(97, 131, CV_8UC3, cv::Scalar(200, 180, 20));
+    cv::Mat bgra16(64, 50, CV_16UC4, cv::Scalar(1000, 2000, 3000, 65535));
+    cv::Mat gray16(40, 70, CV_16UC1, cv::Scalar(4096));
+    for (int r = 0; r < bgr.rows; ++r) {
+        for (int c = 0; c < bgr.cols; ++c) {
+            if (next() % 3 == 0) bgr.ptr<uint8_t>(r)[3 * c + next() % 3] = static_cast<uint8_t>(next());
+        }
+    }
+    for (int r = 0; r < bgra16.rows; ++r) {
+        for (int c = 0; c < bgra16.cols; ++c) {
+            if (next() % 4 == 0) bgra16.ptr<uint16_t>(r)[4 * c + next() % 4] = static_cast<uint16_t>(next() % 16);
+        }
+    }
+    for (int r = 0; r < gray16.rows; ++r) {
+        for (int c = 0; c < gray16.cols; ++c) {
+            if (next() % 2 == 0) gray16.ptr<uint16_t>(r)[c] = static_cast<uint16_t>(next());
+        }
+    }
+    failed += check_image_stats<uint8_t, 3>(bgr, "bgr");
+    failed += check_image_stats<uint16_t, 4>(bgra16, "bgra16");
+    failed += check_image_stats<uint16_t, 1>(gray16, "gray16");
+
+    // 不统计众数时用 HyperLogLog 估计不同颜色数：每个像素颜色都不同
+    cv::Mat noise(200, 300, CV_8UC3);
+    for (int r = 0; r < noise.rows; ++r) {
+        uint8_t* row = noise.ptr<uint8_t>(r);
+        for (int c = 0; c < noise.cols; ++c) {
+            const int i = r * noise.cols + c;
+            row[3 * c] = static_cast<uint8_t>(i); row[3 * c + 1] = static_cast<uint8_t>(i >> 8); row[3 * c + 2] = static_cast<uint8_t>(i >> 16);
+        }
+    }
+    ImageStatsOptions sketch; sketch.color_mode = false; sketch.num_threads = 4;
+    ImageStats approx = ImageStats::Compute(noise, sketch);
+    const double err = std::abs(double(approx.unique_colors) - double(noise.total())) / noise.total();
+    if (approx.unique_exact || approx.has_mode || err > 0.05) {
+        std::cerr << "[ImgProc] HyperLogLog estimate " << approx.unique_colors << " for " << noise.total() << std::endl; ++failed;
+    }
+    sketch.num_threads = 1;
+    if (ImageStats::Compute(noise, sketch).unique_colors != approx.unique_colors) {
+        std::cerr << "[ImgProc] HyperLogLog depends on thread count" << std::endl; ++failed;
+    }
+
+    // 每种颜色只出现一次，全部并列：背景色检测与众数取同一个颜色
+    uint16_t noise_bg[4];
+    TripletUtils::FindBackgroundColor(noise, noise_bg);
+    ImageStatsOptions noise_options; noise_options.color_mode = true;
+    ImageStats noise_stats = ImageStats::Compute(noise, noise_options);
+    if (!std::equal(noise_bg, noise_bg + 4, noise_stats.mode)) {
+        std::cerr << "[ImgProc] FindBackgroundColor breaks ties differently from stats mode" << std::endl; ++failed;
+    }
+
+    // 只统计众数：直方图为空，众数与完整统计一致
+    ImageStatsOptions mode_only; mode_only.histograms = false; mode_only.unique_colors = false; mode_only.color_mode = true;
+    ImageStats full = ImageStats::Compute(bgr, noise_options), lean = ImageStats::Compute(bgr, mode_only);
+    if (!lean.histogram[0].empty() || lean.unique_colors != 0 || !lean.has_mode || lean.mode_count != full.mode_count ||
+        std::memcmp(lean.mode, full.mode, sizeof(lean.mode)) != 0) {
+        std::cerr << "[ImgProc] mode-only stats mismatch" << std::endl; ++failed;
+    }
+
+    // 不支持的类型与不匹配的统计结果
+    ImageStats stats;
+    if (ImageStats::Compute(cv::Mat(4, 4, CV_32FC1), stats) || ImageStats::Compute(cv::Mat(), stats) || stats.pixels != 0) {
+        std::cerr << "[ImgProc] unsupported image accepted" << std::endl; ++failed;
+    }
+    ImageStats other = ImageStats::Compute(gray16, noise_options);
+    if (Compressor::Save(std::string(OUTPUT_DIR) + "/stats_mismatch.trip", bgr, other) ||
+        Compressor::Save(std::string(OUTPUT_DIR) + "/stats_mismatch.trip", bgr, ImageStats::Compute(bgr, sketch))) {
+        std::cerr << "[ImgProc] mismatched stats accepted" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+// 两幅连续图像逐字节相同
+static bool SameBytes(const cv::Mat& a, const cv::Mat& b) {
+    if (a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) return false;
+    for (int r = 0; r < a.rows; ++r) {
+        if (std::memcmp(a.ptr(r), b.ptr(r), a.cols * a.elemSize()) != 0) return false;
+    }
+    return true;
+}
+
+// 分块核外处理：每块一行、多线程时结果与整幅图像的 Processor::Resize / ToGray 逐位相同
+static int test_tiled() {
+    int failed = 0;
+    if (!MappedRaster::Supported()) return failed;
+
+    // BGR 测试图像，写成 P6 文件（RGB 顺序）
+    cv::Mat bgr(61, 97, CV_8UC3);
+    uint32_t seed = 12345;
+    for (int r = 0; r < bgr.rows; ++r) {
+        for (int c = 0; c < bgr.cols * 3; ++c) {
+            seed = seed * 1664525u + 1013904223u;
+            bgr.ptr<uint8_t>(r)[c] = static_cast<uint8_t>((seed >> 24) / 2 + r + c / 3);
+        }
+    }
+    const std::string ppm = std::string(OUTPUT_DIR) + "/tiled_in.ppm";
+    {
+        std::ofstream ofs(ppm, std::ios::binary);
+        ofs << "P6\n# tiled test\n" << bgr.cols << " " << bgr.rows << "\n255\n";
+        for (int r = 0; r < bgr.rows; ++r) {
+            for (int c = 0; c < bgr.cols; ++c) {
+                const uint8_t* p = bgr.ptr<uint8_t>(r) + 3 * c;
+                const char rgb[3] = {static_cast<char>(p[2]), static_cast<char>(p[1]), static_cast<char>(p[0])};
+                ofs.write(rgb, 3);
+            }
+        }
+    }
+
+    MappedRaster src;
+    if (!src.OpenPnm(ppm) || src.width() != bgr.cols || src.height() != bgr.rows || src.type() != CV_8UC3 || !src.rgb()) {
+        std::cerr << "[ImgProc] MappedRaster open P6 failed" << std::endl; return ++failed;
+    }
+    const cv::Mat rgb = src.Image().clone();
+
+    TileOptions tiny;
+    tiny.tile_bytes = 1;    // 每块一行
+    tiny.num_threads = 3;
+    const Processor::Interpolation modes[] = {Processor::Interpolation::kBilinear, Processor::Interpolation::kBicubic,
+                                              Processor::Interpolation::kLanczos3};
+    const std::string out_ppm = std::string(OUTPUT_DIR) + "/tiled_out.ppm";
+    const int sizes[][2] = {{40, 23}, {150, 131}};
+    for (Processor::Interpolation mode : modes) {
+        for (const auto& size : sizes) {
+            MappedRaster out;
+            if (!TiledProcessor::ResizePnm(ppm, out_ppm, size[0], size[1], mode, tiny) || !out.OpenPnm(out_ppm) ||
+                !SameBytes(out.Image(), Processor::Resize(rgb, size[0], size[1], mode))) {
+                std::cerr << "[ImgProc] tiled resize differs from Resize" << std::endl; ++failed;
+            }
+        }
+    }
+
+    // P6 按 RGB 解释，灰度结果与 BGR 图像的 ToGray 相同
+    const std::string out_pgm = std::string(OUTPUT_DIR) + "/tiled_gray.pgm";
+    MappedRaster gray;
+    if (!TiledProcessor::ToGrayPnm(ppm, out_pgm, tiny) || !gray.OpenPnm(out_pgm) || gray.type() != CV_8UC1 ||
+        !SameBytes(gray.Image(), Processor::ToGray(bgr))) {
+        std::cerr << "[ImgProc] tiled gray differs from ToGray" << std::endl; ++failed;
+    }
+
+    // 原始像素文件，16 位 4 通道：默认块大小（整幅一块）与小块结果相同
+    cv::Mat deep(37, 29, CV_16UC4);
+    for (int r = 0; r < deep.rows; ++r) {
+        for (int c = 0; c < deep.cols * 4; ++c) deep.ptr<uint16_t>(r)[c] = static_cast<uint16_t>(r * 1733 + c * 311);
+    }
+    const std::string raw_in = std::string(OUTPUT_DIR) + "/tiled_in.raw";
+    const std::string raw_out = std::string(OUTPUT_DIR) + "/tiled_out.raw";
+    {
+        MappedRaster create;
+        if (!create.CreateRaw(raw_in, deep.cols, deep.rows, deep.type())) {
+            std::cerr << "[ImgProc] MappedRaster create raw failed" << std::endl; return ++failed;
+        }
+        cv::Mat mapped = create.Image();
+        deep.copyTo(mapped);
+    }
+    MappedRaster raw, raw_dst;
+    TileOptions small = tiny;
+    small.tile_bytes = deep.cols * deep.elemSize() * 4;
+    const TileOptions options[] = {TileOptions(), small};
+    for (const TileOptions& opt : options) {
+        if (!raw.OpenRaw(raw_in, deep.cols, deep.rows, deep.type()) || !raw_dst.CreateRaw(raw_out, 50, 17, deep.type()) ||
+            !TiledProcessor::Resize(raw, raw_dst, Processor::Interpolation::kLanczos3, opt) ||
+            !SameBytes(raw_dst.Image(), Processor::Resize(deep, 50, 17, Processor::Interpolation::kLanczos3))) {
+            std::cerr << "[ImgProc] tiled raw resize differs from Resize" << std::endl; ++failed;
+        }
+    }
+
+    // 非法参数：类型不一致、只读输出、文件不存在或长度不足
+    MappedRaster wrong, readonly;
+    wrong.CreateRaw(raw_out, 10, 10, CV_8UC4);
+    readonly.OpenRaw(raw_in, deep.cols, deep.rows, deep.type());
+    if (TiledProcessor::Resize(raw, wrong) || TiledProcessor::Resize(raw, readonly) ||
+        TiledProcessor::ToGray(raw, wrong) || TiledProcessor::ToGrayPnm(raw_in, out_pgm) ||
+        readonly.OpenRaw(raw_in, deep.cols, deep.rows + 1, deep.type()) || readonly.is_open()) {
+        std::cerr << "[ImgProc] tiled processing accepted invalid input" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+// 盒式模糊的逐像素参考实现：复制边缘，窗口和四舍五入后除以窗口像素数
+template <typename T, int CN>
+static cv::Mat ReferenceBoxBlur(const cv::Mat& img, int radius) {
+    cv::Mat out(img.rows, img.cols, img.type());
+    const uint64_t n = static_cast<uint64_t>(2 * radius + 1) * (2 * radius + 1);
+    for (int y = 0; y < img.rows; ++y) {
+        for (int x = 0; x < img.cols; ++x) {
+            for (int k = 0; k < CN; ++k) {
+                uint64_t sum = 0;
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    const T* row = img.ptr<T>(std::min(std::max(y + dy, 0), img.rows - 1));
+                    for (int dx = -radius; dx <= radius; ++dx) sum += row[std::min(std::max(x + dx, 0), img.cols - 1) * CN + k];
+                }
+                out.ptr<T>(y)[x * CN + k] = static_cast<T>((sum + n / 2) / n);
+            }
+        }
+    }
+    return out;
+}
+
+template <typename T, int CN>
+static int check_box_blur(const char* name) {
+    int failed = 0;
+    cv::Mat img(31, 23, CV_MAKETYPE(sizeof(T) == 1 ? CV_8U : CV_16U, CN));
+    uint32_t seed = 777;
+    for (int r = 0; r < img.rows; ++r) {
+        for (int c = 0; c < img.cols * CN; ++c) {
+            seed = seed * 1664525u + 1013904223u;
+            img.ptr<T>(r)[c] = static_cast<T>(seed >> (32 - 8 * sizeof(T)));
+        }
+    }
+    for (int radius : {0, 1, 2, 5, 40}) {
+        const cv::Mat expected = ReferenceBoxBlur<T, CN>(img, radius);
+        for (int threads : {0, 1, 4}) {
+            cv::Mat out, in_place = img.clone();
+            if (!Processor::BoxBlur(img, out, radius, threads) || !SameBytes(out, expected)) {
+                std::cerr << "[ImgProc] BoxBlur " << name << " r=" << radius << " threads=" << threads
+                          << " differs from reference" << std::endl; ++failed;
+            }
+            // 原地：多条带时每个条带都依赖相邻条带的原值
+            const uint8_t* data = in_place.data;
+            if (!Processor::BoxBlur(in_place, in_place, radius, threads) || in_place.data != data ||
+                !SameBytes(in_place, expected)) {
+                std::cerr << "[ImgProc] in-place BoxBlur " << name << " r=" << radius << " threads=" << threads
+                          << " differs from reference" << std::endl; ++failed;
+            }
+        }
+    }
+    return failed;
+}
+
+static int test_blur() {
+    int failed = check_box_blur<uint8_t, 1>("8UC1");
+    failed += check_box_blur<uint8_t, 3>("8UC3");
+    failed += check_box_blur<uint8_t, 4>("8UC4");
+    failed += check_box_blur<uint16_t, 1>("16UC1");
+    failed += check_box_blur<uint16_t, 3>("16UC3");
+
+    // 高斯：常数图像不变；原地与非原地相同；冲激响应的方差接近 sigma^2
+    cv::Mat flat(40, 50, CV_8UC3, cv::Scalar(10, 200, 255));
+    cv::Mat flat_blur = Processor::GaussianBlur(flat, 4.0);
+    if (!SameBytes(flat_blur, flat)) { std::cerr << "[ImgProc] GaussianBlur of flat image changed" << std::endl; ++failed; }
+
+    const int size = 101, center = 50;
+    const double sigma = 6.0;
+    cv::Mat impulse(size, size, CV_16UC1, cv::Scalar(0));
+    impulse.at<uint16_t>(center, center) = 65535;
+    impulse.at<uint16_t>(center - 1, center) = 65535;
+    impulse.at<uint16_t>(center, center - 1) = 65535;
+    cv::Mat blurred, in_place = impulse.clone();
+    if (!Processor::GaussianBlur(impulse, blurred, sigma, 3) || !Processor::GaussianBlur(in_place, in_place, sigma, 3) ||
+        !SameBytes(blurred, in_place)) {
+        std::cerr << "[ImgProc] in-place GaussianBlur differs" << std::endl; ++failed;
+    } else {
+        double mass = 0, second = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const double v = blurred.at<uint16_t>(y, x);
+                mass += v;
+                second += v * (x - center) * (x - center);
+            }
+        }
+        // 冲激本身在 x 方向的方差约为 0.22，允许盒式近似与取整带来的误差
+        const double variance = mass > 0 ? second / mass : 0;
+        if (std::fabs(variance - sigma * sigma) > 0.1 * sigma * sigma) {
+            std::cerr << "[ImgProc] GaussianBlur variance " << variance << " far from " << sigma * sigma << std::endl; ++failed;
+        }
+    }
+
+    // 非法参数：负半径、半径超出 16 位上限、负 sigma、不支持的类型；原地失败时图像保持不变
+    cv::Mat out;
+    cv::Mat deep(8, 8, CV_16UC1, cv::Scalar(7));
+    cv::Mat floats(8, 8, CV_32FC1, cv::Scalar(1));
+    if (Processor::BoxBlur(flat, out, -1) || !out.empty() || Processor::BoxBlur(deep, out, 108) ||
+        !Processor::BoxBlur(deep, out, 107) || Processor::GaussianBlur(flat, out, -1.0) ||
+        !Processor::BoxBlur(floats, 1).empty() || Processor::BoxBlur(deep, deep, 200) || deep.empty()) {
+        std::cerr << "[ImgProc] blur accepted invalid arguments" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+// 进度回调：缩放、模糊与压缩保存汇报单调的中间进度并以 1 结束，结果与不传回调相同；
+// 回调返回 false 时提前返回失败
+static int test_progress() {
     int failed = 0;
+    cv::Mat img(300, 400, CV_8UC3);
+    for (int y = 0; y < img.rows; ++y) {
+        for (int x = 0; x < img.cols; ++x) {
+            img.at<cv::Vec3b>(y, x) = cv::Vec3b(static_cast<uint8_t>(x), static_cast<uint8_t>(y), static_cast<uint8_t>(x ^ y));
+        }
+    }
+    std::vector<double> seen;
+    ProgressFn record = [&seen](double f) { seen.push_back(f); return true; };
+    auto monotonic = [&seen](bool need_end) {
+        if (seen.empty() || (need_end && seen.back() != 1.0)) return false;
+        bool middle = false;
+        for (size_t i = 0; i < seen.size(); ++i) {
+            if (i > 0 && seen[i] < seen[i - 1]) return false;
+            middle = middle || (seen[i] > 0.0 && seen[i] < 1.0);
+        }
+        return middle;
+    };
+
+    cv::Mat plain, tracked;
+    Processor::Resize(img, 250, 170, plain, Processor::Interpolation::kBicubic);
+    if (!Processor::Resize(img, 250, 170, tracked, Processor::Interpolation::kBicubic, record) ||
+        !SameBytes(tracked, plain) || !monotonic(true)) {
+        std::cerr << "[ImgProc] Resize progress wrong" << std::endl; ++failed;
+    }
+    seen.clear();
+    if (!Processor::GaussianBlur(img, tracked, 3.0, 4, record) || !SameBytes(tracked, Processor::GaussianBlur(img, 3.0)) ||
+        !monotonic(true)) {
+        std::cerr << "[ImgProc] GaussianBlur progress wrong" << std::endl; ++failed;
+    }
+
+    // 第一次汇报就要求取消：非原地时输出被置空
+    int calls = 0;
+    ProgressFn cancel = [&calls](double) { ++calls; return false; };
+    if (Processor::Resize(img, 250, 170, tracked, Processor::Interpolation::kBilinear, cancel) || !tracked.empty() || calls != 1) {
+        std::cerr << "[ImgProc] cancelled Resize did not stop" << std::endl; ++failed;
+    }
+    calls = 0;
+    if (Processor::BoxBlur(img, tracked, 2, 4, cancel) || !tracked.empty() || calls != 1) {
+        std::cerr << "[ImgProc] cancelled BoxBlur did not stop" << std::endl; ++failed;
+    }
+
+    // 压缩保存：统计与三元组提取两个阶段边界，在第一个边界取消时不写文件
+    const std::string path = std::string(OUTPUT_DIR) + "/progress.trip";
+    seen.clear();
+    if (!Compressor::Save(path, img, nullptr, record) || !monotonic(false) || seen.size() != 2 ||
+        !SameBytes(Compressor::Load(path), img)) {
+        std::cerr << "[ImgProc] Compressor::Save progress wrong" << std::endl; ++failed;
+    }
+    std::remove(path.c_str());
+    calls = 0;
+    if (Compressor::Save(path, img, nullptr, cancel) || calls != 1 || std::ifstream(path).good()) {
+        std::cerr << "[ImgProc] cancelled Compressor::Save wrote a file" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+// 裁剪视图：不拷贝像素；处理、统计、三元组与压缩入口对不连续的视图与其连续拷贝结果相同；
+// 输出可以是另一幅图像上的视图，与输入重叠时才解除共享
+static int test_crop() {
+    int failed = 0;
+    cv::Mat img(61, 83, CV_8UC3);
+    for (int r = 0; r < img.rows; ++r) {
+        for (int c = 0; c < img.cols; ++c) {
+            img.at<cv::Vec3b>(r, c) = (r / 6 + c / 9) % 3 ? cv::Vec3b(40, 50, 60)
+                                                          : cv::Vec3b((r * 7) & 255, (c * 13) & 255, (r * c) & 255);
+        }
+    }
+    const cv::Rect roi(7, 5, 50, 41);
+    cv::Mat view = Processor::Crop(img, roi);
+    const cv::Mat copy = view.clone();
+    if (view.data != img.ptr(roi.y) + roi.x * img.elemSize() || view.isContinuous() || view.cols != roi.width ||
+        !Processor::Crop(img, cv::Rect(70, 0, 14, 1)).empty() || !Processor::Crop(img, cv::Rect(0, 0, 0, 1)).empty() ||
+        !Processor::Crop(img, cv::Rect(0, -1, 4, 4)).empty() || !Processor::Crop(cv::Mat(), roi).empty()) {
+        std::cerr << "[ImgProc] Crop view/validation mismatch" << std::endl; ++failed;
+    }
+
+    const Processor::Interpolation modes[] = {Processor::Interpolation::kBilinear, Processor::Interpolation::kBicubic,
+                                              Processor::Interpolation::kLanczos3};
+    bool same = SameBytes(Processor::ToGray(view), Processor::ToGray(copy)) &&
+                SameBytes(Processor::BoxBlur(view, 3), Processor::BoxBlur(copy, 3)) &&
+                SameBytes(Processor::GaussianBlur(view, 2.0), Processor::GaussianBlur(copy, 2.0));
+    for (Processor::Interpolation mode : modes) {
+        same = same && SameBytes(Processor::Resize(view, 23, 71, mode), Processor::Resize(copy, 23, 71, mode));
+    }
+    if (!same) { std::cerr << "[ImgProc] processing a crop view differs from its copy" << std::endl; ++failed; }
+
+    // 先裁剪再缩放：与对拷贝缩放相同
+    const cv::Mat chained = Operation::ApplyAll({Operation::Crop(roi.x, roi.y, roi.width, roi.height),
+                                                 Operation::Resize(20, 16)}, img);
+    if (!SameBytes(chained, Processor::Resize(copy, 20, 16))) {
+        std::cerr << "[ImgProc] crop-then-resize mismatch" << std::endl; ++failed;
+    }
+
+    ImageStats a, b;
+    uint16_t bg_view[4], bg_copy[4];
+    TripletUtils::FindBackgroundColor(view, bg_view);
+    TripletUtils::FindBackgroundColor(copy, bg_copy);
+    TripletBuffer triplets;
+    TripletUtils::MatToTriplets(view, bg_view, triplets);
+    cv::Mat rebuilt;
+    TripletUtils::TripletsToMat(triplets, rebuilt);
+    ImageStatsOptions with_mode; with_mode.color_mode = true;
+    if (!ImageStats::Compute(view, a, with_mode) || !ImageStats::Compute(copy, b, with_mode) || a.mode_count != b.mode_count ||
+        a.unique_colors != b.unique_colors || std::memcmp(bg_view, bg_copy, sizeof(bg_view)) != 0 ||
+        !SameBytes(rebuilt, copy) || !TripletUtils::DiffToTriplets(view, copy, 0, triplets) || triplets.size() != 0) {
+        std::cerr << "[ImgProc] stats/triplets of a crop view differ from its copy" << std::endl; ++failed;
+    }
+    const std::string trip_path = std::string(OUTPUT_DIR) + "/crop_view.trip";
+    const std::string ppm_path = std::string(OUTPUT_DIR) + "/crop_view.ppm";
+    if (!Compressor::Save(trip_path, view) || !SameBytes(Compressor::Load(trip_path), copy) ||
+        !ImageIO::SavePpm(ppm_path, view) || !SameBytes(ImageIO::LoadPpm(ppm_path), copy)) {
+        std::cerr << "[ImgProc] saving a crop view failed" << std::endl; ++failed;
+    }
+
+    // 输出为同一幅图像上不重叠的视图：结果直接写入该区域，其余像素不变
+    cv::Mat canvas = img.clone();
+    const cv::Mat left = Processor::Crop(canvas, cv::Rect(0, 0, 40, 30));
+    cv::Mat right = Processor::Crop(canvas, cv::Rect(40, 0, 40, 30));
+    const cv::Mat left_copy = left.clone();
+    const uint8_t* right_data = right.data;
+    if (!Processor::Resize(left, 40, 30, right, Processor::Interpolation::kBicubic) || right.data != right_data ||
+        !SameBytes(Processor::Crop(canvas, cv::Rect(40, 0, 40, 30)), Processor::Resize(left_copy, 40, 30, Processor::Interpolation::kBicubic)) ||
+        !SameBytes(Processor::Crop(canvas, cv::Rect(0, 30, 83, 31)), img(cv::Rect(0, 30, 83, 31)))) {
+        std::cerr << "[ImgProc] writing into a crop view failed" << std::endl; ++failed;
+    }
+    // 重叠的视图：解除共享后输出新图像，画布不变
+    cv::Mat shifted = Processor::Crop(canvas, cv::Rect(20, 10, 40, 30));
+    const cv::Mat before = canvas.clone();
+    if (!Processor::Resize(left, 40, 30, shifted) || shifted.data == canvas.ptr(10) + 20 * canvas.elemSize() ||
+        !SameBytes(shifted, Processor::Resize(left_copy, 40, 30)) || !SameBytes(canvas, before)) {
+        std::cerr << "[ImgProc] overlapping output view was written in place" << std::endl; ++failed;
+    }
+    // 视图上原地模糊只改动视图区域
+    cv::Mat blur_view = Processor::Crop(canvas, roi);
+    const cv::Mat blur_expected = Processor::BoxBlur(blur_view.clone(), 2);
+    if (!Processor::BoxBlur(blur_view, blur_view, 2) || !SameBytes(Processor::Crop(canvas, roi), blur_expected) ||
+        !SameBytes(Processor::Crop(canvas, cv::Rect(0, 0, 83, 5)), before(cv::Rect(0, 0, 83, 5)))) {
+        std::cerr << "[ImgProc] in-place blur on a crop view mismatch" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+int test_imgproc() {
+    int failed = test_output_reuse();
+    failed += test_image_stats();
+    failed += test_tiled();
+    failed += test_blur();
+    failed += test_progress();
+    failed += test_crop();
     cv::Mat color = ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
     if (color.empty()) { std::cerr << "[ImgProc] load color failed" << std::endl; return ++failed; }
 
@@ -21,5 +616,58 @@ int test_imgproc() {
     cv::Mat down = Processor::Resize(gray, gray.cols / 2, gray.rows / 2);
     if (down.empty() || down.rows != gray.rows / 2 || down.cols != gray.cols / 2) { std::cerr << "[ImgProc] Resize down failed" << std::endl; ++failed; }
 
+    // 编译期分派：4 通道与 16 位图像走各自的内核实例，类型保持不变
+    cv::Mat rgba(10, 12, CV_8UC4, cv::Scalar(1, 2, 3, 255));
+    cv::Mat rgba_up = Processor::Resize(rgba, 24, 20);
+    if (rgba_up.type() != CV_8UC4 || rgba_up.at<cv::Vec4b>(19, 23)[3] != 255) { std::cerr << "[ImgProc] Resize 8UC4 failed" << std::endl; ++failed; }
+    cv::Mat deep(8, 8, CV_16UC3, cv::Scalar(1000, 40000, 65535));
+    cv::Mat deep_down = Processor::Resize(deep, 3, 3);
+    if (deep_down.type() != CV_16UC3 || deep_down.ptr<uint16_t>(1)[5] != 65535) { std::cerr << "[ImgProc] Resize 16UC3 failed" << std::endl; ++failed; }
+    cv::Mat deep_gray = Processor::ToGray(deep);
+    if (deep_gray.type() != CV_16UC1) { std::cerr << "[ImgProc] ToGray 16UC3 failed" << std::endl; ++failed; }
+
+    // BGRA 灰度：按 alpha 合成到白色背景，完全透明为白色，不透明与 BGR 结果一致
+    cv::Mat bgra(2, 2, CV_8UC4, cv::Scalar(0, 0, 0, 0));
+    bgra.at<cv::Vec4b>(0, 1) = cv::Vec4b(0, 0, 0, 255);
+    bgra.at<cv::Vec4b>(1, 0) = cv::Vec4b(0, 0, 0, 128);
+    cv::Mat bgra_gray = Processor::ToGray(bgra);
+    if (bgra_gray.type() != CV_8UC1 || bgra_gray.at<uint8_t>(0, 0) != 255 || bgra_gray.at<uint8_t>(0, 1) != 0 ||
+        bgra_gray.at<uint8_t>(1, 0) != 127) {
+        std::cerr << "[ImgProc] ToGray 8UC4 failed" << std::endl; ++failed;
+    }
+    cv::Mat deep_alpha(2, 2, CV_16UC4, cv::Scalar(65535, 65535, 65535, 0));
+    if (Processor::ToGray(deep_alpha).at<uint16_t>(1, 1) != 65535) { std::cerr << "[ImgProc] ToGray 16UC4 failed" << std::endl; ++failed; }
+    cv::Mat gray_copy = Processor::ToGray(deep_gray);
+    if (gray_copy.type() != CV_16UC1 || gray_copy.data == deep_gray.data ||
+        gray_copy.at<uint16_t>(0, 0) != deep_gray.at<uint16_t>(0, 0)) {
+        std::cerr << "[ImgProc] ToGray 16UC1 failed" << std::endl; ++failed;
+    }
+
+    // 双三次与 Lanczos-3：权重归一化，常数图像缩放后不变；同尺寸时为恒等变换
+    const Processor::Interpolation modes[] = {Processor::Interpolation::kBicubic, Processor::Interpolation::kLanczos3};
+    for (Processor::Interpolation mode : modes) {
+        cv::Mat flat = Processor::Resize(deep, 13, 5, mode);
+        if (flat.type() != CV_16UC3 || flat.at<cv::Vec3w>(4, 12)[1] != 40000 || flat.at<cv::Vec3w>(0, 0)[2] != 65535) {
+            std::cerr << "[ImgProc] filtered resize of flat image failed" << std::endl; ++failed;
+        }
+        cv::Mat same = Processor::Resize(color, color.cols, color.rows, mode);
+        if (same.type() != color.type() || std::memcmp(same.data, color.data, color.total() * color.elemSize()) != 0) {
+            std::cerr << "[ImgProc] filtered resize at same size is not identity" << std::endl; ++failed;
+        }
+    }
+
+    // 缩小时滤波器按比例放宽：1 像素棋盘格缩小一半应接近均匀灰，而不是混叠成黑或白
+    cv::Mat checker(64, 64, CV_8UC1);
+    for (int r = 0; r < 64; ++r) {
+        for (int c = 0; c < 64; ++c) checker.at<uint8_t>(r, c) = ((r + c) & 1) ? 255 : 0;
+    }
+    cv::Mat smooth = Processor::Resize(checker, 32, 32, Processor::Interpolation::kLanczos3);
+    if (smooth.empty() || std::abs(static_cast<int>(smooth.at<uint8_t>(16, 16)) - 128) > 8) {
+        std::cerr << "[ImgProc] Lanczos downscale aliasing" << std::endl; ++failed;
+    }
+    if (Processor::Resize(rgba, 0, 4, Processor::Interpolation::kBicubic).data != nullptr) {
+        std::cerr << "[ImgProc] filtered resize accepted invalid size" << std::endl; ++failed;
+    }
+
     return failed;
 }
\ No newline at end of file
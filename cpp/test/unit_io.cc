@@ -1,17 +1,99 @@
-// I/O 模块单元测试：验证 PPM/PNG 读写，以及 Triplet 文本读写接口
+// I/O 模块单元测试：验证 PPM/PNG 读写，以及 Triplet 文本读写接口、批量异步读文件
+#include <cerrno>
+#include <fstream>
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "../src/io/async_file_reader.h"
 #include "../src/io/image_io.h"
 #include "../src/io/ppm.h"
+#include "../src/io/area_reducer.h"
+#include "../src/codec/compressor.h"
+#include "../src/io/image_cache.h"
+#include "../src/imgproc/image_processor.h"
 
 static bool checkSame(const cv::Mat& a, const cv::Mat& b) {
     if (a.size() != b.size() || a.type() != b.type()) return false;
     return std::memcmp(a.data, b.data, a.total() * a.elemSize()) == 0;
 }
 
-int test_io() {
+// 两种后端读到的内容一致，每个文件恰好回调一次；缺失文件、取消与回调异常
+static int test_async_reader() {
     int failed = 0;
+    std::vector<std::string> paths;
+    std::vector<std::vector<uint8_t>> contents;
+    const size_t sizes[] = {0, 1, 4097, 200000};
+    for (int i = 0; i < 40; ++i) {
+        std::vector<uint8_t> bytes(sizes[i % 4] + i);
+        for (size_t k = 0; k < bytes.size(); ++k) bytes[k] = static_cast<uint8_t>(k * 31 + i);
+        paths.push_back(std::string(OUTPUT_DIR) + "/async_" + std::to_string(i) + ".bin");
+        std::ofstream(paths.back(), std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        contents.push_back(bytes);
+    }
+    paths.push_back(std::string(OUTPUT_DIR) + "/async_missing.bin");
+
+    for (AsyncReadOptions::Backend backend : {AsyncReadOptions::Backend::kThreads, AsyncReadOptions::Backend::kAuto}) {
+        AsyncReadOptions options;
+        options.backend = backend;
+        options.queue_depth = 8;
+        AsyncFileReader reader(options);
+        const char* name = reader.backend() == AsyncReadOptions::Backend::kIoUring ? "io_uring" : "threads";
+        if (backend == AsyncReadOptions::Backend::kAuto && AsyncFileReader::IoUringAvailable() &&
+            reader.backend() != AsyncReadOptions::Backend::kIoUring) {
+            std::cerr << "[IO] io_uring available but not used" << std::endl; ++failed;
+        }
+
+        // 同一个读取器连续使用两次
+        for (int round = 0; round < 2; ++round) {
+            std::vector<int> seen(paths.size(), 0);
+            bool content_ok = true;
+            int missing_error = 0;
+            size_t n = reader.ReadAll(paths, [&](FileData& data) {
+                ++seen[data.index];
+                if (data.index == contents.size()) {
+                    missing_error = data.error;
+                } else if (data.error != 0 || data.bytes != contents[data.index]) {
+                    content_ok = false;
+                }
+            });
+            bool once = n == paths.size();
+            for (int v : seen) once = once && v == 1;
+            if (!once || !content_ok || missing_error != ENOENT) {
+                std::cerr << "[IO] async read (" << name << ") mismatch" << std::endl; ++failed;
+            }
+        }
+
+        // 预先取消：不读取任何文件
+        std::atomic<bool> cancel{true};
+        if (reader.ReadAll(paths, [](FileData&) {}, &cancel) != 0) {
+            std::cerr << "[IO] async read (" << name << ") ignored cancel" << std::endl; ++failed;
+        }
+
+        // 回调抛出的异常在读取结束后传播，之后读取器仍可使用
+        bool thrown = false;
+        try {
+            reader.ReadAll(paths, [](FileData& data) { if (data.index == 3) throw std::runtime_error("stop"); });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        size_t again = reader.ReadAll(paths, [](FileData&) {});
+        if (!thrown || again != paths.size()) {
+            std::cerr << "[IO] async read (" << name << ") callback exception not propagated" << std::endl; ++failed;
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    if (AsyncFileReader::ReadWholeFile(paths[2], bytes) != 0 || bytes != contents[2] ||
+        AsyncFileReader::ReadWholeFile(paths.back(), bytes) != ENOENT || !bytes.empty()) {
+        std::cerr << "[IO] ReadWholeFile mismatch" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+int test_io() {
+    int failed = test_async_reader();
     // 1) 读取 P2 灰度
     cv::Mat lena128 = ImageIO::LoadPpm(std::string(DATA_DIR) + "/lena-128-gray.ppm");
     if (lena128.empty() || lena128.channels() != 1 || lena128.rows != 128 || lena128.cols != 128) {
@@ -60,4 +142,219 @@ int test_io() {
     }
 
     return failed;
-}
\ No newline at end of file
+}
+// 解码图像缓存：命中共享内存、文件更新后重新解码、显式失效与按容量淘汰
+int test_image_cache() {
+    int failed = 0;
+    ImageCache& cache = ImageCache::Instance();
+    cache.SetCapacity(64ull << 20);
+    const std::string path = std::string(OUTPUT_DIR) + "/cache_src.ppm";
+    cv::Mat small = ImageIO::LoadPpm(std::string(DATA_DIR) + "/lena-128-gray.ppm");
+    if (small.empty() || !ImageIO::SavePpm(path, small)) {
+        std::cerr << "[Cache] prepare failed" << std::endl;
+        cache.SetCapacity(0);
+        return ++failed;
+    }
+
+    ImageCache::Stats s0 = cache.GetStats();
+    cv::Mat a = ImageIO::LoadPpm(path);
+    cv::Mat b = ImageIO::LoadPpm(std::string(OUTPUT_DIR) + "/./cache_src.ppm");   // 同一文件的不同写法
+    ImageCache::Stats s1 = cache.GetStats();
+    if (a.empty() || a.data == b.data || !checkSame(a, b) || s1.misses != s0.misses + 1 || s1.hits != s0.hits + 1) {
+        std::cerr << "[Cache] second load should hit and return a private copy" << std::endl;
+        ++failed;
+    }
+
+    // 原地修改加载结果不会改写缓存
+    cv::Mat original = a.clone();
+    if (!Processor::BoxBlur(a, a, 3) || !Processor::BoxBlur(b, b, 5) || checkSame(a, original) ||
+        !checkSame(ImageIO::LoadPpm(path), original)) {
+        std::cerr << "[Cache] in-place edit of a loaded image corrupted the cache" << std::endl;
+        ++failed;
+    }
+
+    // 同尺寸改写：大小与修改时间可能都不变，由 Save 显式失效
+    cv::Mat inverted = original.clone();
+    for (int r = 0; r < inverted.rows; ++r) {
+        uint8_t* row = inverted.ptr<uint8_t>(r);
+        for (size_t i = 0; i < static_cast<size_t>(inverted.cols) * inverted.channels(); ++i) row[i] = static_cast<uint8_t>(255 - row[i]);
+    }
+    ImageCache::Stats s_same = cache.GetStats();
+    if (!ImageIO::SavePpm(path, inverted) || !checkSame(ImageIO::LoadPpm(path), inverted) ||
+        cache.GetStats().misses != s_same.misses + 1) {
+        std::cerr << "[Cache] same-size rewrite not invalidated" << std::endl;
+        ++failed;
+    }
+
+    // 文件被改写（大小不同）后重新解码
+    cv::Mat big = ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
+    ImageIO::SavePpm(path, big);
+    cv::Mat c = ImageIO::LoadPpm(path);
+    if (c.empty() || c.size() != big.size() || !checkSame(c, big)) {
+        std::cerr << "[Cache] stale entry returned after file changed" << std::endl;
+        ++failed;
+    }
+
+    // 显式失效
+    cache.Invalidate(path);
+    ImageCache::Stats s2 = cache.GetStats();
+    cv::Mat d = ImageIO::LoadPpm(path);
+    if (cache.GetStats().misses != s2.misses + 1 || !checkSame(d, c)) {
+        std::cerr << "[Cache] Invalidate did not drop the entry" << std::endl;
+        ++failed;
+    }
+
+    // 容量只够一张大图时，加载另一张会淘汰它
+    size_t big_bytes = big.total() * big.elemSize();
+    cache.Clear();
+    cache.SetCapacity(big_bytes + big_bytes / 2);
+    ImageIO::LoadPpm(path);
+    ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
+    ImageCache::Stats s3 = cache.GetStats();
+    if (s3.entries != 1 || s3.bytes > s3.capacity || s3.evictions == 0) {
+        std::cerr << "[Cache] LRU eviction by byte capacity failed" << std::endl;
+        ++failed;
+    }
+
+    cache.SetCapacity(0);
+    if (cache.GetStats().entries != 0 || cache.enabled()) {
+        std::cerr << "[Cache] disabling should clear entries" << std::endl;
+        ++failed;
+    }
+    return failed;
+}
+
+// 预览解码：各格式的降分辨率路径与"完整解码 + 区域平均"结果一致
+int test_preview() {
+    int failed = 0;
+    const std::string color_path = std::string(DATA_DIR) + "/color-block.ppm";
+    cv::Mat color = ImageIO::LoadPpm(color_path);
+
+    // PPM 逐行缩小
+    cv::Mat p = ImageIO::LoadPreview(color_path, 100);
+    if (p.rows != 100 || p.cols != 100 || !checkSame(p, AreaReducer::Reduce(color, cv::Size(100, 100)))) {
+        std::cerr << "[Preview] PPM strip reduction mismatch" << std::endl;
+        ++failed;
+    }
+    // 上限不小于原图时不缩小
+    if (!checkSame(ImageIO::LoadPreview(color_path, 1000), color)) {
+        std::cerr << "[Preview] PPM preview should equal full decode when not reduced" << std::endl;
+        ++failed;
+    }
+    cv::Mat gray = ImageIO::LoadPreview(std::string(DATA_DIR) + "/lena-128-gray.ppm", 50);
+    if (gray.rows != 50 || gray.cols != 50 || gray.channels() != 1) {
+        std::cerr << "[Preview] P2 preview size mismatch" << std::endl;
+        ++failed;
+    }
+
+    // P6 二进制格式逐行读取，结果与文本格式一致
+    const std::string p6_path = std::string(OUTPUT_DIR) + "/preview_color_p6.ppm";
+    {
+        std::ofstream ofs(p6_path, std::ios::binary);
+        ofs << "P6\n" << color.cols << " " << color.rows << "\n255\n";
+        for (int r = 0; r < color.rows; ++r) {
+            for (int c = 0; c < color.cols; ++c) {
+                const cv::Vec3b& bgr = color.at<cv::Vec3b>(r, c);
+                const char rgb[3] = {static_cast<char>(bgr[2]), static_cast<char>(bgr[1]), static_cast<char>(bgr[0])};
+                ofs.write(rgb, 3);
+            }
+        }
+    }
+    if (!checkSame(Ppm::LoadPpmAsMat(p6_path), color)) {
+        std::cerr << "[Preview] P6 full decode mismatch" << std::endl;
+        ++failed;
+    }
+    cv::Mat p6 = ImageIO::LoadPreview(p6_path, 100);
+    if (p6.rows != 100 || p6.cols != 100 || !checkSame(p6, AreaReducer::Reduce(color, cv::Size(100, 100)))) {
+        std::cerr << "[Preview] P6 preview mismatch" << std::endl;
+        ++failed;
+    }
+
+    // 16 位 P5：每个样本 2 字节大端，归一化到 8 位
+    const std::string p5_path = std::string(OUTPUT_DIR) + "/preview_gray16_p5.pgm";
+    {
+        std::ofstream ofs(p5_path, std::ios::binary);
+        ofs << "P5\n4 2\n65535\n";
+        const unsigned char px[16] = {0, 0, 0xFF, 0xFF, 0x80, 0x00, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0x80, 0x00, 0xFF, 0xFF};
+        ofs.write(reinterpret_cast<const char*>(px), sizeof(px));
+    }
+    cv::Mat p5 = ImageIO::LoadPreview(p5_path, 2);
+    if (p5.rows != 1 || p5.cols != 2 || p5.channels() != 1 || p5.at<uint8_t>(0, 0) != 128 || p5.at<uint8_t>(0, 1) != 191) {
+        std::cerr << "[Preview] 16-bit P5 preview mismatch" << std::endl;
+        ++failed;
+    }
+
+    // TRIP 在缩小网格上累加
+    const std::string trip_path = std::string(OUTPUT_DIR) + "/preview_color.trip";
+    if (!Compressor::Save(trip_path, color)) {
+        std::cerr << "[Preview] save trip failed" << std::endl;
+        ++failed;
+    } else {
+        cv::Mat t = ImageIO::LoadPreview(trip_path, 77);
+        cv::Mat expected = AreaReducer::Reduce(Compressor::Load(trip_path), AreaReducer::FitWithin(color.cols, color.rows, 77));
+        if (t.empty() || !checkSame(t, expected)) {
+            std::cerr << "[Preview] TRIP preview mismatch" << std::endl;
+            ++failed;
+        }
+    }
+
+    // PNG 完整解码后缩小
+    const std::string png_path = std::string(OUTPUT_DIR) + "/preview_color.png";
+    if (ImageIO::SavePng(png_path, color)) {
+        cv::Mat png = ImageIO::LoadPreview(png_path, 64);
+        if (png.rows != 64 || png.cols != 64 || !checkSame(png, AreaReducer::Reduce(color, cv::Size(64, 64)))) {
+            std::cerr << "[Preview] PNG preview mismatch" << std::endl;
+            ++failed;
+        }
+    }
+
+    // 保持宽高比，非法参数返回空
+    if (AreaReducer::FitWithin(390, 200, 100) != cv::Size(100, 51) ||
+        !ImageIO::LoadPreview(color_path, 0).empty() ||
+        !ImageIO::LoadPreview(std::string(OUTPUT_DIR) + "/missing.ppm", 64).empty()) {
+        std::cerr << "[Preview] argument handling failed" << std::endl;
+        ++failed;
+    }
+    return failed;
+}
+
+// 内存编解码：解码不拷贝输入即可往返，编码参数生效且复用输出缓冲区
+int test_buffer_codec() {
+    int failed = 0;
+    cv::Mat color = ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
+
+    std::vector<uint8_t> buf;
+    ImageIO::EncodeOptions options;
+    options.png_compression = 0;
+    options.png_strategy = ImageIO::EncodeOptions::PngStrategy::kRle;
+    if (!ImageIO::EncodeToBuffer(color, "png", options, &buf) || buf.empty()) {
+        std::cerr << "[Buffer] encode PNG failed" << std::endl;
+        return ++failed;
+    }
+    cv::Mat decoded = ImageIO::DecodeFromBuffer(buf.data(), buf.size());
+    if (!checkSame(decoded, color)) {
+        std::cerr << "[Buffer] PNG round trip mismatch" << std::endl;
+        ++failed;
+    }
+
+    // 同一图像再次编码到同一缓冲区，不应重新分配
+    const uint8_t* first = buf.data();
+    size_t capacity = buf.capacity();
+    if (!ImageIO::EncodeToBuffer(color, ".PNG", options, &buf) || buf.data() != first || buf.capacity() != capacity) {
+        std::cerr << "[Buffer] encode did not reuse the caller's buffer" << std::endl;
+        ++failed;
+    }
+
+    // 其他格式与非法输入
+    std::vector<uint8_t> ppm;
+    options.ppm_binary = false;
+    if (!ImageIO::EncodeToBuffer(color, "ppm", options, &ppm) || !checkSame(ImageIO::DecodeFromBuffer(ppm.data(), ppm.size()), color)) {
+        std::cerr << "[Buffer] PPM round trip mismatch" << std::endl;
+        ++failed;
+    }
+    if (!ImageIO::DecodeFromBuffer(nullptr, 0).empty() || ImageIO::EncodeToBuffer(cv::Mat(), "png", &buf)) {
+        std::cerr << "[Buffer] invalid input should fail" << std::endl;
+        ++failed;
+    }
+    return failed;
+}
@@ -0,0 +1,235 @@
+// 批处理与帧序列流水线单元测试：并行处理多个文件、按序写出、事件回调、错误与取消、批量异步加载
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../src/io/image_io.h"
+#include "../src/pipeline/async_image_loader.h"
+#include "../src/pipeline/batch_pipeline.h"
+#include "../src/pipeline/image_file.h"
+#include "../src/pipeline/sequence_pipeline.h"
+
+// 异步加载的结果与逐个 ImageFile::Load 相同，失败的文件给出原因
+static int test_async_loader(const cv::Mat& color) {
+    int failed = 0;
+    const std::string out_dir = std::string(OUTPUT_DIR);
+    cv::Mat bgra16(40, 30, CV_16UC4, cv::Scalar(100, 200, 300, 65535));
+    bgra16.ptr<uint16_t>(5)[7] = 12345;
+    std::vector<std::string> paths;
+    for (int i = 0; i < 12; ++i) {
+        const char* exts[] = {".png", ".ppm", ".trip"};
+        paths.push_back(out_dir + "/async_load_" + std::to_string(i) + exts[i % 3]);
+        if (!ImageFile::Save(paths.back(), i == 2 ? bgra16 : color)) { std::cerr << "[Pipeline] save " << paths.back() << " failed" << std::endl; return ++failed; }
+    }
+    paths.push_back(out_dir + "/async_load_missing.png");
+    paths.push_back(std::string(DATA_DIR) + "/color-block.ppm");
+    std::ofstream(out_dir + "/async_load_bad.trip") << "not a trip file";
+    paths.push_back(out_dir + "/async_load_bad.trip");
+
+    for (AsyncReadOptions::Backend backend : {AsyncReadOptions::Backend::kThreads, AsyncReadOptions::Backend::kAuto}) {
+        AsyncLoadOptions options;
+        options.read.backend = backend;
+        options.read.queue_depth = 4;
+        options.decode_threads = 3;
+        AsyncImageLoader loader(options);
+        std::vector<std::string> errors;
+        std::vector<cv::Mat> images = loader.LoadAll(paths, &errors);
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const bool expect_fail = i == 12 || i == 14;
+            cv::Mat expected = expect_fail ? cv::Mat() : ImageFile::Load(paths[i]);
+            bool same = images[i].size() == expected.size() && images[i].type() == expected.type() &&
+                        (expected.empty() || std::memcmp(images[i].data, expected.data, expected.total() * expected.elemSize()) == 0);
+            if (!same || errors[i].empty() != !expect_fail) {
+                std::cerr << "[Pipeline] async load " << paths[i] << " mismatch: " << errors[i] << std::endl; ++failed;
+            }
+        }
+        if (errors[12].find("failed to read") == std::string::npos || errors[14].find("failed to decode") == std::string::npos) {
+            std::cerr << "[Pipeline] async load errors not reported" << std::endl; ++failed;
+        }
+        // 回调版本每个文件回调一次，返回值只计成功解码的文件
+        std::atomic<size_t> callbacks{0};
+        size_t loaded = loader.LoadAll(paths, [&](LoadedImage&) { ++callbacks; });
+        if (callbacks != paths.size() || loaded != paths.size() - 2) {
+            std::cerr << "[Pipeline] async load returned " << loaded << " of " << callbacks << " callbacks" << std::endl; ++failed;
+        }
+    }
+    return failed;
+}
+
+int test_pipeline() {
+    int failed = 0;
+    const std::string out_dir = std::string(OUTPUT_DIR);
+    cv::Mat color = ImageIO::LoadPpm(std::string(DATA_DIR) + "/color-block.ppm");
+    if (color.empty()) { std::cerr << "[Pipeline] load color failed" << std::endl; return ++failed; }
+    failed += test_async_loader(color);
+
+    // 扩展名分派
+    if (ImageFile::FormatOf("a.PNG") != ImageFile::Format::kPng || ImageFile::FormatOf("a.pgm") != ImageFile::Format::kPpm ||
+        ImageFile::FormatOf("a.trip") != ImageFile::Format::kTrip || ImageFile::FormatOf("a.bmp") != ImageFile::Format::kUnknown) {
+        std::cerr << "[Pipeline] FormatOf failed" << std::endl; ++failed;
+    }
+
+    // 8 个作业，输出格式各不相同；最后一个作业的输入不存在
+    std::vector<BatchJob> jobs;
+    const char* exts[] = {".png", ".ppm", ".trip"};
+    for (int i = 0; i < 7; ++i) {
+        BatchJob job;
+        job.input = std::string(DATA_DIR) + "/color-block.ppm";
+        job.output = out_dir + "/batch_" + std::to_string(i) + exts[i % 3];
+        job.ops = {Operation::Gray(), Operation::Resize(64 + i, 32)};
+        jobs.push_back(job);
+    }
+    jobs.push_back(BatchJob{out_dir + "/no_such_file.png", out_dir + "/never.png", {}});
+
+    BatchOptions options;
+    options.concurrency = 4;
+    options.memory_budget = 1;   // 极小的预算也不应死锁
+    std::mutex mutex;
+    size_t finished_events = 0, failed_events = 0, last_completed = 0;
+    bool monotonic = true;
+    BatchResult result = BatchPipeline(options).Run(jobs, [&](const BatchEvent& ev) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ev.type == BatchEvent::Type::kStarted) return;
+        if (ev.type == BatchEvent::Type::kFinished) ++finished_events;
+        if (ev.type == BatchEvent::Type::kFailed) ++failed_events;
+        if (ev.completed <= last_completed) monotonic = false;
+        last_completed = ev.completed;
+    });
+    if (result.succeeded != 7 || result.failed != 1 || result.errors[7].empty() || !result.errors[0].empty()) {
+        std::cerr << "[Pipeline] batch result mismatch" << std::endl; ++failed;
+    }
+    if (finished_events != 7 || failed_events != 1 || !monotonic || last_completed != jobs.size()) {
+        std::cerr << "[Pipeline] batch events mismatch" << std::endl; ++failed;
+    }
+    for (int i = 0; i < 7; ++i) {
+        cv::Mat out = ImageFile::Load(jobs[i].output);
+        if (out.empty() || out.channels() != 1 || out.cols != 64 + i || out.rows != 32) {
+            std::cerr << "[Pipeline] output " << jobs[i].output << " mismatch" << std::endl; ++failed;
+        }
+    }
+
+    // 非法步骤报告失败的步骤
+    BatchResult bad = BatchPipeline().Run({BatchJob{jobs[0].input, out_dir + "/bad.png", {Operation::Resize(0, 10)}}});
+    if (bad.failed != 1 || bad.errors[0].find("resize") == std::string::npos) {
+        std::cerr << "[Pipeline] invalid operation not reported" << std::endl; ++failed;
+    }
+
+    // 预先取消：全部跳过
+    std::atomic<bool> cancel{true};
+    BatchResult skipped = BatchPipeline().Run(jobs, BatchPipeline::EventCallback(), &cancel);
+    if (!skipped.cancelled || skipped.succeeded != 0 || skipped.failed != 0) {
+        std::cerr << "[Pipeline] cancel failed" << std::endl; ++failed;
+    }
+
+    // 第一个作业开始后取消：已开始的作业都以 kCancelled 结束，其余跳过
+    cancel = false;
+    BatchOptions serial;
+    serial.concurrency = 1;
+    size_t started = 0, cancelled_events = 0, other_events = 0;
+    BatchResult aborted = BatchPipeline(serial).Run(jobs, [&](const BatchEvent& ev) {
+        if (ev.type == BatchEvent::Type::kStarted) {
+            ++started;
+            cancel = true;
+        } else if (ev.type == BatchEvent::Type::kCancelled) {
+            ++cancelled_events;
+        } else {
+            ++other_events;
+        }
+    }, &cancel);
+    if (!aborted.cancelled || started != 1 || cancelled_events != 1 || other_events != 0 ||
+        aborted.succeeded != 0 || aborted.failed != 0) {
+        std::cerr << "[Pipeline] started job not terminated on cancel" << std::endl; ++failed;
+    }
+    return failed;
+}
+
+int test_sequence() {
+    int failed = 0;
+    namespace fs = std::filesystem;
+    const std::string in_dir = std::string(OUTPUT_DIR) + "/seq_in";
+    const std::string out_dir = std::string(OUTPUT_DIR) + "/seq_out";
+    fs::remove_all(in_dir);
+    fs::remove_all(out_dir);
+    fs::create_directories(in_dir);
+    fs::create_directories(out_dir);
+
+    // 12 帧纯色图像，编号不补零，通配符展开须按数值排序；另放一个不匹配的文件
+    const int kFrames = 12;
+    for (int i = 0; i < kFrames; ++i) {
+        cv::Mat frame(6, 8, CV_8UC3, cv::Scalar(i * 20, 255 - i * 20, 7));
+        if (!ImageIO::SavePpm(in_dir + "/frame_" + std::to_string(i) + ".ppm", frame)) {
+            std::cerr << "[Sequence] write frame failed" << std::endl; return ++failed;
+        }
+    }
+    std::ofstream(in_dir + "/notes.txt") << "x";
+    std::vector<std::string> frames = SequencePipeline::Glob(in_dir + "/frame_*.ppm");
+    bool sorted = frames.size() == static_cast<size_t>(kFrames);
+    for (int i = 0; sorted && i < kFrames; ++i) {
+        sorted = fs::path(frames[i]).filename().string() == "frame_" + std::to_string(i) + ".ppm";
+    }
+    if (!sorted) { std::cerr << "[Sequence] Glob order mismatch" << std::endl; ++failed; }
+    if (!SequencePipeline::Glob(in_dir + "/none_*.ppm").empty() || !SequencePipeline::Glob(out_dir + "/missing/*.ppm").empty()) {
+        std::cerr << "[Sequence] Glob should be empty" << std::endl; ++failed;
+    }
+
+    // 输出文件名模式
+    if (SequencePipeline::FrameName("f_%05d.png", 42) != "f_00042.png" || SequencePipeline::FrameName("%d%%.ppm", 7) != "7%.ppm" ||
+        !SequencePipeline::FrameName("f.png", 1).empty() || !SequencePipeline::FrameName("%d_%d.png", 1).empty() ||
+        !SequencePipeline::FrameName("%s.png", 1).empty()) {
+        std::cerr << "[Sequence] FrameName mismatch" << std::endl; ++failed;
+    }
+
+    // 写出阶段按帧序回调，输出与输入一一对应；中间插入一个不存在的帧
+    frames.insert(frames.begin() + 5, in_dir + "/missing.ppm");
+    SequenceOptions options;
+    options.workers = 3;
+    options.max_in_flight = 3;
+    options.start_number = 0;
+    size_t events = 0;
+    bool ordered = true;
+    SequenceResult result = SequencePipeline(options).Run(frames, {Operation::Resize(4, 3)}, out_dir + "/out_%03d.png",
+        [&](const SequenceEvent& ev) {
+            if (ev.index != events || ev.completed != events + 1 || ev.total != frames.size()) ordered = false;
+            if ((ev.type == SequenceEvent::Type::kFailed) != (ev.index == 5)) ordered = false;
+            ++events;
+        });
+    if (result.written != static_cast<size_t>(kFrames) || result.failed != 1 || result.errors[5].empty() || result.cancelled ||
+        result.fps <= 0.0 || result.seconds <= 0.0) {
+        std::cerr << "[Sequence] result mismatch" << std::endl; ++failed;
+    }
+    if (!ordered || events != frames.size()) { std::cerr << "[Sequence] events out of order" << std::endl; ++failed; }
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (i == 5) continue;
+        int src = static_cast<int>(i < 5 ? i : i - 1);
+        cv::Mat out = ImageFile::Load(SequencePipeline::FrameName(out_dir + "/out_%03d.png", static_cast<long long>(i)));
+        if (out.empty() || out.cols != 4 || out.rows != 3 || out.at<cv::Vec3b>(1, 1)[0] != src * 20) {
+            std::cerr << "[Sequence] output " << i << " mismatch" << std::endl; ++failed;
+        }
+    }
+    if (fs::exists(out_dir + "/out_005.png")) { std::cerr << "[Sequence] failed frame was written" << std::endl; ++failed; }
+
+    // 写出阶段直接编码的格式，单线程、在途 1 帧
+    options.workers = 1;
+    options.max_in_flight = 0;
+    frames.erase(frames.begin() + 5);
+    SequenceResult trip = SequencePipeline(options).Run(frames, {Operation::Gray()}, out_dir + "/g_%d.trip");
+    cv::Mat last = ImageFile::Load(out_dir + "/g_11.trip");
+    if (trip.written != static_cast<size_t>(kFrames) || last.empty() || last.channels() != 1) {
+        std::cerr << "[Sequence] trip output mismatch" << std::endl; ++failed;
+    }
+
+    // 非法模式全部失败；预先取消不读入任何帧
+    SequenceResult bad = SequencePipeline().Run(frames, {}, out_dir + "/fixed.png");
+    if (bad.failed != frames.size() || bad.errors[0].empty()) { std::cerr << "[Sequence] invalid pattern accepted" << std::endl; ++failed; }
+    std::atomic<bool> cancel{true};
+    SequenceResult skipped = SequencePipeline().Run(frames, {}, out_dir + "/c_%d.png", SequencePipeline::EventCallback(), &cancel);
+    if (!skipped.cancelled || skipped.written != 0 || skipped.failed != 0) {
+        std::cerr << "[Sequence] cancel failed" << std::endl; ++failed;
+    }
+    return failed;
+}
@@ -27,6 +27,7 @@ interface Window {
   native: {
     loadPpm: (filePath: string) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
     loadPng: (filePath: string) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
+    loadPreview: (filePath: string, maxDim: number) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
     savePpm: (filePath: string, img: { width: number; height: number; channels: number; data: Uint8Array }) => Promise<boolean>
     savePng: (filePath: string, img: { width: number; height: number; channels: number; data: Uint8Array }) => Promise<boolean>
     toGray: (img: { width: number; height: number; data: Uint8Array }) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
@@ -34,6 +35,24 @@ interface Window {
     compressorSave: (filePath: string, img: { width: number; height: number; channels: number; data: Uint8Array }) => Promise<boolean>
     compressorLoad: (filePath: string) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
 
+    // Batch processing
+    processBatch: (
+      jobs: Array<{ input: string; output: string; ops?: Array<{ op: 'gray' } | { op: 'resize'; width: number; height: number }> }>,
+      options?: { concurrency?: number; memoryBudget?: number }
+    ) => Promise<{ succeeded: number; failed: number; cancelled: boolean; errors: Array<string | null> }>
+    onBatchEvent: (listener: (ev: { type: 'started' | 'finished' | 'failed' | 'cancelled'; index: number; completed: number; total: number; message?: string }) => void) => () => void
+
+    // Native image handles (pixels stay in the main process)
+    handle: {
+      load: (filePath: string) => Promise<{ id: number; width: number; height: number; channels: number }>
+      toGray: (id: number) => Promise<{ id: number; width: number; height: number; channels: number }>
+      resize: (id: number, newW: number, newH: number) => Promise<{ id: number; width: number; height: number; channels: number }>
+      save: (id: number, filePath: string) => Promise<boolean>
+      pixels: (id: number) => Promise<{ width: number; height: number; channels: number; data: Uint8Array }>
+      draw: (id: number, canvasId: string) => Promise<void>
+      dispose: (id: number) => Promise<boolean>
+    }
+
     // File dialog APIs
     openImageDialog: () => Promise<string | null>
     savePngDialog: () => Promise<string | null>
@@ -50,6 +50,8 @@ function createWindow() {
       preload: path.join(__dirname, 'preload.mjs'),
       contextIsolation: true,
       nodeIntegration: false,
+      // 原生插件只在主进程加载，渲染进程与预加载脚本都运行在沙箱中，经 IPC 访问
+      sandbox: true,
     },
   })
 
@@ -103,56 +105,137 @@ try {
 } catch (e) {
   console.error('Failed to load native addon. Please build it in native-addon.', e)
 }
+// 同尺寸图像反复处理时复用输出内存
+native?.setBufferPool(true)
+// 同一文件反复加载（重新预览、撤销、重新导出）时复用已解码的图像
+native?.setImageCache(256 * 1024 * 1024)
 
-// 辅助函数
+// 辅助函数（IPC 处理函数均调用 xxxAsync，运算在工作线程执行，不阻塞主进程事件循环）
 const toBuffer = (u8: Uint8Array) => Buffer.from(u8.buffer, u8.byteOffset, u8.byteLength)
 
 // 加载 PPM 图像  
 ipcMain.handle('native:loadPpm', async (_event, filePath: string) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.loadPpm(filePath)
+  return native.loadPpmAsync(filePath)
 })
 
 // 加载 PNG 图像  
 ipcMain.handle('native:loadPng', async (_event, filePath: string) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.loadPng(filePath)
+  return native.loadPngAsync(filePath)
+})
+
+// 加载缩小的预览图（缩略图），长边不超过 maxDim
+ipcMain.handle('native:loadPreview', async (_event, filePath: string, maxDim: number) => {
+  if (!native) throw new Error('native addon not loaded')
+  return native.loadPreviewAsync(filePath, maxDim)
 })
 
 // 保存 PPM 图像  
 ipcMain.handle('native:savePpm', async (_event, filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.savePpm(filePath, img.width, img.height, img.channels, toBuffer(img.data))
+  return native.savePpmAsync(filePath, img.width, img.height, img.channels, toBuffer(img.data))
 })
 
 // 保存 PNG 图像  
 ipcMain.handle('native:savePng', async (_event, filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.savePng(filePath, img.width, img.height, img.channels, toBuffer(img.data))
+  return native.savePngAsync(filePath, img.width, img.height, img.channels, toBuffer(img.data))
 })
 
 // 转换为灰度图  
 ipcMain.handle('native:toGray', async (_event, img: { width: number, height: number, data: Uint8Array }) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.toGray(img.width, img.height, toBuffer(img.data))
+  return native.toGrayAsync(img.width, img.height, toBuffer(img.data))
 })
 
 // 缩放
 ipcMain.handle('native:resize', async (_event, img: { width: number, height: number, channels: number, data: Uint8Array }, newW: number, newH: number) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.resize(img.width, img.height, img.channels, newW, newH, toBuffer(img.data))
+  return native.resizeAsync(img.width, img.height, img.channels, newW, newH, toBuffer(img.data))
 })
 
 // 压缩为 .trip 文件并保存
 ipcMain.handle('native:compressorSave', async (_event, filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.compressorSave(filePath, img.width, img.height, img.channels, toBuffer(img.data))
+  return native.compressorSaveAsync(filePath, img.width, img.height, img.channels, toBuffer(img.data))
 })
 
 // 从 .trip 文件加载图像
 ipcMain.handle('native:compressorLoad', async (_event, filePath: string) => {
   if (!native) throw new Error('native addon not loaded')
-  return native.compressorLoad(filePath)
+  return native.compressorLoadAsync(filePath)
+})
+
+// 批处理：一次 IPC 提交全部作业，逐个作业的进度/错误事件推送到渲染进程的 'native:batchEvent'
+ipcMain.handle('native:processBatch', async (event, jobs: Array<{ input: string, output: string, ops?: Array<{ op: string, width?: number, height?: number }> }>, options?: { concurrency?: number, memoryBudget?: number }) => {
+  if (!native) throw new Error('native addon not loaded')
+  return native.processBatch(jobs, {
+    ...options,
+    onEvent: (ev: unknown) => { if (!event.sender.isDestroyed()) event.sender.send('native:batchEvent', ev) },
+  })
+})
+
+// =========================================================
+// 原生图像句柄：像素留在主进程的原生内存中，渲染进程只持有 id
+// =========================================================
+const handles = new Map<number, any>()
+let nextHandleId = 1
+
+// 登记新句柄并返回 { id, width, height, channels }
+const registerHandle = (handle: any) => {
+  const id = nextHandleId++
+  handles.set(id, handle)
+  return { id, width: handle.width, height: handle.height, channels: handle.channels }
+}
+
+const getHandle = (id: number) => {
+  if (!native) throw new Error('native addon not loaded')
+  const handle = handles.get(id)
+  if (!handle) throw new Error(`unknown image handle: ${id}`)
+  return handle
+}
+
+// 从文件加载（按扩展名识别 png / ppm / trip）
+ipcMain.handle('native:handle:load', async (_event, filePath: string) => {
+  if (!native) throw new Error('native addon not loaded')
+  return registerHandle(await native.ImageHandle.loadAsync(filePath))
+})
+
+// 灰度化，返回新句柄
+ipcMain.handle('native:handle:toGray', async (_event, id: number) => {
+  return registerHandle(await getHandle(id).toGrayAsync())
+})
+
+// 缩放，返回新句柄
+ipcMain.handle('native:handle:resize', async (_event, id: number, newW: number, newH: number) => {
+  return registerHandle(await getHandle(id).resizeAsync(newW, newH))
+})
+
+// 保存（按扩展名识别 png / ppm / trip）
+ipcMain.handle('native:handle:save', async (_event, id: number, filePath: string) => {
+  return getHandle(id).saveAsync(filePath)
+})
+
+// 显式导出像素，用于显示
+ipcMain.handle('native:handle:pixels', async (_event, id: number) => {
+  return getHandle(id).toObject()
+})
+
+// 转换为 8 位 RGBA 用于显示：{ width, height, data }，data 可直接作为 ImageData 的像素。
+// 沙箱中的渲染进程不能映射共享内存，像素经 IPC 传一次，转换在原生代码中完成
+ipcMain.handle('native:handle:rgba', async (_event, id: number) => {
+  const handle = getHandle(id)
+  return { width: handle.width, height: handle.height, data: handle.toRgba() }
+})
+
+// 释放句柄
+ipcMain.handle('native:handle:dispose', async (_event, id: number) => {
+  const handle = handles.get(id)
+  if (!handle) return false
+  handle.dispose()
+  handles.delete(id)
+  return true
 })
 
 // =========================================================
@@ -14,6 +14,19 @@
 
 import { ipcRenderer, contextBridge } from 'electron'
 
+// 预加载脚本运行在沙箱中，不加载原生插件：像素由主进程转换为 RGBA 后经 IPC 传来，直接写入 canvas
+const drawHandle = async (id: number, canvasId: string) => {
+  const img: { width: number, height: number, data: Uint8Array } = await ipcRenderer.invoke('native:handle:rgba', id)
+  const canvas = document.getElementById(canvasId)
+  if (!(canvas instanceof HTMLCanvasElement)) throw new Error(`canvas not found: ${canvasId}`)
+  const ctx = canvas.getContext('2d')
+  if (!ctx) throw new Error('2d context unavailable')
+  canvas.width = img.width
+  canvas.height = img.height
+  const pixels = new Uint8ClampedArray(img.data.buffer, img.data.byteOffset, img.data.byteLength)
+  ctx.putImageData(new ImageData(pixels, img.width, img.height), 0, 0)
+}
+
 // --------- Expose some API to the Renderer process ---------
 contextBridge.exposeInMainWorld('ipcRenderer', {
   on(...args: Parameters<typeof ipcRenderer.on>) {
@@ -41,6 +54,7 @@ contextBridge.exposeInMainWorld('ipcRenderer', {
 contextBridge.exposeInMainWorld('native', {
   loadPpm: (filePath: string) => ipcRenderer.invoke('native:loadPpm', filePath),
   loadPng: (filePath: string) => ipcRenderer.invoke('native:loadPng', filePath),
+  loadPreview: (filePath: string, maxDim: number) => ipcRenderer.invoke('native:loadPreview', filePath, maxDim),
   savePpm: (filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => ipcRenderer.invoke('native:savePpm', filePath, img),
   savePng: (filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => ipcRenderer.invoke('native:savePng', filePath, img),
   toGray: (img: { width: number, height: number, data: Uint8Array }) => ipcRenderer.invoke('native:toGray', img),
@@ -48,6 +62,26 @@ contextBridge.exposeInMainWorld('native', {
   compressorSave: (filePath: string, img: { width: number, height: number, channels: number, data: Uint8Array }) => ipcRenderer.invoke('native:compressorSave', filePath, img),
   compressorLoad: (filePath: string) => ipcRenderer.invoke('native:compressorLoad', filePath),
 
+  // 批处理，事件通过 onBatchEvent 订阅，返回取消订阅函数
+  processBatch: (jobs: Array<{ input: string, output: string, ops?: Array<{ op: string, width?: number, height?: number }> }>, options?: { concurrency?: number, memoryBudget?: number }) => ipcRenderer.invoke('native:processBatch', jobs, options),
+  onBatchEvent: (listener: (ev: unknown) => void) => {
+    const wrapped = (_event: unknown, ev: unknown) => listener(ev)
+    ipcRenderer.on('native:batchEvent', wrapped)
+    return () => { ipcRenderer.off('native:batchEvent', wrapped) }
+  },
+
+  // 原生图像句柄，像素只在调用 pixels 时传输
+  handle: {
+    load: (filePath: string) => ipcRenderer.invoke('native:handle:load', filePath),
+    toGray: (id: number) => ipcRenderer.invoke('native:handle:toGray', id),
+    resize: (id: number, newW: number, newH: number) => ipcRenderer.invoke('native:handle:resize', id, newW, newH),
+    save: (id: number, filePath: string) => ipcRenderer.invoke('native:handle:save', id, filePath),
+    pixels: (id: number) => ipcRenderer.invoke('native:handle:pixels', id),
+    // 把句柄的图像绘制到指定 id 的 canvas
+    draw: drawHandle,
+    dispose: (id: number) => ipcRenderer.invoke('native:handle:dispose', id),
+  },
+
   // 文件对话框相关函数
   openImageDialog: () => ipcRenderer.invoke('dialog:openImage'),
   savePngDialog: () => ipcRenderer.invoke('dialog:savePng'),
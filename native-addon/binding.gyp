@@ -4,17 +4,34 @@
       "target_name": "project2_addon",
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions", "-fno-rtti" ],
-      "defines": [ "NAPI_CPP_EXCEPTIONS" ],
+      # NODE_ADDON_API_CPP_EXCEPTIONS_ALL：同步接口中抛出的 std::exception（如超出内存预算）转为 JS 异常
+      "defines": [ "NAPI_CPP_EXCEPTIONS", "NODE_ADDON_API_CPP_EXCEPTIONS_ALL" ],
       
       "sources": [
         "src/main.cc",
+        "src/common.cc",
+        "src/async_ops.cc",
+        "src/buffer_pool.cc",
+        "src/image_handle.cc",
+        "src/batch_ops.cc",
         # 显式列出 C++ 核心模块的所有源文件。
         # node-gyp 对跨目录通配符的支持有限，建议手动列出，虽然繁琐但最稳妥。
         "../cpp/src/data_structure/triplet.cc",
+        "../cpp/src/data_structure/triplet_buffer.cc",
         "../cpp/src/io/image_io.cc",
+        "../cpp/src/io/image_cache.cc",
         "../cpp/src/io/ppm.cc",
+        "../cpp/src/io/area_reducer.cc",
         "../cpp/src/codec/compressor.cc",
-        "../cpp/src/imgproc/image_processor.cc"
+        "../cpp/src/imgproc/image_processor.cc",
+        "../cpp/src/imgproc/image_stats.cc",
+        "../cpp/src/common/thread_pool.cc",
+        "../cpp/src/common/stats.cc",
+        "../cpp/src/common/memory.cc",
+        "../cpp/src/common/scratch.cc",
+        "../cpp/src/pipeline/operation.cc",
+        "../cpp/src/pipeline/image_file.cc",
+        "../cpp/src/pipeline/batch_pipeline.cc"
       ],
       
       "include_dirs": [
@@ -1,4 +1,60 @@
 const bindings = require('bindings');
 const addon = bindings('project2_addon');
 
-module.exports = addon;
\ No newline at end of file
+// 同步版本的参数个数，异步版本在其后多接收一个可选 options
+const ASYNC_ARITY = {
+  loadPngAsync: 1,
+  loadPpmAsync: 1,
+  loadPreviewAsync: 2,
+  savePngAsync: 5,
+  savePpmAsync: 5,
+  toGrayAsync: 3,
+  resizeAsync: 6,
+  saveTripAsync: 6,
+  compressorSaveAsync: 5,
+  compressorLoadAsync: 1,
+  processBatch: 1,
+};
+
+// 把 options 中的 signal（AbortSignal）转换为原生的 token，其余选项（onProgress、onEvent、interpolation、
+// concurrency、memoryBudget 等）原样传给原生函数
+function toNativeOptions(options) {
+  if (!options) return undefined;
+  const { signal, ...rest } = options;
+  if (signal) {
+    if (signal.aborted) {
+      const err = new Error('The operation was aborted');
+      err.name = 'AbortError';
+      return { error: err };
+    }
+    const token = rest.token || new addon.CancelToken();
+    const onAbort = () => token.cancel();
+    signal.addEventListener('abort', onAbort, { once: true });
+    return { options: { ...rest, token }, cleanup: () => signal.removeEventListener('abort', onAbort) };
+  }
+  return { options: rest };
+}
+
+// 包装原生异步函数，使其接受 AbortSignal
+function withSignal(fn, arity) {
+  return function (...args) {
+    const native = toNativeOptions(args[arity]);
+    if (native && native.error) return Promise.reject(native.error);
+    const promise = fn.call(this, ...args.slice(0, arity), native && native.options);
+    return native && native.cleanup ? promise.finally(native.cleanup) : promise;
+  };
+}
+
+const wrapped = {};
+for (const [name, arity] of Object.entries(ASYNC_ARITY)) {
+  wrapped[name] = withSignal(addon[name], arity);
+}
+
+// ImageHandle 的异步方法同样支持 AbortSignal
+const { ImageHandle } = addon;
+ImageHandle.loadAsync = withSignal(ImageHandle.loadAsync, 1);
+ImageHandle.prototype.toGrayAsync = withSignal(ImageHandle.prototype.toGrayAsync, 0);
+ImageHandle.prototype.resizeAsync = withSignal(ImageHandle.prototype.resizeAsync, 2);
+ImageHandle.prototype.saveAsync = withSignal(ImageHandle.prototype.saveAsync, 1);
+
+module.exports = { ...addon, ...wrapped };
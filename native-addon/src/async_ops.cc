@@ -0,0 +1,374 @@
+/**
+ * @file async_ops.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 异步（Promise）接口实现：任务在 libuv 线程池执行，支持取消与进度汇报
+ * @version 0.1
+ * @date 2025-11-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "async_ops.h"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../cpp/src/io/image_io.h"
+#include "../../cpp/src/codec/compressor.h"
+#include "../../cpp/src/common/scratch.h"
+#include "../../cpp/src/imgproc/image_processor.h"
+#include "common.h"
+#include "image_handle.h"
+
+namespace {
+
+/**
+ * @brief 取消令牌，JS 侧调用 cancel()，工作线程只读取标志位
+ */
+class CancelToken : public Napi::ObjectWrap<CancelToken> {
+public:
+    static Napi::Function Define(Napi::Env env) {
+        return DefineClass(env, "CancelToken", {
+            InstanceMethod("cancel", &CancelToken::Cancel),
+            InstanceAccessor("cancelled", &CancelToken::IsCancelled, nullptr),
+        });
+    }
+
+    explicit CancelToken(const Napi::CallbackInfo& info)
+        : Napi::ObjectWrap<CancelToken>(info), flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    const CancelFlag& flag() const { return flag_; }
+
+private:
+    Napi::Value Cancel(const Napi::CallbackInfo& info) {
+        flag_->store(true);
+        return info.Env().Undefined();
+    }
+
+    Napi::Value IsCancelled(const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), flag_->load());
+    }
+
+    CancelFlag flag_;
+};
+
+/**
+ * @brief 异步调用的可选参数
+ */
+struct AsyncOptions {
+    CancelFlag cancel;
+    Napi::FunctionReference on_progress;
+};
+
+/**
+ * @brief 通用异步任务：在线程池执行 OpTask，结束后兑现 Promise
+ *
+ * @details 基于队列版本的进度 worker：每次汇报都会按顺序送达 onProgress 并早于 Promise 兑现，
+ * 不会被合并为最后一次。
+ */
+class OpWorker : public Napi::AsyncProgressQueueWorker<double> {
+public:
+    OpWorker(Napi::Env env, const char* name, OpTask task, AsyncOptions options)
+        : Napi::AsyncProgressQueueWorker<double>(env, name),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          task_(std::move(task)),
+          cancel_(std::move(options.cancel)),
+          on_progress_(std::move(options.on_progress)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    /**
+     * @brief 持有输入对象的引用，任务结束前不会被 GC 回收
+     */
+    void Pin(const Napi::Object& obj) { pinned_.push_back(Napi::Persistent(obj)); }
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        bool report = !on_progress_.IsEmpty();
+        StageReporter reporter(cancel_, [&progress, report](double fraction) {
+            if (report) progress.Send(&fraction, 1);
+        });
+        try {
+            reporter.Stage(0.0);
+            result_ = task_(reporter);
+            // 任务期间取消的，丢弃结果并以 AbortError 拒绝
+            reporter.Stage(1.0);
+        } catch (const OperationCancelled&) {
+            cancelled_ = true;
+            SetError("The operation was aborted");
+        } catch (const std::exception& e) {
+            // 包括 cv::Exception
+            SetError(e.what());
+        }
+        // libuv 线程池的线程长期存活，任务之间归还超大图像留下的暂存区
+        ScratchPool::Trim();
+    }
+
+    void OnProgress(const double* data, size_t count) override {
+        if (on_progress_.IsEmpty() || count == 0) return;
+        Napi::HandleScope scope(Env());
+        on_progress_.Call({Napi::Number::New(Env(), data[count - 1])});
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        switch (result_.kind) {
+            case OpResult::kImage:
+                deferred_.Resolve(MatToObject(env, result_.image));
+                break;
+            case OpResult::kHandle:
+                deferred_.Resolve(ImageHandle::New(env, result_.image));
+                break;
+            case OpResult::kBool:
+                deferred_.Resolve(Napi::Boolean::New(env, result_.ok));
+                break;
+        }
+    }
+
+    void OnError(const Napi::Error& e) override {
+        Napi::Object err = e.Value();
+        if (cancelled_) err.Set("name", Napi::String::New(Env(), "AbortError"));
+        deferred_.Reject(err);
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    OpTask task_;
+    CancelFlag cancel_;
+    Napi::FunctionReference on_progress_;
+    std::vector<Napi::ObjectReference> pinned_;
+    OpResult result_;
+    bool cancelled_ = false;
+};
+
+/**
+ * @brief 解析位于 index 处的可选 options 参数
+ */
+AsyncOptions ParseOptions(const Napi::CallbackInfo& info, size_t index) {
+    AsyncOptions options;
+    if (info.Length() <= index || info[index].IsUndefined() || info[index].IsNull()) return options;
+    if (!info[index].IsObject()) {
+    throw Napi::TypeError::New(info.Env(), "options must be an object");
+    }
+
+    Napi::Object o = info[index].As<Napi::Object>();
+    options.cancel = CancelFlagOf(info.Env(), o.Get("token"));
+    Napi::Value progress = o.Get("onProgress");
+    if (progress.IsFunction()) options.on_progress = Napi::Persistent(progress.As<Napi::Function>());
+    return options;
+}
+
+}  // namespace
+
+CancelFlag CancelFlagOf(Napi::Env env, Napi::Value token) {
+    if (token.IsUndefined() || token.IsNull()) return nullptr;
+    AddonData* data = GetAddonData(env);
+    if (!token.IsObject() || !token.As<Napi::Object>().InstanceOf(data->cancel_token.Value())) {
+    throw Napi::TypeError::New(env, "options.token must be a CancelToken");
+    }
+    return CancelToken::Unwrap(token.As<Napi::Object>())->flag();
+}
+
+Napi::Value OptionOf(const Napi::CallbackInfo& info, size_t options_index, const char* key) {
+    if (info.Length() <= options_index || !info[options_index].IsObject()) return info.Env().Undefined();
+    return info[options_index].As<Napi::Object>().Get(key);
+}
+
+Napi::Value ScheduleTask(const Napi::CallbackInfo& info, size_t options_index, const char* name, OpTask task) {
+    AsyncOptions options = ParseOptions(info, options_index);
+    auto* worker = new OpWorker(info.Env(), name, std::move(task), std::move(options));
+    for (size_t i = 0; i < options_index && i < info.Length(); ++i) {
+        if (info[i].IsBuffer()) worker->Pin(info[i].As<Napi::Object>());
+    }
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+namespace {
+
+// 参数个数检查：同步参数个数为 n，末尾允许多一个 options
+bool ArgCountOk(const Napi::CallbackInfo& info, size_t n) {
+    return info.Length() == n || info.Length() == n + 1;
+}
+
+// =========================================================
+// 各个异步导出
+// =========================================================
+
+// loadPngAsync(filePath, options?)
+Napi::Value LoadPngAsync(const Napi::CallbackInfo& info) {
+    if (!ArgCountOk(info, 1) || !info[0].IsString()) {
+    throw MakeError(info.Env(), "loadPngAsync(filePath, options?) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    return ScheduleTask(info, 1, "loadPngAsync", [path](StageReporter&) {
+        cv::Mat img = ImageIO::LoadPng(path);
+        if (img.empty()) throw std::runtime_error("Failed to load PNG: " + path);
+        return ImageResult(img);
+    });
+}
+
+// loadPpmAsync(filePath, options?)
+Napi::Value LoadPpmAsync(const Napi::CallbackInfo& info) {
+    if (!ArgCountOk(info, 1) || !info[0].IsString()) {
+    throw MakeError(info.Env(), "loadPpmAsync(filePath, options?) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    return ScheduleTask(info, 1, "loadPpmAsync", [path](StageReporter&) {
+        cv::Mat img = ImageIO::LoadPpm(path);
+        if (img.empty()) throw std::runtime_error("Failed to load PPM: " + path);
+        return ImageResult(img);
+    });
+}
+
+// loadPreviewAsync(filePath, maxDim, options?)
+Napi::Value LoadPreviewAsync(const Napi::CallbackInfo& info) {
+    if (!ArgCountOk(info, 2) || !info[0].IsString() || !info[1].IsNumber()) {
+    throw MakeError(info.Env(), "loadPreviewAsync(filePath, maxDim, options?)");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    int maxDim = info[1].As<Napi::Number>().Int32Value();
+    if (maxDim <= 0) {
+    throw MakeError(info.Env(), "maxDim must be positive");
+    }
+    return ScheduleTask(info, 2, "loadPreviewAsync", [path, maxDim](StageReporter&) {
+        cv::Mat img = ImageIO::LoadPreview(path, maxDim);
+        if (img.empty()) throw std::runtime_error("Failed to load preview: " + path);
+        return ImageResult(img);
+    });
+}
+
+// 解析 (filePath, width, height, channels, dataBuffer) 形式的参数
+cv::Mat ParseSaveArgs(const Napi::CallbackInfo& info, const char* usage, std::string* path) {
+    Napi::Env env = info.Env();
+    if (!ArgCountOk(info, 5) || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsBuffer()) {
+    throw MakeError(env, usage);
+    }
+    *path = info[0].As<Napi::String>().Utf8Value();
+    int width = info[1].As<Napi::Number>().Int32Value();
+    int height = info[2].As<Napi::Number>().Int32Value();
+    int channels = info[3].As<Napi::Number>().Int32Value();
+    return MatFromBuffer(env, width, height, channels, info[4].As<Napi::Buffer<uint8_t>>(), "dataBuffer");
+}
+
+// savePngAsync(filePath, width, height, channels, dataBuffer, options?)
+Napi::Value SavePngAsync(const Napi::CallbackInfo& info) {
+    std::string path;
+    cv::Mat img = ParseSaveArgs(info, "savePngAsync(filePath, width, height, channels, dataBuffer, options?)", &path);
+    return ScheduleTask(info, 5, "savePngAsync", [path, img](StageReporter&) {
+        return BoolResult(ImageIO::SavePng(path, img));
+    });
+}
+
+// savePpmAsync(filePath, width, height, channels, dataBuffer, options?)
+Napi::Value SavePpmAsync(const Napi::CallbackInfo& info) {
+    std::string path;
+    cv::Mat img = ParseSaveArgs(info, "savePpmAsync(filePath, width, height, channels, dataBuffer, options?)", &path);
+    return ScheduleTask(info, 5, "savePpmAsync", [path, img](StageReporter&) {
+        return BoolResult(ImageIO::SavePpm(path, img));
+    });
+}
+
+// toGrayAsync(width, height, bgrBuffer, options?)
+Napi::Value ToGrayAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!ArgCountOk(info, 3) || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsBuffer()) {
+    throw MakeError(env, "toGrayAsync(width, height, bgrBuffer, options?)");
+    }
+    int width = info[0].As<Napi::Number>().Int32Value();
+    int height = info[1].As<Napi::Number>().Int32Value();
+    cv::Mat input = MatFromBuffer(env, width, height, 3, info[2].As<Napi::Buffer<uint8_t>>(), "bgrBuffer");
+    return ScheduleTask(info, 3, "toGrayAsync", [input](StageReporter&) {
+        return ImageResult(Processor::ToGray(input));
+    });
+}
+
+// resizeAsync(width, height, channels, newWidth, newHeight, dataBuffer, options?)，options.interpolation 同 resize
+Napi::Value ResizeAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!ArgCountOk(info, 6) || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsNumber() || !info[5].IsBuffer()) {
+    throw MakeError(env, "resizeAsync(width, height, channels, newWidth, newHeight, dataBuffer, options?)");
+    }
+    int width = info[0].As<Napi::Number>().Int32Value();
+    int height = info[1].As<Napi::Number>().Int32Value();
+    int channels = info[2].As<Napi::Number>().Int32Value();
+    int newW = info[3].As<Napi::Number>().Int32Value();
+    int newH = info[4].As<Napi::Number>().Int32Value();
+    cv::Mat input = MatFromBuffer(env, width, height, channels, info[5].As<Napi::Buffer<uint8_t>>(), "dataBuffer");
+    Processor::Interpolation mode = ParseInterpolation(env, OptionOf(info, 6, "interpolation"), "options.interpolation");
+    return ScheduleTask(info, 6, "resizeAsync", [input, newW, newH, mode](StageReporter& reporter) {
+        cv::Mat out;
+        Processor::Resize(input, newW, newH, out, mode, reporter.Progress());
+        return ImageResult(out);
+    });
+}
+
+// compressorSaveAsync(filePath, width, height, channels, dataBuffer, options?)
+Napi::Value CompressorSaveAsync(const Napi::CallbackInfo& info) {
+    std::string path;
+    cv::Mat img = ParseSaveArgs(info, "compressorSaveAsync(filePath, width, height, channels, dataBuffer, options?)", &path);
+    return ScheduleTask(info, 5, "compressorSaveAsync", [path, img](StageReporter& reporter) {
+        return BoolResult(Compressor::Save(path, img, nullptr, reporter.Progress()));
+    });
+}
+
+// compressorLoadAsync(filePath, options?)
+Napi::Value CompressorLoadAsync(const Napi::CallbackInfo& info) {
+    if (!ArgCountOk(info, 1) || !info[0].IsString()) {
+    throw MakeError(info.Env(), "compressorLoadAsync(filePath, options?)");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    return ScheduleTask(info, 1, "compressorLoadAsync", [path](StageReporter&) {
+        cv::Mat img = Compressor::Load(path);
+        if (img.empty()) throw std::runtime_error("Failed to load .trip: " + path);
+        return ImageResult(img);
+    });
+}
+
+// saveTripAsync(filePath, width, height, channels, bgColorBuffer[3], tripletsArray, options?)
+Napi::Value SaveTripAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!ArgCountOk(info, 6) || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsBuffer() || !info[5].IsArray()) {
+    throw MakeError(env, "saveTripAsync(filePath, width, height, channels, bgColorBuffer[3], tripletsArray, options?)");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    int width = info[1].As<Napi::Number>().Int32Value();
+    int height = info[2].As<Napi::Number>().Int32Value();
+    int channels = info[3].As<Napi::Number>().Int32Value();
+    Napi::Buffer<uint8_t> bgBuf = info[4].As<Napi::Buffer<uint8_t>>();
+    if (bgBuf.Length() < 3) {
+    throw MakeError(env, "bgColorBuffer must have length >= 3");
+    }
+    std::array<uint8_t, 3> bg = {bgBuf[0], bgBuf[1], bgBuf[2]};
+
+    // JS 数组只能在主线程读取，先解析好再交给工作线程写文件
+    auto triplets = std::make_shared<std::vector<TripletNode>>(TripletsFromArray(info[5].As<Napi::Array>()));
+    return ScheduleTask(info, 6, "saveTripAsync", [path, width, height, channels, bg, triplets](StageReporter&) {
+        return BoolResult(ImageIO::SaveTrip(path, width, height, channels, bg.data(), *triplets));
+    });
+}
+
+}  // namespace
+
+void InitAsync(Napi::Env env, Napi::Object exports) {
+    Napi::Function token = CancelToken::Define(env);
+    GetAddonData(env)->cancel_token = Napi::Persistent(token);
+    exports.Set("CancelToken", token);
+
+    exports.Set("loadPngAsync", Napi::Function::New(env, LoadPngAsync));
+    exports.Set("loadPpmAsync", Napi::Function::New(env, LoadPpmAsync));
+    exports.Set("loadPreviewAsync", Napi::Function::New(env, LoadPreviewAsync));
+    exports.Set("savePngAsync", Napi::Function::New(env, SavePngAsync));
+    exports.Set("savePpmAsync", Napi::Function::New(env, SavePpmAsync));
+    exports.Set("toGrayAsync", Napi::Function::New(env, ToGrayAsync));
+    exports.Set("resizeAsync", Napi::Function::New(env, ResizeAsync));
+    exports.Set("saveTripAsync", Napi::Function::New(env, SaveTripAsync));
+    exports.Set("compressorSaveAsync", Napi::Function::New(env, CompressorSaveAsync));
+    exports.Set("compressorLoadAsync", Napi::Function::New(env, CompressorLoadAsync));
+}
@@ -0,0 +1,152 @@
+/**
+ * @file async_ops.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 基于 Napi::AsyncProgressQueueWorker 的异步（Promise）接口声明
+ * @version 0.1
+ * @date 2025-11-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <opencv2/core/mat.hpp>
+#include "../../cpp/src/common/progress.h"
+
+using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+/**
+ * @brief 任务被取消时在工作线程内抛出
+ */
+struct OperationCancelled {};
+
+/**
+ * @brief 工作线程内的阶段汇报器：每个阶段边界检查取消标志并发送进度
+ *
+ * @details 取消是协作式的：任务开始前、任务调用 Stage() 时以及任务结束后各检查一次。
+ * 接受 ProgressFn 的核心调用（缩放、压缩保存）通过 Progress() 在条带或阶段边界汇报进度并检查取消，
+ * 被取消时提前返回失败；其余核心调用（如一次解码）开始后会运行到结束，期间的取消在其返回后才生效，
+ * 结果被丢弃。
+ */
+class StageReporter {
+public:
+    StageReporter(CancelFlag cancel, std::function<void(double)> send)
+        : cancel_(std::move(cancel)), send_(std::move(send)) {}
+
+    /**
+     * @brief 标记进入新阶段
+     * @param fraction 已完成比例 [0, 1]
+     */
+    void Stage(double fraction) {
+        CheckCancelled();
+        if (send_) send_(fraction);
+    }
+
+    /**
+     * @brief 已取消时抛出 OperationCancelled，用于区分核心调用因取消还是因参数非法而失败
+     */
+    void CheckCancelled() const {
+        if (cancel_ && cancel_->load()) throw OperationCancelled{};
+    }
+
+    /**
+     * @brief 把核心调用的 [0, 1] 进度映射到 [begin, end] 后发送，已取消时回调返回 false
+     *
+     * @details 返回的回调引用本对象，只能在任务执行期间使用
+     */
+    ProgressFn Progress(double begin = 0.0, double end = 1.0) {
+        return [this, begin, end](double fraction) {
+            if (cancel_ && cancel_->load()) return false;
+            if (send_) send_(begin + (end - begin) * fraction);
+            return true;
+        };
+    }
+
+private:
+    CancelFlag cancel_;
+    std::function<void(double)> send_;
+};
+
+/**
+ * @brief 任务结果：图像对象、ImageHandle 或布尔值
+ */
+struct OpResult {
+    enum Kind { kImage, kHandle, kBool };
+
+    cv::Mat image;
+    bool ok = false;
+    Kind kind = kImage;
+};
+
+inline OpResult ImageResult(cv::Mat img) {
+    OpResult r;
+    r.image = std::move(img);
+    return r;
+}
+
+inline OpResult HandleResult(cv::Mat img) {
+    OpResult r;
+    r.image = std::move(img);
+    r.kind = OpResult::kHandle;
+    return r;
+}
+
+inline OpResult BoolResult(bool ok) {
+    OpResult r;
+    r.ok = ok;
+    r.kind = OpResult::kBool;
+    return r;
+}
+
+/**
+ * @brief 在工作线程执行的任务，抛出的异常转为 Promise 拒绝
+ */
+using OpTask = std::function<OpResult(StageReporter&)>;
+
+/**
+ * @brief 取出 CancelToken 的取消标志
+ *
+ * @details token 为 undefined / null 时返回空指针；不是 CancelToken 时抛出 TypeError。
+ */
+CancelFlag CancelFlagOf(Napi::Env env, Napi::Value token);
+
+/**
+ * @brief 读取 info[options_index] 处可选 options 对象的 key 字段
+ *
+ * @details options 缺省或不是对象时返回 undefined（不是对象的错误由 ScheduleTask 报告）。
+ * 用于 token / onProgress 之外、由具体操作解释的选项，如 resizeAsync 的 interpolation。
+ */
+Napi::Value OptionOf(const Napi::CallbackInfo& info, size_t options_index, const char* key);
+
+/**
+ * @brief 创建并排队一个异步任务，返回其 Promise
+ *
+ * @details info[options_index] 为可选的 options 对象。任务中的 cv::Mat 可以直接指向参数里的
+ * JS Buffer：这里持有 options 之前全部 Buffer 参数的引用，保证任务完成前其内存有效。
+ * 任务执行期间 JS 侧不应修改这些 Buffer。
+ *
+ * @param info Node-API 回调信息
+ * @param options_index options 参数的位置
+ * @param name 异步资源名
+ * @param task 任务
+ * @return Napi::Value Promise
+ */
+Napi::Value ScheduleTask(const Napi::CallbackInfo& info, size_t options_index, const char* name, OpTask task);
+
+/**
+ * @brief 注册所有异步导出函数以及 CancelToken 类
+ *
+ * @details 每个同步导出 xxx 都有对应的 xxxAsync，参数与同步版本相同，末尾可多传一个
+ * options 对象 { token?: CancelToken, onProgress?: (fraction) => void }，返回 Promise。
+ * 同步版本末尾的可选参数（如 resize 的 interpolation）在异步版本中作为同名的 options 字段传入。
+ * 运算在 libuv 线程池中执行；token 在 Promise 完成前被取消时，Promise 以 name 为 "AbortError"
+ * 的错误拒绝（已开始的核心运算不会被中途打断，见 StageReporter）。
+ *
+ * @param env Node-API 环境
+ * @param exports 导出对象
+ */
+void InitAsync(Napi::Env env, Napi::Object exports);
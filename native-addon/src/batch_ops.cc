@@ -0,0 +1,217 @@
+/**
+ * @file batch_ops.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批处理接口实现：BatchPipeline 运行在独立线程，事件经 ThreadSafeFunction 回到 JS
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "batch_ops.h"
+#include <exception>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../../cpp/src/pipeline/batch_pipeline.h"
+#include "../../cpp/src/pipeline/image_file.h"
+#include "async_ops.h"
+#include "common.h"
+
+namespace {
+
+/**
+ * @brief 一次 processBatch 调用的全部状态，由 ThreadSafeFunction 的 finalizer 释放
+ */
+struct BatchContext {
+    explicit BatchContext(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+
+    std::vector<BatchJob> jobs;
+    BatchOptions options;
+    CancelFlag cancel;
+    bool has_listener = false;
+    Napi::Promise::Deferred deferred;
+    BatchResult result;
+    std::string error;      ///< 工作线程中抛出的异常，非空时 Promise 以它 reject
+    std::thread thread;
+};
+
+const char* EventTypeName(BatchEvent::Type type) {
+    switch (type) {
+        case BatchEvent::Type::kStarted: return "started";
+        case BatchEvent::Type::kFinished: return "finished";
+        case BatchEvent::Type::kFailed: return "failed";
+        case BatchEvent::Type::kCancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// 在主线程把事件交给 onEvent。ThreadSafeFunction 已终结（环境销毁）时 env 与 callback 为空，只释放事件
+void DeliverEvent(Napi::Env env, Napi::Function callback, BatchEvent* ev) {
+    std::unique_ptr<BatchEvent> owned(ev);
+    if (env == nullptr || callback.IsEmpty()) return;
+    Napi::Object o = Napi::Object::New(env);
+    o.Set("type", Napi::String::New(env, EventTypeName(ev->type)));
+    o.Set("index", Napi::Number::New(env, static_cast<double>(ev->index)));
+    o.Set("completed", Napi::Number::New(env, static_cast<double>(ev->completed)));
+    o.Set("total", Napi::Number::New(env, static_cast<double>(ev->total)));
+    if (!ev->message.empty()) o.Set("message", Napi::String::New(env, ev->message));
+    callback.Call({o});
+}
+
+// 没有 onEvent 时的占位回调
+Napi::Value IgnoreEvent(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+// 全部事件送达、线程结束后在主线程兑现 Promise，工作线程出错时 reject
+void FinishBatch(Napi::Env env, void* /*data*/, BatchContext* ctx) {
+    if (ctx->thread.joinable()) ctx->thread.join();
+    if (!ctx->error.empty()) {
+        ctx->deferred.Reject(MakeError(env, "processBatch: " + ctx->error).Value());
+        delete ctx;
+        return;
+    }
+    const BatchResult& r = ctx->result;
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("succeeded", Napi::Number::New(env, static_cast<double>(r.succeeded)));
+    out.Set("failed", Napi::Number::New(env, static_cast<double>(r.failed)));
+    out.Set("cancelled", Napi::Boolean::New(env, r.cancelled));
+    Napi::Array errors = Napi::Array::New(env, r.errors.size());
+    for (size_t i = 0; i < r.errors.size(); ++i) {
+        errors.Set(static_cast<uint32_t>(i), r.errors[i].empty() ? env.Null() : Napi::String::New(env, r.errors[i]));
+    }
+    out.Set("errors", errors);
+    ctx->deferred.Resolve(out);
+    delete ctx;
+}
+
+// 解析单个处理步骤 { op: 'gray' } | { op: 'resize', width, height, interpolation? } |
+// { op: 'crop', x, y, width, height }
+Operation ParseOperation(Napi::Env env, const Napi::Value& v) {
+    if (!v.IsObject()) {
+    throw MakeError(env, "processBatch: each op must be an object");
+    }
+    Napi::Object o = v.As<Napi::Object>();
+    std::string op = o.Get("op").IsString() ? o.Get("op").As<Napi::String>().Utf8Value() : "";
+    if (op == "gray") return Operation::Gray();
+    if (op == "resize") {
+        if (!o.Get("width").IsNumber() || !o.Get("height").IsNumber()) {
+        throw MakeError(env, "processBatch: resize requires numeric width and height");
+        }
+        return Operation::Resize(o.Get("width").As<Napi::Number>().Int32Value(),
+                                 o.Get("height").As<Napi::Number>().Int32Value(),
+                                 ParseInterpolation(env, o.Get("interpolation"), "processBatch: interpolation"));
+    }
+    if (op == "crop") {
+        if (!o.Get("x").IsNumber() || !o.Get("y").IsNumber() || !o.Get("width").IsNumber() || !o.Get("height").IsNumber()) {
+        throw MakeError(env, "processBatch: crop requires numeric x, y, width and height");
+        }
+        return Operation::Crop(o.Get("x").As<Napi::Number>().Int32Value(), o.Get("y").As<Napi::Number>().Int32Value(),
+                               o.Get("width").As<Napi::Number>().Int32Value(),
+                               o.Get("height").As<Napi::Number>().Int32Value());
+    }
+    throw MakeError(env, "processBatch: unknown op '" + op + "'");
+}
+
+// 解析作业数组，路径与步骤在主线程校验，工作线程只处理 C++ 数据
+std::vector<BatchJob> ParseJobs(Napi::Env env, const Napi::Array& arr) {
+    std::vector<BatchJob> jobs;
+    jobs.reserve(arr.Length());
+    for (uint32_t i = 0; i < arr.Length(); ++i) {
+        Napi::Value v = arr.Get(i);
+        if (!v.IsObject()) {
+        throw MakeError(env, "processBatch: job " + std::to_string(i) + " must be an object");
+        }
+        Napi::Object o = v.As<Napi::Object>();
+        if (!o.Get("input").IsString() || !o.Get("output").IsString()) {
+        throw MakeError(env, "processBatch: job " + std::to_string(i) + " requires string input and output");
+        }
+        BatchJob job;
+        job.input = o.Get("input").As<Napi::String>().Utf8Value();
+        job.output = o.Get("output").As<Napi::String>().Utf8Value();
+        if (ImageFile::FormatOf(job.output) == ImageFile::Format::kUnknown) {
+        throw MakeError(env, "processBatch: unsupported output extension: " + job.output);
+        }
+        Napi::Value ops = o.Get("ops");
+        if (ops.IsArray()) {
+            Napi::Array a = ops.As<Napi::Array>();
+            for (uint32_t k = 0; k < a.Length(); ++k) job.ops.push_back(ParseOperation(env, a.Get(k)));
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+// processBatch(jobs, options?)
+Napi::Value ProcessBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsArray()) {
+    throw MakeError(env, "processBatch(jobs, options?)");
+    }
+
+    auto* ctx = new BatchContext(env);
+    Napi::Function on_event;
+    try {
+        ctx->jobs = ParseJobs(env, info[0].As<Napi::Array>());
+        if (info.Length() == 2 && !info[1].IsUndefined() && !info[1].IsNull()) {
+            if (!info[1].IsObject()) {
+            throw Napi::TypeError::New(env, "options must be an object");
+            }
+            Napi::Object o = info[1].As<Napi::Object>();
+            if (o.Get("concurrency").IsNumber()) ctx->options.concurrency = o.Get("concurrency").As<Napi::Number>().Int32Value();
+            if (o.Get("memoryBudget").IsNumber()) {
+                double budget = o.Get("memoryBudget").As<Napi::Number>().DoubleValue();
+                if (budget < 0) {
+                throw MakeError(env, "memoryBudget must be non-negative");
+                }
+                ctx->options.memory_budget = static_cast<size_t>(budget);
+            }
+            ctx->cancel = CancelFlagOf(env, o.Get("token"));
+            if (o.Get("onEvent").IsFunction()) on_event = o.Get("onEvent").As<Napi::Function>();
+        }
+    } catch (...) {
+        delete ctx;
+        throw;
+    }
+
+    // 没有监听者时仍需要 ThreadSafeFunction 在主线程收尾，回调用空函数代替
+    ctx->has_listener = !on_event.IsEmpty();
+    if (!ctx->has_listener) on_event = Napi::Function::New(env, IgnoreEvent);
+
+    Napi::Promise promise = ctx->deferred.Promise();
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(env, on_event, "processBatch", 0, 1, ctx, FinishBatch, static_cast<void*>(nullptr));
+    try {
+        ctx->thread = std::thread([ctx, tsfn]() mutable {
+            // 异常不能逃出线程函数（否则 std::terminate），记下后由 FinishBatch reject
+            try {
+                BatchPipeline::EventCallback callback;
+                if (ctx->has_listener) {
+                    callback = [&tsfn](const BatchEvent& ev) {
+                        auto* data = new BatchEvent(ev);
+                        if (tsfn.BlockingCall(data, DeliverEvent) != napi_ok) delete data;   // 环境正在销毁
+                    };
+                }
+                ctx->result = BatchPipeline(ctx->options).Run(ctx->jobs, callback, ctx->cancel.get());
+            } catch (const std::exception& e) {
+                ctx->error = e.what();
+            } catch (...) {
+                ctx->error = "unknown error";
+            }
+            tsfn.Release();   // 队列中的事件全部送达后触发 FinishBatch
+        });
+    } catch (const std::system_error& e) {
+        ctx->error = e.what();   // 线程创建失败，同样经 FinishBatch reject
+        tsfn.Release();
+    }
+    return promise;
+}
+
+}  // namespace
+
+void InitBatch(Napi::Env env, Napi::Object exports) {
+    exports.Set("processBatch", Napi::Function::New(env, ProcessBatch));
+}
@@ -0,0 +1,28 @@
+/**
+ * @file batch_ops.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 批处理接口 processBatch 声明
+ * @version 0.1
+ * @date 2025-11-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <napi.h>
+
+/**
+ * @brief 注册 processBatch(jobs, options?)
+ *
+ * @details jobs 为 [{ input, output, ops?: [{ op: 'gray' } | { op: 'resize', width, height, interpolation? } |
+ * { op: 'crop', x, y, width, height }] }]，
+ * options 为 { concurrency?, memoryBudget?, onEvent?, token? }。
+ * 作业由 BatchPipeline 在独立线程上并行执行，事件 { type: 'started' | 'finished' | 'failed',
+ * index, completed, total, message? } 通过线程安全函数回调 onEvent。
+ * 返回 Promise，在全部事件送达后以 { succeeded, failed, cancelled, errors } 兑现，
+ * errors[i] 为第 i 个作业的错误信息，成功时为 null。
+ *
+ * @param env Node-API 环境
+ * @param exports 导出对象
+ */
+void InitBatch(Napi::Env env, Napi::Object exports);
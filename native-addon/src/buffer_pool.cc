@@ -0,0 +1,120 @@
+/**
+ * @file buffer_pool.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 输出图像池化分配器实现
+ * @version 0.1
+ * @date 2025-11-23
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "buffer_pool.h"
+#include <iterator>
+#include "../../cpp/src/common/memory.h"
+
+BufferPool& BufferPool::Instance() {
+    // 有意泄漏：进程退出时仍可能有 cv::Mat 持有池中的内存
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+void BufferPool::Configure(bool enabled, size_t max_cached_bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_ = enabled;
+        max_cached_bytes_ = enabled ? max_cached_bytes : 0;
+        TrimLocked();
+    }
+    // 经 MemoryTracker 设置，开启图像内存记账时池作为记账分配器的内层分配器
+    MemoryTracker::SetMatAllocator(enabled ? this : nullptr);
+}
+
+void BufferPool::Trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& bucket : free_) {
+        for (uint8_t* p : bucket.second) cv::fastFree(p);
+    }
+    free_.clear();
+    stats_.cached_bytes = 0;
+}
+
+BufferPool::Stats BufferPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+cv::UMatData* BufferPool::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                   cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+    // 与 OpenCV 的 StdMatAllocator 相同的步长计算
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i) {
+        if (step) {
+            if (data && step[i] != CV_AUTOSTEP) {
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data ? static_cast<uint8_t*>(data) : Acquire(total);
+    u->size = total;
+    if (data) u->flags |= cv::UMatData::USER_ALLOCATED;
+    return u;
+}
+
+bool BufferPool::allocate(cv::UMatData* u, cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+    return u != nullptr;
+}
+
+void BufferPool::deallocate(cv::UMatData* u) const {
+    if (!u) return;
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        Release(u->origdata, u->size);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+uint8_t* BufferPool::Acquire(size_t bytes) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = free_.find(bytes);
+        if (it != free_.end() && !it->second.empty()) {
+            uint8_t* p = it->second.back();
+            it->second.pop_back();
+            stats_.cached_bytes -= bytes;
+            ++stats_.hits;
+            return p;
+        }
+        ++stats_.misses;
+    }
+    return static_cast<uint8_t*>(cv::fastMalloc(bytes));
+}
+
+void BufferPool::Release(uint8_t* ptr, size_t bytes) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (enabled_ && stats_.cached_bytes + bytes <= max_cached_bytes_) {
+            free_[bytes].push_back(ptr);
+            stats_.cached_bytes += bytes;
+            return;
+        }
+    }
+    cv::fastFree(ptr);
+}
+
+void BufferPool::TrimLocked() const {
+    // 缩小上限后，从任意桶中释放空闲块直到满足上限
+    for (auto it = free_.begin(); it != free_.end() && stats_.cached_bytes > max_cached_bytes_;) {
+        std::vector<uint8_t*>& blocks = it->second;
+        while (!blocks.empty() && stats_.cached_bytes > max_cached_bytes_) {
+            cv::fastFree(blocks.back());
+            blocks.pop_back();
+            stats_.cached_bytes -= it->first;
+        }
+        it = blocks.empty() ? free_.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file buffer_pool.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief 输出图像的池化分配器：同尺寸的重复调用复用已释放的像素内存
+ * @version 0.1
+ * @date 2025-11-23
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 按字节数分桶缓存像素内存的 cv::MatAllocator
+ *
+ * @details 启用后被设为 OpenCV 的默认分配器（开启图像内存记账时作为记账分配器的内层分配器），
+ * 核心库内部创建的输出 cv::Mat 都从池中取内存。
+ * cv::Mat 引用计数归零（例如 JS 侧 Buffer 被 GC 回收、finalizer 释放其持有的 cv::Mat）时，
+ * 内存按大小放回空闲链表，下次同尺寸分配直接复用，不再经过 malloc/free 与缺页。
+ * 缓存总量超过上限时多余的块直接释放。所有接口线程安全，工作线程中的分配同样适用。
+ */
+class BufferPool : public cv::MatAllocator {
+public:
+    /**
+     * @brief 池的统计信息
+     */
+    struct Stats {
+        uint64_t hits = 0;          ///< 从缓存中复用的次数
+        uint64_t misses = 0;        ///< 新分配内存的次数
+        size_t cached_bytes = 0;    ///< 当前缓存的空闲字节数
+    };
+
+    /**
+     * @brief 全局唯一实例。实例永不析构，保证池外仍存活的 cv::Mat 能安全归还内存
+     */
+    static BufferPool& Instance();
+
+    /**
+     * @brief 启用或停用池
+     *
+     * @details 启用时把池设为 cv::Mat 的默认分配器；停用时恢复 OpenCV 自带的分配器并释放全部缓存。
+     * 停用前由池分配、仍在使用中的内存在释放时直接归还系统。
+     *
+     * @param enabled 是否启用
+     * @param max_cached_bytes 空闲缓存的上限（字节）
+     */
+    void Configure(bool enabled, size_t max_cached_bytes);
+
+    /**
+     * @brief 释放全部空闲缓存
+     */
+    void Trim();
+
+    Stats GetStats() const;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData* u) const override;
+
+private:
+    BufferPool() = default;
+
+    uint8_t* Acquire(size_t bytes) const;
+    void Release(uint8_t* ptr, size_t bytes) const;
+    void TrimLocked() const;
+
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<size_t, std::vector<uint8_t*>> free_;   ///< 字节数 -> 空闲块
+    mutable Stats stats_;
+    bool enabled_ = false;
+    size_t max_cached_bytes_ = 0;
+};
@@ -0,0 +1,125 @@
+/**
+ * @file common.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief Node-API 绑定公共工具实现
+ * @version 0.1
+ * @date 2025-11-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "common.h"
+
+AddonData* GetAddonData(Napi::Env env) {
+    return env.GetInstanceData<AddonData>();
+}
+
+Napi::Error MakeError(Napi::Env env, const std::string& msg) {
+    return Napi::Error::New(env, msg);
+}
+
+cv::Mat MatFromBuffer(Napi::Env env, int width, int height, int channels,
+                      const Napi::Buffer<uint8_t>& buf, const char* name) {
+    if (width <= 0 || height <= 0) {
+    throw MakeError(env, "width and height must be positive");
+    }
+
+    int type = (channels == 1) ? CV_8UC1 : (channels == 4 ? CV_8UC4 : CV_8UC3);
+    size_t needed = static_cast<size_t>(width) * height * CV_ELEM_SIZE(type);
+    if (buf.Length() < needed) {
+    throw MakeError(env, std::string(name) + " length is insufficient");
+    }
+    return cv::Mat(height, width, type, buf.Data());
+}
+
+// 外部 Buffer 的 finalizer：释放其持有的 cv::Mat 引用
+static void ReleaseMat(Napi::Env /*env*/, uint8_t* /*data*/, cv::Mat* owner) {
+    delete owner;
+}
+
+Napi::Object MatToObject(Napi::Env env, const cv::Mat& img) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("width", Napi::Number::New(env, img.cols));
+    out.Set("height", Napi::Number::New(env, img.rows));
+    out.Set("channels", Napi::Number::New(env, img.channels()));
+    out.Set("bitDepth", Napi::Number::New(env, img.empty() ? 8 : static_cast<int>(8 * img.elemSize1())));
+    if (img.empty()) {
+        out.Set("data", Napi::Buffer<uint8_t>::New(env, 0));
+        return out;
+    }
+
+    // finalizer 持有的 cv::Mat 共享 img 的像素内存（引用计数 +1）。
+    // JS 可以改写 Buffer，所以像素还被其他对象（如 ImageCache 的条目）引用时先拷贝
+    bool shareable = img.isContinuous() && img.u != nullptr && img.u->refcount <= 1;
+    cv::Mat* owner = new cv::Mat(shareable ? img : img.clone());
+    size_t byteLen = owner->total() * owner->elemSize();
+    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::NewOrCopy(
+        env, owner->data, byteLen, ReleaseMat, owner);
+    out.Set("data", buf);
+    return out;
+}
+
+namespace {
+
+template <typename T, int CN>
+void ToRgbaRows(const cv::Mat& img, uint8_t* dst) {
+    constexpr int kShift = sizeof(T) == 1 ? 0 : 8;   // 16 位取高 8 位
+    for (int r = 0; r < img.rows; ++r) {
+        const T* s = img.ptr<T>(r);
+        for (int c = 0; c < img.cols; ++c, s += CN, dst += 4) {
+            if (CN == 1) {
+                dst[0] = dst[1] = dst[2] = static_cast<uint8_t>(s[0] >> kShift);
+            } else {
+                dst[0] = static_cast<uint8_t>(s[2] >> kShift);
+                dst[1] = static_cast<uint8_t>(s[1] >> kShift);
+                dst[2] = static_cast<uint8_t>(s[0] >> kShift);
+            }
+            dst[3] = CN == 4 ? static_cast<uint8_t>(s[CN - 1] >> kShift) : 255;
+        }
+    }
+}
+
+}  // namespace
+
+bool MatToRgba(const cv::Mat& img, uint8_t* dst) {
+    switch (img.type()) {
+        case CV_8UC1: ToRgbaRows<uint8_t, 1>(img, dst); return true;
+        case CV_8UC3: ToRgbaRows<uint8_t, 3>(img, dst); return true;
+        case CV_8UC4: ToRgbaRows<uint8_t, 4>(img, dst); return true;
+        case CV_16UC1: ToRgbaRows<uint16_t, 1>(img, dst); return true;
+        case CV_16UC3: ToRgbaRows<uint16_t, 3>(img, dst); return true;
+        case CV_16UC4: ToRgbaRows<uint16_t, 4>(img, dst); return true;
+        default: return false;
+    }
+}
+
+std::vector<TripletNode> TripletsFromArray(const Napi::Array& arr) {
+    // 初始化三元组数据，预留空间
+    std::vector<TripletNode> triplets;
+    triplets.reserve(arr.Length());
+
+    // 遍历数组，提取三元组数据
+    for (uint32_t i = 0; i < arr.Length(); ++i) {
+        Napi::Value v = arr.Get(i);
+        if (!v.IsObject()) continue;
+        Napi::Object o = v.As<Napi::Object>();
+        TripletNode t{};
+        t.row_ = o.Get("row").As<Napi::Number>().Int32Value();
+        t.col_ = o.Get("col").As<Napi::Number>().Int32Value();
+        Napi::Array val = o.Get("val").As<Napi::Array>();
+        t.val_[0] = static_cast<uint8_t>(val.Get((uint32_t)0).As<Napi::Number>().Int32Value());
+        t.val_[1] = static_cast<uint8_t>(val.Get((uint32_t)1).As<Napi::Number>().Int32Value());
+        t.val_[2] = static_cast<uint8_t>(val.Get((uint32_t)2).As<Napi::Number>().Int32Value());
+        triplets.push_back(t);
+    }
+    return triplets;
+}
+
+Processor::Interpolation ParseInterpolation(Napi::Env env, const Napi::Value& v, const char* name) {
+    if (v.IsUndefined()) return Processor::Interpolation::kBilinear;
+    std::string mode = v.IsString() ? v.As<Napi::String>().Utf8Value() : "";
+    if (mode == "bilinear") return Processor::Interpolation::kBilinear;
+    if (mode == "bicubic") return Processor::Interpolation::kBicubic;
+    if (mode == "lanczos3") return Processor::Interpolation::kLanczos3;
+    throw MakeError(env, std::string(name) + " must be 'bilinear', 'bicubic' or 'lanczos3'");
+}
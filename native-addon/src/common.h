@@ -0,0 +1,90 @@
+/**
+ * @file common.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief Node-API 绑定的公共工具：错误构造、cv::Mat 与 JS 对象互转、插件实例数据
+ * @version 0.1
+ * @date 2025-11-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <napi.h>
+#include <opencv2/core/mat.hpp>
+#include <string>
+#include <vector>
+#include "../../cpp/src/data_structure/triplet.h"
+#include "../../cpp/src/imgproc/image_processor.h"
+
+/**
+ * @brief 每个 Node 环境一份的插件数据，保存导出类的构造函数引用
+ */
+struct AddonData {
+    Napi::FunctionReference cancel_token;   ///< CancelToken 构造函数
+    Napi::FunctionReference image_handle;   ///< ImageHandle 构造函数
+};
+
+/**
+ * @brief 获取当前环境的插件数据（在 Init 中创建）
+ */
+AddonData* GetAddonData(Napi::Env env);
+
+/**
+ * @brief 创建 Napi::Error 异常
+ *
+ * @param env Node-API 环境
+ * @param msg 异常消息
+ * @return Napi::Error 异常对象
+ */
+Napi::Error MakeError(Napi::Env env, const std::string& msg);
+
+/**
+ * @brief 在 JS Buffer 的内存上直接构造 8 位 cv::Mat 头，不拷贝像素
+ *
+ * @details channels 为 1 时构造 CV_8UC1，为 4 时构造 CV_8UC4（BGRA），否则为 CV_8UC3。
+ * 宽高非正或 Buffer 长度不足时抛出 JS 异常，异常消息为 "<name> length is insufficient"。
+ * 返回的 cv::Mat 不持有内存，调用方必须保证 buf 在使用期间存活：同步调用中由调用栈保证，
+ * 异步调用中由工作对象持有 buf 的引用。
+ *
+ * @param env Node-API 环境
+ * @param width 图像宽度
+ * @param height 图像高度
+ * @param channels 通道数
+ * @param buf 像素数据
+ * @param name 参数名，用于异常消息
+ * @return cv::Mat 指向 buf 内存的图像
+ */
+cv::Mat MatFromBuffer(Napi::Env env, int width, int height, int channels,
+                      const Napi::Buffer<uint8_t>& buf, const char* name);
+
+/**
+ * @brief 把 cv::Mat 转换为 { width, height, channels, bitDepth, data: Buffer } 对象
+ *
+ * @details bitDepth 为每个通道的位数（8 或 16），16 位图像的 data 按本机字节序存放 uint16。
+ * data 是外部 Buffer，直接指向 img 的像素内存，并通过 finalizer 持有一份 cv::Mat
+ * 引用，GC 回收 Buffer 时才释放像素。img 不连续或不持有自身内存（例如指向另一个 JS Buffer）
+ * 时先克隆。运行时禁止外部 Buffer（如 Electron 的 V8 内存笼）时退化为一次拷贝。
+ */
+Napi::Object MatToObject(Napi::Env env, const cv::Mat& img);
+
+/**
+ * @brief 把图像转换为用于显示的 RGBA（每像素 4 字节，行紧密排列）写入 dst
+ *
+ * @details 支持 8/16 位 1/3/4 通道：灰度复制到 RGB，BGR(A) 交换为 RGB(A)，无 alpha 时为 255，
+ * 16 位取高 8 位。img 可以不连续。dst 至少 width * height * 4 字节。
+ *
+ * @return 类型不支持时返回 false，dst 不被修改
+ */
+bool MatToRgba(const cv::Mat& img, uint8_t* dst);
+
+/**
+ * @brief 把 JS 数组 [{ row, col, val: [b, g, r] }, ...] 解析为三元组，非对象元素会被跳过
+ */
+std::vector<TripletNode> TripletsFromArray(const Napi::Array& arr);
+
+/**
+ * @brief 解析插值方式：'bilinear' | 'bicubic' | 'lanczos3'，undefined 时为 'bilinear'
+ *
+ * @details 其他取值抛出 JS 异常，消息为 "<name> must be 'bilinear', 'bicubic' or 'lanczos3'"。
+ */
+Processor::Interpolation ParseInterpolation(Napi::Env env, const Napi::Value& v, const char* name);
@@ -0,0 +1,284 @@
+/**
+ * @file image_handle.cc
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief ImageHandle 实现
+ * @version 0.1
+ * @date 2025-11-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "image_handle.h"
+#include <stdexcept>
+#include <string>
+#include "../../cpp/src/imgproc/image_processor.h"
+#include "../../cpp/src/pipeline/image_file.h"
+#include "../../cpp/src/pipeline/operation.h"
+#include "async_ops.h"
+#include "common.h"
+
+namespace {
+
+// 按扩展名检查格式，不支持时抛出 JS 异常（在主线程调用）
+void CheckFormat(Napi::Env env, const std::string& path) {
+    if (ImageFile::FormatOf(path) == ImageFile::Format::kUnknown) {
+    throw MakeError(env, "Unsupported file extension: " + path);
+    }
+}
+
+}  // namespace
+
+Napi::Function ImageHandle::Define(Napi::Env env) {
+    // 异步方法可写，index.js 会把它们包装为接受 AbortSignal 的版本
+    constexpr auto kWrappable = static_cast<napi_property_attributes>(napi_writable | napi_configurable);
+    Napi::Function cls = DefineClass(env, "ImageHandle", {
+        StaticMethod("load", &ImageHandle::Load),
+        StaticMethod("loadAsync", &ImageHandle::LoadAsync, kWrappable),
+        StaticMethod("fromBuffer", &ImageHandle::FromBuffer),
+        InstanceAccessor("width", &ImageHandle::GetWidth, nullptr),
+        InstanceAccessor("height", &ImageHandle::GetHeight, nullptr),
+        InstanceAccessor("channels", &ImageHandle::GetChannels, nullptr),
+        InstanceAccessor("disposed", &ImageHandle::GetDisposed, nullptr),
+        InstanceMethod("toGray", &ImageHandle::ToGray),
+        InstanceMethod("resize", &ImageHandle::Resize),
+        InstanceMethod("crop", &ImageHandle::Crop),
+        InstanceMethod("save", &ImageHandle::Save),
+        InstanceMethod("toGrayAsync", &ImageHandle::ToGrayAsync, kWrappable),
+        InstanceMethod("resizeAsync", &ImageHandle::ResizeAsync, kWrappable),
+        InstanceMethod("saveAsync", &ImageHandle::SaveAsync, kWrappable),
+        InstanceMethod("toObject", &ImageHandle::ToObject),
+        InstanceMethod("toRgba", &ImageHandle::ToRgba),
+        InstanceMethod("dispose", &ImageHandle::Dispose),
+    });
+    GetAddonData(env)->image_handle = Napi::Persistent(cls);
+    return cls;
+}
+
+Napi::Object ImageHandle::New(Napi::Env env, const cv::Mat& img) {
+    // 构造函数同步拷贝 cv::Mat 头，External 只需在本次调用期间有效
+    cv::Mat header = img;
+    return GetAddonData(env)->image_handle.New({Napi::External<cv::Mat>::New(env, &header)});
+}
+
+ImageHandle::ImageHandle(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ImageHandle>(info), env_(info.Env()) {
+    if (info.Length() != 1 || !info[0].IsExternal()) {
+    throw MakeError(info.Env(), "ImageHandle cannot be constructed directly; use ImageHandle.load() or ImageHandle.fromBuffer()");
+    }
+    img_ = *info[0].As<Napi::External<cv::Mat>>().Data();
+
+    // 让 GC 感知像素内存，避免大量句柄堆积却迟迟不触发回收。共享像素的句柄会重复计数，只作为估计
+    external_bytes_ = static_cast<int64_t>(img_.total() * img_.elemSize());
+    if (external_bytes_ > 0) Napi::MemoryManagement::AdjustExternalMemory(info.Env(), external_bytes_);
+}
+
+ImageHandle::~ImageHandle() {
+    Release();
+}
+
+void ImageHandle::Release() {
+    img_.release();
+    if (external_bytes_ > 0) {
+        Napi::MemoryManagement::AdjustExternalMemory(Napi::Env(env_), -external_bytes_);
+        external_bytes_ = 0;
+    }
+}
+
+const cv::Mat& ImageHandle::Image(Napi::Env env) const {
+    if (img_.empty()) {
+    throw MakeError(env, "ImageHandle has been disposed");
+    }
+    return img_;
+}
+
+// =========================================================
+// 静态方法
+// =========================================================
+
+// ImageHandle.load(path)
+Napi::Value ImageHandle::Load(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() != 1 || !info[0].IsString()) {
+    throw MakeError(env, "ImageHandle.load(filePath) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    CheckFormat(env, path);
+    cv::Mat img = ImageFile::Load(path);
+    if (img.empty()) {
+    throw MakeError(env, "Failed to load image: " + path);
+    }
+    return New(env, img);
+}
+
+// ImageHandle.loadAsync(path, options?)
+Napi::Value ImageHandle::LoadAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsString()) {
+    throw MakeError(env, "ImageHandle.loadAsync(filePath, options?) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    CheckFormat(env, path);
+    return ScheduleTask(info, 1, "ImageHandle.loadAsync", [path](StageReporter&) {
+        cv::Mat img = ImageFile::Load(path);
+        if (img.empty()) throw std::runtime_error("Failed to load image: " + path);
+        return HandleResult(img);
+    });
+}
+
+// ImageHandle.fromBuffer(width, height, channels, dataBuffer)，像素会被拷贝一份
+Napi::Value ImageHandle::FromBuffer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() != 4 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsBuffer()) {
+    throw MakeError(env, "ImageHandle.fromBuffer(width, height, channels, dataBuffer)");
+    }
+    int width = info[0].As<Napi::Number>().Int32Value();
+    int height = info[1].As<Napi::Number>().Int32Value();
+    int channels = info[2].As<Napi::Number>().Int32Value();
+    cv::Mat view = MatFromBuffer(env, width, height, channels, info[3].As<Napi::Buffer<uint8_t>>(), "dataBuffer");
+    return New(env, view.clone());   // 句柄的生命周期与 JS Buffer 无关，必须拷贝
+}
+
+// =========================================================
+// 属性
+// =========================================================
+
+Napi::Value ImageHandle::GetWidth(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), Image(info.Env()).cols);
+}
+
+Napi::Value ImageHandle::GetHeight(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), Image(info.Env()).rows);
+}
+
+Napi::Value ImageHandle::GetChannels(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), Image(info.Env()).channels());
+}
+
+Napi::Value ImageHandle::GetDisposed(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), img_.empty());
+}
+
+// =========================================================
+// 处理方法
+// =========================================================
+
+// handle.toGray()
+Napi::Value ImageHandle::ToGray(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const cv::Mat& img = Image(env);
+    cv::Mat gray = Operation::Gray().Apply(img);
+    if (gray.empty()) {
+    throw MakeError(env, "toGray: unsupported image type");
+    }
+    return New(env, gray);   // 单通道输入时结果与输入共享内存
+}
+
+// handle.resize(newWidth, newHeight, interpolation?)
+Napi::Value ImageHandle::Resize(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || info.Length() > 3 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    throw MakeError(env, "resize(newWidth, newHeight, interpolation?)");
+    }
+    int newW = info[0].As<Napi::Number>().Int32Value();
+    int newH = info[1].As<Napi::Number>().Int32Value();
+    Processor::Interpolation mode = ParseInterpolation(env, info[2], "interpolation");
+    const cv::Mat& img = Image(env);
+    cv::Mat out = Processor::Resize(img, newW, newH, mode);
+    if (out.empty()) {
+    throw MakeError(env, "resize: invalid size or unsupported image type");
+    }
+    return New(env, out);
+}
+
+// handle.crop(x, y, width, height)：返回共享像素的视图句柄
+Napi::Value ImageHandle::Crop(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() != 4 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber()) {
+    throw MakeError(env, "crop(x, y, width, height)");
+    }
+    cv::Rect roi(info[0].As<Napi::Number>().Int32Value(), info[1].As<Napi::Number>().Int32Value(),
+                 info[2].As<Napi::Number>().Int32Value(), info[3].As<Napi::Number>().Int32Value());
+    const cv::Mat& img = Image(env);
+    cv::Mat view = Operation::Crop(roi.x, roi.y, roi.width, roi.height).Apply(img);
+    if (view.empty()) {
+    throw MakeError(env, "crop: region is empty or outside the image");
+    }
+    return New(env, view);
+}
+
+// handle.save(filePath)
+Napi::Value ImageHandle::Save(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() != 1 || !info[0].IsString()) {
+    throw MakeError(env, "save(filePath) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    CheckFormat(env, path);
+    return Napi::Boolean::New(env, ImageFile::Save(path, Image(env)));
+}
+
+// handle.toGrayAsync(options?)
+Napi::Value ImageHandle::ToGrayAsync(const Napi::CallbackInfo& info) {
+    cv::Mat img = Image(info.Env());   // 按值捕获，任务期间 dispose 不影响计算
+    return ScheduleTask(info, 0, "ImageHandle.toGrayAsync", [img](StageReporter&) {
+        cv::Mat gray = Operation::Gray().Apply(img);
+        if (gray.empty()) throw std::runtime_error("toGray: unsupported image type");
+        return HandleResult(gray);
+    });
+}
+
+// handle.resizeAsync(newWidth, newHeight, options?)，options.interpolation 同 resize
+Napi::Value ImageHandle::ResizeAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || info.Length() > 3 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    throw MakeError(env, "resizeAsync(newWidth, newHeight, options?)");
+    }
+    int newW = info[0].As<Napi::Number>().Int32Value();
+    int newH = info[1].As<Napi::Number>().Int32Value();
+    Processor::Interpolation mode = ParseInterpolation(env, OptionOf(info, 2, "interpolation"), "options.interpolation");
+    cv::Mat img = Image(env);
+    return ScheduleTask(info, 2, "ImageHandle.resizeAsync", [img, newW, newH, mode](StageReporter& reporter) {
+        cv::Mat out;
+        Processor::Resize(img, newW, newH, out, mode, reporter.Progress());
+        reporter.CheckCancelled();   // 被取消时以 AbortError 拒绝，而不是报告参数错误
+        if (out.empty()) throw std::runtime_error("resize: invalid size or unsupported image type");
+        return HandleResult(out);
+    });
+}
+
+// handle.saveAsync(filePath, options?)
+Napi::Value ImageHandle::SaveAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsString()) {
+    throw MakeError(env, "saveAsync(filePath, options?) expects a string path");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    CheckFormat(env, path);
+    cv::Mat img = Image(env);
+    return ScheduleTask(info, 1, "ImageHandle.saveAsync", [path, img](StageReporter&) {
+        return BoolResult(ImageFile::Save(path, img));
+    });
+}
+
+// handle.toObject()：导出 { width, height, channels, data }。data 可能与句柄共享内存，不应原地修改
+Napi::Value ImageHandle::ToObject(const Napi::CallbackInfo& info) {
+    return MatToObject(info.Env(), Image(info.Env()));
+}
+
+// handle.toRgba()：转换为 8 位 RGBA 写入新的 Buffer（width * height * 4 字节），可直接作为 ImageData 的像素。
+// Buffer 由 V8 分配，不是外部内存，可以经 IPC 发送给沙箱中的渲染进程
+Napi::Value ImageHandle::ToRgba(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const cv::Mat& img = Image(env);
+    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, img.total() * 4);
+    if (!MatToRgba(img, buf.Data())) {
+    throw MakeError(env, "toRgba: unsupported image type");
+    }
+    return buf;
+}
+
+// handle.dispose()：重复调用无副作用
+Napi::Value ImageHandle::Dispose(const Napi::CallbackInfo& info) {
+    Release();
+    return info.Env().Undefined();
+}
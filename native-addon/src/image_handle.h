@@ -0,0 +1,84 @@
+/**
+ * @file image_handle.h
+ * @author Runhui Mo (github.com/mugaaaaa)
+ * @brief ImageHandle：在原生侧持有图像，支持链式处理而无需把像素传回 JS
+ * @version 0.1
+ * @date 2025-11-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <napi.h>
+#include <opencv2/core/mat.hpp>
+
+/**
+ * @brief 持有一份引用计数 cv::Mat 的 JS 对象
+ *
+ * @details 处理方法（toGray / resize 等）返回新的 ImageHandle，像素始终留在原生侧；
+ * 只有显式调用 toObject() 时才导出 { width, height, channels, data }。
+ * dispose() 立即释放像素引用，未 dispose 的句柄在 GC 回收时释放。
+ * 多个句柄可能共享同一块像素内存（cv::Mat 引用计数），所有处理都不会原地修改输入。
+ *
+ * JS 接口：
+ * - 静态方法：load(path) / loadAsync(path, options?) / fromBuffer(width, height, channels, data)
+ * - 属性：width, height, channels, disposed
+ * - 方法：toGray() / resize(w, h, interpolation?) / crop(x, y, w, h) / save(path) / toObject() / toRgba() /
+ *   dispose()
+ *   以及 toGrayAsync / resizeAsync / saveAsync（末尾可传 options，见 async_ops.h）
+ *
+ * crop 返回与原句柄共享像素的视图句柄，不拷贝像素；视图上的 resize 等处理只读取裁剪区域，
+ * 原句柄 dispose 后视图仍然有效。
+ *
+ * load / save 按扩展名选择格式：.png、.ppm / .pgm、.trip（Compressor）。
+ */
+class ImageHandle : public Napi::ObjectWrap<ImageHandle> {
+public:
+    /**
+     * @brief 定义 JS 类，并把构造函数保存到 AddonData
+     */
+    static Napi::Function Define(Napi::Env env);
+
+    /**
+     * @brief 创建持有 img 的新句柄（共享像素内存）
+     */
+    static Napi::Object New(Napi::Env env, const cv::Mat& img);
+
+    explicit ImageHandle(const Napi::CallbackInfo& info);
+    ~ImageHandle() override;
+
+private:
+    static Napi::Value Load(const Napi::CallbackInfo& info);
+    static Napi::Value LoadAsync(const Napi::CallbackInfo& info);
+    static Napi::Value FromBuffer(const Napi::CallbackInfo& info);
+
+    Napi::Value GetWidth(const Napi::CallbackInfo& info);
+    Napi::Value GetHeight(const Napi::CallbackInfo& info);
+    Napi::Value GetChannels(const Napi::CallbackInfo& info);
+    Napi::Value GetDisposed(const Napi::CallbackInfo& info);
+
+    Napi::Value ToGray(const Napi::CallbackInfo& info);
+    Napi::Value Resize(const Napi::CallbackInfo& info);
+    Napi::Value Crop(const Napi::CallbackInfo& info);
+    Napi::Value Save(const Napi::CallbackInfo& info);
+    Napi::Value ToGrayAsync(const Napi::CallbackInfo& info);
+    Napi::Value ResizeAsync(const Napi::CallbackInfo& info);
+    Napi::Value SaveAsync(const Napi::CallbackInfo& info);
+    Napi::Value ToObject(const Napi::CallbackInfo& info);
+    Napi::Value ToRgba(const Napi::CallbackInfo& info);
+    Napi::Value Dispose(const Napi::CallbackInfo& info);
+
+    /**
+     * @brief 返回持有的图像，已 dispose 时抛出 JS 异常
+     */
+    const cv::Mat& Image(Napi::Env env) const;
+
+    /**
+     * @brief 释放像素引用并同步 V8 的外部内存计数
+     */
+    void Release();
+
+    cv::Mat img_;
+    int64_t external_bytes_ = 0;    ///< 已通过 AdjustExternalMemory 报告给 V8 的字节数
+    napi_env env_ = nullptr;
+};
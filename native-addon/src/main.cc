@@ -10,21 +10,18 @@
  */
 #include <napi.h>
 #include <opencv2/opencv.hpp>
-#include <cstring>
+#include <sstream>
 #include "../../cpp/src/io/image_io.h"
+#include "../../cpp/src/io/image_cache.h"
 #include "../../cpp/src/codec/compressor.h"
 #include "../../cpp/src/imgproc/image_processor.h"
-
-/**
- * @brief 创建 Napi::Error 异常
- * 
- * @param env Node-API 环境
- * @param msg 异常消息
- * @return Napi::Error 异常对象
- */
-static inline Napi::Error MakeError(Napi::Env env, const std::string& msg) {
-    return Napi::Error::New(env, msg);
-}
+#include "../../cpp/src/common/memory.h"
+#include "../../cpp/src/common/stats.h"
+#include "common.h"
+#include "async_ops.h"
+#include "batch_ops.h"
+#include "buffer_pool.h"
+#include "image_handle.h"
 
 /**
  * @brief 把 ImageIO::LoadPng 包装为 Node-API 函数
@@ -51,16 +48,7 @@ static Napi::Value LoadPngWrapped(const Napi::CallbackInfo& info) {
     }
 
     // 构造 out 并返回
-    size_t elemSize = img.elemSize();
-    size_t byteLen = static_cast<size_t>(img.rows) * img.cols * elemSize;
-    Napi::Object out = Napi::Object::New(env);
-    out.Set("width", Napi::Number::New(env, img.cols));
-    out.Set("height", Napi::Number::New(env, img.rows));
-    out.Set("channels", Napi::Number::New(env, img.channels()));
-    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, byteLen); // Buffer 存储图像数据
-    std::memcpy(buf.Data(), img.data, byteLen);
-    out.Set("data", buf);
-    return out;
+    return MatToObject(env, img);
 }
 
 /**
@@ -88,16 +76,35 @@ static Napi::Value LoadPpmWrapped(const Napi::CallbackInfo& info) {
     }
 
     // 构造 out 并输出
-    size_t elemSize = img.elemSize();
-    size_t byteLen = static_cast<size_t>(img.rows) * img.cols * elemSize;
-    Napi::Object out = Napi::Object::New(env);
-    out.Set("width", Napi::Number::New(env, img.cols));
-    out.Set("height", Napi::Number::New(env, img.rows));
-    out.Set("channels", Napi::Number::New(env, img.channels()));
-    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, byteLen);
-    std::memcpy(buf.Data(), img.data, byteLen);
-    out.Set("data", buf);
-    return out;
+    return MatToObject(env, img);
+}
+
+/**
+ * @brief 把 ImageIO::LoadPreview 包装为 Node-API 函数
+ * 
+ * @details 加载长边不超过 maxDim 的缩小预览图，返回 { width, height, channels, data: Buffer }
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 包含预览图数据的对象
+ */
+static Napi::Value LoadPreviewWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() != 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    throw MakeError(env, "loadPreview(filePath, maxDim)");
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    int maxDim = info[1].As<Napi::Number>().Int32Value();
+    if (maxDim <= 0) {
+    throw MakeError(env, "maxDim must be positive");
+    }
+    cv::Mat img = ImageIO::LoadPreview(path, maxDim);
+    if (img.empty()) {
+    throw MakeError(env, "Failed to load preview: " + path);
+    }
+    return MatToObject(env, img);
 }
 
 /**
@@ -122,13 +129,7 @@ static Napi::Value SavePngWrapped(const Napi::CallbackInfo& info) {
     int height = info[2].As<Napi::Number>().Int32Value();
     int channels = info[3].As<Napi::Number>().Int32Value();
     Napi::Buffer<uint8_t> buf = info[4].As<Napi::Buffer<uint8_t>>();
-    int type = (channels == 1) ? CV_8UC1 : CV_8UC3;
-    cv::Mat img(height, width, type);
-    size_t needed = static_cast<size_t>(width) * height * img.elemSize();
-    if (buf.Length() < needed) {
-    throw MakeError(env, "dataBuffer length is insufficient");
-    }
-    std::memcpy(img.data, buf.Data(), needed);
+    cv::Mat img = MatFromBuffer(env, width, height, channels, buf, "dataBuffer");
     
     // 调用 ImageIO::SavePng 保存 img
     bool ok = ImageIO::SavePng(path, img);
@@ -157,13 +158,7 @@ static Napi::Value SavePpmWrapped(const Napi::CallbackInfo& info) {
     int height = info[2].As<Napi::Number>().Int32Value();
     int channels = info[3].As<Napi::Number>().Int32Value();
     Napi::Buffer<uint8_t> buf = info[4].As<Napi::Buffer<uint8_t>>();
-    int type = (channels == 1) ? CV_8UC1 : CV_8UC3;
-    cv::Mat img(height, width, type);
-    size_t needed = static_cast<size_t>(width) * height * img.elemSize();
-    if (buf.Length() < needed) {
-    throw MakeError(env, "dataBuffer length is insufficient");
-    }
-    std::memcpy(img.data, buf.Data(), needed);
+    cv::Mat img = MatFromBuffer(env, width, height, channels, buf, "dataBuffer");
 
     // 调用 ImageIO::SavePpm 保存 img
     bool ok = ImageIO::SavePpm(path, img);
@@ -190,31 +185,20 @@ static Napi::Value ToGrayWrapped(const Napi::CallbackInfo& info) {
     int width = info[0].As<Napi::Number>().Int32Value();
     int height = info[1].As<Napi::Number>().Int32Value();
     Napi::Buffer<uint8_t> buf = info[2].As<Napi::Buffer<uint8_t>>();
-    cv::Mat input(height, width, CV_8UC3);
-    size_t needed = static_cast<size_t>(width) * height * input.elemSize();
-    if (buf.Length() < needed) {
-    throw MakeError(env, "bgrBuffer length is insufficient");
-    }
-    std::memcpy(input.data, buf.Data(), needed);
+    cv::Mat input = MatFromBuffer(env, width, height, 3, buf, "bgrBuffer");
 
     // 调用 Processor::ToGray 转换为灰度图像
     cv::Mat gray = Processor::ToGray(input);
 
     // 返回数据
-    Napi::Object out = Napi::Object::New(env);
-    out.Set("width", Napi::Number::New(env, gray.cols));
-    out.Set("height", Napi::Number::New(env, gray.rows));
-    out.Set("channels", Napi::Number::New(env, 1));
-    Napi::Buffer<uint8_t> gbuf = Napi::Buffer<uint8_t>::New(env, static_cast<size_t>(gray.rows) * gray.cols);
-    std::memcpy(gbuf.Data(), gray.data, static_cast<size_t>(gray.rows) * gray.cols);
-    out.Set("data", gbuf);
-    return out;
+    return MatToObject(env, gray);
 }
 
 /**
  * @brief 把 Processor::Resize 包装为 Node-API 函数
  * 
- * @details 把包含图像数据的对象按指定比例缩放
+ * @details 把包含图像数据的对象按指定比例缩放，可选第 7 个参数指定插值方式
+ * （'bilinear' | 'bicubic' | 'lanczos3'，默认 'bilinear'）
  * 
  * @param info Node-API 回调信息
  * @return Napi::Value 包含缩放后图像数据的对象
@@ -223,8 +207,8 @@ static Napi::Value ResizeWrapped(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
     // 参数检查
-    if (info.Length() != 6 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsNumber() || !info[5].IsBuffer()) {
-    throw MakeError(env, "resize(width, height, channels, newWidth, newHeight, dataBuffer)");
+    if (info.Length() < 6 || info.Length() > 7 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsNumber() || !info[5].IsBuffer()) {
+    throw MakeError(env, "resize(width, height, channels, newWidth, newHeight, dataBuffer, interpolation?)");
     }
 
     // 提取图像信息
@@ -234,26 +218,14 @@ static Napi::Value ResizeWrapped(const Napi::CallbackInfo& info) {
     int newW = info[3].As<Napi::Number>().Int32Value();
     int newH = info[4].As<Napi::Number>().Int32Value();
     Napi::Buffer<uint8_t> buf = info[5].As<Napi::Buffer<uint8_t>>();
-    int type = (channels == 1) ? CV_8UC1 : CV_8UC3;
-    cv::Mat input(height, width, type);
-    size_t needed = static_cast<size_t>(width) * height * input.elemSize();
-    if (buf.Length() < needed) {
-    throw MakeError(env, "dataBuffer length is insufficient");
-    }
-    std::memcpy(input.data, buf.Data(), needed);
+    cv::Mat input = MatFromBuffer(env, width, height, channels, buf, "dataBuffer");
+    Processor::Interpolation mode = ParseInterpolation(env, info[6], "interpolation");
 
     // 调用 Processor::Resize 缩放图像
-    cv::Mat outImg = Processor::Resize(input, newW, newH);
+    cv::Mat outImg = Processor::Resize(input, newW, newH, mode);
 
     // 构造 out 并返回数据
-    Napi::Object out = Napi::Object::New(env);
-    out.Set("width", Napi::Number::New(env, outImg.cols));
-    out.Set("height", Napi::Number::New(env, outImg.rows));
-    out.Set("channels", Napi::Number::New(env, outImg.channels()));
-    Napi::Buffer<uint8_t> obuf = Napi::Buffer<uint8_t>::New(env, static_cast<size_t>(outImg.rows) * outImg.cols * outImg.elemSize());
-    std::memcpy(obuf.Data(), outImg.data, static_cast<size_t>(outImg.rows) * outImg.cols * outImg.elemSize());
-    out.Set("data", obuf);
-    return out;
+    return MatToObject(env, outImg);
 }
 
 /**
@@ -278,13 +250,7 @@ static Napi::Value CompressorSaveWrapped(const Napi::CallbackInfo& info) {
     int height = info[2].As<Napi::Number>().Int32Value();
     int channels = info[3].As<Napi::Number>().Int32Value();
     Napi::Buffer<uint8_t> buf = info[4].As<Napi::Buffer<uint8_t>>();
-    int type = (channels == 1) ? CV_8UC1 : CV_8UC3;
-    cv::Mat img(height, width, type);
-    size_t needed = static_cast<size_t>(width) * height * img.elemSize();
-    if (buf.Length() < needed) {
-    throw MakeError(env, "dataBuffer length is insufficient");
-    }
-    std::memcpy(img.data, buf.Data(), needed);
+    cv::Mat img = MatFromBuffer(env, width, height, channels, buf, "dataBuffer");
 
     // 调用 Compressor::Save 保存图像
     bool ok = Compressor::Save(path, img);
@@ -315,15 +281,7 @@ static Napi::Value CompressorLoadWrapped(const Napi::CallbackInfo& info) {
     }
 
     // 构造 out 并返回数据
-    size_t byteLen = static_cast<size_t>(img.rows) * img.cols * img.elemSize();
-    Napi::Object out = Napi::Object::New(env);
-    out.Set("width", Napi::Number::New(env, img.cols));
-    out.Set("height", Napi::Number::New(env, img.rows));
-    out.Set("channels", Napi::Number::New(env, img.channels()));
-    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(env, byteLen);
-    std::memcpy(buf.Data(), img.data, byteLen);
-    out.Set("data", buf);
-    return out;
+    return MatToObject(env, img);
 }
 
 /**
@@ -355,33 +313,353 @@ static Napi::Value SaveTripWrapped(const Napi::CallbackInfo& info) {
     // 背景颜色
     uint8_t bg[3] = { bgBuf[0], bgBuf[1], bgBuf[2] };
 
-    // .trip 文件头
-    Napi::Array arr = info[5].As<Napi::Array>();
-
-    // 初始化三元组数据，预留空间
-    std::vector<TripletNode> triplets;
-    triplets.reserve(arr.Length());
-
-    // 遍历数组，提取三元组数据
-    for (uint32_t i = 0; i < arr.Length(); ++i) {
-        Napi::Value v = arr.Get(i);
-        if (!v.IsObject()) continue;
-        Napi::Object o = v.As<Napi::Object>();
-        TripletNode t{};
-        t.row_ = o.Get("row").As<Napi::Number>().Int32Value();
-        t.col_ = o.Get("col").As<Napi::Number>().Int32Value();
-        Napi::Array val = o.Get("val").As<Napi::Array>();
-        t.val_[0] = static_cast<uint8_t>(val.Get((uint32_t)0).As<Napi::Number>().Int32Value());
-        t.val_[1] = static_cast<uint8_t>(val.Get((uint32_t)1).As<Napi::Number>().Int32Value());
-        t.val_[2] = static_cast<uint8_t>(val.Get((uint32_t)2).As<Napi::Number>().Int32Value());
-        triplets.push_back(t);
-    }
+    // 解析三元组数组
+    std::vector<TripletNode> triplets = TripletsFromArray(info[5].As<Napi::Array>());
 
     // 调用 ImageIO::SaveTrip 保存图像
     bool ok = ImageIO::SaveTrip(path, width, height, channels, bg, triplets);
     return Napi::Boolean::New(env, ok);
 }
 
+// 编码结果 Buffer 的 finalizer：释放其持有的 std::vector
+static void ReleaseEncoded(Napi::Env /*env*/, uint8_t* /*data*/, std::vector<uint8_t>* owner) {
+    delete owner;
+}
+
+// 解析 encodeImage 的 options：{ pngCompression?, pngStrategy?, jpegQuality?, ppmBinary? }
+static ImageIO::EncodeOptions ParseEncodeOptions(Napi::Env env, const Napi::Value& value) {
+    using Strategy = ImageIO::EncodeOptions::PngStrategy;
+    ImageIO::EncodeOptions options;
+    if (value.IsUndefined() || value.IsNull()) return options;
+    if (!value.IsObject()) {
+    throw MakeError(env, "encode options must be an object");
+    }
+    Napi::Object o = value.As<Napi::Object>();
+    if (o.Get("pngCompression").IsNumber()) options.png_compression = o.Get("pngCompression").As<Napi::Number>().Int32Value();
+    if (o.Get("jpegQuality").IsNumber()) options.jpeg_quality = o.Get("jpegQuality").As<Napi::Number>().Int32Value();
+    if (o.Get("ppmBinary").IsBoolean()) options.ppm_binary = o.Get("ppmBinary").As<Napi::Boolean>().Value();
+    if (o.Get("pngStrategy").IsString()) {
+        std::string s = o.Get("pngStrategy").As<Napi::String>().Utf8Value();
+        if (s == "default") options.png_strategy = Strategy::kDefault;
+        else if (s == "filtered") options.png_strategy = Strategy::kFiltered;
+        else if (s == "huffman") options.png_strategy = Strategy::kHuffmanOnly;
+        else if (s == "rle") options.png_strategy = Strategy::kRle;
+        else if (s == "fixed") options.png_strategy = Strategy::kFixed;
+        else {
+        throw MakeError(env, "unknown pngStrategy: " + s);
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief 把 ImageIO::EncodeToBuffer 包装为 Node-API 函数
+ * 
+ * @details encodeImage(format, width, height, channels, dataBuffer, options?)，
+ * format 为 'png' / 'jpg' / 'ppm' 等，options 见 ParseEncodeOptions。
+ * 返回的 Buffer 直接持有编码结果，不再拷贝。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 编码后的 Buffer
+ */
+static Napi::Value EncodeImageWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() < 5 || info.Length() > 6 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsBuffer()) {
+    throw MakeError(env, "encodeImage(format, width, height, channels, dataBuffer, options?)");
+    }
+
+    std::string format = info[0].As<Napi::String>().Utf8Value();
+    int width = info[1].As<Napi::Number>().Int32Value();
+    int height = info[2].As<Napi::Number>().Int32Value();
+    int channels = info[3].As<Napi::Number>().Int32Value();
+    Napi::Buffer<uint8_t> buf = info[4].As<Napi::Buffer<uint8_t>>();
+    cv::Mat img = MatFromBuffer(env, width, height, channels, buf, "dataBuffer");
+    ImageIO::EncodeOptions options = ParseEncodeOptions(env, info.Length() == 6 ? info[5] : env.Undefined());
+
+    auto* encoded = new std::vector<uint8_t>();
+    if (!ImageIO::EncodeToBuffer(img, format, options, encoded)) {
+        delete encoded;
+    throw MakeError(env, "Failed to encode image as " + format);
+    }
+    return Napi::Buffer<uint8_t>::NewOrCopy(env, encoded->data(), encoded->size(), ReleaseEncoded, encoded);
+}
+
+/**
+ * @brief 把 ImageIO::DecodeFromBuffer 包装为 Node-API 函数
+ * 
+ * @details decodeImage(encodedBuffer)，直接在 Buffer 内存上解码，不拷贝输入。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 包含图像数据的对象
+ */
+static Napi::Value DecodeImageWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() != 1 || !info[0].IsBuffer()) {
+    throw MakeError(env, "decodeImage(encodedBuffer)");
+    }
+
+    Napi::Buffer<uint8_t> buf = info[0].As<Napi::Buffer<uint8_t>>();
+    cv::Mat img = ImageIO::DecodeFromBuffer(buf.Data(), buf.Length());
+    if (img.empty()) {
+    throw MakeError(env, "Failed to decode image buffer");
+    }
+    return MatToObject(env, img);
+}
+
+/**
+ * @brief 启用或停用输出图像的内存池
+ * 
+ * @details setBufferPool(enabled, maxCachedBytes?)。启用后，同尺寸的重复调用会复用
+ * 已被 GC 回收的输出 Buffer 的内存；maxCachedBytes 为空闲缓存上限，默认 256 MB。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value SetBufferPoolWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsBoolean() || (info.Length() == 2 && !info[1].IsNumber())) {
+    throw MakeError(env, "setBufferPool(enabled, maxCachedBytes?)");
+    }
+
+    bool enabled = info[0].As<Napi::Boolean>().Value();
+    double maxBytes = info.Length() == 2 ? info[1].As<Napi::Number>().DoubleValue() : 256.0 * 1024 * 1024;
+    if (maxBytes < 0) {
+    throw MakeError(env, "maxCachedBytes must be non-negative");
+    }
+    BufferPool::Instance().Configure(enabled, static_cast<size_t>(maxBytes));
+    return env.Undefined();
+}
+
+/**
+ * @brief 返回内存池统计信息 { hits, misses, cachedBytes }
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 统计信息对象
+ */
+static Napi::Value BufferPoolStatsWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    BufferPool::Stats stats = BufferPool::Instance().GetStats();
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    out.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    out.Set("cachedBytes", Napi::Number::New(env, static_cast<double>(stats.cached_bytes)));
+    return out;
+}
+
+/**
+ * @brief 设置解码图像缓存的容量
+ * 
+ * @details setImageCache(maxBytes)。maxBytes > 0 时启用，重复加载同一文件（路径、大小与
+ * 修改时间均未变）直接返回已解码的图像；0 表示停用并清空。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value SetImageCacheWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() != 1 || !info[0].IsNumber()) {
+    throw MakeError(env, "setImageCache(maxBytes)");
+    }
+
+    double maxBytes = info[0].As<Napi::Number>().DoubleValue();
+    if (maxBytes < 0) {
+    throw MakeError(env, "maxBytes must be non-negative");
+    }
+    ImageCache::Instance().SetCapacity(static_cast<size_t>(maxBytes));
+    return env.Undefined();
+}
+
+/**
+ * @brief 返回解码图像缓存的统计信息 { hits, misses, evictions, bytes, entries, capacity }
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 统计信息对象
+ */
+static Napi::Value ImageCacheStatsWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ImageCache::Stats stats = ImageCache::Instance().GetStats();
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    out.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    out.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    out.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+    out.Set("entries", Napi::Number::New(env, static_cast<double>(stats.entries)));
+    out.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+    return out;
+}
+
+/**
+ * @brief 使解码图像缓存失效
+ * 
+ * @details invalidateImageCache(filePath?)。传入路径时只丢弃该文件的条目，否则清空整个缓存。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value InvalidateImageCacheWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() > 1 || (info.Length() == 1 && !info[0].IsString())) {
+    throw MakeError(env, "invalidateImageCache(filePath?)");
+    }
+
+    if (info.Length() == 1) {
+        ImageCache::Instance().Invalidate(info[0].As<Napi::String>().Utf8Value());
+    } else {
+        ImageCache::Instance().Clear();
+    }
+    return env.Undefined();
+}
+
+/**
+ * @brief 开启或关闭核心库的耗时统计
+ * 
+ * @details setStatsEnabled(enabled, tracing?)。统计默认关闭；tracing 为 true 时同时记录
+ * 每次计时的事件，供 getStatsTrace 导出时间线。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value SetStatsEnabledWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsBoolean() || (info.Length() == 2 && !info[1].IsBoolean())) {
+    throw MakeError(env, "setStatsEnabled(enabled, tracing?)");
+    }
+
+    Stats::SetEnabled(info[0].As<Napi::Boolean>().Value());
+    Stats::SetTracing(info.Length() == 2 && info[1].As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+// { current, peak } 形式的内存用量
+static Napi::Object UsageToObject(Napi::Env env, const MemoryTracker::Usage& usage) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("current", Napi::Number::New(env, static_cast<double>(usage.current)));
+    out.Set("peak", Napi::Number::New(env, static_cast<double>(usage.peak)));
+    return out;
+}
+
+/**
+ * @brief 返回各阶段的耗时统计与内存记账
+ * 
+ * @details 格式为：
+ * { enabled, tracing,
+ *   stages: { decode: { count, totalMs, maxMs, bytes, peakBytes }, ... },
+ *   memory: { current, peak, budget, budgetFailures, trackingImages,
+ *             categories: { image: { current, peak }, ... },
+ *             threads: [{ id, currentBytes, peakBytes }] } }
+ * 所有线程（包括异步与批处理的工作线程）的计数已合并；peakBytes 为单次调用期间
+ * 所在线程新增内存的最大值。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value 统计信息对象
+ */
+static Napi::Value GetStatsWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stages = Napi::Object::New(env);
+    for (const Stats::StageStats& s : Stats::Snapshot()) {
+        Napi::Object stage = Napi::Object::New(env);
+        stage.Set("count", Napi::Number::New(env, static_cast<double>(s.count)));
+        stage.Set("totalMs", Napi::Number::New(env, s.total_ns / 1e6));
+        stage.Set("maxMs", Napi::Number::New(env, s.max_ns / 1e6));
+        stage.Set("bytes", Napi::Number::New(env, static_cast<double>(s.bytes)));
+        stage.Set("peakBytes", Napi::Number::New(env, static_cast<double>(s.peak_bytes)));
+        stages.Set(s.name, stage);
+    }
+
+    MemoryTracker::Report report = MemoryTracker::GetReport();
+    Napi::Object categories = Napi::Object::New(env);
+    for (int i = 0; i < MemoryTracker::kNumCategories; ++i) {
+        categories.Set(MemoryTracker::Name(static_cast<MemoryTracker::Category>(i)), UsageToObject(env, report.categories[i]));
+    }
+    std::vector<Stats::ThreadStats> thread_stats = Stats::Threads();
+    Napi::Array threads = Napi::Array::New(env, thread_stats.size());
+    for (size_t i = 0; i < thread_stats.size(); ++i) {
+        Napi::Object t = Napi::Object::New(env);
+        t.Set("id", Napi::Number::New(env, thread_stats[i].id));
+        t.Set("currentBytes", Napi::Number::New(env, static_cast<double>(thread_stats[i].current_bytes)));
+        t.Set("peakBytes", Napi::Number::New(env, static_cast<double>(thread_stats[i].peak_bytes)));
+        threads.Set(static_cast<uint32_t>(i), t);
+    }
+    Napi::Object memory = UsageToObject(env, report.total);
+    memory.Set("budget", Napi::Number::New(env, static_cast<double>(report.budget)));
+    memory.Set("budgetFailures", Napi::Number::New(env, static_cast<double>(report.budget_failures)));
+    memory.Set("trackingImages", Napi::Boolean::New(env, MemoryTracker::tracking_mats()));
+    memory.Set("categories", categories);
+    memory.Set("threads", threads);
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("enabled", Napi::Boolean::New(env, Stats::enabled()));
+    out.Set("tracing", Napi::Boolean::New(env, Stats::tracing()));
+    out.Set("stages", stages);
+    out.Set("memory", memory);
+    return out;
+}
+
+/**
+ * @brief 清零耗时统计、丢弃已记录的事件，并把内存峰值重置为当前值
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value ResetStatsWrapped(const Napi::CallbackInfo& info) {
+    Stats::Reset();
+    MemoryTracker::ResetPeaks();
+    return info.Env().Undefined();
+}
+
+/**
+ * @brief 设置核心库的内存预算
+ * 
+ * @details setMemoryBudget(maxBytes, trackImages?)。maxBytes 为 0 表示不限制；超出预算的分配
+ * 立即失败，同步接口抛出异常，异步接口 reject，批处理中对应的作业报告错误。
+ * trackImages 为 true 时 cv::Mat 的像素内存也计入用量与预算（默认只统计核心库内部的容器）。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value undefined
+ */
+static Napi::Value SetMemoryBudgetWrapped(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // 参数检查
+    if (info.Length() < 1 || info.Length() > 2 || !info[0].IsNumber() || (info.Length() == 2 && !info[1].IsBoolean())) {
+    throw MakeError(env, "setMemoryBudget(maxBytes, trackImages?)");
+    }
+
+    double maxBytes = info[0].As<Napi::Number>().DoubleValue();
+    if (maxBytes < 0) {
+    throw MakeError(env, "maxBytes must be non-negative");
+    }
+    MemoryTracker::SetBudget(static_cast<size_t>(maxBytes));
+    if (info.Length() == 2) MemoryTracker::TrackMats(info[1].As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+/**
+ * @brief 以 Chrome trace-event JSON 字符串返回已记录的事件
+ * 
+ * @details 写入文件后可在 chrome://tracing 或 Perfetto 中打开。
+ * 
+ * @param info Node-API 回调信息
+ * @return Napi::Value JSON 字符串
+ */
+static Napi::Value GetStatsTraceWrapped(const Napi::CallbackInfo& info) {
+    std::ostringstream os;
+    Stats::WriteChromeTrace(os);
+    return Napi::String::New(info.Env(), os.str());
+}
+
 /**
  * @brief 初始化 Node-API 模块
  * 
@@ -392,8 +670,11 @@ static Napi::Value SaveTripWrapped(const Napi::CallbackInfo& info) {
  * @return Napi::Object 导出对象
  */
 static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    env.SetInstanceData(new AddonData());
+
     exports.Set("loadPng", Napi::Function::New(env, LoadPngWrapped));
     exports.Set("loadPpm", Napi::Function::New(env, LoadPpmWrapped));
+    exports.Set("loadPreview", Napi::Function::New(env, LoadPreviewWrapped));
     exports.Set("savePng", Napi::Function::New(env, SavePngWrapped));
     exports.Set("savePpm", Napi::Function::New(env, SavePpmWrapped));
     exports.Set("toGray", Napi::Function::New(env, ToGrayWrapped));
@@ -401,6 +682,27 @@ static Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("saveTrip", Napi::Function::New(env, SaveTripWrapped));
     exports.Set("compressorSave", Napi::Function::New(env, CompressorSaveWrapped));
     exports.Set("compressorLoad", Napi::Function::New(env, CompressorLoadWrapped));
+    exports.Set("encodeImage", Napi::Function::New(env, EncodeImageWrapped));
+    exports.Set("decodeImage", Napi::Function::New(env, DecodeImageWrapped));
+    exports.Set("setBufferPool", Napi::Function::New(env, SetBufferPoolWrapped));
+    exports.Set("bufferPoolStats", Napi::Function::New(env, BufferPoolStatsWrapped));
+    exports.Set("setImageCache", Napi::Function::New(env, SetImageCacheWrapped));
+    exports.Set("imageCacheStats", Napi::Function::New(env, ImageCacheStatsWrapped));
+    exports.Set("invalidateImageCache", Napi::Function::New(env, InvalidateImageCacheWrapped));
+    exports.Set("setStatsEnabled", Napi::Function::New(env, SetStatsEnabledWrapped));
+    exports.Set("getStats", Napi::Function::New(env, GetStatsWrapped));
+    exports.Set("resetStats", Napi::Function::New(env, ResetStatsWrapped));
+    exports.Set("getStatsTrace", Napi::Function::New(env, GetStatsTraceWrapped));
+    exports.Set("setMemoryBudget", Napi::Function::New(env, SetMemoryBudgetWrapped));
+
+    // 原生侧图像句柄
+    exports.Set("ImageHandle", ImageHandle::Define(env));
+
+    // 异步（Promise）版本
+    InitAsync(env, exports);
+
+    // 多文件批处理
+    InitBatch(env, exports);
     return exports;
 }
 
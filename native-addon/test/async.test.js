@@ -0,0 +1,77 @@
+const path = require('path');
+const assert = require('assert');
+const fs = require('fs');
+const addon = require('..');
+const { checkSame } = require('./helpers');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+const OUTPUT_DIR = path.resolve(__dirname, '../../cpp/build/test/out-node');
+
+function ensureDir(p) { if (!fs.existsSync(p)) fs.mkdirSync(p, { recursive: true }); }
+
+async function run() {
+  console.log('[RUN] Async tests...');
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+  ensureDir(OUTPUT_DIR);
+
+  // 异步结果应与同步版本逐字节一致
+  const c = await addon.loadPpmAsync(colorPpm);
+  checkSame(c, addon.loadPpm(colorPpm));
+  checkSame(await addon.toGrayAsync(c.width, c.height, c.data), addon.toGray(c.width, c.height, c.data));
+  checkSame(await addon.resizeAsync(c.width, c.height, c.channels, 64, 48, c.data),
+            addon.resize(c.width, c.height, c.channels, 64, 48, c.data));
+  // 同步版本末尾的 interpolation 在异步版本中作为 options 字段
+  checkSame(await addon.resizeAsync(c.width, c.height, c.channels, 64, 48, c.data, { interpolation: 'bicubic' }),
+            addon.resize(c.width, c.height, c.channels, 64, 48, c.data, 'bicubic'));
+  await assert.rejects(addon.resizeAsync(c.width, c.height, c.channels, 64, 48, c.data, { interpolation: 'nearest' }),
+                       /interpolation/);
+
+  // 进度单调递增、以 1 结束，并且汇报了中间阶段
+  const checkProgress = (progress) => {
+    assert.ok(progress.length > 0);
+    for (let i = 1; i < progress.length; ++i) assert.ok(progress[i] >= progress[i - 1]);
+    assert.strictEqual(progress[progress.length - 1], 1);
+    assert.ok(progress.some((f) => f > 0 && f < 1), `no intermediate progress in ${progress}`);
+  };
+
+  // 压缩保存：统计、三元组提取、写入三个阶段
+  const outTrip = path.join(OUTPUT_DIR, 'node_async_color.trip');
+  const progress = [];
+  assert.ok(await addon.compressorSaveAsync(outTrip, c.width, c.height, c.channels, c.data,
+                                            { onProgress: (f) => progress.push(f) }));
+  checkProgress(progress);
+  checkSame(await addon.compressorLoadAsync(outTrip), addon.compressorLoad(outTrip));
+
+  // 大图缩放按输出行分段汇报进度，结果与同步版本一致
+  const bigW = 2048, bigH = 2048;
+  const big = Buffer.alloc(bigW * bigH * 3);
+  for (let i = 0; i < big.length; ++i) big[i] = (i * 7 + (i >> 11)) & 0xff;
+  const resizeProgress = [];
+  checkSame(await addon.resizeAsync(bigW, bigH, 3, 1500, 1200, big,
+                                    { interpolation: 'lanczos3', onProgress: (f) => resizeProgress.push(f) }),
+            addon.resize(bigW, bigH, 3, 1500, 1200, big, 'lanczos3'));
+  checkProgress(resizeProgress);
+  const handleProgress = [];
+  const bigHandle = addon.ImageHandle.fromBuffer(bigW, bigH, 3, big);
+  const resizedHandle = await bigHandle.resizeAsync(1500, 1200, { onProgress: (f) => handleProgress.push(f) });
+  checkProgress(handleProgress);
+  resizedHandle.dispose();
+  bigHandle.dispose();
+
+  // 已取消的 signal 直接拒绝
+  const ac = new AbortController();
+  ac.abort();
+  await assert.rejects(addon.loadPpmAsync(colorPpm, { signal: ac.signal }), { name: 'AbortError' });
+
+  // 取消原生 token 同样以 AbortError 拒绝
+  const token = new addon.CancelToken();
+  token.cancel();
+  assert.strictEqual(token.cancelled, true);
+  await assert.rejects(addon.resizeAsync(c.width, c.height, c.channels, 64, 48, c.data, { token }),
+                       { name: 'AbortError' });
+
+  // 失败通过 Promise 拒绝而不是同步抛出
+  await assert.rejects(addon.loadPngAsync(path.join(DATA_DIR, 'no-such-file.png')));
+}
+
+module.exports = { run };
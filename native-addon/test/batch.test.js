@@ -0,0 +1,68 @@
+const path = require('path');
+const assert = require('assert');
+const fs = require('fs');
+const addon = require('..');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+const OUTPUT_DIR = path.resolve(__dirname, '../../cpp/build/test/out-node');
+
+function ensureDir(p) { if (!fs.existsSync(p)) fs.mkdirSync(p, { recursive: true }); }
+
+async function run() {
+  console.log('[RUN] Batch tests...');
+  ensureDir(OUTPUT_DIR);
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+
+  const jobs = [];
+  for (let i = 0; i < 6; ++i) {
+    jobs.push({
+      input: colorPpm,
+      output: path.join(OUTPUT_DIR, `node_batch_${i}${i % 2 ? '.png' : '.ppm'}`),
+      ops: [{ op: 'gray' }, { op: 'resize', width: 40 + i, height: 30 }],
+    });
+  }
+  jobs.push({ input: path.join(DATA_DIR, 'no-such-file.png'), output: path.join(OUTPUT_DIR, 'never.png') });
+
+  // 事件在 Promise 兑现前全部送达
+  const events = [];
+  const result = await addon.processBatch(jobs, { concurrency: 3, onEvent: (ev) => events.push(ev) });
+  assert.strictEqual(result.succeeded, 6);
+  assert.strictEqual(result.failed, 1);
+  assert.strictEqual(result.errors[0], null);
+  assert.ok(typeof result.errors[6] === 'string');
+  const done = events.filter((ev) => ev.type !== 'started');
+  assert.strictEqual(done.length, jobs.length);
+  assert.strictEqual(done.filter((ev) => ev.type === 'failed').length, 1);
+  assert.ok(done.every((ev) => ev.total === jobs.length));
+
+  for (let i = 0; i < 6; ++i) {
+    const out = jobs[i].output.endsWith('.png') ? addon.loadPng(jobs[i].output) : addon.loadPpm(jobs[i].output);
+    assert.strictEqual(out.channels, 1);
+    assert.strictEqual(out.width, 40 + i);
+  }
+
+  // 裁剪后缩放：输出尺寸由最后一步决定，裁剪越界的作业失败
+  const cropped = await addon.processBatch([
+    { input: colorPpm, output: path.join(OUTPUT_DIR, 'node_batch_crop.ppm'),
+      ops: [{ op: 'crop', x: 2, y: 2, width: 20, height: 16 }, { op: 'resize', width: 10, height: 8 }] },
+    { input: colorPpm, output: path.join(OUTPUT_DIR, 'never_crop.ppm'),
+      ops: [{ op: 'crop', x: 0, y: 0, width: 100000, height: 1 }] },
+  ]);
+  assert.strictEqual(cropped.succeeded, 1);
+  assert.ok(/crop/.test(cropped.errors[1]));
+  const crop = addon.loadPpm(path.join(OUTPUT_DIR, 'node_batch_crop.ppm'));
+  assert.strictEqual(crop.width, 10);
+  assert.strictEqual(crop.height, 8);
+
+  // 参数在调用时同步校验
+  assert.throws(() => addon.processBatch([{ input: colorPpm, output: 'x.bmp' }]));
+  assert.throws(() => addon.processBatch([{ input: colorPpm, output: 'x.png', ops: [{ op: 'blur' }] }]));
+  assert.throws(() => addon.processBatch([{ input: colorPpm, output: 'x.png', ops: [{ op: 'crop', x: 0 }] }]));
+
+  // 已取消的 signal 直接拒绝
+  const ac = new AbortController();
+  ac.abort();
+  await assert.rejects(addon.processBatch(jobs, { signal: ac.signal }), { name: 'AbortError' });
+}
+
+module.exports = { run };
@@ -0,0 +1,39 @@
+const path = require('path');
+const assert = require('assert');
+const addon = require('..');
+const { checkSame } = require('./helpers');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+
+function run() {
+  console.log('[RUN] Image cache tests...');
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+  const ref = addon.loadPpm(colorPpm);
+
+  addon.setImageCache(64 * 1024 * 1024);
+  try {
+    const before = addon.imageCacheStats();
+    const a = addon.loadPpm(colorPpm);
+    // 改写返回的 Buffer 不能污染缓存
+    a.data.fill(0);
+    const b = addon.loadPpm(colorPpm);
+    checkSame(b, ref);
+    const after = addon.imageCacheStats();
+    assert.strictEqual(after.misses, before.misses + 1);
+    assert.strictEqual(after.hits, before.hits + 1);
+    assert.ok(after.entries >= 1 && after.bytes <= after.capacity);
+
+    // 失效后重新解码
+    addon.invalidateImageCache(colorPpm);
+    addon.loadPpm(colorPpm);
+    assert.strictEqual(addon.imageCacheStats().misses, after.misses + 1);
+    addon.invalidateImageCache();
+    assert.strictEqual(addon.imageCacheStats().entries, 0);
+  } finally {
+    addon.setImageCache(0);
+  }
+  assert.strictEqual(addon.imageCacheStats().capacity, 0);
+  assert.throws(() => addon.setImageCache(-1));
+}
+
+module.exports = { run };
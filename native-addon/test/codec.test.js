@@ -21,6 +21,17 @@ function run() {
   assert.strictEqual(restored.width, c.width);
   assert.strictEqual(restored.height, c.height);
   assert.strictEqual(restored.channels, c.channels);
+  assert.strictEqual(restored.bitDepth, 8);
+
+  // BGRA 图像：alpha 通道原样保存并还原
+  const w = 16, h = 8;
+  const bgra = Buffer.alloc(w * h * 4, 255);
+  for (let i = 0; i < 20; ++i) bgra.writeUInt32LE(0x80102030 + i, (i * 5) * 4);
+  const outRgba = path.join(OUTPUT_DIR, 'node_bgra.trip');
+  assert.ok(addon.compressorSave(outRgba, w, h, 4, bgra));
+  const rgba = addon.compressorLoad(outRgba);
+  assert.strictEqual(rgba.channels, 4);
+  assert.ok(Buffer.from(rgba.data).equals(bgra));
 }
 
 module.exports = { run };
\ No newline at end of file
@@ -0,0 +1,81 @@
+const path = require('path');
+const assert = require('assert');
+const fs = require('fs');
+const addon = require('..');
+const { checkSame } = require('./helpers');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+const OUTPUT_DIR = path.resolve(__dirname, '../../cpp/build/test/out-node');
+
+function ensureDir(p) { if (!fs.existsSync(p)) fs.mkdirSync(p, { recursive: true }); }
+
+async function run() {
+  console.log('[RUN] ImageHandle tests...');
+  const { ImageHandle } = addon;
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+  ensureDir(OUTPUT_DIR);
+
+  // 链式处理结果与逐步调用导出函数一致
+  const c = addon.loadPpm(colorPpm);
+  const expected = addon.resize(c.width, c.height, 1, 64, 48, addon.toGray(c.width, c.height, c.data).data);
+  const h = ImageHandle.load(colorPpm);
+  assert.strictEqual(h.width, c.width);
+  assert.strictEqual(h.channels, 3);
+  const small = h.toGray().resize(64, 48);
+  checkSame(small.toObject(), expected);
+
+  // 保存按扩展名选择格式
+  const outPng = path.join(OUTPUT_DIR, 'node_handle.png');
+  assert.ok(small.save(outPng));
+  checkSame(ImageHandle.load(outPng).toObject(), expected);
+  assert.throws(() => small.save(path.join(OUTPUT_DIR, 'node_handle.bmp')));
+
+  // 异步方法返回新句柄
+  const ha = await ImageHandle.loadAsync(colorPpm);
+  const smallAsync = await (await ha.toGrayAsync()).resizeAsync(64, 48);
+  checkSame(smallAsync.toObject(), expected);
+  checkSame((await h.resizeAsync(64, 48, { interpolation: 'lanczos3' })).toObject(), h.resize(64, 48, 'lanczos3').toObject());
+  assert.ok(await smallAsync.saveAsync(path.join(OUTPUT_DIR, 'node_handle_async.ppm')));
+
+  // fromBuffer 拷贝像素，与源 Buffer 无关
+  const src = Buffer.from(c.data);
+  const hb = ImageHandle.fromBuffer(c.width, c.height, c.channels, src);
+  src.fill(0);
+  checkSame(hb.toObject(), c);
+
+  // toRgba 把 BGR 转为 RGBA，alpha 为 255
+  const rgba = hb.toRgba();
+  assert.strictEqual(rgba.length, c.width * c.height * 4);
+  for (const i of [0, c.width * c.height - 1]) {
+    assert.deepStrictEqual([...rgba.subarray(i * 4, i * 4 + 4)], [c.data[i * 3 + 2], c.data[i * 3 + 1], c.data[i * 3], 255]);
+  }
+
+  // crop 返回视图句柄：与在 JS 中逐行拷贝出的区域一致，先裁剪再缩放与缩放拷贝出的区域一致
+  const [x, y, w, hh] = [5, 3, c.width - 17, c.height - 11];
+  const region = Buffer.alloc(w * hh * c.channels);
+  for (let r = 0; r < hh; ++r) {
+    c.data.copy(region, r * w * c.channels, ((y + r) * c.width + x) * c.channels, ((y + r) * c.width + x + w) * c.channels);
+  }
+  const view = h.crop(x, y, w, hh);
+  assert.strictEqual(view.width, w);
+  assert.strictEqual(view.height, hh);
+  checkSame(view.toObject(), { width: w, height: hh, channels: c.channels, data: region });
+  checkSame(view.resize(32, 24, 'bicubic').toObject(), addon.resize(w, hh, c.channels, 32, 24, region, 'bicubic'));
+  checkSame(view.toGray().crop(1, 1, 10, 10).toObject(), h.toGray().crop(x + 1, y + 1, 10, 10).toObject());
+  assert.throws(() => h.crop(0, 0, c.width + 1, 1));
+  assert.throws(() => h.crop(-1, 0, 4, 4));
+  assert.throws(() => h.crop(0, 0, 0, 4));
+
+  // dispose 之后不可再使用，重复 dispose 无副作用
+  h.dispose();
+  h.dispose();
+  assert.strictEqual(h.disposed, true);
+  assert.throws(() => h.width);
+  assert.throws(() => h.toGray());
+  assert.throws(() => new ImageHandle());
+
+  // 视图持有像素引用，原句柄 dispose 后仍然有效
+  checkSame(view.toObject(), { width: w, height: hh, channels: c.channels, data: region });
+}
+
+module.exports = { run };
@@ -20,6 +20,16 @@ function run() {
   const down = addon.resize(c.width, c.height, c.channels, Math.floor(c.width / 2), Math.floor(c.height / 2), c.data);
   assert.strictEqual(down.width, Math.floor(c.width / 2));
   assert.strictEqual(down.height, Math.floor(c.height / 2));
+
+  // 高质量插值：类型不变，常数图像保持常数
+  for (const mode of ['bicubic', 'lanczos3']) {
+    const big = addon.resize(c.width, c.height, c.channels, c.width * 3, c.height * 2, c.data, mode);
+    assert.strictEqual(big.width, c.width * 3);
+    assert.strictEqual(big.channels, c.channels);
+    const flat = addon.resize(4, 4, 1, 9, 7, Buffer.alloc(16, 200), mode);
+    assert.ok(flat.data.every((v) => v === 200));
+  }
+  assert.throws(() => addon.resize(c.width, c.height, c.channels, 8, 8, c.data, 'nearest'), /interpolation/);
 }
 
 module.exports = { run };
\ No newline at end of file
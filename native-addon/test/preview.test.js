@@ -0,0 +1,28 @@
+const path = require('path');
+const assert = require('assert');
+const addon = require('..');
+const { checkSame } = require('./helpers');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+
+async function run() {
+  console.log('[RUN] Preview tests...');
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+  const full = addon.loadPpm(colorPpm);
+
+  // 长边不超过 maxDim，保持通道数
+  const p = addon.loadPreview(colorPpm, 100);
+  assert.strictEqual(Math.max(p.width, p.height), 100);
+  assert.strictEqual(p.channels, full.channels);
+  assert.strictEqual(p.data.length, p.width * p.height * p.channels);
+
+  // 异步版本结果相同；maxDim 不小于原图时不缩小
+  checkSame(await addon.loadPreviewAsync(colorPpm, 100), p);
+  checkSame(addon.loadPreview(colorPpm, 4096), full);
+
+  assert.throws(() => addon.loadPreview(colorPpm, 0));
+  assert.throws(() => addon.loadPreview(path.join(DATA_DIR, 'missing.ppm'), 64));
+  await assert.rejects(addon.loadPreviewAsync(path.join(DATA_DIR, 'missing.ppm'), 64));
+}
+
+module.exports = { run };
@@ -89,12 +89,22 @@ function runIntegrationTest() {
   assert.ok(fs.existsSync(outPng));
 }
 
-function main() {
+async function main() {
   runIoTests();
   runImgprocTests();
   runCodecTests();
   runIntegrationTest();
+  require('./zerocopy.test').run();
+  require('./cache.test').run();
+  await require('./async.test').run();
+  await require('./preview.test').run();
+  await require('./handle.test').run();
+  await require('./batch.test').run();
+  await require('./stats.test').run();
   console.log('[OK] Node tests passed.');
 }
 
-main();
\ No newline at end of file
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
\ No newline at end of file
@@ -0,0 +1,64 @@
+const path = require('path');
+const assert = require('assert');
+const addon = require('..');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+
+async function run() {
+  console.log('[RUN] Stats tests...');
+  const colorPpm = path.join(DATA_DIR, 'color-block.ppm');
+  const c = addon.loadPpm(colorPpm);
+
+  addon.resetStats();
+  assert.strictEqual(addon.getStats().enabled, false);
+  addon.toGray(c.width, c.height, c.data);
+  assert.strictEqual(addon.getStats().stages.gray.count, 0);
+
+  addon.setStatsEnabled(true, true);
+  try {
+    addon.toGray(c.width, c.height, c.data);
+    addon.resize(c.width, c.height, c.channels, 32, 32, c.data);
+    // 异步版本在工作线程上计时，同样计入
+    await addon.resizeAsync(c.width, c.height, c.channels, 16, 16, c.data);
+    const stats = addon.getStats();
+    assert.strictEqual(stats.tracing, true);
+    assert.strictEqual(stats.stages.gray.count, 1);
+    assert.strictEqual(stats.stages.gray.bytes, c.data.length);
+    assert.strictEqual(stats.stages.resize.count, 2);
+    assert.ok(stats.stages.resize.totalMs >= stats.stages.resize.maxMs);
+
+    const trace = JSON.parse(addon.getStatsTrace());
+    assert.ok(trace.traceEvents.some((e) => e.name === 'gray' && e.ph === 'X'));
+
+    addon.resetStats();
+    assert.strictEqual(addon.getStats().stages.resize.count, 0);
+  } finally {
+    addon.setStatsEnabled(false);
+    addon.resetStats();
+  }
+  assert.throws(() => addon.setStatsEnabled('yes'));
+
+  // 内存记账与预算
+  console.log('[RUN] Memory accounting tests...');
+  addon.setStatsEnabled(true);
+  try {
+    addon.resetStats();
+    const out = path.join(path.resolve(__dirname, '../../cpp/build/test/out-node'), 'stats_memory.trip');
+    assert.ok(addon.compressorSave(out, c.width, c.height, c.channels, c.data));
+    const stats = addon.getStats();
+    assert.ok(stats.stages.compress.peakBytes > 0);
+    assert.ok(stats.memory.categories.triplets.peak > 0);
+    assert.ok(Array.isArray(stats.memory.threads) && stats.memory.threads.length > 0);
+
+    addon.setMemoryBudget(stats.memory.current + 1024, true);
+    assert.throws(() => addon.compressorSave(out, c.width, c.height, c.channels, c.data), /memory budget exceeded/);
+    assert.ok(addon.getStats().memory.budgetFailures >= 1);
+  } finally {
+    addon.setMemoryBudget(0, false);
+    addon.setStatsEnabled(false);
+    addon.resetStats();
+  }
+  assert.throws(() => addon.setMemoryBudget(-1));
+}
+
+module.exports = { run };
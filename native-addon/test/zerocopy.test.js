@@ -0,0 +1,46 @@
+const path = require('path');
+const assert = require('assert');
+const addon = require('..');
+const { checkSame } = require('./helpers');
+
+const DATA_DIR = path.resolve(__dirname, '../../data');
+
+function run() {
+  console.log('[RUN] Zero-copy / buffer pool tests...');
+  const c = addon.loadPpm(path.join(DATA_DIR, 'color-block.ppm'));
+
+  // 输入直接引用 JS 内存：输出必须与输入独立，之后修改输入不影响输出
+  const input = Buffer.from(c.data);
+  const gray = addon.toGray(c.width, c.height, input);
+  const snapshot = Buffer.from(gray.data);
+  input.fill(0);
+  assert.strictEqual(Buffer.compare(gray.data, snapshot), 0);
+
+  // 启用内存池后结果不变
+  const ref = addon.resize(c.width, c.height, c.channels, 100, 80, c.data);
+  addon.setBufferPool(true, 64 * 1024 * 1024);
+  try {
+    for (let i = 0; i < 4; ++i) {
+      checkSame(addon.resize(c.width, c.height, c.channels, 100, 80, c.data), ref);
+      if (global.gc) global.gc();
+    }
+    const stats = addon.bufferPoolStats();
+    assert.ok(stats.misses >= 1);
+    assert.ok(stats.cachedBytes <= 64 * 1024 * 1024);
+  } finally {
+    addon.setBufferPool(false);
+  }
+  assert.strictEqual(addon.bufferPoolStats().cachedBytes, 0);
+  assert.throws(() => addon.setBufferPool('yes'));
+
+  // 内存编解码往返，编码参数可选
+  const png = addon.encodeImage('png', c.width, c.height, c.channels, c.data, { pngCompression: 1, pngStrategy: 'rle' });
+  assert.ok(Buffer.isBuffer(png) && png.length > 0);
+  checkSame(addon.decodeImage(png), c);
+  const ppm = addon.encodeImage('ppm', c.width, c.height, c.channels, c.data, { ppmBinary: false });
+  checkSame(addon.decodeImage(ppm), c);
+  assert.throws(() => addon.encodeImage('png', c.width, c.height, c.channels, c.data, { pngStrategy: 'best' }));
+  assert.throws(() => addon.decodeImage(Buffer.alloc(0)));
+}
+
+module.exports = { run };
@@ -17,45 +17,28 @@ import { Box, Card, CardContent, CardHeader, Button, Typography, Divider, TextFi
 import '@fontsource/roboto/400.css'
 import '@fontsource/roboto/500.css'
 
-// 图像数据类型定义
-type ImageDataObj = { width: number; height: number; channels: number; data: Uint8Array }
+// 主进程中原生图像句柄的描述（像素留在主进程）
+type HandleMeta = { id: number; width: number; height: number; channels: number }
 
 /**
  * Canvas 图像渲染组件
  * 
- * 将图像数据（灰度或 BGR）转换并绘制到 Canvas，支持指定显示尺寸。
+ * 由主进程把句柄的图像转换为 RGBA，预加载脚本直接写入 Canvas，渲染进程不做逐像素转换。
  * 
- * @param param0.image - 图像数据
+ * @param param0.image - 图像句柄描述
+ * @param param0.canvasId - Canvas 元素 id，预加载脚本据此找到画布
  * @param param0.fixedWidth - 显示宽度
  * @param param0.fixedHeight - 显示高度
  * @returns Canvas 元素
  */
-function CanvasImage({ image, fixedWidth, fixedHeight }: { image?: ImageDataObj, fixedWidth: number, fixedHeight: number }) {
-  const canvasRef = useRef<HTMLCanvasElement>(null)
+function CanvasImage({ image, canvasId, fixedWidth, fixedHeight }: { image?: HandleMeta, canvasId: string, fixedWidth: number, fixedHeight: number }) {
   useEffect(() => {
-    const canvas = canvasRef.current
-    if (!canvas || !image) return
-    canvas.width = image.width
-    canvas.height = image.height
-    const ctx = canvas.getContext('2d')!
-    const imgData = ctx.createImageData(image.width, image.height)
-    const src = image.data
-    const dst = imgData.data
-    if (image.channels === 1) {
-      for (let i = 0, j = 0; i < src.length; i++, j += 4) {
-        const g = src[i]
-        dst[j] = g; dst[j + 1] = g; dst[j + 2] = g; dst[j + 3] = 255
-      }
-    } else {
-      // 将 BGR 转为 RGBA
-      for (let i = 0, j = 0; i < src.length; i += 3, j += 4) {
-        const b = src[i], g = src[i + 1], r = src[i + 2]
-        dst[j] = r; dst[j + 1] = g; dst[j + 2] = b; dst[j + 3] = 255
-      }
-    }
-    ctx.putImageData(imgData, 0, 0)
-  }, [image])
-  return <canvas ref={canvasRef} style={{ width: fixedWidth, height: fixedHeight, background: '#222' }} />
+    if (!image) return
+    window.native.handle.draw(image.id, canvasId).catch((e) => {
+      console.error('Failed to draw image', e)
+    })
+  }, [image, canvasId])
+  return <canvas id={canvasId} style={{ width: fixedWidth, height: fixedHeight, background: '#222' }} />
 }
 
 /**
@@ -66,7 +49,7 @@ function App() {
 
   const theme = useMemo(() => createTheme({ palette: { mode: 'light' } }), [])
 
-  const [current, setCurrent] = useState<ImageDataObj | undefined>(undefined)
+  const [current, setCurrent] = useState<HandleMeta | undefined>(undefined)
 
   const LEFT_WIDTH = 540
   const LEFT_HEIGHT = 540
@@ -74,13 +57,29 @@ function App() {
   const [resizeW, setResizeW] = useState('')
   const [resizeH, setResizeH] = useState('')
 
+  // 当前图像在主进程中的原生句柄 id；处理、保存与显示都基于句柄
+  const handleIdRef = useRef<number | undefined>(undefined)
+
+  // 切换到新句柄用于显示，并释放旧句柄
+  const adopt = async (meta: HandleMeta) => {
+    const prev = handleIdRef.current
+    handleIdRef.current = meta.id
+    setCurrent(meta)
+    if (prev !== undefined) await window.native.handle.dispose(prev)
+  }
+
+  // 在当前句柄上保存，格式由扩展名决定，缺少扩展名时补上
+  const saveCurrent = async (target: string, ext: string) => {
+    if (handleIdRef.current === undefined) return false
+    const path = target.toLowerCase().endsWith(ext) ? target : target + ext
+    return window.native.handle.save(handleIdRef.current, path)
+  }
+
   const handleUpload = async () => {
     try {
       const chosen = await window.native.openImageDialog()
       if (!chosen) return
-      const isPpm = chosen.endsWith('.ppm')
-      const img = isPpm ? await window.native.loadPpm(chosen) : await window.native.loadPng(chosen)
-      setCurrent(img)
+      await adopt(await window.native.handle.load(chosen))
     } catch (e) {
       console.error(e)
       alert('加载图片失败: ' + (e as any).message)
@@ -92,7 +91,7 @@ function App() {
       if (!current) return
       const target = await window.native.savePngDialog()
       if (!target) return
-      const ok = await window.native.savePng(target, current)
+      const ok = await saveCurrent(target, '.png')
       alert(ok ? '保存 PNG 成功' : '保存 PNG 失败')
     } catch (e) { alert('保存 PNG 出错: ' + (e as any).message) }
   }
@@ -102,7 +101,7 @@ function App() {
       if (!current) return
       const target = await window.native.savePpmDialog()
       if (!target) return
-      const ok = await window.native.savePpm(target, current)
+      const ok = await saveCurrent(target, '.ppm')
       alert(ok ? '保存 PPM 成功' : '保存 PPM 失败')
     } catch (e) { alert('保存 PPM 出错: ' + (e as any).message) }
   }
@@ -112,7 +111,7 @@ function App() {
       if (!current) return
       const target = await window.native.saveTripDialog()
       if (!target) return
-      const ok = await window.native.compressorSave(target, current)
+      const ok = await saveCurrent(target, '.trip')
       alert(ok ? '保存 .trip 成功' : '保存 .trip 失败')
     } catch (e) { alert('保存 .trip 出错: ' + (e as any).message) }
   }
@@ -121,27 +120,24 @@ function App() {
     try {
       const chosen = await window.native.openTripDialog()
       if (!chosen) return
-      const img = await window.native.compressorLoad(chosen)
-      setCurrent(img)
+      await adopt(await window.native.handle.load(chosen))
     } catch (e) { alert('读入 .trip 出错: ' + (e as any).message) }
   }
 
   const handleToGray = async () => {
     try {
-      if (!current) return
-      if (current.channels !== 3) { alert('当前不是彩色图'); return }
-      const img = await window.native.toGray({ width: current.width, height: current.height, data: current.data })
-      setCurrent(img)
+      if (!current || handleIdRef.current === undefined) return
+      if (current.channels === 1) { alert('当前已是灰度图'); return }
+      await adopt(await window.native.handle.toGray(handleIdRef.current))
     } catch (e) { alert('灰度转换出错: ' + (e as any).message) }
   }
 
   const handleResize = async () => {
     try {
-      if (!current) return
+      if (!current || handleIdRef.current === undefined) return
       const w = parseInt(resizeW, 10), h = parseInt(resizeH, 10)
       if (!Number.isFinite(w) || !Number.isFinite(h) || w <= 0 || h <= 0) { alert('尺寸不合法'); return }
-      const img = await window.native.resize(current, w, h)
-      setCurrent(img)
+      await adopt(await window.native.handle.resize(handleIdRef.current, w, h))
     } catch (e) { alert('缩放出错: ' + (e as any).message) }
   }
 
@@ -156,7 +152,7 @@ function App() {
           <Divider sx={{ mb: 2 }} />
           <Box sx={{ flex: 1, width: LEFT_WIDTH, height: LEFT_HEIGHT, border: '1px solid #eee', display: 'flex', alignItems: 'center', justifyContent: 'center', overflow: 'hidden' }}>
             {/* 固定显示区域，不随图片大小变化；通过 CSS 控制画布尺寸 */}
-            <CanvasImage image={current} fixedWidth={LEFT_WIDTH} fixedHeight={LEFT_HEIGHT} />
+            <CanvasImage image={current} canvasId="preview-canvas" fixedWidth={LEFT_WIDTH} fixedHeight={LEFT_HEIGHT} />
           </Box>
         </Box>
 